@@ -253,7 +253,7 @@ bool OGLESSkinning::createPipelines(const pvr::api::DescriptorSetLayout& default
 	int skinnedMeshId = -1, nonSkinnedMeshId = -1;
 	for (int i = 0; i < scene->getNumMeshes() && (skinnedMeshId == -1 || nonSkinnedMeshId == -1); ++i)
 	{
-		bool skinned = (scene->getMesh(i).getVertexAttributeIndex("BONEWEIGHT") != -1);
+		bool skinned = (scene->getMesh(i).getVertexAttributeIndex(pvr::StringHashLiteral("BONEWEIGHT")) != -1);
 		if (skinned && skinnedMeshId == -1) { skinnedMeshId = i; }
 		if (!skinned && nonSkinnedMeshId == -1) { nonSkinnedMeshId = i; }
 	}
@@ -609,7 +609,7 @@ void OGLESSkinning::recordCommandBuffer()
 			for (pvr::uint32 i32Batch = 0; i32Batch < mesh.getNumBoneBatches(); ++i32Batch)
 			{
 				// Set the number of bones that will influence each vertex in the mesh
-				secBuff->setUniform<pvr::int32>(skinnedUniformLocations[SkinnedUniforms::BoneCount], mesh.getVertexAttributeByName("BONEINDEX")->getN());
+				secBuff->setUniform<pvr::int32>(skinnedUniformLocations[SkinnedUniforms::BoneCount], mesh.getVertexAttributeByName(pvr::StringHashLiteral("BONEINDEX"))->getN());
 				secBuff->setUniformPtr<glm::mat4>(skinnedUniformLocations[SkinnedUniforms::BoneMatrices], mesh.getBatchBoneCount(i32Batch), uniforms.perSkinnedMesh[currentSkinnedMesh][i32Batch].boneWorld);
 				secBuff->setUniformPtr<glm::mat3>(skinnedUniformLocations[SkinnedUniforms::BoneMatricesIT], mesh.getBatchBoneCount(i32Batch), uniforms.perSkinnedMesh[currentSkinnedMesh][i32Batch].boneWorldIT);
 
@@ -8,9 +8,11 @@
 #include "PVRApi/ApiIncludes.h"
 #include "PVRApi/ApiCommand.h"
 #include "PVRApi/ApiCommands.h"
+#include "PVRApi/CommandEncoding.h"
 #include "PVRApi/ApiObjects/GraphicsPipeline.h"
 #include "PVRApi/ApiObjects/ComputePipeline.h"
 #include "PVRCore/StackTrace.h"
+#include "PVRCore/Profiler.h"
 #define USE_NONHOMOGENEOUS_LIST
 #ifdef USE_NONHOMOGENEOUS_LIST
 #include "PVRCore/ListOfInterfaces.h"
@@ -58,6 +60,9 @@ public:
 		In debug builds (define DEBUG or define PVR_STORE_STACK_TRACE_WITH_API_COMMANDS), a limited stack trace 
 		is stored with each command so that if an error occurs, the site where the command was actually added to the 
 		command buffer can be determined.
+		Draws, uniforms and dynamic states are recorded as a few bytes each into a single growing block of memory,
+		kept when the command buffer is recorded again, and executed without a virtual call, so that recording and
+		submitting thousands of them every frame stays cheap.
 		
 		Primary command buffers can contain RenderPasses, and can be submitted to the GPU.
 		Secondary command buffers cannot contain RenderPasses, and can be enqueued to PrimaryCommandBuffers.
@@ -214,7 +219,8 @@ public:
 	void drawIndexed(uint32 firstIndex, uint32 indexCount, uint32 vertexOffset = 0,
 	                 uint32 firstInstance = 0, uint32 instanceCount = 1)
 	{
-		enqueue_internal<DrawIndexed>(DrawIndexed(firstIndex, indexCount, vertexOffset, firstInstance, instanceCount));
+		encode(encoding::CommandType::DrawIndexed,
+		       encoding::DrawIndexed(firstIndex, indexCount, vertexOffset, firstInstance, instanceCount));
 	}
 
 	/*!****************************************************************************************************************
@@ -227,7 +233,7 @@ public:
 	*******************************************************************************************************************/
 	void drawArrays(uint32 firstVertex, uint32 vertexCount, uint32 firstInstance = 0, uint32 instanceCount = 1)
 	{
-		enqueue_internal<DrawArrays>(DrawArrays(firstVertex, vertexCount, firstInstance, instanceCount));
+		encode(encoding::CommandType::DrawArrays, encoding::DrawArrays(firstVertex, vertexCount, firstInstance, instanceCount));
 	}
 
 	/*!****************************************************************************************************************
@@ -282,7 +288,7 @@ public:
 	*******************************************************************************************************************/
 	void setViewport(const pvr::Rectanglei & viewport)
 	{
-		enqueue_internal<SetViewport>(SetViewport(viewport));
+		encode(encoding::CommandType::SetViewport, viewport);
 	}
 
 	/*!****************************************************************************************************************
@@ -291,7 +297,7 @@ public:
 	*******************************************************************************************************************/
 	void setScissor(const pvr::Rectanglei & scissor)
 	{
-		enqueue_internal<SetScissor>(SetScissor(scissor));
+		encode(encoding::CommandType::SetScissor, scissor);
 	}
 
 	/*!****************************************************************************************************************
@@ -311,7 +317,7 @@ public:
 	*******************************************************************************************************************/
 	void setStencilCompareMask(pvr::api::Face::Enum face, pvr::uint32 compareMask)
 	{
-		enqueue_internal<SetStencilCompareMask>(SetStencilCompareMask(face, compareMask));
+		encode(encoding::CommandType::SetStencilCompareMask, encoding::SetStencil(face, compareMask));
 	}
 
 	/*!****************************************************************************************************************
@@ -321,7 +327,7 @@ public:
 	*******************************************************************************************************************/
 	void setStencilWriteMask(pvr::api::Face::Enum face, pvr::uint32 writeMask)
 	{
-		enqueue_internal<SetStencilWriteMask>(SetStencilWriteMask(face, writeMask));
+		encode(encoding::CommandType::SetStencilWriteMask, encoding::SetStencil(face, writeMask));
 	}
 
 	/*!****************************************************************************************************************
@@ -331,7 +337,7 @@ public:
 	*******************************************************************************************************************/
 	void setStencilReference(pvr::api::Face::Enum face, pvr::uint32 ref)
 	{
-		enqueue_internal<SetStencilReference>(SetStencilReference(face, ref));
+		encode(encoding::CommandType::SetStencilReference, encoding::SetStencil(face, ref));
 	}
 
 	void setDepthBias(pvr::float32 depthBias, pvr::float32 depthBiasClamp, pvr::float32 slopeScaledDepthBias)
@@ -348,7 +354,7 @@ public:
 	*******************************************************************************************************************/
 	void setBlendConstants(pvr::float32 r, pvr::float32 g, pvr::float32 b, pvr::float32 a)
 	{
-		enqueue_internal<SetBlendConstants>(SetBlendConstants(glm::vec4(r, g, b, a)));
+		encode(encoding::CommandType::SetBlendConstants, glm::vec4(r, g, b, a));
 	}
 
 	/*!****************************************************************************************************************
@@ -377,7 +383,7 @@ public:
 	*******************************************************************************************************************/
 	void dispatchCompute(uint32 numGroupsX, uint32 numGroupsY = 1, uint32 numGroupsZ = 1)
 	{
-		enqueue_internal<DispatchCompute>(DispatchCompute(numGroupsX, numGroupsY, numGroupsZ));
+		encode(encoding::CommandType::DispatchCompute, encoding::DispatchCompute(numGroupsX, numGroupsY, numGroupsZ));
 	}
 
 	/*!****************************************************************************************************************
@@ -395,7 +401,11 @@ public:
 	template<typename _type>
 	void setUniform(int32 location, const _type& val)
 	{
-		enqueue_internal<SetUniform<_type>/**/>(SetUniform<_type>(location, val));
+		// submit reads every SetUniform record as a SetUniform<int32>, and passes the address of its value on
+		static_assert(offsetof(encoding::SetUniform<_type>, value) == offsetof(encoding::SetUniform<int32>, value),
+		              "Uniform values must follow their location");
+		encode(encoding::CommandType::SetUniform, encoding::SetUniform<_type>(location, val),
+		       encoding::UniformTypeOf<_type>::value);
 	}
 
 	/*!****************************************************************************************************************
@@ -416,7 +426,8 @@ public:
 	template<typename _type>
 	void setUniformPtr(int32 location, pvr::uint32 count, const _type* ptr)
 	{
-		enqueue_internal<SetUniformPtr<_type>/**/>(SetUniformPtr<_type>(location, count, ptr));
+		encode(encoding::CommandType::SetUniformPtr, encoding::SetUniformPtr(location, count, ptr),
+		       encoding::UniformTypeOf<_type>::value);
 	}
 
 	/*!****************************************************************************************************************
@@ -467,14 +478,21 @@ public:
 	/*!*********************************************************************************************************************
 	\brief Clear the command queue. It is invalid to clear the command buffer while it is being recorded
 	***********************************************************************************************************************/
-	void clear() {	queue.clear(); }
+	void clear()
+	{
+		commands.clear();
+		queue.clear();
+#ifdef DEBUG
+		debug_commandCallSiteStackTraces.clear();
+#endif
+	}
 
 #ifdef DEBUG
 	void logCommandStackTraces()
 	{
-		for (auto it = queue.begin(); it != queue.end(); ++it)
+		for (auto it = debug_commandCallSiteStackTraces.begin(); it != debug_commandCallSiteStackTraces.end(); ++it)
 		{
-			Log(Log.Debug, it->debug_commandCallSiteStackTrace.c_str());
+			Log(Log.Debug, it->c_str());
 		}
 	}
 #endif
@@ -487,7 +505,22 @@ protected:
 	typedef std::deque<ApiCommand*> CommandQueue;
 #endif
 	GraphicsContext context;
-	CommandQueue queue;
+	encoding::CommandStream commands; //!< All the commands recorded, in order, executed by submit
+	CommandQueue queue; //!< Owns the ApiCommand objects that the ApiCommand records of the command stream point to
+#ifdef DEBUG
+	std::vector<std::string> debug_commandCallSiteStackTraces; //!< One per command of the command stream
+#endif
+
+	//Encode a command with its parameters inline in the command stream
+	template<typename ParametersType>
+	void encode(encoding::CommandType::Enum type, const ParametersType& parameters, uint16 uniformType = 0)
+	{
+		if (!valdidateRecordState()) { return; }
+		commands.append(type, parameters, uniformType);
+#ifdef DEBUG
+		debug_commandCallSiteStackTraces.push_back(getStackTraceInfo(2));
+#endif
+	}
 
 	//Enqueue a parameterless object
 	template<typename ClassType, typename ObjectType> void enqueue_internal(const ObjectType& obj)
@@ -496,11 +529,10 @@ protected:
 
 #ifdef USE_NONHOMOGENEOUS_LIST
 		queue.emplace_back<ClassType>(obj);
+		encodeApiCommand(queue.last()->interfacePtr);
 #else
 		queue.push_back(new ClassType(obj));
-#endif
-#ifdef DEBUG
-		queue.last()->interfacePtr->debug_commandCallSiteStackTrace = getStackTraceInfo(2);
+		encodeApiCommand(queue.back());
 #endif
 	}
 
@@ -511,21 +543,19 @@ protected:
 		if (!valdidateRecordState()) { return; }
 #ifdef USE_NONHOMOGENEOUS_LIST
 		queue.emplace_back<ClassType>(obj, par);
+		encodeApiCommand(queue.last()->interfacePtr);
 #else
 		queue.push_back(new ClassType(obj, par));
-#endif
-#ifdef DEBUG
-		queue.last()->interfacePtr->debug_commandCallSiteStackTrace = getStackTraceInfo(2);
+		encodeApiCommand(queue.back());
 #endif
 	}
 
-	template<typename iterator>
-	void execute_iterator(iterator& it)
+	void encodeApiCommand(ApiCommand* command)
 	{
-#ifdef USE_NONHOMOGENEOUS_LIST
-		it->execute(*this);
-#else
-		(*it)->execute(*this);
+		commands.append(encoding::CommandType::ApiCommand, command);
+#ifdef DEBUG
+		command->debug_commandCallSiteStackTrace = getStackTraceInfo(3);
+		debug_commandCallSiteStackTraces.push_back(command->debug_commandCallSiteStackTrace);
 #endif
 	}
 	CommandBufferBaseImpl(GraphicsContext& context) : context(context)
@@ -555,14 +585,7 @@ protected:
 		return true;
 	}
 
-	void submit()
-	{
-		PVR_ASSERT(context.isValid() && "No context has been set");
-		for (CommandQueue::iterator it = queue.begin(); it != queue.end(); ++it)
-		{
-			execute_iterator(it);
-		}
-	}
+	void submit();
 
 	native::HCommandBuffer m_cmdBuffer;
 	bool m_isRecording;
@@ -612,6 +635,7 @@ public:
 	***********************************************************************************************************************/
 	void submit()
 	{
+		PVR_PROFILE_ZONE("CommandBuffer::submit");
 		CommandBufferBaseImpl::submit();
 	}
 
@@ -0,0 +1,197 @@
+/*!*********************************************************************************************************************
+\file         PVRApi\CommandEncoding.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief        Internal byte stream encoding of the commands recorded into a CommandBuffer.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRApi/ApiObjectTypes.h"
+#include "PVRApi/ApiCommand.h"
+#include "PVRCore/Rectangle.h"
+#include "PVRCore/Maths.h"
+#include <vector>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+namespace pvr {
+namespace api {
+namespace impl {
+//!\cond NO_DOXYGEN
+/*
+The commands recorded into a CommandBuffer are kept as a stream of records. Each record starts with a CommandHeader, is
+followed by the parameters of the command and padded to a multiple of 16 bytes. Records are only guaranteed to start
+8-byte aligned, which is all that the parameters of a command may require. The commands recorded most often (draws, uniforms and dynamic states) keep their parameters inline in their
+record and are executed by a switch over the type of the record, without a virtual call or an allocation per command.
+The commands holding resources (pipelines, descriptor sets, buffers, render passes, fences...) stay ApiCommand objects,
+owned by the CommandBuffer, that their record only points to.
+*/
+namespace encoding {
+struct CommandType
+{
+	enum Enum
+	{
+		ApiCommand, // The record points to an ApiCommand, executed through its virtual execute
+		DrawIndexed,
+		DrawArrays,
+		SetViewport,
+		SetScissor,
+		SetStencilCompareMask,
+		SetStencilWriteMask,
+		SetStencilReference,
+		SetBlendConstants,
+		DispatchCompute,
+		SetUniform, // The value of the uniform is inline
+		SetUniformPtr // The record points to the values of the uniform, read at each submit
+	};
+};
+
+struct UniformType
+{
+	enum Enum
+	{
+		Float32, Int32, Uint32,
+		Vec2, Ivec2, Uvec2,
+		Vec3, Ivec3, Uvec3,
+		Vec4, Ivec4, Uvec4,
+		Mat2, Mat3, Mat4
+	};
+};
+
+// The UniformType of each type that setUniform and setUniformPtr accept. Other types do not compile.
+template<typename> struct UniformTypeOf;
+template<> struct UniformTypeOf<float32> { enum { value = UniformType::Float32 }; };
+template<> struct UniformTypeOf<int32> { enum { value = UniformType::Int32 }; };
+template<> struct UniformTypeOf<uint32> { enum { value = UniformType::Uint32 }; };
+template<> struct UniformTypeOf<glm::vec2> { enum { value = UniformType::Vec2 }; };
+template<> struct UniformTypeOf<glm::ivec2> { enum { value = UniformType::Ivec2 }; };
+template<> struct UniformTypeOf<glm::uvec2> { enum { value = UniformType::Uvec2 }; };
+template<> struct UniformTypeOf<glm::vec3> { enum { value = UniformType::Vec3 }; };
+template<> struct UniformTypeOf<glm::ivec3> { enum { value = UniformType::Ivec3 }; };
+template<> struct UniformTypeOf<glm::uvec3> { enum { value = UniformType::Uvec3 }; };
+template<> struct UniformTypeOf<glm::vec4> { enum { value = UniformType::Vec4 }; };
+template<> struct UniformTypeOf<glm::ivec4> { enum { value = UniformType::Ivec4 }; };
+template<> struct UniformTypeOf<glm::uvec4> { enum { value = UniformType::Uvec4 }; };
+template<> struct UniformTypeOf<glm::mat2> { enum { value = UniformType::Mat2 }; };
+template<> struct UniformTypeOf<glm::mat3> { enum { value = UniformType::Mat3 }; };
+template<> struct UniformTypeOf<glm::mat4> { enum { value = UniformType::Mat4 }; };
+
+struct CommandHeader
+{
+	uint16 type; // CommandType
+	uint16 uniformType; // UniformType of SetUniform and SetUniformPtr records
+	uint32 size; // Of the whole record, header and padding included
+};
+
+// The parameters of each command, following its header
+struct DrawIndexed
+{
+	uint32 firstIndex, indexCount, vertexOffset, firstInstance, instanceCount;
+	DrawIndexed(uint32 firstIndex, uint32 indexCount, uint32 vertexOffset, uint32 firstInstance, uint32 instanceCount) :
+		firstIndex(firstIndex), indexCount(indexCount), vertexOffset(vertexOffset), firstInstance(firstInstance),
+		instanceCount(instanceCount) {}
+};
+
+struct DrawArrays
+{
+	uint32 firstVertex, vertexCount, firstInstance, instanceCount;
+	DrawArrays(uint32 firstVertex, uint32 vertexCount, uint32 firstInstance, uint32 instanceCount) :
+		firstVertex(firstVertex), vertexCount(vertexCount), firstInstance(firstInstance), instanceCount(instanceCount) {}
+};
+
+struct SetStencil // Compare mask, write mask or reference
+{
+	Face::Enum face;
+	uint32 value;
+	SetStencil(Face::Enum face, uint32 value) : face(face), value(value) {}
+};
+
+struct DispatchCompute
+{
+	uint32 numGroupsXYZ[3];
+	DispatchCompute(uint32 numGroupsX, uint32 numGroupsY, uint32 numGroupsZ)
+	{
+		numGroupsXYZ[0] = numGroupsX, numGroupsXYZ[1] = numGroupsY, numGroupsXYZ[2] = numGroupsZ;
+	}
+};
+
+template<typename Type_>
+struct SetUniform
+{
+	int32 location;
+	Type_ value;
+	SetUniform(int32 location, const Type_& value) : location(location), value(value) {}
+};
+
+struct SetUniformPtr
+{
+	const void* values;
+	int32 location;
+	uint32 count;
+	SetUniformPtr(int32 location, uint32 count, const void* values) : values(values), location(location), count(count) {}
+};
+
+// The commands recorded into a CommandBuffer, as a stream of records. Clearing keeps the memory, so that a command
+// buffer recorded again every frame only allocates when it grows. Only the parameters of the commands are copied:
+// they must be trivially copyable and destructible, and aligned to no more than 8 bytes.
+class CommandStream
+{
+public:
+	CommandStream() : m_size(0), m_numCommands(0) {}
+
+	template<typename Parameters_>
+	void append(CommandType::Enum type, const Parameters_& parameters, uint16 uniformType = 0)
+	{
+		// So that the parameters of every record directly follow its header, where getParameters reads them
+		static_assert(std::alignment_of<Parameters_>::value <= sizeof(uint64),
+		              "Command parameters must be aligned to no more than 8 bytes");
+		const size_t numBlocks = (sizeof(Record<Parameters_>) + sizeof(Block) - 1) / sizeof(Block);
+		if (m_size + numBlocks > m_blocks.size())
+		{
+			m_blocks.resize(m_blocks.size() * 2 > m_size + numBlocks ? m_blocks.size() * 2 : m_size + numBlocks + 1024);
+		}
+		Record<Parameters_>* record = new(&m_blocks[m_size]) Record<Parameters_>(parameters);
+		record->header.type = (uint16)type;
+		record->header.uniformType = uniformType;
+		record->header.size = (uint32)(numBlocks * sizeof(Block));
+		m_size += numBlocks;
+		++m_numCommands;
+	}
+
+	const CommandHeader* begin() const { return reinterpret_cast<const CommandHeader*>(m_blocks.data()); }
+	const CommandHeader* end() const { return reinterpret_cast<const CommandHeader*>(m_blocks.data() + m_size); }
+	static const CommandHeader* next(const CommandHeader* command)
+	{
+		return reinterpret_cast<const CommandHeader*>(reinterpret_cast<const char8*>(command) + command->size);
+	}
+
+	template<typename Parameters_>
+	static const Parameters_& getParameters(const CommandHeader* command)
+	{
+		return reinterpret_cast<const Record<Parameters_>*>(command)->parameters;
+	}
+
+	uint32 getNumCommands() const { return m_numCommands; }
+
+	// Size of the records, in bytes
+	size_t getSize() const { return m_size * sizeof(Block); }
+
+	void clear() { m_size = 0; m_numCommands = 0; }
+
+private:
+	struct Block { uint64 data[2]; };
+	template<typename Parameters_>
+	struct Record
+	{
+		CommandHeader header;
+		Parameters_ parameters;
+		Record(const Parameters_& parameters) : parameters(parameters) {}
+	};
+	std::vector<Block> m_blocks;
+	size_t m_size; // In blocks
+	uint32 m_numCommands;
+};
+}
+//!\endcond
+}
+}
+}
@@ -240,6 +240,13 @@ public:
 	const DescriptorSet& getDescriptorSet() const { return m_descriptorSet; }
 
 	const assets::Effect& getEffectAsset()const {return m_assetEffect;}
+
+	/*!****************************************************************************************************************
+	\brief Get the order and render target assignment of the render passes this effect depends on. Allocate one FBO
+	       per target slot of the schedule, rather than one per pass.
+	\return The render pass schedule of the effect
+	*******************************************************************************************************************/
+	const assets::EffectRenderPassSchedule& getRenderPassSchedule() const { return m_assetEffect.renderPassSchedule; }
 private:
 	Result::Enum loadShadersForEffect(api::Shader& vertexShader, api::Shader& fragmentShader);
 	Result::Enum loadTexturesForEffect();
@@ -50,38 +50,291 @@ void bindVertexBuffer(platform::ContextGles& context)
 	context.disableUnneededAttributes();
 }
 
-void DrawArrays::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
+namespace {
+inline platform::ContextGles& getContextGles(impl::CommandBufferBaseImpl& cmdBuff)
+{
+	return static_cast<platform::ContextGles&>(*cmdBuff.getContext());
+}
+
+inline GLenum getIndexType(const platform::ContextGles::RenderStatesTracker& renderStates)
+{
+	return renderStates.iboState.indexArrayFormat == IndexType::IndexType16Bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+void drawIndexed(platform::ContextGles& context, uint32 indexCount, uint32 vertexOffset, uint32 instanceCount)
 {
-	platform::ContextGles& context = static_cast<platform::ContextGles&>(*cmdBuff.getContext());
 	platform::ContextGles::RenderStatesTracker& renderStates = context.getCurrentRenderStates();
 	bindVertexBuffer(context);
-    if(instanceCount > 1 && context.getApiCapabilities().supports(ApiCapabilities::Instancing))
-    {
-        gl::DrawArraysInstanced(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), firstVertex, vertexCount, instanceCount);
-    }
-    else
-    {
-        gl::DrawArrays(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), firstVertex, vertexCount);
-    }
+	if (instanceCount > 1 && context.getApiCapabilities().supports(ApiCapabilities::Instancing))
+	{
+		gl::DrawElementsInstanced(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), indexCount,
+		                          getIndexType(renderStates), (void*)(intptr_t)vertexOffset, instanceCount);
+	}
+	else
+	{
+		gl::DrawElements(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), indexCount,
+		                 getIndexType(renderStates), (void*)(intptr_t)vertexOffset);
+	}
 }
 
-void DrawIndexed::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
+void drawArrays(platform::ContextGles& context, uint32 firstVertex, uint32 vertexCount, uint32 instanceCount)
 {
-	pvr::platform::ContextGles& context = static_cast<pvr::platform::ContextGles&>(*cmdBuff.getContext());
 	platform::ContextGles::RenderStatesTracker& renderStates = context.getCurrentRenderStates();
 	bindVertexBuffer(context);
-    if(instanceCount > 1 && context.getApiCapabilities().supports(ApiCapabilities::Instancing))
-    {
-        gl::DrawElementsInstanced(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), indexCount,
-                                  renderStates.iboState.indexArrayFormat == IndexType::IndexType16Bit ?
-                                  GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)vertexOffset, instanceCount);
-    }
-    else
-    {
-        gl::DrawElements(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), indexCount,
-                         renderStates.iboState.indexArrayFormat == IndexType::IndexType16Bit ?
-                         GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)vertexOffset);
-    }
+	if (instanceCount > 1 && context.getApiCapabilities().supports(ApiCapabilities::Instancing))
+	{
+		gl::DrawArraysInstanced(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), firstVertex, vertexCount,
+		                        instanceCount);
+	}
+	else
+	{
+		gl::DrawArrays(ConvertToGles::drawPrimitiveType(renderStates.primitiveTopology), firstVertex, vertexCount);
+	}
+}
+
+void setViewport(platform::ContextGles& context, const Rectanglei& viewport)
+{
+	platform::ContextGles::RenderStatesTracker& recordedStates = context.getCurrentRenderStates();
+	if (recordedStates.viewport == viewport) { return; }
+	gl::Viewport(viewport.x, viewport.y, viewport.width, viewport.height);
+	recordedStates.viewport = viewport;
+}
+
+void setScissor(platform::ContextGles& context, const Rectanglei& scissor)
+{
+	platform::ContextGles::RenderStatesTracker& recordedStates = context.getCurrentRenderStates();
+	if (recordedStates.scissor == scissor) { return; }
+	gl::Scissor(scissor.x, scissor.y, scissor.width, scissor.height);
+	recordedStates.scissor = scissor;
+}
+
+void setStencilCompareMask(platform::ContextGles& context, Face::Enum face, uint32 mask)
+{
+	platform::ContextGles::RenderStatesTracker& recordedStates = context.getCurrentRenderStates();
+	switch (face)
+	{
+	case Face::Front:
+		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
+		                        recordedStates.depthStencil.refFront, mask);
+		recordedStates.depthStencil.readMaskFront = mask;
+
+		break;
+	case Face::Back:
+		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
+		                        recordedStates.depthStencil.refBack, mask);
+		recordedStates.depthStencil.readMaskBack = mask;
+
+		break;
+	case Face::FrontBack:
+		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
+		                        recordedStates.depthStencil.refFront, mask);
+
+		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
+		                        recordedStates.depthStencil.refBack, mask);
+
+		recordedStates.depthStencil.readMaskFront = recordedStates.depthStencil.readMaskBack = mask;
+		break;
+	case Face::None: break;
+	}
+}
+
+void setStencilReference(platform::ContextGles& context, Face::Enum face, uint32 ref)
+{
+	platform::ContextGles::RenderStatesTracker& recordedStates = context.getCurrentRenderStates();
+	switch (face)
+	{
+	case Face::Front:
+		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
+		                        ref, recordedStates.depthStencil.readMaskFront);
+		recordedStates.depthStencil.refFront = ref;
+
+		break;
+	case Face::Back:
+		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
+		                        ref, recordedStates.depthStencil.readMaskBack);
+		recordedStates.depthStencil.refBack = ref;
+
+		break;
+	case Face::FrontBack:
+		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
+		                        ref, recordedStates.depthStencil.readMaskFront);
+
+		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
+		                        ref, recordedStates.depthStencil.readMaskBack);
+
+		recordedStates.depthStencil.refFront = recordedStates.depthStencil.refBack = ref;
+		break;
+	case Face::None: break;
+	}
+}
+
+void setStencilWriteMask(platform::ContextGles& context, Face::Enum face, uint32 mask)
+{
+	platform::ContextGles::RenderStatesTracker& recordedStates = context.getCurrentRenderStates();
+	switch (face)
+	{
+	case Face::Front:
+		gl::StencilMaskSeparate(GL_FRONT, mask);
+		recordedStates.depthStencil.writeMaskFront = mask;
+		break;
+	case Face::Back:
+		gl::StencilMaskSeparate(GL_BACK, mask);
+		recordedStates.depthStencil.writeMaskBack = mask;
+		break;
+	case Face::FrontBack:
+		gl::StencilMaskSeparate(GL_FRONT_AND_BACK, mask);
+		recordedStates.depthStencil.writeMaskBack = recordedStates.depthStencil.writeMaskFront = mask;
+		break;
+	case Face::None: break;
+	}
+}
+
+void setBlendConstants(const glm::vec4& constants)
+{
+	gl::BlendColor(constants.r, constants.g, constants.b, constants.a);
+}
+
+void dispatchCompute(platform::ContextGles& context, const uint32* numGroupsXYZ)
+{
+#if BUILD_API_MAX>=31
+	if (context.hasApiCapability(ApiCapabilities::ComputeShader))
+	{
+		PVR_ASSERT(context.isQueueSupported(DeviceQueueType::Compute) && "Compute Queue Not supported by the Context");
+		gl::DispatchCompute(numGroupsXYZ[0], numGroupsXYZ[1], numGroupsXYZ[2]);
+	}
+#endif
+}
+
+// Upload count values of a uniform, of any of the types of setUniform, to the current program.
+inline void setUniform(platform::ContextGles& context, encoding::UniformType::Enum type, int32 location, uint32 count,
+                       const void* values)
+{
+	switch (type)
+	{
+	case encoding::UniformType::Float32: gl::Uniform1fv(location, count, static_cast<const GLfloat*>(values)); break;
+	case encoding::UniformType::Vec2: gl::Uniform2fv(location, count, static_cast<const GLfloat*>(values)); break;
+	case encoding::UniformType::Vec3: gl::Uniform3fv(location, count, static_cast<const GLfloat*>(values)); break;
+	case encoding::UniformType::Vec4: gl::Uniform4fv(location, count, static_cast<const GLfloat*>(values)); break;
+	case encoding::UniformType::Int32: gl::Uniform1iv(location, count, static_cast<const GLint*>(values)); break;
+	case encoding::UniformType::Ivec2: gl::Uniform2iv(location, count, static_cast<const GLint*>(values)); break;
+	case encoding::UniformType::Ivec3: gl::Uniform3iv(location, count, static_cast<const GLint*>(values)); break;
+	case encoding::UniformType::Ivec4: gl::Uniform4iv(location, count, static_cast<const GLint*>(values)); break;
+	case encoding::UniformType::Mat2:
+		gl::UniformMatrix2fv(location, count, GL_FALSE, static_cast<const GLfloat*>(values));
+		break;
+	case encoding::UniformType::Mat3:
+		gl::UniformMatrix3fv(location, count, GL_FALSE, static_cast<const GLfloat*>(values));
+		break;
+	case encoding::UniformType::Mat4:
+		gl::UniformMatrix4fv(location, count, GL_FALSE, static_cast<const GLfloat*>(values));
+		break;
+	case encoding::UniformType::Uint32:
+	case encoding::UniformType::Uvec2:
+	case encoding::UniformType::Uvec3:
+	case encoding::UniformType::Uvec4:
+		if (!context.hasApiCapability(ApiCapabilities::UintUniforms))
+		{
+			PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
+			Log(Log.Error, "SetUniform: Unsigned integer uniforms are NOT SUPPORTED in OpenGL ES 2");
+			break;
+		}
+		switch (type)
+		{
+		case encoding::UniformType::Uint32: gl::Uniform1uiv(location, count, static_cast<const GLuint*>(values)); break;
+		case encoding::UniformType::Uvec2: gl::Uniform2uiv(location, count, static_cast<const GLuint*>(values)); break;
+		case encoding::UniformType::Uvec3: gl::Uniform3uiv(location, count, static_cast<const GLuint*>(values)); break;
+		default: gl::Uniform4uiv(location, count, static_cast<const GLuint*>(values)); break;
+		}
+		break;
+	}
+}
+}
+
+// The functions executing the commands are qualified, as the recording functions of the CommandBuffer hide them
+void CommandBufferBaseImpl::submit()
+{
+	PVR_ASSERT(context.isValid() && "No context has been set");
+	platform::ContextGles& contextGles = static_cast<platform::ContextGles&>(*context);
+#ifdef DEBUG
+	std::vector<std::string>::const_iterator stackTrace = debug_commandCallSiteStackTraces.begin();
+#endif
+	const encoding::CommandHeader* end = commands.end();
+	for (const encoding::CommandHeader* command = commands.begin(); command != end; command = encoding::CommandStream::next(command))
+	{
+		switch (command->type)
+		{
+		case encoding::CommandType::ApiCommand:
+			encoding::CommandStream::getParameters<ApiCommand*>(command)->execute(*this);
+			break;
+		case encoding::CommandType::DrawIndexed:
+		{
+			const encoding::DrawIndexed& draw = encoding::CommandStream::getParameters<encoding::DrawIndexed>(command);
+			impl::drawIndexed(contextGles, draw.indexCount, draw.vertexOffset, draw.instanceCount);
+		} break;
+		case encoding::CommandType::DrawArrays:
+		{
+			const encoding::DrawArrays& draw = encoding::CommandStream::getParameters<encoding::DrawArrays>(command);
+			impl::drawArrays(contextGles, draw.firstVertex, draw.vertexCount, draw.instanceCount);
+		} break;
+		case encoding::CommandType::SetViewport:
+			impl::setViewport(contextGles, encoding::CommandStream::getParameters<Rectanglei>(command));
+			break;
+		case encoding::CommandType::SetScissor:
+			impl::setScissor(contextGles, encoding::CommandStream::getParameters<Rectanglei>(command));
+			break;
+		case encoding::CommandType::SetStencilCompareMask:
+		{
+			const encoding::SetStencil& stencil = encoding::CommandStream::getParameters<encoding::SetStencil>(command);
+			impl::setStencilCompareMask(contextGles, stencil.face, stencil.value);
+		} break;
+		case encoding::CommandType::SetStencilWriteMask:
+		{
+			const encoding::SetStencil& stencil = encoding::CommandStream::getParameters<encoding::SetStencil>(command);
+			impl::setStencilWriteMask(contextGles, stencil.face, stencil.value);
+		} break;
+		case encoding::CommandType::SetStencilReference:
+		{
+			const encoding::SetStencil& stencil = encoding::CommandStream::getParameters<encoding::SetStencil>(command);
+			impl::setStencilReference(contextGles, stencil.face, stencil.value);
+		} break;
+		case encoding::CommandType::SetBlendConstants:
+			impl::setBlendConstants(encoding::CommandStream::getParameters<glm::vec4>(command));
+			break;
+		case encoding::CommandType::DispatchCompute:
+			impl::dispatchCompute(contextGles,
+			                      encoding::CommandStream::getParameters<encoding::DispatchCompute>(command).numGroupsXYZ);
+			break;
+		case encoding::CommandType::SetUniform:
+		{
+			// All SetUniform<T> records share the layout of their location, and their value follows it
+			const encoding::SetUniform<int32>& uniform = encoding::CommandStream::getParameters<encoding::SetUniform<int32>/**/>(command);
+			impl::setUniform(contextGles, (encoding::UniformType::Enum)command->uniformType, uniform.location, 1, &uniform.value);
+		} break;
+		case encoding::CommandType::SetUniformPtr:
+		{
+			const encoding::SetUniformPtr& uniform = encoding::CommandStream::getParameters<encoding::SetUniformPtr>(command);
+			impl::setUniform(contextGles, (encoding::UniformType::Enum)command->uniformType, uniform.location, uniform.count,
+			                 uniform.values);
+		} break;
+		}
+#ifdef DEBUG
+		if (command->type != encoding::CommandType::ApiCommand)
+		{
+			debugLogApiError(("Error logged for API command. Stacktrace:\n" + *stackTrace).c_str());
+		}
+		++stackTrace;
+#endif
+	}
+}
+
+void DrawArrays::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
+{
+	drawArrays(getContextGles(cmdBuff), firstVertex, vertexCount, instanceCount);
+}
+
+void DrawIndexed::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
+{
+	drawIndexed(getContextGles(cmdBuff), indexCount, vertexOffset, instanceCount);
 }
 
 void BindIndexBuffer::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
@@ -240,7 +493,7 @@ void EndRenderPass::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
 
 void SetBlendConstants::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-	gl::BlendColor(m_constants.r, m_constants.g, m_constants.b, m_constants.a);
+	setBlendConstants(m_constants);
 }
 
 void SetLineWidth::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
@@ -250,109 +503,34 @@ void SetLineWidth::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 
 void SetViewport::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-	platform::ContextGles::RenderStatesTracker& recordedStates = static_cast<platform::ContextGles&>
-	        (*cmdBuffer.getContext()).getCurrentRenderStates();
-	if (recordedStates.viewport == m_viewport) { return; }
-	gl::Viewport(m_viewport.x, m_viewport.y, m_viewport.width, m_viewport.height);
-	recordedStates.viewport = m_viewport;
+	setViewport(getContextGles(cmdBuffer), m_viewport);
 }
 
-void SetStencilCompareMask::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
+void SetScissor::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-	platform::ContextGles::RenderStatesTracker& recordedStates = static_cast<platform::ContextGles&>
-	        (*cmdBuffer.getContext()).getCurrentRenderStates();
-	switch (m_face)
-	{
-	case Face::Front:
-		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
-		                        recordedStates.depthStencil.refFront, m_mask);
-		recordedStates.depthStencil.readMaskFront = m_mask;
-
-		break;
-	case Face::Back:
-		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
-		                        recordedStates.depthStencil.refBack, m_mask);
-		recordedStates.depthStencil.readMaskBack = m_mask;
-
-		break;
-	case Face::FrontBack:
-		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
-		                        recordedStates.depthStencil.refFront, m_mask);
-
-		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
-		                        recordedStates.depthStencil.refBack, m_mask);
+	setScissor(getContextGles(cmdBuffer), m_scissor);
+}
 
-		recordedStates.depthStencil.readMaskFront = recordedStates.depthStencil.readMaskBack = m_mask;
-		break;
-	case Face::None: break;
-	}
+void SetStencilCompareMask::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
+{
+	setStencilCompareMask(getContextGles(cmdBuffer), m_face, m_mask);
 }
 
 void SetStencilReference::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-	platform::ContextGles::RenderStatesTracker& recordedStates = static_cast<platform::ContextGles&>
-	        (*cmdBuffer.getContext()).getCurrentRenderStates();
-	switch (m_face)
-	{
-	case Face::Front:
-		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
-		                        m_ref, recordedStates.depthStencil.readMaskFront);
-		recordedStates.depthStencil.refFront = m_ref;
-
-		break;
-	case Face::Back:
-		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
-		                        m_ref, recordedStates.depthStencil.readMaskBack);
-		recordedStates.depthStencil.refBack = m_ref;
-
-		break;
-	case Face::FrontBack:
-		gl::StencilFuncSeparate(GL_FRONT, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpFront),
-		                        m_ref, recordedStates.depthStencil.readMaskFront);
-
-		gl::StencilFuncSeparate(GL_BACK, ConvertToGles::comparisonMode(recordedStates.depthStencil.stencilOpBack),
-		                        m_ref, recordedStates.depthStencil.readMaskBack);
-
-		recordedStates.depthStencil.refFront = recordedStates.depthStencil.refBack = m_ref;
-		break;
-	case Face::None: break;
-	}
+	setStencilReference(getContextGles(cmdBuffer), m_face, m_ref);
 }
 
 void SetStencilWriteMask::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-	platform::ContextGles::RenderStatesTracker& recordedStates = static_cast<platform::ContextGles&>
-	        (*cmdBuffer.getContext()).getCurrentRenderStates();
-	switch (m_face)
-	{
-	case Face::Front:
-		gl::StencilMaskSeparate(GL_FRONT, m_mask);
-		recordedStates.depthStencil.writeMaskFront = m_mask;
-		break;
-	case Face::Back:
-		gl::StencilMaskSeparate(GL_BACK, m_mask);
-		recordedStates.depthStencil.writeMaskBack = m_mask;
-		break;
-	case Face::FrontBack:
-		gl::StencilMaskSeparate(GL_FRONT_AND_BACK, m_mask);
-		recordedStates.depthStencil.writeMaskBack = recordedStates.depthStencil.writeMaskFront = m_mask;
-		break;
-	case Face::None: break;
-	}
+	setStencilWriteMask(getContextGles(cmdBuffer), m_face, m_mask);
 }
 
 
 //////////////////////////// COMPUTE COMMANDS ////////////////////////////
 void DispatchCompute::execute_private(impl::CommandBufferBaseImpl& cmdBuffer)
 {
-#if BUILD_API_MAX>=31
-	if (cmdBuffer.getContext()->hasApiCapability(ApiCapabilities::ComputeShader))
-	{
-		PVR_ASSERT(cmdBuffer.getContext()->isQueueSupported(DeviceQueueType::Compute)
-		           && "Compute Queue Not supported by the Context");
-		gl::DispatchCompute(m_numGroupXYZ[0], m_numGroupXYZ[1], m_numGroupXYZ[2]);
-	}
-#endif
+	dispatchCompute(getContextGles(cmdBuffer), m_numGroupXYZ);
 }
 
 //////////////////////////////// FENCE/SYNC COMMANDS ////////////////////////////////
@@ -418,264 +596,31 @@ void impl::CreateFenceSyncImpl::execute_private(impl::CommandBufferBaseImpl& cmd
 }
 
 //////////////////////////////// UNIFORM COMMANDS ////////////////////////////////
-void SetUniform<float32>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform1f(location, val);
-}
-
-void SetUniform<int32>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform1i(location, val);
-}
-
-void SetUniform<uint32>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		gl::Uniform1ui(location, val);
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORM NOT SUPPORTED IN OPENGL ES 2");
-	}
-}
-
-void SetUniformPtr<float32>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform1f(location, *val);
-	}
-	else
-	{
-		gl::Uniform1fv(location, count, val);
-	}
-}
-void SetUniformPtr<int32>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform1i(location, *val);
-	}
-	else
-	{
-		gl::Uniform1iv(location, count, val);
-	}
-}
-void SetUniformPtr<uint32>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform1ui(location, *val);
-	}
-	else
-	{
-		gl::Uniform1uiv(location, count, val);
-	}
-}
-
-void  SetUniform<glm::ivec2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform2i(location, val.x, val.y);
-}
-
-void SetUniform<glm::uvec2>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		gl::Uniform2ui(location, val.x, val.y);
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniform<uvec2>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniform<glm::vec2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform2f(location, val.x, val.y);
-}
-
-void SetUniformPtr<glm::ivec2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform2i(location, val->x, val->y);
-	}
-	else
-	{
-		gl::Uniform2iv(location, count, glm::value_ptr(*val));
-	}
-}
-
-void SetUniformPtr<glm::uvec2>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		if (count == 1)
-		{
-			gl::Uniform2ui(location, val->x, val->y);
-		}
-		else
-		{
-			gl::Uniform2uiv(location, count, glm::value_ptr(*val));
-		}
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniformPtr<uvec2>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniformPtr<glm::vec2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform2f(location, val->x, val->y);
-	}
-	else
-	{
-		gl::Uniform2fv(location, count, glm::value_ptr(*val));
-	}
-}
-
-void SetUniform<glm::ivec3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform3i(location, val.x, val.y, val.z);
-}
-
-void SetUniform<glm::uvec3>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		gl::Uniform3ui(location, val.x, val.y, val.z);
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniformPtr<uvec2>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniform<glm::vec3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform3f(location, val.x, val.y, val.z);
-}
-
-void SetUniformPtr<glm::ivec3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	if (count == 1)
-	{
-		gl::Uniform3i(location, val->x, val->y, val->z);
-	}
-	else
-	{
-		gl::Uniform3iv(location, count, glm::value_ptr(*val));
-	}
-}
-
-void SetUniformPtr<glm::uvec3>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		if (count == 1)
-		{
-			gl::Uniform3ui(location, val->x, val->y, val->z);
-		}
-		else
-		{
-			gl::Uniform3uiv(location, count, glm::value_ptr(*val));
-		}
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniformPtr<uvec3>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniformPtr<glm::vec3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform3fv(location, count, glm::value_ptr(*val));
-}
-
-void SetUniform<glm::ivec4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform4i(location, val.x, val.y, val.z, val.w);
-}
-
-void SetUniform<glm::uvec4>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		gl::Uniform4ui(location, val.x, val.y, val.z, val.w);
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniformPtr<uvec3>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniform<glm::vec4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform4f(location, val.x, val.y, val.z, val.w);
-}
-
-void SetUniform<glm::mat2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix2fv(location, 1, false, glm::value_ptr(val));
-}
-
-void SetUniform<glm::mat3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix3fv(location, 1, false, glm::value_ptr(val));
-}
-
-void SetUniform<glm::mat4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix4fv(location, 1, false, glm::value_ptr(val));
-}
-
-void SetUniformPtr<glm::ivec4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform4iv(location, count, glm::value_ptr(*val));
-}
-
-void SetUniformPtr<glm::uvec4>::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
-{
-	if (cmdBuff.getContext()->hasApiCapability(ApiCapabilities::UintUniforms))
-	{
-		gl::Uniform4uiv(location, count, glm::value_ptr(*val));
-	}
-	else
-	{
-		PVR_ASSERT(0 && "UNSIGNED INT UNIFORMS NOT SUPPORTED IN OPENGL ES 2");
-		Log(Log.Error, "SetUniformPtr<uvec4>::execute NOT SUPPORTED in OpenGL ES 2");
-	}
-}
-
-void SetUniformPtr<glm::vec4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::Uniform4fv(location, count, glm::value_ptr(*val));
-}
-
-void SetUniformPtr<glm::mat2>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix2fv(location, count, false, glm::value_ptr(*val));
-}
-
-void SetUniformPtr<glm::mat3>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix3fv(location, count, false, glm::value_ptr(*val));
-}
-
-void SetUniformPtr<glm::mat4>::execute_private(impl::CommandBufferBaseImpl&)
-{
-	gl::UniformMatrix4fv(location, count, false, glm::value_ptr(*val));
-}
+#define PVR_EXECUTE_SET_UNIFORM(type_) \
+void SetUniform<type_>::execute_private(impl::CommandBufferBaseImpl& cmdBuff) \
+{ \
+	setUniform(getContextGles(cmdBuff), (encoding::UniformType::Enum)encoding::UniformTypeOf<type_>::value, location, 1, &val); \
+} \
+void SetUniformPtr<type_>::execute_private(impl::CommandBufferBaseImpl& cmdBuff) \
+{ \
+	setUniform(getContextGles(cmdBuff), (encoding::UniformType::Enum)encoding::UniformTypeOf<type_>::value, location, count, val); \
+}
+PVR_EXECUTE_SET_UNIFORM(float32)
+PVR_EXECUTE_SET_UNIFORM(int32)
+PVR_EXECUTE_SET_UNIFORM(uint32)
+PVR_EXECUTE_SET_UNIFORM(glm::vec2)
+PVR_EXECUTE_SET_UNIFORM(glm::ivec2)
+PVR_EXECUTE_SET_UNIFORM(glm::uvec2)
+PVR_EXECUTE_SET_UNIFORM(glm::vec3)
+PVR_EXECUTE_SET_UNIFORM(glm::ivec3)
+PVR_EXECUTE_SET_UNIFORM(glm::uvec3)
+PVR_EXECUTE_SET_UNIFORM(glm::vec4)
+PVR_EXECUTE_SET_UNIFORM(glm::ivec4)
+PVR_EXECUTE_SET_UNIFORM(glm::uvec4)
+PVR_EXECUTE_SET_UNIFORM(glm::mat2)
+PVR_EXECUTE_SET_UNIFORM(glm::mat3)
+PVR_EXECUTE_SET_UNIFORM(glm::mat4)
+#undef PVR_EXECUTE_SET_UNIFORM
 
 void BindVertexBuffer::execute_private(impl::CommandBufferBaseImpl& cmdBuff)
 {
@@ -171,7 +171,7 @@ public:
 #endif
 
 		//These cannot fail...
-		initialiseNativeContext();
+		initialiseEntryPoints();
 		m_platformContext = &osManager.getPlatformContext();
 		m_osManager = &osManager;
 
@@ -234,7 +234,7 @@ public:
 			m_platformContext = 0;
 			m_apiType = Api::Unspecified;
 			m_renderStatesTracker.releaseAll();
-			releaseNativeContext();
+			releaseEntryPoints();
 		}
 		m_this_shared.release();
 	}		//Error if no display set
@@ -583,6 +583,16 @@ public:
 
 protected:
 	RenderStatesTracker m_renderStatesTracker;
+	/*!*********************************************************************************************************************
+	\brief Populate the gl:: and glext:: function pointers. Called by init() before any OpenGL ES call is made.
+	***********************************************************************************************************************/
+	virtual void initialiseEntryPoints() { initialiseNativeContext(); }
+
+	/*!*********************************************************************************************************************
+	\brief Release what initialiseEntryPoints() acquired. Called by release().
+	***********************************************************************************************************************/
+	virtual void releaseEntryPoints() { releaseNativeContext(); }
+
 	/*!*********************************************************************************************************************
 	\brief Implements IGraphicsContext. Get the source of a shader as a stream.
 	\param stream A Stream object containing the source of the shader.
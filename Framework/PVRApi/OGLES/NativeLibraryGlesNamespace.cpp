@@ -359,8 +359,11 @@ void gl::releaseGl()
 #endif
 }
 
+bool gl::entryPointsOverridden = false;
+
 void gl::initGl()
 {
+	if (entryPointsOverridden) { return; }
 #ifndef TARGET_OS_IPHONE
 	// Load ES2 functionality
 	gl::ActiveTexture = glesLibrary().getFunction<PROC_ES2_glActiveTexture>("glActiveTexture");
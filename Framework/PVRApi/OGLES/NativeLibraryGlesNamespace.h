@@ -39,6 +39,11 @@ public:
 	\brief Call once per application run to release the OpenGL library. PVRShell calls this on exit.
 	*********************************************************************************************************************/
 	static void releaseGl();
+	/*!*******************************************************************************************************************
+	\brief Set while the function pointers are provided by something other than the OpenGL ES library, such as the null
+	       context of the -nullgraphics option. initGl then leaves them as they are.
+	*********************************************************************************************************************/
+	static bool entryPointsOverridden;
 
 	// Es2 functions
 	static PROC_ES2_glActiveTexture ActiveTexture;
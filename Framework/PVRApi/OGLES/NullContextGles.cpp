@@ -0,0 +1,855 @@
+/*!*********************************************************************************************************************
+\file         PVRApi\OGLES\NullContextGles.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the NullContextGles class: the recording stubs of the gl:: functions.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRApi/OGLES/NullContextGles.h"
+#include "PVRApi/OGLES/OpenGLESBindings.h"
+#include "PVRCore/Hash_.h"
+#include <algorithm>
+#include <cstring>
+
+namespace pvr {
+GraphicsContextStrongReference createNullGraphicsContext()
+{
+	RefCountedResource<platform::NullContextGles> ctx;
+	ctx.construct();
+	return ctx;
+}
+
+namespace platform {
+namespace {
+typedef NullContextGles::CallStatistics CallCounter;
+
+std::vector<CallCounter*>& registeredCounters()
+{
+	static std::vector<CallCounter*> counters;
+	return counters;
+}
+
+// The counter of the function being called, for its implementation to add the bytes passed to it.
+CallCounter* currentCall = NULL;
+inline void addBytes(uint64 bytes) { currentCall->bytes += bytes; }
+
+// One instantiation per gl:: function (Id is the line it is installed on): counts the calls, then forwards them to the
+// implementation if there is one, else returns zero.
+template<int Id, typename Function> struct Recorder;
+template<int Id, typename Return, typename... Args>
+struct Recorder<Id, Return(PVR_APIENTRY*)(Args...)>
+{
+	typedef Return(PVR_APIENTRY* Function)(Args...);
+	static CallCounter counter;
+	static Function implementation;
+
+	static Return PVR_APIENTRY record(Args... args)
+	{
+		++counter.calls;
+		currentCall = &counter;
+		return implementation ? implementation(args...) : Return();
+	}
+};
+template<int Id, typename Return, typename... Args>
+CallCounter Recorder<Id, Return(PVR_APIENTRY*)(Args...)>::counter;
+template<int Id, typename Return, typename... Args>
+Return(PVR_APIENTRY* Recorder<Id, Return(PVR_APIENTRY*)(Args...)>::implementation)(Args...);
+
+template<int Id, typename Function>
+void install(Function& entryPoint, const char8* name, Function implementation)
+{
+	typedef Recorder<Id, Function> Stub;
+	if (!Stub::counter.function) { registeredCounters().push_back(&Stub::counter); }
+	Stub::counter.function = name;
+	Stub::implementation = implementation;
+	entryPoint = &Stub::record;
+}
+
+template<int Id, typename Function>
+void install(Function& entryPoint, const char8* name) { install<Id>(entryPoint, name, Function(NULL)); }
+
+#define PVR_NULL_GL(function) install<__LINE__>(gl::function, "gl" #function)
+// Variadic, as the implementations may be template instances with commas in their arguments
+#define PVR_NULL_GL_IMPLEMENTATION(function, ...) install<__LINE__>(gl::function, "gl" #function, __VA_ARGS__)
+
+// What the implementations keep track of, to answer queries as a real context would.
+struct NullGlesState
+{
+	Api::Enum apiType;
+	GLuint lastName;
+	GLint currentProgram;
+	GLint drawFramebuffer;
+	GLint readFramebuffer;
+	GLint viewport[4];
+	GLint scissor[4];
+	// Mapped buffer ranges point into the last block. Blocks are never freed until the context is released, as ranges
+	// mapped before a larger block was needed may still be in use.
+	std::vector<std::vector<char8> > mappedMemory;
+};
+NullGlesState state;
+
+uint32 getPixelSize(GLenum format, GLenum type)
+{
+	uint32 components = 1;
+	switch (format)
+	{
+	case GL_RGBA:
+#if BUILD_API_MAX>=30
+	case GL_RGBA_INTEGER:
+#endif
+		components = 4; break;
+	case GL_RGB:
+#if BUILD_API_MAX>=30
+	case GL_RGB_INTEGER:
+#endif
+		components = 3; break;
+	case GL_LUMINANCE_ALPHA:
+#if BUILD_API_MAX>=30
+	case GL_RG:
+	case GL_RG_INTEGER:
+	case GL_DEPTH_STENCIL:
+#endif
+		components = 2; break;
+	}
+	switch (type)
+	{
+	case GL_UNSIGNED_BYTE:
+	case GL_BYTE:
+		return components;
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+#if BUILD_API_MAX>=30
+	case GL_HALF_FLOAT:
+#endif
+#ifdef GL_HALF_FLOAT_OES
+	case GL_HALF_FLOAT_OES:
+#endif
+		return components * 2;
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+		return 2;
+#if BUILD_API_MAX>=30
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+	case GL_UNSIGNED_INT_10F_11F_11F_REV:
+	case GL_UNSIGNED_INT_5_9_9_9_REV:
+	case GL_UNSIGNED_INT_24_8:
+		return 4;
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+		return 8;
+#endif
+	default:
+		return components * 4;
+	}
+}
+
+// The limits of a typical OpenGL ES 3.1 GPU, and the state that is tracked. Returns the number of values written.
+uint32 getIntegers(GLenum name, GLint* values)
+{
+	switch (name)
+	{
+	case GL_VIEWPORT: memcpy(values, state.viewport, sizeof(state.viewport)); return 4;
+	case GL_SCISSOR_BOX: memcpy(values, state.scissor, sizeof(state.scissor)); return 4;
+	case GL_MAX_VIEWPORT_DIMS: values[0] = values[1] = 8192; return 2;
+	case GL_ALIASED_LINE_WIDTH_RANGE: values[0] = values[1] = 1; return 2;
+	case GL_ALIASED_POINT_SIZE_RANGE: values[0] = 1; values[1] = 1024; return 2;
+	case GL_CURRENT_PROGRAM: values[0] = state.currentProgram; return 1;
+	case GL_FRAMEBUFFER_BINDING: values[0] = state.drawFramebuffer; return 1;
+	case GL_IMPLEMENTATION_COLOR_READ_FORMAT: values[0] = GL_RGBA; return 1;
+	case GL_IMPLEMENTATION_COLOR_READ_TYPE: values[0] = GL_UNSIGNED_BYTE; return 1;
+	case GL_MAX_TEXTURE_SIZE:
+	case GL_MAX_CUBE_MAP_TEXTURE_SIZE:
+	case GL_MAX_RENDERBUFFER_SIZE: values[0] = 8192; return 1;
+	case GL_MAX_TEXTURE_IMAGE_UNITS:
+	case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS:
+	case GL_MAX_VERTEX_ATTRIBS:
+	case GL_MAX_VARYING_VECTORS: values[0] = 16; return 1;
+	case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: values[0] = 48; return 1;
+	case GL_MAX_VERTEX_UNIFORM_VECTORS:
+	case GL_MAX_FRAGMENT_UNIFORM_VECTORS: values[0] = 256; return 1;
+	case GL_RED_BITS:
+	case GL_GREEN_BITS:
+	case GL_BLUE_BITS:
+	case GL_ALPHA_BITS:
+	case GL_STENCIL_BITS: values[0] = 8; return 1;
+	case GL_DEPTH_BITS: values[0] = 24; return 1;
+	case GL_SUBPIXEL_BITS: values[0] = 4; return 1;
+#if BUILD_API_MAX>=30
+	case GL_READ_FRAMEBUFFER_BINDING: values[0] = state.readFramebuffer; return 1;
+	case GL_MAJOR_VERSION: values[0] = state.apiType >= Api::OpenGLES3 ? 3 : 2; return 1;
+	case GL_MINOR_VERSION: values[0] = state.apiType >= Api::OpenGLES31 ? 1 : 0; return 1;
+	case GL_MAX_3D_TEXTURE_SIZE:
+	case GL_MAX_ARRAY_TEXTURE_LAYERS: values[0] = 2048; return 1;
+	case GL_MAX_SAMPLES: values[0] = 4; return 1;
+	case GL_MAX_DRAW_BUFFERS:
+	case GL_MAX_COLOR_ATTACHMENTS: values[0] = 8; return 1;
+	case GL_MAX_UNIFORM_BUFFER_BINDINGS: values[0] = 72; return 1;
+	case GL_MAX_UNIFORM_BLOCK_SIZE: values[0] = 65536; return 1;
+	case GL_MAX_VERTEX_UNIFORM_BLOCKS:
+	case GL_MAX_FRAGMENT_UNIFORM_BLOCKS: values[0] = 12; return 1;
+	case GL_MAX_COMBINED_UNIFORM_BLOCKS: values[0] = 24; return 1;
+	case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: values[0] = 16; return 1;
+	case GL_MAX_VERTEX_UNIFORM_COMPONENTS:
+	case GL_MAX_FRAGMENT_UNIFORM_COMPONENTS: values[0] = 1024; return 1;
+	case GL_MAX_COMBINED_VERTEX_UNIFORM_COMPONENTS:
+	case GL_MAX_COMBINED_FRAGMENT_UNIFORM_COMPONENTS: values[0] = 1024 + 12 * 65536 / 4; return 1;
+	case GL_MAX_VERTEX_OUTPUT_COMPONENTS:
+	case GL_MAX_FRAGMENT_INPUT_COMPONENTS:
+	case GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS: values[0] = 64; return 1;
+	case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS:
+	case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS: values[0] = 4; return 1;
+	case GL_MAX_ELEMENTS_VERTICES:
+	case GL_MAX_ELEMENTS_INDICES: values[0] = 1 << 20; return 1;
+	case GL_MAX_ELEMENT_INDEX: values[0] = 0x7FFFFFFF; return 1;
+	case GL_MAX_PROGRAM_TEXEL_OFFSET: values[0] = 7; return 1;
+	case GL_MIN_PROGRAM_TEXEL_OFFSET: values[0] = -8; return 1;
+	case GL_MAX_TEXTURE_LOD_BIAS: values[0] = 16; return 1;
+#endif
+#if BUILD_API_MAX>=31
+	case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS:
+	case GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS:
+	case GL_MAX_IMAGE_UNITS: values[0] = 8; return 1;
+	case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: values[0] = 16; return 1;
+	case GL_MAX_SHADER_STORAGE_BLOCK_SIZE: values[0] = 1 << 27; return 1;
+	case GL_MAX_COMPUTE_SHARED_MEMORY_SIZE: values[0] = 16384; return 1;
+	case GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS: values[0] = 512; return 1;
+	case GL_MAX_COMPUTE_UNIFORM_BLOCKS: values[0] = 12; return 1;
+	case GL_MAX_COMPUTE_TEXTURE_IMAGE_UNITS:
+	case GL_MAX_VERTEX_ATTRIB_BINDINGS: values[0] = 16; return 1;
+	case GL_MAX_VERTEX_ATTRIB_STRIDE: values[0] = 2048; return 1;
+#endif
+	default: values[0] = 0; return 1;
+	}
+}
+
+void PVR_APIENTRY nullGetIntegerv(GLenum name, GLint* data) { getIntegers(name, data); }
+
+void PVR_APIENTRY nullGetFloatv(GLenum name, GLfloat* data)
+{
+	GLint values[4];
+	for (uint32 i = 0, count = getIntegers(name, values); i < count; ++i) { data[i] = static_cast<GLfloat>(values[i]); }
+}
+
+void PVR_APIENTRY nullGetBooleanv(GLenum name, GLboolean* data)
+{
+	GLint values[4];
+	for (uint32 i = 0, count = getIntegers(name, values); i < count; ++i) { data[i] = values[i] ? GL_TRUE : GL_FALSE; }
+}
+
+#if BUILD_API_MAX>=30
+void PVR_APIENTRY nullGetInteger64v(GLenum name, GLint64* data)
+{
+	GLint values[4];
+	for (uint32 i = 0, count = getIntegers(name, values); i < count; ++i) { data[i] = values[i]; }
+}
+#endif
+
+const GLubyte* PVR_APIENTRY nullGetString(GLenum name)
+{
+	const char8* string = "";
+	switch (name)
+	{
+	case GL_VENDOR: string = "Imagination Technologies"; break;
+	case GL_RENDERER: string = "PowerVR Framework null renderer"; break;
+	case GL_VERSION:
+		string = state.apiType >= Api::OpenGLES31 ? "OpenGL ES 3.1 (null)" :
+		         state.apiType >= Api::OpenGLES3 ? "OpenGL ES 3.0 (null)" : "OpenGL ES 2.0 (null)";
+		break;
+	case GL_SHADING_LANGUAGE_VERSION:
+		string = state.apiType >= Api::OpenGLES31 ? "OpenGL ES GLSL ES 3.10" :
+		         state.apiType >= Api::OpenGLES3 ? "OpenGL ES GLSL ES 3.00" : "OpenGL ES GLSL ES 1.00";
+		break;
+	}
+	return reinterpret_cast<const GLubyte*>(string);
+}
+
+#if BUILD_API_MAX>=30
+const GLubyte* PVR_APIENTRY nullGetStringi(GLenum, GLuint) { return reinterpret_cast<const GLubyte*>(""); }
+#endif
+
+void PVR_APIENTRY nullGenNames(GLsizei count, GLuint* names)
+{
+	for (GLsizei i = 0; i < count; ++i) { names[i] = ++state.lastName; }
+}
+
+GLuint PVR_APIENTRY nullCreateProgram() { return ++state.lastName; }
+GLuint PVR_APIENTRY nullCreateShader(GLenum) { return ++state.lastName; }
+
+void PVR_APIENTRY nullShaderSource(GLuint, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	for (GLsizei i = 0; i < count; ++i) { addBytes(lengths && lengths[i] >= 0 ? lengths[i] : strlen(strings[i])); }
+}
+
+#if BUILD_API_MAX>=31
+GLuint PVR_APIENTRY nullCreateShaderProgramv(GLenum, GLsizei count, const GLchar* const* strings)
+{
+	nullShaderSource(0, count, strings, NULL);
+	return ++state.lastName;
+}
+#endif
+
+void PVR_APIENTRY nullShaderBinary(GLsizei, const GLuint*, GLenum, const void*, GLsizei length) { addBytes(length); }
+
+#if BUILD_API_MAX>=30
+void PVR_APIENTRY nullProgramBinary(GLuint, GLenum, const void*, GLsizei length) { addBytes(length); }
+#endif
+
+// Shaders compile, programs link and validate.
+void PVR_APIENTRY nullGetObjectiv(GLuint, GLenum name, GLint* value)
+{
+	*value = (name == GL_COMPILE_STATUS || name == GL_LINK_STATUS || name == GL_VALIDATE_STATUS) ? GL_TRUE : 0;
+}
+
+void PVR_APIENTRY nullGetInfoLog(GLuint, GLsizei bufferSize, GLsizei* length, GLchar* infoLog)
+{
+	if (length) { *length = 0; }
+	if (infoLog && bufferSize > 0) { infoLog[0] = 0; }
+}
+
+void PVR_APIENTRY nullGetShaderPrecisionFormat(GLenum, GLenum, GLint* range, GLint* precision)
+{
+	range[0] = range[1] = 127;
+	*precision = 23;
+}
+
+// Every uniform and attribute exists, at a location derived from its name.
+GLint PVR_APIENTRY nullGetUniformLocation(GLuint, const GLchar* name)
+{
+	return static_cast<GLint>(hash32_bytes(name, strlen(name)) & 0xFFFF);
+}
+
+GLint PVR_APIENTRY nullGetAttribLocation(GLuint, const GLchar* name)
+{
+	return static_cast<GLint>(hash32_bytes(name, strlen(name)) % 16);
+}
+
+void PVR_APIENTRY nullUseProgram(GLuint program) { state.currentProgram = static_cast<GLint>(program); }
+
+void PVR_APIENTRY nullBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+#if BUILD_API_MAX>=30
+	if (target != GL_READ_FRAMEBUFFER) { state.drawFramebuffer = static_cast<GLint>(framebuffer); }
+	if (target != GL_DRAW_FRAMEBUFFER) { state.readFramebuffer = static_cast<GLint>(framebuffer); }
+#else
+	state.drawFramebuffer = state.readFramebuffer = static_cast<GLint>(framebuffer);
+#endif
+}
+
+GLenum PVR_APIENTRY nullCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+
+void PVR_APIENTRY nullViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	state.viewport[0] = x; state.viewport[1] = y; state.viewport[2] = width; state.viewport[3] = height;
+}
+
+void PVR_APIENTRY nullScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	state.scissor[0] = x; state.scissor[1] = y; state.scissor[2] = width; state.scissor[3] = height;
+}
+
+void PVR_APIENTRY nullBufferData(GLenum, GLsizeiptr size, const void* data, GLenum)
+{
+	if (data) { addBytes(size); }
+}
+
+void PVR_APIENTRY nullBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*) { addBytes(size); }
+
+#if BUILD_API_MAX>=30
+void* PVR_APIENTRY nullMapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+{
+	addBytes(length);
+	if (state.mappedMemory.empty() || state.mappedMemory.back().size() < size_t(length))
+	{
+		const size_t previousSize = state.mappedMemory.empty() ? 0 : state.mappedMemory.back().size();
+		state.mappedMemory.push_back(std::vector<char8>(std::max(size_t(length), previousSize * 2)));
+	}
+	return state.mappedMemory.back().data();
+}
+
+GLboolean PVR_APIENTRY nullUnmapBuffer(GLenum) { return GL_TRUE; }
+
+GLsync PVR_APIENTRY nullFenceSync(GLenum, GLbitfield) { return reinterpret_cast<GLsync>(size_t(++state.lastName)); }
+
+GLenum PVR_APIENTRY nullClientWaitSync(GLsync, GLbitfield, GLuint64) { return GL_ALREADY_SIGNALED; }
+
+void PVR_APIENTRY nullGetSynciv(GLsync, GLenum name, GLsizei bufferSize, GLsizei* length, GLint* values)
+{
+	const bool answered = bufferSize > 0 && (name == GL_SYNC_STATUS || name == GL_OBJECT_TYPE);
+	if (answered) { values[0] = name == GL_SYNC_STATUS ? GL_SIGNALED : GL_SYNC_FENCE; }
+	if (length) { *length = answered ? 1 : 0; }
+}
+#endif
+
+void PVR_APIENTRY nullReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+	const size_t size = size_t(width) * height * getPixelSize(format, type);
+	memset(pixels, 0, size);
+	addBytes(size);
+}
+
+void PVR_APIENTRY nullTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                                 const void* pixels)
+{
+	if (pixels) { addBytes(uint64(width) * height * getPixelSize(format, type)); }
+}
+
+void PVR_APIENTRY nullTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format,
+                                    GLenum type, const void*)
+{
+	addBytes(uint64(width) * height * getPixelSize(format, type));
+}
+
+void PVR_APIENTRY nullCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei imageSize,
+    const void* data)
+{
+	if (data) { addBytes(imageSize); }
+}
+
+void PVR_APIENTRY nullCompressedTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei imageSize,
+    const void*)
+{
+	addBytes(imageSize);
+}
+
+#if BUILD_API_MAX>=30
+void PVR_APIENTRY nullTexImage3D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format,
+                                 GLenum type, const void* pixels)
+{
+	if (pixels) { addBytes(uint64(width) * height * depth * getPixelSize(format, type)); }
+}
+
+void PVR_APIENTRY nullTexSubImage3D(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth,
+                                    GLenum format, GLenum type, const void*)
+{
+	addBytes(uint64(width) * height * depth * getPixelSize(format, type));
+}
+
+void PVR_APIENTRY nullCompressedTexImage3D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLsizei, GLint, GLsizei imageSize,
+    const void* data)
+{
+	if (data) { addBytes(imageSize); }
+}
+
+void PVR_APIENTRY nullCompressedTexSubImage3D(GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum,
+    GLsizei imageSize, const void*)
+{
+	addBytes(imageSize);
+}
+#endif
+
+// glUniform{1234}{f,i,ui}, glUniform{1234}{f,i,ui}v and glUniformMatrix*fv, and their glProgramUniform versions.
+template<typename Value, typename... Values>
+void PVR_APIENTRY nullUniform(GLint, Value, Values...) { addBytes(sizeof(Value) * (1 + sizeof...(Values))); }
+
+template<typename Value, int Components>
+void PVR_APIENTRY nullUniformv(GLint, GLsizei count, const Value*) { addBytes(uint64(count) * Components * sizeof(Value)); }
+
+template<int Elements>
+void PVR_APIENTRY nullUniformMatrixv(GLint, GLsizei count, GLboolean, const GLfloat*)
+{
+	addBytes(uint64(count) * Elements * sizeof(GLfloat));
+}
+
+#if BUILD_API_MAX>=31
+template<typename Value, typename... Values>
+void PVR_APIENTRY nullProgramUniform(GLuint, GLint, Value, Values...)
+{
+	addBytes(sizeof(Value) * (1 + sizeof...(Values)));
+}
+
+template<typename Value, int Components>
+void PVR_APIENTRY nullProgramUniformv(GLuint, GLint, GLsizei count, const Value*)
+{
+	addBytes(uint64(count) * Components * sizeof(Value));
+}
+
+template<int Elements>
+void PVR_APIENTRY nullProgramUniformMatrixv(GLuint, GLint, GLsizei count, GLboolean, const GLfloat*)
+{
+	addBytes(uint64(count) * Elements * sizeof(GLfloat));
+}
+#endif
+
+void installStubs()
+{
+	PVR_NULL_GL(ActiveTexture);
+	PVR_NULL_GL(AttachShader);
+	PVR_NULL_GL(BindAttribLocation);
+	PVR_NULL_GL(BindBuffer);
+	PVR_NULL_GL_IMPLEMENTATION(BindFramebuffer, &nullBindFramebuffer);
+	PVR_NULL_GL(BindRenderbuffer);
+	PVR_NULL_GL(BindTexture);
+	PVR_NULL_GL(BlendColor);
+	PVR_NULL_GL(BlendEquation);
+	PVR_NULL_GL(BlendEquationSeparate);
+	PVR_NULL_GL(BlendFunc);
+	PVR_NULL_GL(BlendFuncSeparate);
+	PVR_NULL_GL_IMPLEMENTATION(BufferData, &nullBufferData);
+	PVR_NULL_GL_IMPLEMENTATION(BufferSubData, &nullBufferSubData);
+	PVR_NULL_GL_IMPLEMENTATION(CheckFramebufferStatus, &nullCheckFramebufferStatus);
+	PVR_NULL_GL(Clear);
+	PVR_NULL_GL(ClearColor);
+	PVR_NULL_GL(ClearDepthf);
+	PVR_NULL_GL(ClearStencil);
+	PVR_NULL_GL(ColorMask);
+	PVR_NULL_GL(CompileShader);
+	PVR_NULL_GL_IMPLEMENTATION(CompressedTexImage2D, &nullCompressedTexImage2D);
+	PVR_NULL_GL_IMPLEMENTATION(CompressedTexSubImage2D, &nullCompressedTexSubImage2D);
+	PVR_NULL_GL(CopyTexImage2D);
+	PVR_NULL_GL(CopyTexSubImage2D);
+	PVR_NULL_GL_IMPLEMENTATION(CreateProgram, &nullCreateProgram);
+	PVR_NULL_GL_IMPLEMENTATION(CreateShader, &nullCreateShader);
+	PVR_NULL_GL(CullFace);
+	PVR_NULL_GL(DeleteBuffers);
+	PVR_NULL_GL(DeleteFramebuffers);
+	PVR_NULL_GL(DeleteTextures);
+	PVR_NULL_GL(DeleteProgram);
+	PVR_NULL_GL(DeleteRenderbuffers);
+	PVR_NULL_GL(DeleteShader);
+	PVR_NULL_GL(DetachShader);
+	PVR_NULL_GL(DepthFunc);
+	PVR_NULL_GL(DepthMask);
+	PVR_NULL_GL(DepthRangef);
+	PVR_NULL_GL(Disable);
+	PVR_NULL_GL(DisableVertexAttribArray);
+	PVR_NULL_GL(DrawArrays);
+	PVR_NULL_GL(DrawElements);
+	PVR_NULL_GL(Enable);
+	PVR_NULL_GL(EnableVertexAttribArray);
+	PVR_NULL_GL(Finish);
+	PVR_NULL_GL(Flush);
+	PVR_NULL_GL(FramebufferRenderbuffer);
+	PVR_NULL_GL(FramebufferTexture2D);
+	PVR_NULL_GL(FrontFace);
+	PVR_NULL_GL_IMPLEMENTATION(GenBuffers, &nullGenNames);
+	PVR_NULL_GL(GenerateMipmap);
+	PVR_NULL_GL_IMPLEMENTATION(GenFramebuffers, &nullGenNames);
+	PVR_NULL_GL_IMPLEMENTATION(GenRenderbuffers, &nullGenNames);
+	PVR_NULL_GL_IMPLEMENTATION(GenTextures, &nullGenNames);
+	PVR_NULL_GL(GetActiveAttrib);
+	PVR_NULL_GL(GetActiveUniform);
+	PVR_NULL_GL(GetAttachedShaders);
+	PVR_NULL_GL_IMPLEMENTATION(GetAttribLocation, &nullGetAttribLocation);
+	PVR_NULL_GL_IMPLEMENTATION(GetBooleanv, &nullGetBooleanv);
+	PVR_NULL_GL(GetBufferParameteriv);
+	PVR_NULL_GL(GetError);
+	PVR_NULL_GL_IMPLEMENTATION(GetFloatv, &nullGetFloatv);
+	PVR_NULL_GL(GetFramebufferAttachmentParameteriv);
+	PVR_NULL_GL_IMPLEMENTATION(GetIntegerv, &nullGetIntegerv);
+	PVR_NULL_GL_IMPLEMENTATION(GetProgramiv, &nullGetObjectiv);
+	PVR_NULL_GL_IMPLEMENTATION(GetProgramInfoLog, &nullGetInfoLog);
+	PVR_NULL_GL(GetRenderbufferParameteriv);
+	PVR_NULL_GL_IMPLEMENTATION(GetShaderiv, &nullGetObjectiv);
+	PVR_NULL_GL_IMPLEMENTATION(GetShaderInfoLog, &nullGetInfoLog);
+	PVR_NULL_GL_IMPLEMENTATION(GetShaderPrecisionFormat, &nullGetShaderPrecisionFormat);
+	PVR_NULL_GL(GetShaderSource);
+	PVR_NULL_GL_IMPLEMENTATION(GetString, &nullGetString);
+	PVR_NULL_GL(GetTexParameterfv);
+	PVR_NULL_GL(GetTexParameteriv);
+	PVR_NULL_GL(GetUniformfv);
+	PVR_NULL_GL(GetUniformiv);
+	PVR_NULL_GL_IMPLEMENTATION(GetUniformLocation, &nullGetUniformLocation);
+	PVR_NULL_GL(GetVertexAttribfv);
+	PVR_NULL_GL(GetVertexAttribiv);
+	PVR_NULL_GL(GetVertexAttribPointerv);
+	PVR_NULL_GL(Hint);
+	PVR_NULL_GL(IsBuffer);
+	PVR_NULL_GL(IsEnabled);
+	PVR_NULL_GL(IsFramebuffer);
+	PVR_NULL_GL(IsProgram);
+	PVR_NULL_GL(IsRenderbuffer);
+	PVR_NULL_GL(IsShader);
+	PVR_NULL_GL(IsTexture);
+	PVR_NULL_GL(LineWidth);
+	PVR_NULL_GL(LinkProgram);
+	PVR_NULL_GL(PixelStorei);
+	PVR_NULL_GL(PolygonOffset);
+	PVR_NULL_GL_IMPLEMENTATION(ReadPixels, &nullReadPixels);
+	PVR_NULL_GL(ReleaseShaderCompiler);
+	PVR_NULL_GL(RenderbufferStorage);
+	PVR_NULL_GL(SampleCoverage);
+	PVR_NULL_GL_IMPLEMENTATION(Scissor, &nullScissor);
+	PVR_NULL_GL_IMPLEMENTATION(ShaderBinary, &nullShaderBinary);
+	PVR_NULL_GL_IMPLEMENTATION(ShaderSource, &nullShaderSource);
+	PVR_NULL_GL(StencilFunc);
+	PVR_NULL_GL(StencilFuncSeparate);
+	PVR_NULL_GL(StencilMask);
+	PVR_NULL_GL(StencilMaskSeparate);
+	PVR_NULL_GL(StencilOp);
+	PVR_NULL_GL(StencilOpSeparate);
+	PVR_NULL_GL_IMPLEMENTATION(TexImage2D, &nullTexImage2D);
+	PVR_NULL_GL(TexParameterf);
+	PVR_NULL_GL(TexParameterfv);
+	PVR_NULL_GL(TexParameteri);
+	PVR_NULL_GL(TexParameteriv);
+	PVR_NULL_GL_IMPLEMENTATION(TexSubImage2D, &nullTexSubImage2D);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1f, &nullUniform<GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1fv, &nullUniformv<GLfloat, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1i, &nullUniform<GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1iv, &nullUniformv<GLint, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2f, &nullUniform<GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2fv, &nullUniformv<GLfloat, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2i, &nullUniform<GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2iv, &nullUniformv<GLint, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3f, &nullUniform<GLfloat, GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3fv, &nullUniformv<GLfloat, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3i, &nullUniform<GLint, GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3iv, &nullUniformv<GLint, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4f, &nullUniform<GLfloat, GLfloat, GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4fv, &nullUniformv<GLfloat, 4>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4i, &nullUniform<GLint, GLint, GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4iv, &nullUniformv<GLint, 4>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix2fv, &nullUniformMatrixv<4>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix3fv, &nullUniformMatrixv<9>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix4fv, &nullUniformMatrixv<16>);
+	PVR_NULL_GL_IMPLEMENTATION(UseProgram, &nullUseProgram);
+	PVR_NULL_GL(ValidateProgram);
+	PVR_NULL_GL(VertexAttrib1f);
+	PVR_NULL_GL(VertexAttrib1fv);
+	PVR_NULL_GL(VertexAttrib2f);
+	PVR_NULL_GL(VertexAttrib2fv);
+	PVR_NULL_GL(VertexAttrib3f);
+	PVR_NULL_GL(VertexAttrib3fv);
+	PVR_NULL_GL(VertexAttrib4f);
+	PVR_NULL_GL(VertexAttrib4fv);
+	PVR_NULL_GL(VertexAttribPointer);
+	PVR_NULL_GL_IMPLEMENTATION(Viewport, &nullViewport);
+#if BUILD_API_MAX>=30
+	PVR_NULL_GL(ReadBuffer);
+	PVR_NULL_GL(DrawRangeElements);
+	PVR_NULL_GL_IMPLEMENTATION(TexImage3D, &nullTexImage3D);
+	PVR_NULL_GL_IMPLEMENTATION(TexSubImage3D, &nullTexSubImage3D);
+	PVR_NULL_GL(CopyTexSubImage3D);
+	PVR_NULL_GL_IMPLEMENTATION(CompressedTexImage3D, &nullCompressedTexImage3D);
+	PVR_NULL_GL_IMPLEMENTATION(CompressedTexSubImage3D, &nullCompressedTexSubImage3D);
+	PVR_NULL_GL_IMPLEMENTATION(GenQueries, &nullGenNames);
+	PVR_NULL_GL(DeleteQueries);
+	PVR_NULL_GL(IsQuery);
+	PVR_NULL_GL(BeginQuery);
+	PVR_NULL_GL(EndQuery);
+	PVR_NULL_GL(GetQueryiv);
+	PVR_NULL_GL(GetQueryObjectuiv);
+	PVR_NULL_GL_IMPLEMENTATION(UnmapBuffer, &nullUnmapBuffer);
+	PVR_NULL_GL(GetBufferPointerv);
+	PVR_NULL_GL(DrawBuffers);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix2x3fv, &nullUniformMatrixv<6>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix3x2fv, &nullUniformMatrixv<6>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix2x4fv, &nullUniformMatrixv<8>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix4x2fv, &nullUniformMatrixv<8>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix3x4fv, &nullUniformMatrixv<12>);
+	PVR_NULL_GL_IMPLEMENTATION(UniformMatrix4x3fv, &nullUniformMatrixv<12>);
+	PVR_NULL_GL(BlitFramebuffer);
+	PVR_NULL_GL(RenderbufferStorageMultisample);
+	PVR_NULL_GL(FramebufferTextureLayer);
+	PVR_NULL_GL_IMPLEMENTATION(MapBufferRange, &nullMapBufferRange);
+	PVR_NULL_GL(FlushMappedBufferRange);
+	PVR_NULL_GL(BindVertexArray);
+	PVR_NULL_GL(DeleteVertexArrays);
+	PVR_NULL_GL_IMPLEMENTATION(GenVertexArrays, &nullGenNames);
+	PVR_NULL_GL(IsVertexArray);
+	PVR_NULL_GL(GetIntegeri_v);
+	PVR_NULL_GL(BeginTransformFeedback);
+	PVR_NULL_GL(EndTransformFeedback);
+	PVR_NULL_GL(BindBufferRange);
+	PVR_NULL_GL(BindBufferBase);
+	PVR_NULL_GL(TransformFeedbackVaryings);
+	PVR_NULL_GL(GetTransformFeedbackVarying);
+	PVR_NULL_GL(VertexAttribIPointer);
+	PVR_NULL_GL(GetVertexAttribIiv);
+	PVR_NULL_GL(GetVertexAttribIuiv);
+	PVR_NULL_GL(VertexAttribI4i);
+	PVR_NULL_GL(VertexAttribI4ui);
+	PVR_NULL_GL(VertexAttribI4iv);
+	PVR_NULL_GL(VertexAttribI4uiv);
+	PVR_NULL_GL(GetUniformuiv);
+	PVR_NULL_GL(GetFragDataLocation);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1ui, &nullUniform<GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2ui, &nullUniform<GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3ui, &nullUniform<GLuint, GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4ui, &nullUniform<GLuint, GLuint, GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform1uiv, &nullUniformv<GLuint, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform2uiv, &nullUniformv<GLuint, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform3uiv, &nullUniformv<GLuint, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(Uniform4uiv, &nullUniformv<GLuint, 4>);
+	PVR_NULL_GL(ClearBufferiv);
+	PVR_NULL_GL(ClearBufferuiv);
+	PVR_NULL_GL(ClearBufferfv);
+	PVR_NULL_GL(ClearBufferfi);
+	PVR_NULL_GL_IMPLEMENTATION(GetStringi, &nullGetStringi);
+	PVR_NULL_GL(CopyBufferSubData);
+	PVR_NULL_GL(GetUniformIndices);
+	PVR_NULL_GL(GetActiveUniformsiv);
+	PVR_NULL_GL(GetUniformBlockIndex);
+	PVR_NULL_GL(GetActiveUniformBlockiv);
+	PVR_NULL_GL(GetActiveUniformBlockName);
+	PVR_NULL_GL(UniformBlockBinding);
+	PVR_NULL_GL(DrawArraysInstanced);
+	PVR_NULL_GL(DrawElementsInstanced);
+	PVR_NULL_GL_IMPLEMENTATION(FenceSync, &nullFenceSync);
+	PVR_NULL_GL(IsSync);
+	PVR_NULL_GL(DeleteSync);
+	PVR_NULL_GL_IMPLEMENTATION(ClientWaitSync, &nullClientWaitSync);
+	PVR_NULL_GL(WaitSync);
+	PVR_NULL_GL_IMPLEMENTATION(GetInteger64v, &nullGetInteger64v);
+	PVR_NULL_GL_IMPLEMENTATION(GetSynciv, &nullGetSynciv);
+	PVR_NULL_GL(GetInteger64i_v);
+	PVR_NULL_GL(GetBufferParameteri64v);
+	PVR_NULL_GL_IMPLEMENTATION(GenSamplers, &nullGenNames);
+	PVR_NULL_GL(DeleteSamplers);
+	PVR_NULL_GL(IsSampler);
+	PVR_NULL_GL(BindSampler);
+	PVR_NULL_GL(SamplerParameteri);
+	PVR_NULL_GL(SamplerParameteriv);
+	PVR_NULL_GL(SamplerParameterf);
+	PVR_NULL_GL(SamplerParameterfv);
+	PVR_NULL_GL(GetSamplerParameteriv);
+	PVR_NULL_GL(GetSamplerParameterfv);
+	PVR_NULL_GL(VertexAttribDivisor);
+	PVR_NULL_GL(BindTransformFeedback);
+	PVR_NULL_GL(DeleteTransformFeedbacks);
+	PVR_NULL_GL_IMPLEMENTATION(GenTransformFeedbacks, &nullGenNames);
+	PVR_NULL_GL(IsTransformFeedback);
+	PVR_NULL_GL(PauseTransformFeedback);
+	PVR_NULL_GL(ResumeTransformFeedback);
+	PVR_NULL_GL(GetProgramBinary);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramBinary, &nullProgramBinary);
+	PVR_NULL_GL(ProgramParameteri);
+	PVR_NULL_GL(InvalidateFramebuffer);
+	PVR_NULL_GL(InvalidateSubFramebuffer);
+	PVR_NULL_GL(TexStorage2D);
+	PVR_NULL_GL(TexStorage3D);
+	PVR_NULL_GL(GetInternalformativ);
+#endif
+#if BUILD_API_MAX>=31
+	PVR_NULL_GL(DispatchCompute);
+	PVR_NULL_GL(DispatchComputeIndirect);
+	PVR_NULL_GL(BindImageTexture);
+	PVR_NULL_GL(MemoryBarrier);
+	PVR_NULL_GL(MemoryBarrierByRegion);
+	PVR_NULL_GL(BindProgramPipeline);
+	PVR_NULL_GL(DeleteProgramPipelines);
+	PVR_NULL_GL_IMPLEMENTATION(GenProgramPipelines, &nullGenNames);
+	PVR_NULL_GL(IsProgramPipeline);
+	PVR_NULL_GL(GetProgramPipelineiv);
+	PVR_NULL_GL(ValidateProgramPipeline);
+	PVR_NULL_GL(GetProgramPipelineInfoLog);
+	PVR_NULL_GL(UseProgramStages);
+	PVR_NULL_GL(ActiveShaderProgram);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1i, &nullProgramUniform<GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2i, &nullProgramUniform<GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3i, &nullProgramUniform<GLint, GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4i, &nullProgramUniform<GLint, GLint, GLint, GLint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1ui, &nullProgramUniform<GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2ui, &nullProgramUniform<GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3ui, &nullProgramUniform<GLuint, GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4ui, &nullProgramUniform<GLuint, GLuint, GLuint, GLuint>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1f, &nullProgramUniform<GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2f, &nullProgramUniform<GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3f, &nullProgramUniform<GLfloat, GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4f, &nullProgramUniform<GLfloat, GLfloat, GLfloat, GLfloat>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1iv, &nullProgramUniformv<GLint, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2iv, &nullProgramUniformv<GLint, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3iv, &nullProgramUniformv<GLint, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4iv, &nullProgramUniformv<GLint, 4>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1uiv, &nullProgramUniformv<GLuint, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2uiv, &nullProgramUniformv<GLuint, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3uiv, &nullProgramUniformv<GLuint, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4uiv, &nullProgramUniformv<GLuint, 4>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform1fv, &nullProgramUniformv<GLfloat, 1>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform2fv, &nullProgramUniformv<GLfloat, 2>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform3fv, &nullProgramUniformv<GLfloat, 3>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniform4fv, &nullProgramUniformv<GLfloat, 4>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix2fv, &nullProgramUniformMatrixv<4>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix3fv, &nullProgramUniformMatrixv<9>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix4fv, &nullProgramUniformMatrixv<16>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix2x3fv, &nullProgramUniformMatrixv<6>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix3x2fv, &nullProgramUniformMatrixv<6>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix2x4fv, &nullProgramUniformMatrixv<8>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix4x2fv, &nullProgramUniformMatrixv<8>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix3x4fv, &nullProgramUniformMatrixv<12>);
+	PVR_NULL_GL_IMPLEMENTATION(ProgramUniformMatrix4x3fv, &nullProgramUniformMatrixv<12>);
+	PVR_NULL_GL_IMPLEMENTATION(CreateShaderProgramv, &nullCreateShaderProgramv);
+	PVR_NULL_GL(DrawArraysIndirect);
+	PVR_NULL_GL(DrawElementsIndirect);
+	PVR_NULL_GL(TexStorage2DMultisample);
+	PVR_NULL_GL(SampleMaski);
+	PVR_NULL_GL(BindVertexBuffer);
+	PVR_NULL_GL(VertexAttribFormat);
+	PVR_NULL_GL(VertexAttribIFormat);
+	PVR_NULL_GL(VertexAttribBinding);
+	PVR_NULL_GL(VertexBindingDivisor);
+	PVR_NULL_GL(FramebufferParameteri);
+	PVR_NULL_GL(GetFramebufferParameteriv);
+	PVR_NULL_GL(GetProgramInterfaceiv);
+	PVR_NULL_GL(GetProgramResourceIndex);
+	PVR_NULL_GL(GetProgramResourceName);
+	PVR_NULL_GL(GetProgramResourceiv);
+	PVR_NULL_GL(GetProgramResourceLocation);
+	PVR_NULL_GL(GetBooleani_v);
+	PVR_NULL_GL(GetMultisamplefv);
+	PVR_NULL_GL(GetTexLevelParameteriv);
+	PVR_NULL_GL(GetTexLevelParameterfv);
+#endif
+}
+
+bool compareCalls(const CallCounter& lhs, const CallCounter& rhs) { return lhs.calls > rhs.calls; }
+}
+
+void NullContextGles::initialiseEntryPoints()
+{
+	state.apiType = m_apiType;
+	state.lastName = 0;
+	state.currentProgram = state.drawFramebuffer = state.readFramebuffer = 0;
+	memset(state.viewport, 0, sizeof(state.viewport));
+	memset(state.scissor, 0, sizeof(state.scissor));
+	installStubs();
+	gl::entryPointsOverridden = true;
+	resetStatistics();
+}
+
+void NullContextGles::releaseEntryPoints()
+{
+	if (!getStatistics().empty()) { logStatistics(); }
+	state.mappedMemory.clear();
+	gl::entryPointsOverridden = false;
+	gl::releaseGl();
+}
+
+std::vector<NullContextGles::CallStatistics> NullContextGles::getStatistics()
+{
+	std::vector<CallStatistics> statistics;
+	for (size_t i = 0; i < registeredCounters().size(); ++i)
+	{
+		if (registeredCounters()[i]->calls) { statistics.push_back(*registeredCounters()[i]); }
+	}
+	std::stable_sort(statistics.begin(), statistics.end(), &compareCalls);
+	return statistics;
+}
+
+void NullContextGles::resetStatistics()
+{
+	for (size_t i = 0; i < registeredCounters().size(); ++i)
+	{
+		registeredCounters()[i]->calls = 0;
+		registeredCounters()[i]->bytes = 0;
+	}
+}
+
+void NullContextGles::logStatistics()
+{
+	std::vector<CallStatistics> statistics = getStatistics();
+	uint64 totalCalls = 0, totalBytes = 0;
+	Log(Log.Information, "OpenGL ES calls recorded by the null context:");
+	for (size_t i = 0; i < statistics.size(); ++i)
+	{
+		Log(Log.Information, "  %-36s %12llu calls %14llu bytes", statistics[i].function,
+		    (unsigned long long)statistics[i].calls, (unsigned long long)statistics[i].bytes);
+		totalCalls += statistics[i].calls;
+		totalBytes += statistics[i].bytes;
+	}
+	Log(Log.Information, "  %-36s %12llu calls %14llu bytes", "Total", (unsigned long long)totalCalls,
+	    (unsigned long long)totalBytes);
+}
+}
+}
+//!\endcond
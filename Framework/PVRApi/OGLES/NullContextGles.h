@@ -0,0 +1,70 @@
+/*!*********************************************************************************************************************
+\file         PVRApi\OGLES\NullContextGles.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief		Definition of an OpenGL ES graphics context that records the OpenGL ES calls instead of making them
+              (pvr::platform::NullContextGles)
+***********************************************************************************************************************/
+#pragma once
+#include "PVRApi/OGLES/ContextGles.h"
+
+namespace pvr {
+namespace platform {
+/*!*********************************************************************************************************************
+\brief ContextGles that makes no OpenGL ES calls, to measure the CPU cost of the Framework and of applications without a
+       GPU, or without the cost of the driver.
+\description Instead of loading the OpenGL ES library, the context points every gl:: function at a stub that counts its
+       calls and the bytes of data passed to it (buffer and texture uploads, uniforms, shader sources, mapped ranges),
+       then returns what a conforming implementation would: new object names, successful compilation, linking and
+       framebuffer status, no errors, signalled fences and the limits of a typical OpenGL ES 3.1 GPU. All api:: objects
+       can then be created, and CommandBuffers recorded and submitted, through the unchanged OpenGL ES implementation.
+       No extensions are reported, so glext:: functions are not used. The platform context must be a
+       NullPlatformContext (PVRCore/NullPlatformContext.h), as the PVRShell command line option "-nullgraphics" sets up.
+       The counters are global, as the gl:: function pointers are: only one context, null or not, may exist at a time.
+       Not thread safe.
+***********************************************************************************************************************/
+class NullContextGles : public ContextGles
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief The calls recorded for one OpenGL ES function.
+	***********************************************************************************************************************/
+	struct CallStatistics
+	{
+		const char8* function; //!< The name of the function, e.g. "glDrawElements"
+		uint64 calls; //!< The number of calls
+		uint64 bytes; //!< The bytes of data passed to or mapped by the calls
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Create a new, empty, uninitialized context.
+	***********************************************************************************************************************/
+	NullContextGles() {}
+
+	/*!*********************************************************************************************************************
+	\brief Release the context, logging the statistics if any call was recorded.
+	***********************************************************************************************************************/
+	~NullContextGles() { release(); }
+
+	/*!*********************************************************************************************************************
+	\brief Get the statistics of the functions called since the context was initialised or the statistics were reset.
+	\return One entry per function called at least once, the most called first.
+	***********************************************************************************************************************/
+	static std::vector<CallStatistics> getStatistics();
+
+	/*!*********************************************************************************************************************
+	\brief Reset the calls and bytes of all functions to zero, e.g. after loading, to only record the frames rendered.
+	***********************************************************************************************************************/
+	static void resetStatistics();
+
+	/*!*********************************************************************************************************************
+	\brief Log the statistics of the functions called, and their totals.
+	***********************************************************************************************************************/
+	static void logStatistics();
+
+protected:
+	void initialiseEntryPoints();
+	void releaseEntryPoints();
+};
+}
+}
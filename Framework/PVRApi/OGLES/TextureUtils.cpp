@@ -7,6 +7,7 @@
 //!\cond NO_DOXYGEN
 #include "PVRCore/Types.h"
 #include "PVRCore/FileStream.h"
+#include "PVRCore/Profiler.h"
 #include "PVRApi/OGLES/TextureUtils.h"
 #include "PVRAssets/SamplerDescription.h"
 #include "PVRAssets/Texture/Texture.h"
@@ -1528,6 +1529,7 @@ bool getOpenGLStorageFormat(PixelFormat pixelFormat, ColorSpace::Enum colorSpace
 Result::Enum textureUpload(GraphicsContext& context, const assets::Texture& texture,
                            native::HTexture_& outTextureName, bool allowDecompress/*=true*/)
 {
+	PVR_PROFILE_ZONE("textureUpload");
 	using namespace assets;
 	//Initial error checks
 	// Check for any glError occurring prior to loading the texture, and warn the user.
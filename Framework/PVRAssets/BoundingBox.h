@@ -31,13 +31,16 @@ inline math::AxisAlignedBox getBoundingBox(const byte* data, size_t stride_bytes
 	if (size_bytes && data)
 	{
 		data = data + offset_bytes;
-		glm::vec3 minvec; glm::vec3 maxvec;
-		memcpy(&minvec, data, 12);
-		memcpy(&maxvec, data, 12);
+		// The positions may be unaligned, so they are copied through a float array
+		float32 position[3];
+		memcpy(position, data, sizeof(position));
+		glm::vec3 minvec = glm::make_vec3(position);
+		glm::vec3 maxvec = minvec;
 
-		for (size_t i = stride_bytes; i < size_bytes; i += stride_bytes)
+		for (size_t i = stride_bytes; stride_bytes && offset_bytes + i + 12 <= size_bytes; i += stride_bytes)
 		{
-			glm::vec3 vec; memcpy(&vec, data + i, 12);
+			memcpy(position, data + i, sizeof(position));
+			glm::vec3 vec = glm::make_vec3(position);
 			minvec = glm::min(vec, minvec);
 			maxvec = glm::max(vec, maxvec);
 		}
@@ -47,6 +50,7 @@ inline math::AxisAlignedBox getBoundingBox(const byte* data, size_t stride_bytes
 	{
 		aabb.setMinMax(glm::vec3(0, 0, 0), glm::vec3(0, 0, 0));
 	}
+	return aabb;
 }
 
 /*!*********************************************************************************************************************
@@ -61,9 +65,10 @@ inline math::AxisAlignedBox getBoundingBox(const Mesh& mesh, const char* positio
 	const Mesh::VertexAttributeData* vbo = mesh.getVertexAttributeByName(positionSemanticName);
 	if (vbo)
 	{
-		return getBoundingBox(static_cast<const byte*>(mesh.getData(vbo->getDataIndex())), vbo->getStride(), vbo->getOffset(),
-		                      mesh.getDataSize(vbo->getDataIndex()));
+		return getBoundingBox(static_cast<const byte*>(mesh.getData(vbo->getDataIndex())), mesh.getStride(vbo->getDataIndex()),
+		                      vbo->getOffset(), mesh.getDataSize(vbo->getDataIndex()));
 	}
+	return math::AxisAlignedBox();
 }
 
 /*!*********************************************************************************************************************
@@ -88,7 +93,7 @@ inline math::AxisAlignedBox getBoundingBox(const Model& model)
 	if (model.getNumMeshes())
 	{
 		math::AxisAlignedBox retval(getBoundingBox(model.getMesh(0)));
-		for (int i = 1; i < model.getNumMeshes(); ++i)
+		for (uint32 i = 1; i < model.getNumMeshes(); ++i)
 		{
 			retval.mergeBox(getBoundingBox(model.getMesh(i)));
 		}
@@ -128,7 +128,7 @@ struct EffectSemanticData
 	};
 	SemanticDataType::Enum	type;
 
-	EffectSemanticData() : type(SemanticDataType::None) {}
+	EffectSemanticData() : dataChar(), type(SemanticDataType::None) {}
 };
 
 /*!*****************************************************************************************************************
@@ -147,7 +147,7 @@ struct EffectSemantic
 struct EffectShader
 {
 	StringHash name;
-	bool useFileName;//!< Use shader file name 
+	bool useFileName;//!< The code was loaded from glslFile. glslCode still holds its contents.
 	std::string glslFile;//!< Glsl source file
 	std::string	 glslBinFile;//!< Glsl binary file
 	std::string glslCode;//!< Glsl code
@@ -155,6 +155,8 @@ struct EffectShader
 	uint32 glslBinSize;//!< Glsl binary size
 	uint32 firstLineNumPos;	//!< Line number in the text file where this code began; use to correct line-numbers in compiler errors
 	uint32 lastLineNumPos;	//!< The final line number of the GLSL block.
+
+	EffectShader() : useFileName(false), glslBinSize(0), firstLineNumPos(0), lastLineNumPos(0) {}
 };
 
 /*!*****************************************************************************************************************
@@ -162,6 +164,41 @@ struct EffectShader
 *******************************************************************************************************************/
 typedef std::pair<std::string, std::string> EffectTargetPair;
 
+/*!*****************************************************************************************************************
+\brief  The order in which the render passes (PFX targets) an effect depends on must be rendered, and which of them can
+		share a render target.
+\description Passes are grouped into levels. The passes of a level only depend on passes of earlier levels, so they
+		can be recorded in any order. The render target of a pass is needed from the level it is rendered in until the
+		last level that reads it. Passes whose targets are never needed at the same time, and that have the same
+		dimensions and format, are given the same target slot, so one FBO can be allocated per slot instead of one
+		per pass.
+*******************************************************************************************************************/
+struct EffectRenderPassSchedule
+{
+	/*!*****************************************************************************************************************
+	\brief  A scheduled render pass.
+	*******************************************************************************************************************/
+	struct Pass
+	{
+		StringHash name;		//!< Name of the render pass (its target texture)
+		StringHash effectName;	//!< The effect rendering a post-process pass. Empty for camera passes.
+		uint32 level;			//!< The level the pass is rendered in
+		uint32 lastUseLevel;	//!< The last level reading the pass's target. getNumLevels() if it is read after the schedule.
+		uint32 targetSlot;		//!< The render target slot the pass renders into
+	};
+
+	std::vector<Pass> passes;			//!< The passes, sorted by level
+	std::vector<uint32> levelStart;		//!< The passes of level L are [levelStart[L], levelStart[L+1]). Has getNumLevels()+1 entries.
+	uint32 numTargetSlots;				//!< The number of distinct render targets required
+
+	EffectRenderPassSchedule() : numTargetSlots(0) {}
+
+	/*!*****************************************************************************************************************
+	\brief Get the number of levels of the schedule.
+	*******************************************************************************************************************/
+	uint32 getNumLevels() const { return levelStart.size() ? (uint32)levelStart.size() - 1 : 0; }
+};
+
 /*!*****************************************************************************************************************
 \brief  Represents the information of an entire Effect, all information required to set up rendering of a Mesh in a 
 		graphics API, such as number and type of textures, attributes, shader variables etc.
@@ -177,12 +214,13 @@ public:
 	std::vector<EffectSemantic> attributes;//!< Effect attributes
 	std::vector<EffectTexture> textures;//!< Effect textures
 	std::vector<EffectTargetPair> targets; //!< Effect targets
+	EffectRenderPassSchedule renderPassSchedule; //!< The render passes this effect depends on
 	uint32 numDefaultSemantics;//!< Number of default semantics stored in the effect
 	assets::Model::Material material;//!< Effect material
 	glm::vec4 viewport;             //!< Effect viewport
 	std::string fileName;//!< effect file name
-	Effect() {}
-	Effect(const std::string& effectName) { material.setEffectName(effectName); }
+	Effect() : numDefaultSemantics(0), viewport(0.f) {}
+	Effect(const std::string& effectName) : numDefaultSemantics(0), viewport(0.f) { material.setEffectName(effectName); }
 	const assets::Model::Material& getMaterial()const { return material; }
 
 	/*!*********************************************************************************************************************
@@ -0,0 +1,285 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets\FileIO\EffectCacheReader.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of methods of the EffectCacheReader class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRAssets/FileIO/EffectCacheReader.h"
+#include "PVRCore/Log.h"
+#include <cstring>
+namespace pvr {
+namespace assets {
+namespace assetReaders {
+namespace {
+// Bounds-checked decoding of the records written by EffectCacheWriter. Any overrun sets failed and yields zeroes.
+class RecordReader
+{
+public:
+	RecordReader(const byte* data, size_t size) : failed(false), m_data(data), m_size(size), m_position(0) {}
+
+	bool failed;
+
+	size_t getPosition() const { return m_position; }
+
+	template<typename T_> void read(T_& value)
+	{
+		if (failed || m_size - m_position < sizeof(T_))
+		{
+			failed = true;
+			memset(&value, 0, sizeof(T_));
+			return;
+		}
+		memcpy(&value, m_data + m_position, sizeof(T_));
+		m_position += sizeof(T_);
+	}
+
+	template<typename T_> T_ read()
+	{
+		T_ value;
+		read(value);
+		return value;
+	}
+
+	void readString(std::string& str)
+	{
+		const uint32 length = read<uint32>();
+		if (failed || m_size - m_position < length)
+		{
+			failed = true;
+			str.clear();
+			return;
+		}
+		str.assign(reinterpret_cast<const char8*>(m_data + m_position), length);
+		m_position += length;
+	}
+
+	std::string readString()
+	{
+		std::string str;
+		readString(str);
+		return str;
+	}
+
+	// Element counts are validated against the bytes left so a corrupt count cannot trigger a huge allocation.
+	uint32 readCount(size_t minElementSize)
+	{
+		const uint32 count = read<uint32>();
+		if (failed || (m_size - m_position) / minElementSize < count)
+		{
+			failed = true;
+			return 0;
+		}
+		return count;
+	}
+
+	void readShader(EffectShader& shader)
+	{
+		shader.name = readString();
+		shader.useFileName = read<uint8>() != 0;
+		readString(shader.glslFile);
+		readString(shader.glslBinFile);
+		readString(shader.glslCode);
+		readString(shader.glslBin);
+		read(shader.glslBinSize);
+		read(shader.firstLineNumPos);
+		read(shader.lastLineNumPos);
+	}
+
+	void readSemantics(std::vector<EffectSemantic>& semantics)
+	{
+		semantics.resize(readCount(sizeof(uint32) * 3));
+		for (uint32 i = 0; i < semantics.size(); ++i)
+		{
+			readString(semantics[i].variableName);
+			semantics[i].semantic = readString();
+			semantics[i].sDefaultValue.type = (SemanticDataType::Enum)read<uint32>();
+			read(semantics[i].sDefaultValue.dataChar);
+		}
+	}
+
+	void readTexture(EffectTexture& texture)
+	{
+		texture.name = readString();
+		texture.fileName = readString();
+		read(texture.number);
+		read(texture.unit);
+		texture.minFilter = (SamplerFilter::Enum)read<uint32>();
+		texture.magFilter = (SamplerFilter::Enum)read<uint32>();
+		texture.mipFilter = (SamplerFilter::Enum)read<uint32>();
+		texture.wrapS = (SamplerWrap::Enum)read<uint32>();
+		texture.wrapT = (SamplerWrap::Enum)read<uint32>();
+		texture.wrapR = (SamplerWrap::Enum)read<uint32>();
+		read(texture.width);
+		read(texture.height);
+		read(texture.flags);
+		texture.renderToTexture = read<uint8>() != 0;
+	}
+
+	void readSchedule(EffectRenderPassSchedule& schedule)
+	{
+		schedule.passes.resize(readCount(sizeof(uint32) * 5));
+		for (uint32 i = 0; i < schedule.passes.size(); ++i)
+		{
+			EffectRenderPassSchedule::Pass& pass = schedule.passes[i];
+			pass.name = readString();
+			pass.effectName = readString();
+			read(pass.level);
+			read(pass.lastUseLevel);
+			read(pass.targetSlot);
+		}
+		schedule.levelStart.resize(readCount(sizeof(uint32)));
+		for (uint32 i = 0; i < schedule.levelStart.size(); ++i) { read(schedule.levelStart[i]); }
+		read(schedule.numTargetSlots);
+	}
+
+	void readEffect(Effect& effect)
+	{
+		effect.material.setEffectName(readString());
+		effect.material.setEffectFile(readString());
+		readString(effect.fileName);
+		readString(effect.annotation);
+		readShader(effect.vertexShader);
+		readShader(effect.fragmentShader);
+		readSemantics(effect.uniforms);
+		readSemantics(effect.attributes);
+		effect.textures.resize(readCount(sizeof(uint32) * 2));
+		for (uint32 i = 0; i < effect.textures.size(); ++i) { readTexture(effect.textures[i]); }
+		effect.targets.resize(readCount(sizeof(uint32) * 2));
+		for (uint32 i = 0; i < effect.targets.size(); ++i)
+		{
+			readString(effect.targets[i].first);
+			readString(effect.targets[i].second);
+		}
+		readSchedule(effect.renderPassSchedule);
+		read(effect.numDefaultSemantics);
+		float32 viewport[4];
+		read(viewport);
+		effect.viewport = glm::make_vec4(viewport);
+	}
+
+private:
+	const byte* m_data;
+	size_t m_size;
+	size_t m_position;
+};
+}
+
+EffectCacheReader::EffectCacheReader() : m_readPosition(0), m_effectsRead(0), m_expectedSourceHash(0),
+	m_expectedSourceSize(0), m_hasExpectedSource(false), m_loaded(false), m_valid(false)
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+EffectCacheReader::EffectCacheReader(Stream::ptr_type assetStream) : AssetReader<Effect>(assetStream), m_readPosition(0),
+	m_effectsRead(0), m_expectedSourceHash(0), m_expectedSourceSize(0), m_hasExpectedSource(false), m_loaded(false),
+	m_valid(false)
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+void EffectCacheReader::setSource(const void* sourceData, size_t sourceSize)
+{
+	m_expectedSourceHash = effect_cache::hashSource(sourceData, sourceSize);
+	m_expectedSourceSize = (uint32)sourceSize;
+	m_hasExpectedSource = true;
+	m_loaded = false;
+}
+
+bool EffectCacheReader::loadCache()
+{
+	m_loaded = true;
+	m_valid = false;
+	m_readPosition = 0;
+	m_effectsRead = 0;
+	if (!m_assetStream.get()) { return false; }
+	if (!m_assetStream->isopen() && !m_assetStream->open()) { return false; }
+
+	// Fetch the whole cache with one read; everything after this point decodes from memory.
+	const size_t size = m_assetStream->getSize();
+	if (size < sizeof(effect_cache::Header)) { return false; }
+	m_data.resize(size);
+	size_t dataRead = 0;
+	if (!m_assetStream->seek(0, Stream::SeekOriginFromStart) || !m_assetStream->read(1, size, &m_data[0], dataRead) ||
+	    dataRead != size)
+	{
+		Log(Log.Error, "[EffectCacheReader::loadCache] Could not read the effect cache");
+		return false;
+	}
+	memcpy(&m_header, &m_data[0], sizeof(m_header));
+
+	if (m_header.magic != effect_cache::c_magic || m_header.version != effect_cache::c_version ||
+	    m_header.payloadSize != size - sizeof(effect_cache::Header))
+	{
+		Log(Log.Error, "[EffectCacheReader::loadCache] Not an effect cache, or an incompatible version");
+		return false;
+	}
+	if (m_hasExpectedSource &&
+	    (m_header.sourceHash != m_expectedSourceHash || m_header.sourceSize != m_expectedSourceSize))
+	{
+		Log(Log.Debug, "[EffectCacheReader::loadCache] Effect cache is out of date with its PFX source");
+		return false;
+	}
+	m_readPosition = sizeof(effect_cache::Header);
+	m_valid = true;
+	return true;
+}
+
+bool EffectCacheReader::isValid()
+{
+	if (!m_loaded) { loadCache(); }
+	return m_valid;
+}
+
+uint32 EffectCacheReader::getNumberEffects()
+{
+	return isValid() ? m_header.numEffects : 0;
+}
+
+bool EffectCacheReader::readNextAsset(Effect& asset)
+{
+	if (!isValid() || m_effectsRead >= m_header.numEffects) { return false; }
+
+	RecordReader reader(&m_data[0] + m_readPosition, m_data.size() - m_readPosition);
+	reader.readEffect(asset);
+	if (reader.failed)
+	{
+		Log(Log.Error, "[EffectCacheReader::readNextAsset] Effect cache is corrupted");
+		m_valid = false;
+		return false;
+	}
+	m_readPosition += reader.getPosition();
+	++m_effectsRead;
+	return true;
+}
+
+bool EffectCacheReader::hasAssetsLeftToLoad()
+{
+	return isValid() && m_effectsRead < m_header.numEffects;
+}
+
+bool EffectCacheReader::canHaveMultipleAssets()
+{
+	return true;
+}
+
+std::vector<std::string> EffectCacheReader::getSupportedFileExtensions()
+{
+	std::vector<std::string> extensions;
+	extensions.push_back("pfxc");
+	return extensions;
+}
+
+std::string EffectCacheReader::getReaderName()
+{
+	return "PowerVR Effect Cache Reader";
+}
+
+std::string EffectCacheReader::getReaderVersion()
+{
+	return "1.0.0";
+}
+}
+}
+}
+//!\endcond
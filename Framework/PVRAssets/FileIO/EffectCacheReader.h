@@ -0,0 +1,74 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets/FileIO/EffectCacheReader.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief        An AssetReader that reads pvr::assets::Effect objects from a binary effect cache written by
+              EffectCacheWriter.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRAssets/Effect.h"
+#include "PVRAssets/AssetReader.h"
+#include "PVRAssets/FileIO/FileDefinesEffectCache.h"
+
+namespace pvr {
+namespace assets {
+namespace assetReaders {
+/*!*********************************************************************************************************************
+\brief	Rebuilds Effects from a binary effect cache without parsing any PFX text. The whole cache is fetched with a
+		single read of the stream, then each readAsset() call decodes the next effect from memory.
+\description If the PFX source the cache was built from is available, pass it to setSource() before reading: a cache
+		whose recorded source hash does not match is rejected, and the caller should fall back to PfxReader.
+***********************************************************************************************************************/
+class EffectCacheReader : public AssetReader<Effect>
+{
+public:
+	/*!******************************************************************************************************************
+	\brief    Construct empty reader
+	********************************************************************************************************************/
+	EffectCacheReader();
+
+	/*!******************************************************************************************************************
+	\brief    Construct reader from the specified stream
+	********************************************************************************************************************/
+	EffectCacheReader(Stream::ptr_type assetStream);
+
+	/*!******************************************************************************************************************
+	\brief    Only accept a cache that was built from this PFX source.
+	\param    sourceData The PFX text
+	\param    sourceSize The size of the PFX text in bytes
+	********************************************************************************************************************/
+	void setSource(const void* sourceData, size_t sourceSize);
+
+	/*!******************************************************************************************************************
+	\brief    Load the cache from the stream if not already loaded and check it against the expected source.
+	\return   True if the cache is well formed and, if a source was set, up to date
+	********************************************************************************************************************/
+	bool isValid();
+
+	/*!******************************************************************************************************************
+	\brief    Get the number of effects stored in the cache. Zero if the cache is not valid.
+	********************************************************************************************************************/
+	uint32 getNumberEffects();
+
+	virtual bool hasAssetsLeftToLoad();
+	virtual bool canHaveMultipleAssets();
+	virtual std::vector<std::string> getSupportedFileExtensions();
+	virtual std::string getReaderName();
+	virtual std::string getReaderVersion();
+private:
+	virtual bool readNextAsset(Effect& asset);
+	bool loadCache();
+
+	std::vector<byte> m_data;
+	effect_cache::Header m_header;
+	size_t m_readPosition;
+	uint32 m_effectsRead;
+	uint32 m_expectedSourceHash;
+	uint32 m_expectedSourceSize;
+	bool m_hasExpectedSource;
+	bool m_loaded;
+	bool m_valid;
+};
+}
+}
+}
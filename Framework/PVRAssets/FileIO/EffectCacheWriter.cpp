@@ -0,0 +1,208 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets\FileIO\EffectCacheWriter.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of methods of the EffectCacheWriter class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRAssets/FileIO/EffectCacheWriter.h"
+#include "PVRAssets/FileIO/PFXReader.h"
+#include "PVRCore/Log.h"
+#include <cstring>
+namespace pvr {
+namespace assets {
+namespace assetWriters {
+namespace {
+class RecordBuffer
+{
+public:
+	std::vector<byte> data;
+
+	template<typename T_> void write(const T_& value)
+	{
+		const byte* bytes = reinterpret_cast<const byte*>(&value);
+		data.insert(data.end(), bytes, bytes + sizeof(T_));
+	}
+
+	void writeString(const std::string& str)
+	{
+		write((uint32)str.length());
+		data.insert(data.end(), str.begin(), str.end());
+	}
+
+	void writeShader(const EffectShader& shader)
+	{
+		writeString(shader.name.getString());
+		write((uint8)shader.useFileName);
+		writeString(shader.glslFile);
+		writeString(shader.glslBinFile);
+		writeString(shader.glslCode);
+		writeString(shader.glslBin);
+		write(shader.glslBinSize);
+		write(shader.firstLineNumPos);
+		write(shader.lastLineNumPos);
+	}
+
+	void writeSemantics(const std::vector<EffectSemantic>& semantics)
+	{
+		write((uint32)semantics.size());
+		for (uint32 i = 0; i < semantics.size(); ++i)
+		{
+			writeString(semantics[i].variableName);
+			writeString(semantics[i].semantic.getString());
+			write((uint32)semantics[i].sDefaultValue.type);
+			write(semantics[i].sDefaultValue.dataChar);
+		}
+	}
+
+	void writeTexture(const EffectTexture& texture)
+	{
+		writeString(texture.name.getString());
+		writeString(texture.fileName.getString());
+		write(texture.number);
+		write(texture.unit);
+		write((uint32)texture.minFilter);
+		write((uint32)texture.magFilter);
+		write((uint32)texture.mipFilter);
+		write((uint32)texture.wrapS);
+		write((uint32)texture.wrapT);
+		write((uint32)texture.wrapR);
+		write(texture.width);
+		write(texture.height);
+		write(texture.flags);
+		write((uint8)texture.renderToTexture);
+	}
+
+	void writeSchedule(const EffectRenderPassSchedule& schedule)
+	{
+		write((uint32)schedule.passes.size());
+		for (uint32 i = 0; i < schedule.passes.size(); ++i)
+		{
+			const EffectRenderPassSchedule::Pass& pass = schedule.passes[i];
+			writeString(pass.name.getString());
+			writeString(pass.effectName.getString());
+			write(pass.level);
+			write(pass.lastUseLevel);
+			write(pass.targetSlot);
+		}
+		write((uint32)schedule.levelStart.size());
+		for (uint32 i = 0; i < schedule.levelStart.size(); ++i) { write(schedule.levelStart[i]); }
+		write(schedule.numTargetSlots);
+	}
+
+	void writeEffect(const Effect& effect)
+	{
+		writeString(effect.material.getEffectName());
+		writeString(effect.material.getEffectFile());
+		writeString(effect.fileName);
+		writeString(effect.annotation);
+		writeShader(effect.vertexShader);
+		writeShader(effect.fragmentShader);
+		writeSemantics(effect.uniforms);
+		writeSemantics(effect.attributes);
+		write((uint32)effect.textures.size());
+		for (uint32 i = 0; i < effect.textures.size(); ++i) { writeTexture(effect.textures[i]); }
+		write((uint32)effect.targets.size());
+		for (uint32 i = 0; i < effect.targets.size(); ++i)
+		{
+			writeString(effect.targets[i].first);
+			writeString(effect.targets[i].second);
+		}
+		writeSchedule(effect.renderPassSchedule);
+		write(effect.numDefaultSemantics);
+		const float32 viewport[4] = { effect.viewport.x, effect.viewport.y, effect.viewport.z, effect.viewport.w };
+		write(viewport);
+	}
+};
+}
+
+bool EffectCacheWriter::addEffectsFrom(const PfxReader& reader)
+{
+	for (uint32 i = 0; i < reader.getNumberEffects(); ++i)
+	{
+		m_readerEffects.push_back(Effect());
+		if (!reader.getEffect(m_readerEffects.back(), i))
+		{
+			Log(Log.Error, "[EffectCacheWriter::addEffectsFrom] Could not read effect %d", i);
+			m_readerEffects.pop_back();
+			return false;
+		}
+		m_assetsToWrite.push_back(&m_readerEffects.back());
+	}
+	return true;
+}
+
+bool EffectCacheWriter::addAssetToWrite(const Effect& asset)
+{
+	m_assetsToWrite.push_back(&asset);
+	return true;
+}
+
+bool EffectCacheWriter::writeAllAssets()
+{
+	if (!m_assetStream.get()) { return false; }
+
+	RecordBuffer records;
+	for (uint32 i = 0; i < m_assetsToWrite.size(); ++i)
+	{
+		// Shader files are not read when loading the cache, so their code must be stored in the effect
+		const Effect& effect = *m_assetsToWrite[i];
+		if ((effect.vertexShader.useFileName && effect.vertexShader.glslCode.empty()) ||
+		    (effect.fragmentShader.useFileName && effect.fragmentShader.glslCode.empty()))
+		{
+			Log(Log.Error, "[EffectCacheWriter::writeAllAssets] Effect '%s' refers to a shader file without its code",
+			    effect.material.getEffectName().c_str());
+			return false;
+		}
+		records.writeEffect(effect);
+	}
+
+	effect_cache::Header header;
+	header.magic = effect_cache::c_magic;
+	header.version = effect_cache::c_version;
+	header.sourceHash = m_sourceHash;
+	header.sourceSize = m_sourceSize;
+	header.numEffects = (uint32)m_assetsToWrite.size();
+	header.payloadSize = (uint32)records.data.size();
+
+	size_t dataWritten = 0;
+	if (!m_assetStream->write(sizeof(header), 1, &header, dataWritten) || dataWritten != 1) { return false; }
+	if (records.data.empty()) { return true; }
+	return m_assetStream->write(1, records.data.size(), &records.data[0], dataWritten) && dataWritten == records.data.size();
+}
+
+uint32 EffectCacheWriter::assetsAddedSoFar()
+{
+	return (uint32)m_assetsToWrite.size();
+}
+
+bool EffectCacheWriter::supportsMultipleAssets()
+{
+	return true;
+}
+
+bool EffectCacheWriter::canWriteAsset(const Effect&)
+{
+	return true;
+}
+
+std::vector<string> EffectCacheWriter::getSupportedFileExtensions()
+{
+	std::vector<string> extensions;
+	extensions.push_back("pfxc");
+	return extensions;
+}
+
+string EffectCacheWriter::getWriterName()
+{
+	return "PowerVR Effect Cache Writer";
+}
+
+string EffectCacheWriter::getWriterVersion()
+{
+	return "1.0.0";
+}
+}
+}
+}
+//!\endcond
@@ -0,0 +1,61 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets/FileIO/EffectCacheWriter.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief        A Writer that stores fully parsed pvr::assets::Effect objects into a binary effect cache.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRAssets/Effect.h"
+#include "PVRAssets/AssetWriter.h"
+#include "PVRAssets/FileIO/FileDefinesEffectCache.h"
+#include <deque>
+namespace pvr {
+namespace assets {
+class PfxReader;
+namespace assetWriters {
+/*!*********************************************************************************************************************
+\brief	Writes Effects into a binary effect cache, which EffectCacheReader loads back without any text parsing.
+\description Typically built offline from a PfxReader with addEffectsFrom(). The cache records the hash of the PFX
+		source set with setSource(), so that the reader can reject a cache that no longer matches its source. The code
+		of shaders that the PFX loads from files is stored in the cache, so loading the cache never reads those files,
+		and changing them does not invalidate the cache: rebuild it when they change.
+***********************************************************************************************************************/
+class EffectCacheWriter : public AssetWriter<Effect>
+{
+public:
+	EffectCacheWriter() : m_sourceHash(0), m_sourceSize(0) {}
+
+	/*!*****************************************************************************************************************
+	\brief	Set the PFX source that the effects to be written were parsed from.
+	\param	sourceData The PFX text
+	\param	sourceSize The size of the PFX text in bytes
+	*******************************************************************************************************************/
+	void setSource(const void* sourceData, size_t sourceSize)
+	{
+		m_sourceHash = effect_cache::hashSource(sourceData, sourceSize);
+		m_sourceSize = (uint32)sourceSize;
+	}
+
+	/*!*****************************************************************************************************************
+	\brief	Add every effect of a parsed PFX, as returned by PfxReader::getEffect, to the effects to write.
+	\param	reader A PfxReader that has successfully parsed a PFX
+	\return	true on success, false if any of the effects could not be read
+	*******************************************************************************************************************/
+	bool addEffectsFrom(const PfxReader& reader);
+
+	virtual bool addAssetToWrite(const Effect& asset);
+	virtual bool writeAllAssets();
+	virtual uint32 assetsAddedSoFar();
+	virtual bool supportsMultipleAssets();
+	virtual bool canWriteAsset(const Effect& asset);
+	virtual std::vector<string> getSupportedFileExtensions();
+	virtual string getWriterName();
+	virtual string getWriterVersion();
+private:
+	std::deque<Effect> m_readerEffects;
+	uint32 m_sourceHash;
+	uint32 m_sourceSize;
+};
+}
+}
+}
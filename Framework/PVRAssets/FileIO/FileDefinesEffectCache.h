@@ -0,0 +1,42 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets/FileIO/FileDefinesEffectCache.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief        Defines used by the binary effect cache reader and writer.
+***********************************************************************************************************************/
+#pragma once
+
+#include "PVRCore/CoreIncludes.h"
+#include "PVRCore/Hash_.h"
+//!\cond NO_DOXYGEN
+namespace pvr {
+namespace assets {
+namespace effect_cache {
+
+// "PFXC"
+static const uint32 c_magic = 0x43584650;
+// Bump whenever the layout of an effect record changes.
+static const uint32 c_version = 2;
+
+// The file is this header followed by payloadSize bytes holding numEffects effect records. All values are stored in
+// the native byte order of the device that wrote the cache; strings are a uint32 length followed by the characters.
+struct Header
+{
+	uint32 magic;		//!< c_magic
+	uint32 version;		//!< c_version
+	uint32 sourceHash;	//!< hashSource() of the PFX the effects were parsed from
+	uint32 sourceSize;	//!< Size in bytes of that PFX
+	uint32 numEffects;	//!< Number of effect records
+	uint32 payloadSize;	//!< Size in bytes of the effect records
+};
+
+// Hash identifying the PFX source a cache was built from. A cache is stale if this no longer matches the source.
+inline uint32 hashSource(const void* sourceData, size_t sourceSize)
+{
+	return hash32_bytes(sourceData, sourceSize);
+}
+
+}
+}
+}
+//!\endcond
@@ -14,6 +14,7 @@
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 
 namespace {
 using namespace pvr;
@@ -53,6 +54,115 @@ const uint32 g_DfltViewPortHeight = 480;
 #define NEWLINE_TOKENS "\r\n"
 #define DELIM_TOKENS " \t"
 
+/* Top-level sections of a PFX file. Recognised once, while lexing, so that parse() never rescans for tags. */
+namespace PfxSection {
+enum Enum
+{
+	Header,
+	Texture,
+	Target,
+	Textures,
+	VertexShader,
+	FragmentShader,
+	Effect,
+	Count,
+	None = 0xFF
+};
+}
+const char8* g_SectionNames[PfxSection::Count] =
+{
+	"HEADER",
+	"TEXTURE",
+	"TARGET",
+	"TEXTURES",
+	"VERTEXSHADER",
+	"FRAGMENTSHADER",
+	"EFFECT",
+};
+const uint8 g_EndTagFlag = 0x80;
+
+/*!*********************************************************************************************************************
+\brief	Lex one raw line [begin, end) into out: strips the comment, converts tabs to spaces, drops leading and trailing
+		whitespace and collapses every whitespace run to a single space.
+\return	The number of characters written (no terminator is written).
+***********************************************************************************************************************/
+uint32 lexLine(const char8* begin, const char8* end, char8* out)
+{
+	char8* const outStart = out;
+	bool pendingSpace = false;
+	for (const char8* c = begin; c != end; ++c)
+	{
+		if (*c == '/' && c + 1 != end && c[1] == '/') { break; }
+		if (*c == ' ' || *c == '\t')
+		{
+			pendingSpace = (out != outStart);
+			continue;
+		}
+		if (pendingSpace) { *out++ = ' '; pendingSpace = false; }
+		*out++ = *c;
+	}
+	return (uint32)(out - outStart);
+}
+
+/*!*********************************************************************************************************************
+\brief	Classify a lexed line as a section start tag ([NAME]), a section end tag ([/NAME], flagged with g_EndTagFlag)
+		or PfxSection::None.
+***********************************************************************************************************************/
+uint8 classifySectionTag(const char8* line, uint32 length)
+{
+	if (length < 3 || line[0] != '[' || line[length - 1] != ']') { return PfxSection::None; }
+	const bool isEnd = (line[1] == '/');
+	const char8* name = line + (isEnd ? 2 : 1);
+	const uint32 nameLength = length - (isEnd ? 3 : 2);
+	for (uint32 i = 0; i < PfxSection::Count; ++i)
+	{
+		if (strlen(g_SectionNames[i]) == nameLength && memcmp(g_SectionNames[i], name, nameLength) == 0)
+		{
+			return (uint8)(isEnd ? (i | g_EndTagFlag) : i);
+		}
+	}
+	return PfxSection::None;
+}
+
+/*!*********************************************************************************************************************
+\brief	A token of a lexed line: a view of the characters up to the next space. Lexed lines hold no tabs and no runs of
+		spaces, so consecutive tokens are separated by exactly one space.
+***********************************************************************************************************************/
+struct PfxToken
+{
+	const char8* str;
+	uint32 length;
+
+	PfxToken() : str(NULL), length(0) {}
+	const char8* end() const { return str + length; }
+	bool equals(const char8* other, size_t otherLength) const { return length == otherLength && memcmp(str, other, length) == 0; }
+	bool equals(const char8* other) const { return equals(other, strlen(other)); }
+};
+
+/*!*********************************************************************************************************************
+\brief	Read the next token of the lexed line [cursor, end) and advance cursor past it and the space that follows it.
+\return	False if there is no token left.
+***********************************************************************************************************************/
+bool nextToken(const char8*& cursor, const char8* end, PfxToken& token)
+{
+	if (cursor == end) { return false; }
+	const char8* tokenEnd = static_cast<const char8*>(memchr(cursor, ' ', end - cursor));
+	if (!tokenEnd) { tokenEnd = end; }
+	token.str = cursor;
+	token.length = (uint32)(tokenEnd - cursor);
+	cursor = (tokenEnd == end ? end : tokenEnd + 1);
+	return true;
+}
+
+/*!*********************************************************************************************************************
+\brief	Bounded strstr: find the first occurrence of str in [begin, end), or NULL.
+***********************************************************************************************************************/
+const char8* findInRange(const char8* begin, const char8* end, const char8* str)
+{
+	const char8* found = std::search(begin, end, str, str + strlen(str));
+	return found == end ? NULL : found;
+}
+
 bool getSemanticDataFromString(assets::EffectSemanticData& pDataItem, const char8* const pszArgumentString,
                                assets::SemanticDataType::Enum eType, std::string& errorOut)
 {
@@ -204,20 +314,120 @@ bool getSemanticDataFromString(assets::EffectSemanticData& pDataItem, const char
 namespace pvr {
 namespace assets {
 
+/*!*********************************************************************************************************************
+\brief	A lexed line of the effect file. A non-owning view into the read context's line buffer; the text is
+		NUL-terminated so that the section parsers can keep using the C string functions on it.
+***********************************************************************************************************************/
+struct PfxLexeme
+{
+	char8* str;
+	uint32 length;
+
+	PfxLexeme() : str(NULL), length(0) {}
+	const char8* c_str() const { return str; }
+	bool empty() const { return length == 0; }
+};
+
 class PFXParserReadContext
 {
 public:
-	std::vector<string> ppszEffectFile;
+	std::vector<PfxLexeme> ppszEffectFile;
 	std::vector<int32> fileLineNumbers;
 	uint32	nNumLines;
+	std::vector<char8> lineBuffer; //!< All lexed lines back to back, each NUL-terminated
+	std::vector<uint8> lineTags; //!< Per line: PfxSection id of a start tag, id | g_EndTagFlag of an end tag, or None
+	std::vector<int32> endTagLines[PfxSection::Count]; //!< Ascending line indices of the end tags of each section
 
 public:
 	PFXParserReadContext()
 	{
 		nNumLines = 0;
 	}
+
+	/*!*****************************************************************************************************************
+	\brief	Split the script into lines in a single pass, lexing each one straight into the shared line buffer and
+			building the section index on the way.
+	*******************************************************************************************************************/
+	void tokenise(const char8* script)
+	{
+		const size_t scriptLength = strlen(script);
+		const char8* const scriptEnd = script + scriptLength;
+		std::vector<uint32> lineOffsets;
+		lineBuffer.resize(scriptLength + 1);
+
+		uint32 bufferUsed = 0;
+		int32 lineCounter = 0;
+		const char8* current = script;
+		for (bool done = false; !done;)
+		{
+			++lineCounter;
+			while (*current == '\r') { ++current; }
+
+			const char8* lineEnd = static_cast<const char8*>(memchr(current, '\n', scriptEnd - current));
+			if (!lineEnd)
+			{
+				lineEnd = scriptEnd;
+				done = true;
+			}
+			const char8* next = lineEnd + 1;
+			const char8* contentEnd = lineEnd;
+			while (contentEnd != current && contentEnd[-1] == '\r') { --contentEnd; }
+
+			// Lexed lines are never longer than their source line, and every source line except the last gives up a
+			// '\n' for the terminator, so the buffer cannot overflow.
+			const uint32 length = lexLine(current, contentEnd, &lineBuffer[bufferUsed]);
+			const uint8 tag = classifySectionTag(&lineBuffer[bufferUsed], length);
+			if (tag != PfxSection::None && (tag & g_EndTagFlag))
+			{
+				endTagLines[tag & ~g_EndTagFlag].push_back((int32)nNumLines);
+			}
+
+			// Store the line, even if blank lines (to get correct errors from GLSL compiler).
+			lineOffsets.push_back(bufferUsed);
+			lineTags.push_back(tag);
+			fileLineNumbers.push_back(lineCounter);
+			lineBuffer[bufferUsed + length] = '\0';
+			bufferUsed += length + 1;
+			++nNumLines;
+			current = next;
+		}
+
+		ppszEffectFile.resize(nNumLines);
+		for (uint32 i = 0; i < nNumLines; ++i)
+		{
+			ppszEffectFile[i].str = &lineBuffer[lineOffsets[i]];
+			ppszEffectFile[i].length = (i + 1 < nNumLines ? lineOffsets[i + 1] : bufferUsed) - lineOffsets[i] - 1;
+		}
+	}
 };
 
+/*!*********************************************************************************************************************
+\brief	Append the lexed lines [line, line of endStr) to out, each followed by a newline, and leave line on the end string.
+\return	False if endStr is not found before limit.
+***********************************************************************************************************************/
+static bool appendLexemesUntil(string& out, int32& line, const std::vector<PfxLexeme>& lines, uint32 limit,
+                               const char8* endStr)
+{
+	const size_t endLength = strlen(endStr);
+	size_t length = 0;
+	uint32 i;
+	for (i = line; i < limit; ++i)
+	{
+		if (lines[i].length == endLength && memcmp(lines[i].c_str(), endStr, endLength) == 0) { break; }
+		length += lines[i].length + 1;
+	}
+	if (i == limit) { return false; }
+
+	out.reserve(out.size() + length);
+	for (uint32 j = line; j < i; ++j)
+	{
+		out.append(lines[j].c_str(), lines[j].length);
+		out.push_back('\n');
+	}
+	line = i;
+	return true;
+}
+
 PfxParserEffect::PfxParserEffect()/* :
 	Uniforms(DEFAULT_EFFECT_NUM_UNIFORM),
 	Attributes(DEFAULT_EFFECT_NUM_ATTRIB),
@@ -248,31 +458,6 @@ PfxReader::~PfxReader()
 
 bool PfxReader::parse(string& pReturnError)
 {
-	enum Cmd
-	{
-		CmdsHeader,
-		CmdsTexture,
-		CmdsTarget,
-		CmdsTextures,
-		CmdsVertexShader,
-		CmdsFragmentShader,
-		CmdsEffect,
-
-		CmdsSize
-	};
-
-	const StringHash parserCommands[] =
-	{
-		StringHash("[HEADER]"),				// eCmds_Header
-		StringHash("[TEXTURE]"),			// eCmds_Texture
-		StringHash("[TARGET]"),				// eCmds_Target
-		StringHash("[TEXTURES]"),			// eCmds_Textures
-		StringHash("[VERTEXSHADER]"),		// eCmds_VertexShader
-		StringHash("[FRAGMENTSHADER]"),		// eCmds_FragmentShader
-		StringHash("[EFFECT]"),				// eCmds_Effect
-	};
-	PVR_STATIC_ASSERT(sizeof(parserCommands) / sizeof(parserCommands[0]) == CmdsSize, parserCommands);
-
 	int32 nEndLine = 0;
 	int32 nHeaderCounter = 0, nTexturesCounter = 0;
 	uint32 i, j, k;
@@ -283,15 +468,15 @@ bool PfxReader::parse(string& pReturnError)
 		// Skip blank lines
 		if (m_context->ppszEffectFile[nLine].empty()) {continue;}
 
-		StringHash Cmd(m_context->ppszEffectFile[nLine]);
-		if (Cmd ==  parserCommands[CmdsHeader])
+		const uint8 tag = m_context->lineTags[nLine];
+		if (tag == PfxSection::Header)
 		{
 			if (nHeaderCounter > 0)
 			{
 				pReturnError = strings::createFormatted("[HEADER] redefined on line %d\n", m_context->fileLineNumbers[nLine]);
 				return false;
 			}
-			if (getEndTag("HEADER", nLine, &nEndLine))
+			if (getEndTag(PfxSection::Header, nLine, &nEndLine))
 			{
 				if (parseHeader(nLine, nEndLine, pReturnError))
 				{
@@ -309,9 +494,9 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsTexture])
+		else if (tag == PfxSection::Texture)
 		{
-			if (getEndTag("TEXTURE", nLine, &nEndLine))
+			if (getEndTag(PfxSection::Texture, nLine, &nEndLine))
 			{
 				if (!parseTexture(nLine, nEndLine, pReturnError))
 				{
@@ -325,9 +510,9 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsTarget])
+		else if (tag == PfxSection::Target)
 		{
-			if (getEndTag("TARGET", nLine, &nEndLine))
+			if (getEndTag(PfxSection::Target, nLine, &nEndLine))
 			{
 				if (!parseTarget(nLine, nEndLine, pReturnError))
 				{
@@ -341,14 +526,14 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsTextures])
+		else if (tag == PfxSection::Textures)
 		{
 			if (nTexturesCounter > 0)
 			{
 				pReturnError = strings::createFormatted("[TEXTURES] redefined on line %d\n", m_context->fileLineNumbers[nLine]);
 				return false;
 			}
-			if (getEndTag("TEXTURES", nLine, &nEndLine))
+			if (getEndTag(PfxSection::Textures, nLine, &nEndLine))
 			{
 				if (parseTextures(nLine, nEndLine, pReturnError))
 				{
@@ -367,9 +552,9 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsVertexShader])
+		else if (tag == PfxSection::VertexShader)
 		{
-			if (getEndTag("VERTEXSHADER", nLine, &nEndLine))
+			if (getEndTag(PfxSection::VertexShader, nLine, &nEndLine))
 			{
 				PFXParserShader vertexShader;
 				if (parseShader(nLine, nEndLine, pReturnError, vertexShader, "VERTEXSHADER"))
@@ -389,9 +574,9 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsFragmentShader])
+		else if (tag == PfxSection::FragmentShader)
 		{
-			if (getEndTag("FRAGMENTSHADER", nLine, &nEndLine))
+			if (getEndTag(PfxSection::FragmentShader, nLine, &nEndLine))
 			{
 				PFXParserShader fragShader;
 				if (parseShader(nLine, nEndLine, pReturnError, fragShader, "FRAGMENTSHADER"))
@@ -411,9 +596,9 @@ bool PfxReader::parse(string& pReturnError)
 			}
 			nLine = nEndLine;
 		}
-		else if (Cmd == parserCommands[CmdsEffect])
+		else if (tag == PfxSection::Effect)
 		{
-			if (getEndTag("EFFECT", nLine, &nEndLine))
+			if (getEndTag(PfxSection::Effect, nLine, &nEndLine))
 			{
 				PfxParserEffect effect;
 				if (parseEffect(effect, nLine, nEndLine, pReturnError))
@@ -495,12 +680,6 @@ bool PfxReader::parse(string& pReturnError)
 bool PfxReader::parseFromMemory(const char8* const pszScript, string& pReturnError)
 {
 	PFXParserReadContext	context;
-	char8			pszLine[512];
-	const char8*		pszEnd, *pszCurr;
-	int32				nLineCounter;
-	uint32	nLen;
-	uint32	nReduce;
-	bool			bDone;
 
 	if (!pszScript)
 	{
@@ -509,64 +688,7 @@ bool PfxReader::parseFromMemory(const char8* const pszScript, string& pReturnErr
 	}
 
 	m_context = &context;
-
-	// Find & process each line
-	nLineCounter	= 0;
-	bDone			= false;
-	pszCurr			= pszScript;
-	while (!bDone)
-	{
-		nLineCounter++;
-
-		while (*pszCurr == '\r')
-		{
-			++pszCurr;
-		}
-
-		// Find length of line
-		pszEnd = strchr(pszCurr, '\n');
-		if (pszEnd)
-		{
-			nLen = (uint32)(pszEnd - pszCurr);
-		}
-		else
-		{
-			nLen = (uint32)strlen(pszCurr);
-			bDone = true;
-		}
-
-		nReduce = 0; // Tells how far to go back because of '\r'.
-		while (nLen - nReduce > 0 && pszCurr[nLen - 1 - nReduce] == '\r')
-		{
-			nReduce++;
-		}
-
-		// Ensure pszLine will not be not overrun
-		if (nLen + 1 - nReduce > sizeof(pszLine) / sizeof(*pszLine))
-		{
-			nLen = sizeof(pszLine) / sizeof(*pszLine) - 1 + nReduce;
-		}
-
-		// Copy line into pszLine
-		strncpy(pszLine, pszCurr, nLen - nReduce);
-		pszLine[nLen - nReduce] = 0;
-		pszCurr += nLen + 1;
-
-		PVR_ASSERT(strchr(pszLine, '\r') == 0);
-		PVR_ASSERT(strchr(pszLine, '\n') == 0);
-
-		// Ignore comments
-		char8* tmp = strstr(pszLine, "//");
-		if (tmp != NULL)	{ *tmp = '\0'; }
-
-		// Reduce whitespace to one character.
-		reduceWhitespace(pszLine);
-
-		// Store the line, even if blank lines (to get correct errors from GLSL compiler).
-		m_context->fileLineNumbers.push_back(nLineCounter);
-		m_context->ppszEffectFile.push_back(pszLine);
-		m_context->nNumLines++;
-	}
+	m_context->tokenise(pszScript);
 
 	return parse(pReturnError);
 }
@@ -692,145 +814,40 @@ bool PfxReader::retrieveRenderPassDependencies(std::vector<PfxRenderPass*>& aReq
 	return false;
 }
 
-bool PfxReader::getEndTag(const char8* pszTagName, int32 nStartLine, int32* pnEndLine)
+bool PfxReader::getEndTag(uint32 section, int32 nStartLine, int32* pnEndLine)
 {
-	char8 pszEndTag[100];
-	strcpy(pszEndTag, "[/");
-	strcat(pszEndTag, pszTagName);
-	strcat(pszEndTag, "]");
-	char* bb = NULL;
-	for (uint32 i = nStartLine; i < m_context->nNumLines; i++)
-	{
-		bb = (char*)m_context->ppszEffectFile[i].c_str();
-		if (strcmp(pszEndTag, m_context->ppszEffectFile[i].c_str()) == 0)
-		{
-			*pnEndLine = i;
-			return true;
-		}
-	}
-
-	return false;
-}
-
-void PfxReader::reduceWhitespace(char8* line)
-{
-	// convert tabs and newlines to ' '
-	char8* tmp = strpbrk(line, "\t\n");
-	while (tmp != NULL)
-	{
-		*tmp = ' ';
-		tmp = strpbrk(line, "\t\n");
-	}
-
-	// remove all whitespace at start
-	while (line[0] == ' ')
-	{
-		// move chars along to omit whitespace
-		int32 counter = 0;
-		do
-		{
-			line[counter] = line[counter + 1];
-			counter++;
-		}
-		while (line[counter] != '\0');
-	}
-
-	// step through chars of line remove multiple whitespace
-	for (int32 i = 0; i < (int32)strlen(line); i++)
-	{
-		// whitespace found
-		if (line[i] == ' ')
-		{
-			// count number of whitespace chars
-			int32 numWhiteChars = 0;
-			while (line[i + 1 + numWhiteChars] == ' ')
-			{
-				numWhiteChars++;
-			}
-
-			// multiple whitespace chars found
-			if (numWhiteChars > 0)
-			{
-				// move chars along to omit whitespace
-				int32 counter = 1;
-				while (line[i + counter] != '\0')
-				{
-					line[i + counter] = line[i + numWhiteChars + counter];
-					counter++;
-				}
-			}
-		}
-	}
-
-	// If there is no string then do not remove terminating white symbols
-	if (!strlen(line))
-	{
-		return;
-	}
-
-	// remove all whitespace from end
-	while (line[strlen(line) - 1] == ' ')
-	{
-		// move chars along to omit whitespace
-		line[strlen(line) - 1] = '\0';
-	}
-}
-
-string PfxReader::findParameter(char8* aszSourceString, const string& parameterTag, const string& delimiter)
-{
-	string returnString("");
-	char8* aszTagStart = strstr(aszSourceString, parameterTag.c_str());
-
-	// Tag was found, so search for parameter
-	if (aszTagStart)
-	{
-		char8* aszDelimiterStart = strstr(aszTagStart, delimiter.c_str());
-		char8* aszSpaceStart = strstr(aszTagStart, " ");
-
-		// Delimiter found
-		if (aszDelimiterStart && (!aszSpaceStart || (aszDelimiterStart < aszSpaceStart)))
-		{
-			// Create a string from the delimiter to the next space
-			size_t strCount(strcspn(aszDelimiterStart, " "));
-			aszDelimiterStart++;	// Skip =
-			returnString.assign(aszDelimiterStart, strCount - 1);
-		}
-	}
-
-	return returnString;
+	const std::vector<int32>& endLines = m_context->endTagLines[section];
+	std::vector<int32>::const_iterator found = std::lower_bound(endLines.begin(), endLines.end(), nStartLine);
+	if (found == endLines.end()) { return false; }
+	*pnEndLine = *found;
+	return true;
 }
 
-bool PfxReader::readStringToken(char8* pszSource, string& output, string& ErrorStr, int32 i, const char8* pCaller)
+bool PfxReader::readStringToken(const char8* pszSource, string& output, string& ErrorStr, int32 i, const char8* pCaller)
 {
+	const char8* pszEnd;
 	if (*pszSource == '\"')		// Quote marks. Continue parsing until end mark or NULL
 	{
 		pszSource++;		// Skip past first quote
-		while (*pszSource != '\"')
+		pszEnd = strchr(pszSource, '\"');
+		if (!pszEnd)
 		{
-			if (*pszSource == '\0')
-			{
-				ErrorStr = strings::createFormatted("Incomplete argument in [%s] on line %d: %s\n", pCaller, m_context->fileLineNumbers[i],
-				                                    m_context->ppszEffectFile[i].c_str());
-				return false;
-			}
-
-			output.push_back(*pszSource);
-			pszSource++;
+			ErrorStr = strings::createFormatted("Incomplete argument in [%s] on line %d: %s\n", pCaller, m_context->fileLineNumbers[i],
+			                                    m_context->ppszEffectFile[i].c_str());
+			return false;
 		}
-
-		pszSource++;		// Skip past final quote.
+		output.assign(pszSource, pszEnd);
+		pszEnd++;		// Skip past final quote.
 	}
 	else		// No quotes. Read until space
 	{
-		pszSource = strtok(pszSource, DELIM_TOKENS NEWLINE_TOKENS);
-		output = pszSource;
-
-		pszSource += strlen(pszSource);
+		pszEnd = pszSource + strcspn(pszSource, DELIM_TOKENS NEWLINE_TOKENS);
+		output.assign(pszSource, pszEnd);
 	}
 
 	// Check that there's nothing left on this line
-	pszSource = strtok(pszSource, NEWLINE_TOKENS);
-	if (pszSource)
+	pszSource = pszEnd + strspn(pszEnd, DELIM_TOKENS NEWLINE_TOKENS);
+	if (*pszSource)
 	{
 		ErrorStr = strings::createFormatted("Unknown keyword '%s' in [%s] on line %d: %s\n", pszSource, pCaller,
 		                                    m_context->fileLineNumbers[i],  m_context->ppszEffectFile[i].c_str());
@@ -850,11 +867,11 @@ bool PfxReader::parseHeader(int32 nStartLine, int32 nEndLine, string& pReturnErr
 		CmdsSize
 	};
 
-	const StringHash HeaderCommands[] =
+	static const StringHashLiteral HeaderCommands[] =
 	{
-		StringHash("VERSION"),			// eCmds_Version
-		StringHash("DESCRIPTION"),		// eCmds_Description
-		StringHash("COPYRIGHT"),		// eCmds_Copyright
+		StringHashLiteral("VERSION"),			// eCmds_Version
+		StringHashLiteral("DESCRIPTION"),		// eCmds_Description
+		StringHashLiteral("COPYRIGHT"),		// eCmds_Copyright
 	};
 	PVR_STATIC_ASSERT(sizeof(HeaderCommands) / sizeof(HeaderCommands[0]) == CmdsSize, HeaderCommands);
 
@@ -901,7 +918,7 @@ bool PfxReader::parseHeader(int32 nStartLine, int32 nEndLine, string& pReturnErr
 
 
 template<typename EnumType>
-static bool parseTextureFlags(const char8* c_pszRemainingLine, EnumType** ppFlagsOut, uint32 uiNumFlags,
+static bool parseTextureFlags(const char8* c_pszRemainingLine, const char8* c_pszLineEnd, EnumType** ppFlagsOut, uint32 uiNumFlags,
                               const char8** c_ppszFlagNames, uint32 uiNumFlagNames,
                               string& returnError, int32 iLineNum, PFXParserReadContext* m_context)
 {
@@ -912,10 +929,10 @@ static bool parseTextureFlags(const char8* c_pszRemainingLine, EnumType** ppFlag
 
 	// --- Find the first flag
 	uiIndex = 0;
-	c_pszCursor = strstr(c_pszRemainingLine, c_ppszFlagNames[uiIndex++]);
+	c_pszCursor = findInRange(c_pszRemainingLine, c_pszLineEnd, c_ppszFlagNames[uiIndex++]);
 	while (uiIndex < uiNumFlagNames)
 	{
-		c_pszResult = strstr(c_pszRemainingLine, c_ppszFlagNames[uiIndex++]);
+		c_pszResult = findInRange(c_pszRemainingLine, c_pszLineEnd, c_ppszFlagNames[uiIndex++]);
 		if (((c_pszResult < c_pszCursor) || !c_pszCursor) && c_pszResult)
 		{
 			c_pszCursor = c_pszResult;
@@ -950,12 +967,12 @@ static bool parseTextureFlags(const char8* c_pszRemainingLine, EnumType** ppFlag
 	uint32 uiBufferIdx;
 	char8 szBuffer[128];		// Buffer to hold the token
 
-	while (*c_pszCursor != ' ' && *c_pszCursor != 0 && uiFlagsFound < uiNumFlags)
+	while (c_pszCursor != c_pszLineEnd && *c_pszCursor != ' ' && uiFlagsFound < uiNumFlags)
 	{
 		memset(szBuffer, 0, sizeof(szBuffer));		// Clear the buffer
 		uiBufferIdx = 0;
 
-		while (*c_pszCursor != '-' && *c_pszCursor != 0 && *c_pszCursor != ' ' && uiBufferIdx < 128)		// - = delim. token
+		while (c_pszCursor != c_pszLineEnd && *c_pszCursor != '-' && *c_pszCursor != ' ' && uiBufferIdx < sizeof(szBuffer) - 1)		// - = delim. token
 		{
 			szBuffer[uiBufferIdx++] = *c_pszCursor++;
 		}
@@ -1010,38 +1027,38 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 		eCmds_Size
 	};
 
-	const StringHash GenericSurfCommands[] =
-	{
-		StringHash("MINIFICATION"),			// eCmds_Min
-		StringHash("MAGNIFICATION"),		// eCmds_Mag
-		StringHash("MIPMAP"),				// eCmds_Mip
-		StringHash("WRAP_S"),				// eCmds_WrapS
-		StringHash("WRAP_T"),				// eCmds_WrapT
-		StringHash("WRAP_R"),				// eCmds_WrapR
-		StringHash("FILTER"),				// eCmds_Filter
-		StringHash("WRAP"),					// eCmds_Wrap
-		StringHash("RESOLUTION"),			// eCmds_Resolution
-		StringHash("SURFACETYPE"),			// eCmds_Surface
+	static const StringHashLiteral GenericSurfCommands[] =
+	{
+		StringHashLiteral("MINIFICATION"),			// eCmds_Min
+		StringHashLiteral("MAGNIFICATION"),		// eCmds_Mag
+		StringHashLiteral("MIPMAP"),				// eCmds_Mip
+		StringHashLiteral("WRAP_S"),				// eCmds_WrapS
+		StringHashLiteral("WRAP_T"),				// eCmds_WrapT
+		StringHashLiteral("WRAP_R"),				// eCmds_WrapR
+		StringHashLiteral("FILTER"),				// eCmds_Filter
+		StringHashLiteral("WRAP"),					// eCmds_Wrap
+		StringHashLiteral("RESOLUTION"),			// eCmds_Resolution
+		StringHashLiteral("SURFACETYPE"),			// eCmds_Surface
 	};
 	PVR_STATIC_ASSERT(sizeof(GenericSurfCommands) / sizeof(GenericSurfCommands[0]) == eCmds_Size, GenericSurfCommands);
 
 	struct SSurfacePair
 	{
-		StringHash name;
+		StringHashLiteral name;
 		PixelFormat eType;
 		uint32 BufferType;
 	};
 
-	const SSurfacePair surfacePairs[] =
+	static const SSurfacePair surfacePairs[] =
 	{
-		{ StringHash("RGBA8888"),	PixelFormat::RGBA_8888, g_PfxTexColor },
-		{ StringHash("RGBA4444"),	PixelFormat::RGBA_4444, g_PfxTexColor },
-		{ StringHash("RGB888"),		PixelFormat::RGB_888, g_PfxTexColor },
-		{ StringHash("RGB565"),		PixelFormat::RGB_565, g_PfxTexColor },
-		{ StringHash("INTENSITY8"), PixelFormat::Intensity8, g_PfxTexColor },
-		{ StringHash("DEPTH24"),	PixelFormat::Depth24, g_PfxTexDepth },
-		{ StringHash("DEPTH16"),	PixelFormat::Depth16, g_PfxTexDepth },
-		{ StringHash("DEPTH8"),		PixelFormat::Depth8, g_PfxTexDepth },
+		{ StringHashLiteral("RGBA8888"),	PixelFormat::RGBA_8888, g_PfxTexColor },
+		{ StringHashLiteral("RGBA4444"),	PixelFormat::RGBA_4444, g_PfxTexColor },
+		{ StringHashLiteral("RGB888"),		PixelFormat::RGB_888, g_PfxTexColor },
+		{ StringHashLiteral("RGB565"),		PixelFormat::RGB_565, g_PfxTexColor },
+		{ StringHashLiteral("INTENSITY8"), PixelFormat::Intensity8, g_PfxTexColor },
+		{ StringHashLiteral("DEPTH24"),	PixelFormat::Depth24, g_PfxTexDepth },
+		{ StringHashLiteral("DEPTH16"),	PixelFormat::Depth16, g_PfxTexDepth },
+		{ StringHashLiteral("DEPTH8"),		PixelFormat::Depth8, g_PfxTexDepth },
 	};
 	const uint32 numSurfaceType = sizeof(surfacePairs) / sizeof(surfacePairs[0]);
 
@@ -1050,12 +1067,14 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 		// Skip blank lines
 		if (m_context->ppszEffectFile[i].empty()) {	continue; }
 
-		// Need to make a copy so we can use strtok and not affect subsequent parsing
-		string blockCopy(m_context->ppszEffectFile[i]);
-		char8* str = strtok(const_cast<char8*>(blockCopy.c_str()), NEWLINE_TOKENS DELIM_TOKENS);
-		if (!str) {	return false; }
+		// Read the tokens in place: the line is parsed again by the caller
+		const PfxLexeme& line = m_context->ppszEffectFile[i];
+		const char8* cursor = line.c_str();
+		const char8* const lineEnd = line.c_str() + line.length;
+		PfxToken token;
+		if (!nextToken(cursor, lineEnd, token)) {	return false; }
 
-		StringHash Cmd(str);
+		StringHash Cmd(StringHashLiteral(token.str, token.length));
 		const char8** ppParams    = NULL;
 		uint32 uiNumParams = 0;
 		bool bKnown = false;
@@ -1078,8 +1097,7 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 		// --- Inline filtering flags
 		else if (Cmd == GenericSurfCommands[eCmds_Filter])
 		{
-			char8* pszRemaining = strtok(NULL, NEWLINE_TOKENS DELIM_TOKENS);
-			if (!pszRemaining)
+			if (!nextToken(cursor, lineEnd, token))
 			{
 				pReturnError = strings::createFormatted("Missing FILTER arguments in [%s] on line %d: %s\n", pCaller,
 				                                        m_context->fileLineNumbers[i],  m_context->ppszEffectFile[i].c_str());
@@ -1093,14 +1111,13 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 				&Params.mipFilter,
 			};
 
-			if (!parseTextureFlags<SamplerFilter::Enum>(pszRemaining, pFlags, 3, Filters, SamplerFilter::Size, pReturnError, i, m_context)) { return false; }
+			if (!parseTextureFlags<SamplerFilter::Enum>(token.str, token.end(), pFlags, 3, Filters, SamplerFilter::Size, pReturnError, i, m_context)) { return false; }
 			bKnown     = true;
 		}
 		// --- Inline wrapping flags
 		else if (Cmd == GenericSurfCommands[eCmds_Wrap])
 		{
-			char8* pszRemaining = strtok(NULL, NEWLINE_TOKENS DELIM_TOKENS);
-			if (!pszRemaining)
+			if (!nextToken(cursor, lineEnd, token))
 			{
 				pReturnError = strings::createFormatted("Missing WRAP arguments in [%s] on line %d: %s\n", pCaller, m_context->fileLineNumbers[i],
 				                                        m_context->ppszEffectFile[i].c_str());
@@ -1114,35 +1131,32 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 				&Params.wrapR,
 			};
 
-			if (!parseTextureFlags<SamplerWrap::Enum>(pszRemaining, pFlags, 3, Wraps, SamplerWrap::Size, pReturnError, i, m_context)) { return false; }
+			if (!parseTextureFlags<SamplerWrap::Enum>(token.str, token.end(), pFlags, 3, Wraps, SamplerWrap::Size, pReturnError, i, m_context)) { return false; }
 			bKnown     = true;
 		}
 		// --- Resolution
 		else if (Cmd == GenericSurfCommands[eCmds_Resolution])
 		{
-			char8* pszRemaining;
-
 			uint32* uiVals[2] = { &Params.width, &Params.height };
 
 			// There should be precisely TWO arguments for resolution (width and height)
 			for (uint32 uiIndex = 0; uiIndex < 2; ++uiIndex)
 			{
-				pszRemaining = strtok(NULL, DELIM_TOKENS NEWLINE_TOKENS);
-				if (!pszRemaining)
+				if (!nextToken(cursor, lineEnd, token))
 				{
 					pReturnError = strings::createFormatted("Missing RESOLUTION argument(s) (requires width AND height) in [TARGET] on line %d\n",
 					                                        m_context->fileLineNumbers[i]);
 					return false;
 				}
 
-				int32 val = atoi(pszRemaining);
+				int32 val = atoi(token.str);
 
 				if ((val == 0
-				     && *pszRemaining != '0')			// Make sure they haven't explicitly set the value to be 0 as this might be a valid use-case.
+				     && *token.str != '0')			// Make sure they haven't explicitly set the value to be 0 as this might be a valid use-case.
 				    || (val < 0))
 				{
-					pReturnError = strings::createFormatted("Invalid RESOLUTION argument \"%s\" in [TEXTURE] on line %d\n", pszRemaining,
-					                                        m_context->fileLineNumbers[i]);
+					pReturnError = strings::createFormatted("Invalid RESOLUTION argument \"%.*s\" in [TEXTURE] on line %d\n", (int)token.length,
+					                                        token.str, m_context->fileLineNumbers[i]);
 					return false;
 				}
 
@@ -1154,17 +1168,15 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 		// --- Surface type
 		else if (Cmd == GenericSurfCommands[eCmds_Surface])
 		{
-			char8* pszRemaining = strtok(NULL, NEWLINE_TOKENS DELIM_TOKENS);
-			if (!pszRemaining)
+			if (!nextToken(cursor, lineEnd, token))
 			{
 				pReturnError = strings::createFormatted("Missing SURFACETYPE arguments in [TARGET] on line %d\n", m_context->fileLineNumbers[i]);
 				return false;
 			}
 
-			StringHash hashType(pszRemaining);
 			for (uint32 uiIndex = 0; uiIndex < numSurfaceType; ++uiIndex)
 			{
-				if (hashType == surfacePairs[uiIndex].name)
+				if (token.equals(surfacePairs[uiIndex].name.c_str(), surfacePairs[uiIndex].name.length()))
 				{
 					Params.flags =  surfacePairs[uiIndex].eType.getPixelTypeId() | surfacePairs[uiIndex].BufferType;
 					break;
@@ -1177,8 +1189,7 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 		// Valid Verbose command
 		if (ppParams)
 		{
-			char8* pszRemaining = strtok(NULL, NEWLINE_TOKENS DELIM_TOKENS);
-			if (!pszRemaining)
+			if (!nextToken(cursor, lineEnd, token))
 			{
 				pReturnError = strings::createFormatted("Missing arguments in [%s] on line %d: %s\n", pCaller, m_context->fileLineNumbers[i],
 				                                        m_context->ppszEffectFile[i].c_str());
@@ -1188,7 +1199,7 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 			uint32 Type = INVALID_TYPE;
 			for (uint32 uiIndex = 0; uiIndex < uiNumParams; ++uiIndex)
 			{
-				if (strcmp(pszRemaining, ppParams[uiIndex]) == 0)
+				if (token.equals(ppParams[uiIndex]))
 				{
 					Type = uiIndex;			// Yup, it's valid.
 					break;
@@ -1198,7 +1209,7 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 			// Tell the user it's invalid.
 			if (Type == INVALID_TYPE)
 			{
-				pReturnError = strings::createFormatted("Unknown keyword '%s' in [%s] on line %d: %s\n", pszRemaining, pCaller,
+				pReturnError = strings::createFormatted("Unknown keyword '%.*s' in [%s] on line %d: %s\n", (int)token.length, token.str, pCaller,
 				                                        m_context->fileLineNumbers[i], m_context->ppszEffectFile[i].c_str());
 				return false;
 			}
@@ -1216,10 +1227,9 @@ bool PfxReader::parseGenericSurface(int32 nStartLine, int32 nEndLine, PFXParserT
 			KnownCmds.push_back(Cmd);
 
 			// Make sure nothing else exists on the line that hasn't been parsed.
-			char8* pszRemaining = strtok(NULL, NEWLINE_TOKENS);
-			if (pszRemaining)
+			if (cursor != lineEnd)
 			{
-				pReturnError = strings::createFormatted("Unexpected keyword '%s' in [%s] on line %d: %s\n", pszRemaining, pCaller,
+				pReturnError = strings::createFormatted("Unexpected keyword '%s' in [%s] on line %d: %s\n", cursor, pCaller,
 				                                        m_context->fileLineNumbers[i], m_context->ppszEffectFile[i].c_str());
 				return false;
 			}
@@ -1232,12 +1242,12 @@ bool PfxReader::parseTexture(int32 nStartLine, int32 nEndLine, string& pReturnEr
 {
 	enum eCmd {	CmdsName,	CmdsPath,	CmdsView,	CmdsCamera, CmdsSize	};
 
-	const StringHash TextureCmds[] =
+	static const StringHashLiteral TextureCmds[] =
 	{
-		StringHash("NAME"),				// eTextureCmds_Name
-		StringHash("PATH"),				// eTextureCmds_Path
-		StringHash("VIEW"),				// eTextureCmds_View
-		StringHash("CAMERA"),			// eTextureCmds_Camera
+		StringHashLiteral("NAME"),				// eTextureCmds_Name
+		StringHashLiteral("PATH"),				// eTextureCmds_Path
+		StringHashLiteral("VIEW"),				// eTextureCmds_View
+		StringHashLiteral("CAMERA"),			// eTextureCmds_Camera
 	};
 	PVR_STATIC_ASSERT(sizeof(TextureCmds) / sizeof(TextureCmds[0]) == CmdsSize, TextureCmds);
 
@@ -1419,9 +1429,9 @@ bool PfxReader::parseTarget(int32 nStartLine, int32 nEndLine, string& pReturnErr
 {
 	enum Cmd {CmdsName, CmdsSize};
 
-	const StringHash TargetCommands[] =
+	static const StringHashLiteral TargetCommands[] =
 	{
-		StringHash("NAME"),				// eCmds_Name
+		StringHashLiteral("NAME"),				// eCmds_Name
 	};
 	PVR_STATIC_ASSERT(sizeof(TargetCommands) / sizeof(TargetCommands[0]) == CmdsSize, TargetCommands);
 
@@ -1626,7 +1636,7 @@ bool PfxReader::parseTextures(int32 nStartLine, int32 nEndLine, string& pReturnE
 						&uiMip,
 					};
 
-					if (!parseTextureFlags<SamplerFilter::Enum>(pszRemaining, pFlags, 3, Filters, SamplerFilter::Size, pReturnError, i, m_context)) { return false; }
+					if (!parseTextureFlags<SamplerFilter::Enum>(pszRemaining, pszRemaining + strlen(pszRemaining), pFlags, 3, Filters, SamplerFilter::Size, pReturnError, i, m_context)) { return false; }
 				}
 
 				// --- Wrap flags
@@ -1638,7 +1648,7 @@ bool PfxReader::parseTextures(int32 nStartLine, int32 nEndLine, string& pReturnE
 						&uiWrapR,
 					};
 
-					if (!parseTextureFlags<SamplerWrap::Enum>(pszRemaining, pFlags, 3, Wraps, SamplerWrap::Size, pReturnError, i, m_context)) { return false; }
+					if (!parseTextureFlags<SamplerWrap::Enum>(pszRemaining, pszRemaining + strlen(pszRemaining), pFlags, 3, Wraps, SamplerWrap::Size, pReturnError, i, m_context)) { return false; }
 				}
 
 				PFXParserTexture* pTex = new PFXParserTexture();
@@ -1685,12 +1695,12 @@ bool PfxReader::parseShader(int32 nStartLine, int32 nEndLine, string& pReturnErr
 		CmdsSize
 	};
 
-	const StringHash ShaderCommands[] =
+	static const StringHashLiteral ShaderCommands[] =
 	{
-		StringHash("[GLSL_CODE]"),
-		StringHash("NAME"),
-		StringHash("FILE"),
-		StringHash("BINARYFILE"),
+		StringHashLiteral("[GLSL_CODE]"),
+		StringHashLiteral("NAME"),
+		StringHashLiteral("FILE"),
+		StringHashLiteral("BINARYFILE"),
 	};
 	PVR_STATIC_ASSERT(sizeof(ShaderCommands) / sizeof(ShaderCommands[0]) == CmdsSize, ShaderCommands);
 
@@ -1731,7 +1741,7 @@ bool PfxReader::parseShader(int32 nStartLine, int32 nEndLine, string& pReturnErr
 				// Skip the block-start
 				i++;
 				string GLSLCode;
-				if (!strings::concatenateLinesUntil(
+				if (!appendLexemesUntil(
 				      GLSLCode,
 				      i,
 				      m_context->ppszEffectFile,
@@ -2007,16 +2017,16 @@ bool PfxReader::parseEffect(PfxParserEffect& effect, int32 nStartLine, int32 nEn
 		CmdsSize
 	};
 
-	const StringHash effectCommands[] =
+	static const StringHashLiteral effectCommands[] =
 	{
-		StringHash("[ANNOTATION]"),
-		StringHash("VERTEXSHADER"),
-		StringHash("FRAGMENTSHADER"),
-		StringHash("TEXTURE"),
-		StringHash("UNIFORM"),
-		StringHash("ATTRIBUTE"),
-		StringHash("NAME"),
-		StringHash("TARGET"),
+		StringHashLiteral("[ANNOTATION]"),
+		StringHashLiteral("VERTEXSHADER"),
+		StringHashLiteral("FRAGMENTSHADER"),
+		StringHashLiteral("TEXTURE"),
+		StringHashLiteral("UNIFORM"),
+		StringHashLiteral("ATTRIBUTE"),
+		StringHashLiteral("NAME"),
+		StringHashLiteral("TARGET"),
 	};
 	PVR_STATIC_ASSERT(sizeof(effectCommands) / sizeof(effectCommands[0]) == CmdsSize, effectCommands);
 
@@ -2044,7 +2054,7 @@ bool PfxReader::parseEffect(PfxParserEffect& effect, int32 nStartLine, int32 nEn
 				}
 
 				i++;		// Skip the block-start
-				if (!strings::concatenateLinesUntil(
+				if (!appendLexemesUntil(
 				      effect.annotation,
 				      i,
 				      m_context->ppszEffectFile,
@@ -2331,6 +2341,154 @@ bool PfxReader::determineRenderPassDependencies(string& errorOut)
 	return true;
 }
 
+bool PfxReader::retrieveRenderPassSchedule(EffectRenderPassSchedule& outSchedule,
+    const std::vector<StringHash>& activeEffects) const
+{
+	outSchedule = EffectRenderPassSchedule();
+	const uint32 numNodes = m_renderPassSkipGraph.getNumNodes();
+	if (numNodes == 0) { return true; }
+
+	std::vector<std::vector<uint32> > graphLevels;
+	std::vector<uint32> nodeLevels;
+	if (!m_renderPassSkipGraph.retrieveDependencyLevels(graphLevels, nodeLevels))
+	{
+		Log(Log.Error, "[PfxReader::retrieveRenderPassSchedule] The render passes of '%s' depend on each other cyclically.",
+		    m_fileName.c_str());
+		return false;
+	}
+
+	// Find the passes the active effects use directly: the passes they render, and the passes whose targets they sample.
+	// (finalReaders) marks the passes whose targets are still read once all scheduled passes are done.
+	std::vector<bool> required(numNodes, activeEffects.empty());
+	std::vector<bool> finalReaders(numNodes, activeEffects.empty());
+	for (uint32 i = 0; i < (uint32)activeEffects.size(); ++i)
+	{
+		int32 effectId = getEffectId(activeEffects[i]);
+		if (effectId < 0)
+		{
+			Log(Log.Error, "[PfxReader::retrieveRenderPassSchedule] Effect '%s' not found.", activeEffects[i].c_str());
+			return false;
+		}
+		const PfxParserEffect& effect = m_effects[effectId];
+		for (uint32 node = 0; node < numNodes; ++node)
+		{
+			const PfxRenderPass& pass = *m_renderPassSkipGraph[node];
+			if (pass.effect == &effect) { required[node] = true; }
+			for (uint32 tex = 0; tex < (uint32)effect.textures.size(); ++tex)
+			{
+				if (pass.texture->name == effect.textures[tex].name)
+				{
+					required[node] = true;
+					finalReaders[node] = true;
+				}
+			}
+		}
+	}
+
+	// Everything a required pass depends on is required too. Deeper levels come later, so walk them backwards.
+	for (uint32 level = (uint32)graphLevels.size(); level-- > 0;)
+	{
+		for (uint32 i = 0; i < (uint32)graphLevels[level].size(); ++i)
+		{
+			const uint32 node = graphLevels[level][i];
+			if (!required[node]) { continue; }
+			const SkipGraphNode<PfxRenderPass*>& graphNode = m_renderPassSkipGraph.getNode(node);
+			for (uint32 dep = 0; dep < graphNode.getNumDependencies(); ++dep)
+			{
+				for (uint32 other = 0; other < numNodes; ++other)
+				{
+					if (&m_renderPassSkipGraph.getNode(other) == &graphNode.getDependency(dep)) { required[other] = true; }
+				}
+			}
+		}
+	}
+
+	// Drop levels left empty by the passes that are not required, and build the schedule level by level
+	std::vector<uint32> scheduledLevel(numNodes, 0);
+	std::vector<uint32> passIndex(numNodes, 0);
+	std::vector<uint32> passNodes;
+	for (uint32 level = 0; level < (uint32)graphLevels.size(); ++level)
+	{
+		const uint32 levelStart = (uint32)outSchedule.passes.size();
+		for (uint32 i = 0; i < (uint32)graphLevels[level].size(); ++i)
+		{
+			const uint32 node = graphLevels[level][i];
+			if (!required[node]) { continue; }
+			const PfxRenderPass& renderPass = *m_renderPassSkipGraph[node];
+			EffectRenderPassSchedule::Pass pass;
+			pass.name = renderPass.semanticName;
+			pass.effectName = renderPass.effect ? renderPass.effect->name : StringHash();
+			pass.level = outSchedule.getNumLevels();
+			pass.lastUseLevel = pass.level;
+			pass.targetSlot = 0;
+			scheduledLevel[node] = pass.level;
+			passIndex[node] = (uint32)outSchedule.passes.size();
+			passNodes.push_back(node);
+			outSchedule.passes.push_back(pass);
+		}
+		if (outSchedule.passes.size() != levelStart)
+		{
+			if (outSchedule.levelStart.empty()) { outSchedule.levelStart.push_back(levelStart); }
+			outSchedule.levelStart.push_back((uint32)outSchedule.passes.size());
+		}
+	}
+
+	// Lifetimes: a target lives from the level it is rendered in to the last level of a required pass reading it
+	const uint32 numLevels = outSchedule.getNumLevels();
+	for (uint32 node = 0; node < numNodes; ++node)
+	{
+		if (!required[node]) { continue; }
+		EffectRenderPassSchedule::Pass& pass = outSchedule.passes[passIndex[node]];
+		const SkipGraphNode<PfxRenderPass*>& graphNode = m_renderPassSkipGraph.getNode(node);
+		bool hasReaders = false;
+		for (uint32 dep = 0; dep < graphNode.getNumDependents(); ++dep)
+		{
+			for (uint32 other = 0; other < numNodes; ++other)
+			{
+				if (required[other] && &m_renderPassSkipGraph.getNode(other) == &graphNode.getDependent(dep))
+				{
+					pass.lastUseLevel = std::max(pass.lastUseLevel, scheduledLevel[other]);
+					hasReaders = true;
+				}
+			}
+		}
+		if (finalReaders[node] || !hasReaders) { pass.lastUseLevel = numLevels; }
+	}
+
+	// Greedy interval allocation: in level order, reuse the first compatible slot whose target is no longer needed
+	struct Slot
+	{
+		const PFXParserTexture* desc;
+		uint32 lastUseLevel;
+	};
+	std::vector<Slot> slots;
+	for (uint32 i = 0; i < (uint32)outSchedule.passes.size(); ++i)
+	{
+		EffectRenderPassSchedule::Pass& pass = outSchedule.passes[i];
+		const PFXParserTexture* desc = m_renderPassSkipGraph[passNodes[i]]->texture;
+
+		uint32 slot = 0;
+		for (; slot < (uint32)slots.size(); ++slot)
+		{
+			const PFXParserTexture* slotDesc = slots[slot].desc;
+			if (slots[slot].lastUseLevel < pass.level && slotDesc->width == desc->width && slotDesc->height == desc->height &&
+			    slotDesc->flags == desc->flags)
+			{
+				break;
+			}
+		}
+		if (slot == slots.size())
+		{
+			Slot newSlot = { desc, 0 };
+			slots.push_back(newSlot);
+		}
+		slots[slot].lastUseLevel = pass.lastUseLevel;
+		pass.targetSlot = slot;
+	}
+	outSchedule.numTargetSlots = (uint32)slots.size();
+	return true;
+}
+
 uint32 PfxReader::findTextureIndex(const StringHash& TextureName, uint32 uiEffect) const
 {
 	for (uint32 uiIndex = 0; uiIndex < m_effects[uiEffect].textures.size(); ++uiIndex)
@@ -2401,6 +2559,7 @@ bool PfxReader::readEffect(Effect& asset, uint32 id) const
 	m_textures.reserve(numTextures);
 	asset.material.setEffectName(parserEffect.name);
 	asset.fileName = m_fileName;
+	retrieveRenderPassSchedule(asset.renderPassSchedule, std::vector<StringHash>(1, parserEffect.name));
 	// Initialize each Texture
 	for (uint32 i = 0; i < numTextures; ++i)
 	{
@@ -2437,7 +2596,9 @@ bool PfxReader::readEffect(Effect& asset, uint32 id) const
 			asset.vertexShader.name = vertShader.name;
 			if (vertShader.useFileName)
 			{
+				// The file was read when parsing: keep its contents, so that the effect does not depend on it
 				asset.vertexShader.glslFile = vertShader.glslFile;
+				asset.vertexShader.glslCode = vertShader.glslCode;
 				asset.vertexShader.useFileName = true;
 			}
 			else
@@ -2463,6 +2624,7 @@ bool PfxReader::readEffect(Effect& asset, uint32 id) const
 			if (fragmentShader.useFileName)
 			{
 				asset.fragmentShader.glslFile = fragmentShader.glslFile;
+				asset.fragmentShader.glslCode = fragmentShader.glslCode;
 				asset.fragmentShader.useFileName = true;
 			}
 			else
@@ -218,6 +218,17 @@ public:
 	bool retrieveRenderPassDependencies(std::vector<PfxRenderPass*>& aRequiredRenderPasses,
 	                                    std::vector<StringHash>& aszActiveEffecstrings);
 
+	/*!*****************************************************************************************************************
+	\param[out]	outSchedule			The schedule of the required render passes
+	\param[in]	activeEffects		Names of the active effects. If empty, all render passes are scheduled.
+	\return		false if an effect was not found or the render passes depend on each other cyclically
+	\brief      Sorts the render passes required by the active effects into levels of independent passes, and
+				assigns their render targets to slots so that targets with disjoint lifetimes can share one FBO.
+				See EffectRenderPassSchedule.
+	*******************************************************************************************************************/
+	bool retrieveRenderPassSchedule(EffectRenderPassSchedule& outSchedule,
+	                                const std::vector<StringHash>& activeEffects) const;
+
 	/*!*****************************************************************************************************************
 	\brief  Returns the number of render passes within this PFX.
 	\return	The number of render passes required
@@ -414,13 +425,9 @@ private:
 
 	bool parse(string& returnError);
 
-	void reduceWhitespace(char8* line);
-
-	bool getEndTag(const char8* tagName, int32 startLine, int32* endLine);
-
-	string findParameter(tchar* sourceString, const string& parameterTag, const string& delimiter);
+	bool getEndTag(uint32 section, int32 startLine, int32* endLine);
 
-	bool readStringToken(tchar* source, string& output, string& errorStr, int32 line, const tchar* caller);
+	bool readStringToken(const tchar* source, string& output, string& errorStr, int32 line, const tchar* caller);
 
 	bool parseHeader(int32 startLine, int32 endLine, string& errorOut);
 
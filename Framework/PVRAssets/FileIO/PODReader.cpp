@@ -9,6 +9,7 @@
 #include "PVRAssets/FileIO/PODDefines.h"
 #include "PVRAssets/Model.h"
 #include "PVRCore/Log.h"
+#include "PVRCore/Profiler.h"
 //#include "PVRAssets/assets::Model.h"
 #include "PVRAssets/Helper.h"
 //#include "PVRAssets/assets::Model/Light.h"
@@ -620,6 +621,7 @@ bool readNodeBlock(Stream& stream, assets::Model::Node& node)
 				}
 				animInternData.numberOfFrames = (std::max)(animInternData.numberOfFrames, (uint32)animInternData.matrices.size());
 			}
+			nodeInternData.animation.buildMatrixInterpolation();
 			return true;
 		}
 		case pod::e_nodeIndex | pod::c_startTagMask:
@@ -1128,6 +1130,7 @@ PODReader::PODReader() : m_modelsToLoad(true)
 
 bool PODReader::readNextAsset(assets::Model& asset)
 {
+	PVR_PROFILE_ZONE("PODReader::readNextAsset");
 	bool result;
 	uint32 identifier, dataLength;
 	size_t dataRead;
@@ -0,0 +1,58 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets\MeshNodeHierarchy.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Contains definitions for methods of the MeshNodeHierarchy class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRAssets/MeshNodeHierarchy.h"
+#include "PVRAssets/BoundingBox.h"
+#include "PVRCore/Log.h"
+
+namespace pvr {
+namespace assets {
+bool MeshNodeHierarchy::init(const Model& model)
+{
+	bool result = true;
+	std::vector<math::AxisAlignedBox> meshBoxes(model.getNumMeshes());
+	for (uint32 i = 0; i < model.getNumMeshes(); ++i)
+	{
+		if (!model.getMesh(i).getVertexAttributeByName(StringHashLiteral("POSITION")))
+		{
+			Log(Log.Warning, "MeshNodeHierarchy: Mesh %u has no POSITION data. Its nodes are bounded by their origin.", i);
+			result = false;
+		}
+		else { meshBoxes[i] = utils::getBoundingBox(model.getMesh(i)); }
+	}
+	const uint32 numMeshNodes = model.getNumMeshNodes();
+	m_localBoxes.resize(numMeshNodes);
+	for (uint32 i = 0; i < numMeshNodes; ++i) { m_localBoxes.set(i, meshBoxes[model.getMeshNode(i).getObjectId()]); }
+	updateWorldBoxes(model);
+	m_hierarchy.build(m_worldBoxes);
+	return result;
+}
+
+void MeshNodeHierarchy::refit(const Model& model)
+{
+	updateWorldBoxes(model);
+	m_hierarchy.refit(m_worldBoxes);
+}
+
+void MeshNodeHierarchy::queryFrustum(const glm::mat4& viewProjection, std::vector<uint32>& outMeshNodes) const
+{
+	glm::vec4 planes[6];
+	math::getFrustumPlanes(viewProjection, planes);
+	m_hierarchy.queryFrustum(planes, outMeshNodes);
+}
+
+void MeshNodeHierarchy::updateWorldBoxes(const Model& model)
+{
+	const uint32 numMeshNodes = m_localBoxes.size();
+	m_worldMatrices.resize(numMeshNodes);
+	for (uint32 i = 0; i < numMeshNodes; ++i) { m_worldMatrices[i] = model.getWorldMatrix(i); }
+	m_worldBoxes.resize(numMeshNodes);
+	math::transformAxisAlignedBoxes(m_localBoxes, m_worldMatrices.data(), m_worldBoxes, 0, numMeshNodes);
+}
+}
+}
+//!\endcond
@@ -0,0 +1,89 @@
+/*!*********************************************************************************************************************
+\file         PVRAssets/MeshNodeHierarchy.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief        A bounding volume hierarchy over the mesh nodes of a Model, for culling and picking.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRAssets/Model.h"
+#include "PVRCore/BoundingVolumeHierarchy.h"
+
+namespace pvr {
+namespace assets {
+/*!********************************************************************************************************************
+\brief    A bounding volume hierarchy over the world space bounding boxes of the mesh nodes of a Model.
+\description The box of each mesh node is the box of its mesh's POSITION data (assumed to be three floats), transformed
+          by Model::getWorldMatrix at the Model's current frame. Queries return mesh node indexes, ready to be used to
+          record the draws of the visible or picked nodes:
+          \code
+          hierarchy.init(*scene);
+          ...
+          scene->setCurrentFrame(frame);
+          hierarchy.refit(*scene);
+          visibleNodes.clear();
+          hierarchy.queryFrustum(viewProjection, visibleNodes);
+          \endcode
+          Skinned meshes are bounded in their bind pose, which may not contain the animated vertices.
+**********************************************************************************************************************/
+class MeshNodeHierarchy
+{
+public:
+	/*!********************************************************************************************************************
+	\brief    Compute the boxes of the meshes and of the mesh nodes, and build the hierarchy.
+	\param    model The model. Its meshes must keep their vertex data.
+	\return   True on success, false if a mesh has no POSITION data (its nodes are then bounded by a point at their origin)
+	**********************************************************************************************************************/
+	bool init(const Model& model);
+
+	/*!********************************************************************************************************************
+	\brief    Update the boxes of the mesh nodes to the current frame of the model, keeping the structure of the hierarchy.
+	\param    model The model init was called with
+	**********************************************************************************************************************/
+	void refit(const Model& model);
+
+	/*!********************************************************************************************************************
+	\brief    Rebuild the hierarchy from the current boxes of the mesh nodes. Queries on a hierarchy refit many times, with
+	          nodes far from where they were when it was built, are slower than on a rebuilt one.
+	**********************************************************************************************************************/
+	void rebuild() { m_hierarchy.build(m_worldBoxes); }
+
+	/*!********************************************************************************************************************
+	\brief    Find the mesh nodes at least partly inside a frustum.
+	\param    viewProjection The view projection matrix of the camera
+	\param[out] outMeshNodes The indexes of the mesh nodes are appended, in no particular order
+	**********************************************************************************************************************/
+	void queryFrustum(const glm::mat4& viewProjection, std::vector<uint32>& outMeshNodes) const;
+
+	/*!********************************************************************************************************************
+	\brief    Find the mesh nodes whose box is hit by a ray, nearest first.
+	\param    origin The origin of the ray, in world space
+	\param    direction The direction of the ray
+	\param[out] outMeshNodes The indexes of the mesh nodes are appended
+	\param    maxDistance Boxes entered further than this, in multiples of the length of direction, are ignored
+	**********************************************************************************************************************/
+	void queryRay(const glm::vec3& origin, const glm::vec3& direction, std::vector<uint32>& outMeshNodes,
+	              float32 maxDistance = FLT_MAX) const
+	{
+		m_hierarchy.queryRay(origin, direction, outMeshNodes, maxDistance);
+	}
+
+	/*!********************************************************************************************************************
+	\return   The world space box of each mesh node, indexed by mesh node.
+	**********************************************************************************************************************/
+	const math::AxisAlignedBoxArray& getWorldBoundingBoxes() const { return m_worldBoxes; }
+
+	/*!********************************************************************************************************************
+	\return   The hierarchy.
+	**********************************************************************************************************************/
+	const math::BoundingVolumeHierarchy& getHierarchy() const { return m_hierarchy; }
+
+private:
+	void updateWorldBoxes(const Model& model);
+
+	math::AxisAlignedBoxArray m_localBoxes; // Per mesh node, in the space of its mesh
+	math::AxisAlignedBoxArray m_worldBoxes;
+	std::vector<glm::mat4> m_worldMatrices;
+	math::BoundingVolumeHierarchy m_hierarchy;
+};
+}
+}
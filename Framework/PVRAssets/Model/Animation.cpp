@@ -105,8 +105,92 @@ glm::mat4x4 Animation::getScalingMatrix(uint32 frame, float32 interp) const
 	return glm::mat4x4();
 }
 
+namespace {
+const float32 c_quaternionQuantisation = 32767.f;
+
+// Decompose an affine matrix into translation, rotation and (possibly negative) scale. Fails for shear and zero scale.
+bool decomposeMatrix(const float32* m, Animation::MatrixKey& key)
+{
+	glm::vec3 columns[3] =
+	{
+		glm::vec3(m[0], m[1], m[2]),
+		glm::vec3(m[4], m[5], m[6]),
+		glm::vec3(m[8], m[9], m[10]),
+	};
+	if (m[3] != 0.f || m[7] != 0.f || m[11] != 0.f || m[15] != 1.f)
+	{
+		return false;
+	}
+
+	key.translation = glm::vec3(m[12], m[13], m[14]);
+	key.scale = glm::vec3(glm::length(columns[0]), glm::length(columns[1]), glm::length(columns[2]));
+	if (key.scale.x <= 0.f || key.scale.y <= 0.f || key.scale.z <= 0.f)
+	{
+		return false;
+	}
+	// Mirroring is folded into the x scale, so that what remains is a proper rotation
+	if (glm::dot(glm::cross(columns[0], columns[1]), columns[2]) < 0.f)
+	{
+		key.scale.x = -key.scale.x;
+	}
+
+	glm::mat3 rotation(columns[0] / key.scale.x, columns[1] / key.scale.y, columns[2] / key.scale.z);
+	const float32 c_orthogonalityTolerance = 1e-3f;
+	if (fabs(glm::dot(rotation[0], rotation[1])) > c_orthogonalityTolerance ||
+	    fabs(glm::dot(rotation[1], rotation[2])) > c_orthogonalityTolerance ||
+	    fabs(glm::dot(rotation[2], rotation[0])) > c_orthogonalityTolerance)
+	{
+		return false;
+	}
+
+	glm::quat q = glm::normalize(glm::quat_cast(rotation));
+	key.rotation[0] = static_cast<int16>(floor(q.x * c_quaternionQuantisation + .5f));
+	key.rotation[1] = static_cast<int16>(floor(q.y * c_quaternionQuantisation + .5f));
+	key.rotation[2] = static_cast<int16>(floor(q.z * c_quaternionQuantisation + .5f));
+	key.rotation[3] = static_cast<int16>(floor(q.w * c_quaternionQuantisation + .5f));
+	return true;
+}
+
+inline glm::quat dequantiseRotation(const int16(&rotation)[4])
+{
+	return glm::normalize(glm::quat(rotation[3] / c_quaternionQuantisation, rotation[0] / c_quaternionQuantisation,
+	                                rotation[1] / c_quaternionQuantisation, rotation[2] / c_quaternionQuantisation));
+}
+
+inline glm::mat4x4 composeMatrix(const glm::vec3& translation, const glm::quat& q, const glm::vec3& scale)
+{
+	glm::mat3 rotation = glm::mat3_cast(q);
+	return glm::mat4x4(glm::vec4(rotation[0] * scale.x, 0.f), glm::vec4(rotation[1] * scale.y, 0.f),
+	                   glm::vec4(rotation[2] * scale.z, 0.f), glm::vec4(translation, 1.f));
+}
+
+glm::mat4x4 interpolateMatrixKeys(const Animation::MatrixKey& key0, const Animation::MatrixKey& key1, float32 interp)
+{
+	glm::quat q0 = dequantiseRotation(key0.rotation);
+	glm::quat q1 = dequantiseRotation(key1.rotation);
+	// Take the shortest path
+	if (glm::dot(q0, q1) < 0.f) { q1 = -q1; }
+
+	return composeMatrix(glm::mix(key0.translation, key1.translation, interp), glm::slerp(q0, q1, interp),
+	                     glm::mix(key0.scale, key1.scale, interp));
+}
+}
+
 glm::mat4x4 Animation::getTransformationMatrix(uint32 frame, float32 interp) const
 {
+	if (m_data.matrixKeys.size())
+	{
+		// The matrix animation has been replaced by its keys (see buildMatrixInterpolation)
+		PVR_ASSERT(frame < m_data.numberOfFrames);
+		uint32 index = m_data.matrixIndices.size() ? m_data.matrixIndices[frame] / 16 : frame;
+		const MatrixKey& key = m_data.matrixKeys[index];
+		if (interp > 0.f && frame + 1 < m_data.numberOfFrames)
+		{
+			uint32 nextIndex = m_data.matrixIndices.size() ? m_data.matrixIndices[frame + 1] / 16 : frame + 1;
+			return interpolateMatrixKeys(key, m_data.matrixKeys[nextIndex], interp);
+		}
+		return composeMatrix(key.translation, dequantiseRotation(key.rotation), key.scale);
+	}
 	if (m_data.matrices.size())
 	{
 		if (m_data.flags & Animation::HasMatrixAnimation)
@@ -304,6 +388,7 @@ bool Animation::setMatrices(uint32 numFrames, const float32* const data, const u
 {
 	m_data.matrices.resize(0);
 	m_data.matrixIndices.resize(0);
+	m_data.matrixKeys.clear();
 	m_data.flags |= ~HasMatrixAnimation;
 	if (numFrames > 1 && m_data.flags && numFrames != m_data.numberOfFrames)
 	{
@@ -344,6 +429,37 @@ bool Animation::setMatrices(uint32 numFrames, const float32* const data, const u
 	{
 		m_data.flags |= HasMatrixAnimation;
 	}
+	buildMatrixInterpolation();
+	return true;
+}
+
+bool Animation::buildMatrixInterpolation()
+{
+	if (!(m_data.flags & HasMatrixAnimation))
+	{
+		m_data.matrixKeys.clear();
+		return false;
+	}
+	if (m_data.matrices.empty())
+	{
+		// Already replaced by keys
+		return !m_data.matrixKeys.empty();
+	}
+
+	const uint32 numMatrices = static_cast<uint32>(m_data.matrices.size() / 16);
+	std::vector<MatrixKey> keys(numMatrices);
+	for (uint32 i = 0; i < numMatrices; ++i)
+	{
+		if (!decomposeMatrix(&m_data.matrices[i * 16], keys[i]))
+		{
+			Log(Log.Debug, "Animation: matrix %d cannot be decomposed into translation/rotation/scale. "
+			    "The matrix animation will not be interpolated.", i);
+			m_data.matrixKeys.clear();
+			return false;
+		}
+	}
+	m_data.matrixKeys.swap(keys);
+	std::vector<float32>().swap(m_data.matrices);
 	return true;
 }
 
@@ -384,7 +500,12 @@ const uint32* Animation::getScaleIndices() const
 
 const float32* Animation::getMatrices() const
 {
-	return m_data.matrices.data();
+	return m_data.matrices.empty() ? NULL : m_data.matrices.data();
+}
+
+const Animation::MatrixKey* Animation::getMatrixKeys() const
+{
+	return m_data.matrixKeys.empty() ? NULL : m_data.matrixKeys.data();
 }
 
 const uint32* Animation::getMatrixIndices() const
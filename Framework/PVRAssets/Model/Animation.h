@@ -23,6 +23,19 @@ public:
 		HasMatrixAnimation   = 0x08//!< matrix animation data
 	};
 
+	/*!************************************************************************************************************
+	\brief A transformation matrix of a matrix animation, decomposed into translation, rotation and scale so that it
+	       can be interpolated. The rotation quaternion (x,y,z,w) is quantised to normalised 16 bit integers, so a key
+	       takes 32 bytes. Once every matrix of an animation has been decomposed, the keys replace the matrices, so
+	       matrix animations take 32 bytes per frame instead of 64.
+	***************************************************************************************************************/
+	struct MatrixKey
+	{
+		glm::vec3 translation;
+		int16 rotation[4];
+		glm::vec3 scale;
+	};
+
 	/*!************************************************************************************************************
 	\brief Raw internal structure of the Animation.
 	***************************************************************************************************************/
@@ -34,7 +47,7 @@ public:
 		std::vector<float32> positions;	/*!< 3 floats per frame of animation. */
 		std::vector<float32> rotations;	/*!< 4 floats per frame of animation. */
 		std::vector<float32> scales;		/*!< 7 floats per frame of animation. */
-		std::vector<float32> matrices;	/*!< 16 floats per frame of animation. */
+		std::vector<float32> matrices;	/*!< 16 floats per frame of animation. Empty if replaced by matrixKeys. */
 
 		// Indices: If you will have loads of repeated values
 		std::vector<uint32> positionIndices;
@@ -42,6 +55,9 @@ public:
 		std::vector<uint32> scaleIndices;
 		std::vector<uint32> matrixIndices;
 
+		// One decomposed key per matrix, indexed like (matrices) divided by 16. Empty if the matrices cannot be interpolated.
+		std::vector<MatrixKey> matrixKeys;
+
 		uint32   numberOfFrames;
 
 		InternalData() : flags(0), numberOfFrames(0)
@@ -57,14 +73,28 @@ public:
 	        between frame \p frame and frame \p frame+1
 	\param	frame The first frame for which the transformation matrix will be returned
 	\param	interp Interpolation value used between the frames
-	\remarks If the animation consists of Transformation Matrices, they will NOT be
-	         interpolated as this would be a very expensive operation. Rather, the 
-			 closest matrix will be returned. If the transformation consists of Scale/
-			 translation vectors and Rotation quaternia, Scale and Translation will be
-			 Linear Interpolated, and Rotation will be SLERPed (Smooth Linear Interpolation)
-			 as normal.
+	\remarks If the animation consists of Transformation Matrices, they are interpolated
+	         through the keys prepared by buildMatrixInterpolation: translation and scale
+			 are Linear Interpolated and rotation is SLERPed. If the matrices could not be
+			 decomposed (e.g. they contain shear), they are kept and the matrix of \p frame
+			 is returned.
+			 If the transformation consists of Scale/translation vectors and Rotation
+			 quaternia, Scale and Translation will be Linear Interpolated, and Rotation
+			 will be SLERPed (Smooth Linear Interpolation) as normal.
 	********************************************************************************/
 	glm::mat4x4 getTransformationMatrix(uint32 frame = 0, float32 interp = 0) const;
+
+	/*!******************************************************************************
+	\brief	Decompose the transformation matrices of a matrix animation into
+	        translation/rotation/scale keys, so that getTransformationMatrix can
+			interpolate between frames. If every matrix can be decomposed, the keys
+			replace the matrices, which are freed. Called by setMatrices and by the
+			PODReader when loading, so it only needs to be called after modifying the
+			internal data directly.
+	\return	True if the animation is stored as keys, false if there is no matrix
+	        animation or a matrix cannot be represented as translation/rotation/scale.
+	********************************************************************************/
+	bool buildMatrixInterpolation();
 //
 //TO IMPLEMENT
 //	\brief	Get translation for specific frame and interpolation. The aniumation MUST
@@ -131,10 +161,17 @@ public:
 	const uint32* getScaleIndices() const;
 
 	/*!******************************************************************************
-	\brief	Get a pointer to the transformation matrices of this animation.
+	\brief	Get a pointer to the transformation matrices of this animation. NULL if the
+	        matrices have been replaced by keys (see getMatrixKeys).
 	********************************************************************************/
 	const float32* getMatrices() const;
 
+	/*!******************************************************************************
+	\brief	Get a pointer to the decomposed keys of the matrix animation, indexed like
+	        the matrices divided by 16. NULL if the animation has no keys.
+	********************************************************************************/
+	const MatrixKey* getMatrixKeys() const;
+
 	/*!******************************************************************************
 	\brief	Get a pointer to the indexes of the transformation matrices of this animation.
 	********************************************************************************/
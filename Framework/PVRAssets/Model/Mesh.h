@@ -483,7 +483,7 @@ public:
 	/*!****************************************************************************************************************
 	\brief	Get the information of a VertexAttribute by its SemanticName.
 	\return	A VertexAttributeData object with information on this attribute. (layout, index etc.) Null if failed
-	\description This method does lookup in O(logN) time. Prefer to call the getVertexAttributeID and then use the
+	\description This method does a hash lookup. Prefer to call the getVertexAttributeID and then use the
 	             constant-time O(1) getVertexAttribute(int32) method
 	*******************************************************************************************************************/
 	const VertexAttributeData* getVertexAttributeByName(const StringHash& semanticName) const
@@ -496,10 +496,21 @@ public:
 		return NULL;
 	}
 
+	/*!****************************************************************************************************************
+	\brief	Get the information of a VertexAttribute by its SemanticName, given as a StringHashLiteral.
+	\return	A VertexAttributeData object with information on this attribute. (layout, index etc.) Null if failed
+	\description Unlike the StringHash overload, does not allocate: the hash of the literal is computed at compile time.
+	*******************************************************************************************************************/
+	const VertexAttributeData* getVertexAttributeByName(const StringHashLiteral& semanticName) const
+	{
+		const size_t index = m_data.vertexAttributes.getIndex(semanticName);
+		return index != static_cast<size_t>(-1) ? &(m_data.vertexAttributes[index]) : NULL;
+	}
+
 	/*!****************************************************************************************************************
 	\brief	Get the Index of a VertexAttribute by its SemanticName.
 	\return	The Index of the vertexAttribute.
-	\description Use this method to get the Index of a vertex attribute in O(logN) time and then be able to retrieve it
+	\description Use this method to get the Index of a vertex attribute with a hash lookup and then be able to retrieve it
 	             by index with getVertexAttribute in constant time
 	*******************************************************************************************************************/
 	int32 getVertexAttributeIndex(const char8* semanticName) const
@@ -507,6 +518,15 @@ public:
 		return (int32)m_data.vertexAttributes.getIndex(semanticName);
 	}
 
+	/*!****************************************************************************************************************
+	\brief	Get the Index of a VertexAttribute by its SemanticName, given as a StringHashLiteral. Does not allocate.
+	\return	The Index of the vertexAttribute.
+	*******************************************************************************************************************/
+	int32 getVertexAttributeIndex(const StringHashLiteral& semanticName) const
+	{
+		return (int32)m_data.vertexAttributes.getIndex(semanticName);
+	}
+
 	/*!****************************************************************************************************************
 	\brief	Get the information of a VertexAttribute by its SemanticName.
 	\return	A VertexAttributeData object with information on this attribute. (layout, data index etc.) Null if failed
@@ -6,9 +6,12 @@
 ***********************************************************************************************************************/
 #pragma once
 #include "PVRAssets/Model.h"
+#include "PVRAssets/MeshNodeHierarchy.h"
 #include "PVRAssets/Shader.h"
 #include "PVRAssets/FileIO/PODReader.h"
 #include "PVRAssets/FileIO/PFXReader.h"
+#include "PVRAssets/FileIO/EffectCacheReader.h"
+#include "PVRAssets/FileIO/EffectCacheWriter.h"
 #include "PVRAssets/FileIO/TextureReaderPVR.h"
 #include "PVRAssets/FileIO/TextureReaderBMP.h"
 #include "PVRAssets/FileIO/TextureReaderKTX.h"
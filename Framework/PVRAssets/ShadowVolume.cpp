@@ -11,6 +11,19 @@
 #include "PVRAssets/Helper.h"
 
 #include "PVRCore/Log.h"
+#include "PVRCore/Profiler.h"
+#include "PVRCore/TaskScheduler.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PVR_SHADOWVOLUME_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PVR_SHADOWVOLUME_SSE
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PVR_SHADOWVOLUME_NEON
+#endif
 using std::pair;
 using std::map;
 
@@ -30,6 +43,9 @@ const static unsigned short c_linesHyperCube[64] =
 
 };
 
+// Lights are processed in groups that fit the bits of a per-triangle uint32 facing mask
+const static pvr::uint32 c_maxLightsPerPass = 32;
+
 const static glm::vec3 c_rect0(-1, -1, 1), c_rect1(-1,  1, 1), c_rect2(1, -1, 1), c_rect3(1,  1, 1);
 namespace pvr {
 
@@ -46,6 +62,72 @@ ShadowVolume::~ShadowVolume()
 	delete [] m_shadowMesh.edges;
 	delete [] m_shadowMesh.triangles;
 	delete [] m_shadowMesh.vertexData;
+	releaseProjectionData();
+}
+
+void ShadowVolume::releaseProjectionData()
+{
+	// The four plane arrays share a single allocation
+	delete [] m_shadowMesh.planeNormalX;
+	delete [] m_shadowMesh.edgeTriangleStart;
+	delete [] m_shadowMesh.edgeTriangles;
+	delete [] m_shadowMesh.triangleLitMask;
+	m_shadowMesh.planeNormalX = m_shadowMesh.planeNormalY = m_shadowMesh.planeNormalZ = m_shadowMesh.planeDistance = NULL;
+	m_shadowMesh.edgeTriangleStart = NULL;
+	m_shadowMesh.edgeTriangles = NULL;
+	m_shadowMesh.triangleLitMask = NULL;
+}
+
+void ShadowVolume::initialiseProjectionData()
+{
+	releaseProjectionData();
+
+	// Triangle planes, laid out so that the facing test can process 4 or 8 triangles at once. The padding entries are
+	// zero and are never read back.
+	const uint32 paddedTriangles = (m_shadowMesh.numTriangles + 7) & ~7u;
+	m_shadowMesh.planeNormalX = new float32[paddedTriangles * 4];
+	m_shadowMesh.planeNormalY = m_shadowMesh.planeNormalX + paddedTriangles;
+	m_shadowMesh.planeNormalZ = m_shadowMesh.planeNormalY + paddedTriangles;
+	m_shadowMesh.planeDistance = m_shadowMesh.planeNormalZ + paddedTriangles;
+	memset(m_shadowMesh.planeNormalX, 0, paddedTriangles * 4 * sizeof(float32));
+	m_shadowMesh.triangleLitMask = new uint32[paddedTriangles];
+
+	for (uint32 i = 0; i < m_shadowMesh.numTriangles; ++i)
+	{
+		const ShadowVolumeTriangle& triangle = m_shadowMesh.triangles[i];
+		const ShadowVolumeEdge& edge0 = m_shadowMesh.edges[triangle.edgeIndices[0]];
+		m_shadowMesh.planeNormalX[i] = triangle.normal.x;
+		m_shadowMesh.planeNormalY[i] = triangle.normal.y;
+		m_shadowMesh.planeNormalZ[i] = triangle.normal.z;
+		m_shadowMesh.planeDistance[i] = glm::dot(triangle.normal, m_shadowMesh.vertices[edge0.vertexIndices[0]]);
+	}
+
+	// Invert the triangle->edge references so that every edge can be classified on its own
+	m_shadowMesh.edgeTriangleStart = new uint32[m_shadowMesh.numEdges + 1];
+	memset(m_shadowMesh.edgeTriangleStart, 0, (m_shadowMesh.numEdges + 1) * sizeof(uint32));
+	for (uint32 i = 0; i < m_shadowMesh.numTriangles; ++i)
+	{
+		for (uint32 j = 0; j < 3; ++j)
+		{
+			++m_shadowMesh.edgeTriangleStart[m_shadowMesh.triangles[i].edgeIndices[j] + 1];
+		}
+	}
+	for (uint32 i = 0; i < m_shadowMesh.numEdges; ++i)
+	{
+		m_shadowMesh.edgeTriangleStart[i + 1] += m_shadowMesh.edgeTriangleStart[i];
+	}
+
+	std::vector<uint32> fill(m_shadowMesh.edgeTriangleStart, m_shadowMesh.edgeTriangleStart + m_shadowMesh.numEdges);
+	m_shadowMesh.edgeTriangles = new ShadowVolumeEdgeTriangle[m_shadowMesh.numTriangles * 3];
+	for (uint32 i = 0; i < m_shadowMesh.numTriangles; ++i)
+	{
+		for (uint32 j = 0; j < 3; ++j)
+		{
+			ShadowVolumeEdgeTriangle& entry = m_shadowMesh.edgeTriangles[fill[m_shadowMesh.triangles[i].edgeIndices[j]]++];
+			entry.triangle = i;
+			entry.windingMatches = (m_shadowMesh.triangles[i].winding >> j) & 0x01;
+		}
+	}
 }
 
 uint32 ShadowVolume::findOrCreateVertex(const glm::vec3& vertex, bool& existed)
@@ -117,7 +199,6 @@ uint32 ShadowVolume::findOrCreateEdge(const glm::vec3& v0, const glm::vec3& v1,
 	// Add the edge
 	m_shadowMesh.edges[m_shadowMesh.numEdges].vertexIndices[0] = vertexIndices[0];
 	m_shadowMesh.edges[m_shadowMesh.numEdges].vertexIndices[1] = vertexIndices[1];
-	m_shadowMesh.edges[m_shadowMesh.numEdges].visibilityFlags = 0;
 	existed = false;
 	return m_shadowMesh.numEdges++;
 }
@@ -208,7 +289,7 @@ void ShadowVolume::findOrCreateTriangle(const glm::vec3& v0, const glm::vec3& v1
 
 Result::Enum ShadowVolume::init(const assets::Mesh& mesh)
 {
-	const assets::Mesh::VertexAttributeData* positions = mesh.getVertexAttributeByName("POSITION");
+	const assets::Mesh::VertexAttributeData* positions = mesh.getVertexAttributeByName(StringHashLiteral("POSITION"));
 
 	if (positions == NULL)
 	{ return Result::NoData; }
@@ -333,6 +414,7 @@ Result::Enum ShadowVolume::init(const byte* const data, uint32 numVertices,
 
 	m_shadowMesh.needs32BitIndices = (m_shadowMesh.numTriangles * 2 * 3) > 65535;
 
+	initialiseProjectionData();
 	initialiseVertexData();
 	return Result::Success;
 }
@@ -477,152 +559,308 @@ byte* ShadowVolume::getIndices(uint32 volumeID)
 }
 
 Result::Enum ShadowVolume::projectSilhouette(uint32 volumeID, uint32 flags, const glm::vec3& lightModel, bool isPointLight,
-    byte** externalIndexBuffer)
-{
-	if (m_shadowMesh.needs32BitIndices)
-	{
-		return project<uint32>(volumeID, flags, lightModel, isPointLight, reinterpret_cast<uint32**>(externalIndexBuffer));
-	}
-	else
-	{
-		return project<uint16>(volumeID, flags, lightModel, isPointLight, reinterpret_cast<uint16**>(externalIndexBuffer));
-	}
-}
-
-template<typename INDEXTYPE>
-Result::Enum ShadowVolume::project(uint32 volumeID, uint32 flags, const glm::vec3& lightModel, bool isPointLight,
-                                   INDEXTYPE** externalIndexBuffer)
+    byte** externalIndexBuffer, uint32 numThreads)
 {
 	ShadowVolumeMapType::iterator found = m_shadowVolumes.find(volumeID);
 	PVR_ASSERT(found != m_shadowVolumes.end());
 
-	if (found != m_shadowVolumes.end())
+	if (found == m_shadowVolumes.end())
 	{
 		return Result::OutOfBounds;
 	}
 
 	ShadowVolumeData& volume = found->second;
-	INDEXTYPE* indices = externalIndexBuffer ? *externalIndexBuffer : reinterpret_cast<INDEXTYPE*>(volume.indexData);
+	byte* indices = externalIndexBuffer ? *externalIndexBuffer : volume.indexData;
 
 	if (indices == NULL)
 	{ return Result::NoData; }
 
-	float32 f;
+	Light light;
+	light.lightModel = lightModel;
+	light.isPointLight = isPointLight;
 	volume.indexCount = 0;
 
-	// Run through triangles, testing which face the From point
-	for (uint32 i = 0; i < m_shadowMesh.numTriangles; ++i)
+	if (m_shadowMesh.needs32BitIndices)
+	{
+		project<uint32>(&light, 1, &flags, reinterpret_cast<uint32*>(indices), 0, &volume.indexCount, numThreads);
+	}
+	else
+	{
+		project<uint16>(&light, 1, &flags, reinterpret_cast<uint16*>(indices), 0, &volume.indexCount, numThreads);
+	}
+	return Result::Success;
+}
+
+Result::Enum ShadowVolume::projectSilhouettes(const Light* lights, uint32 numLights, const uint32* flags, byte* indexBuffer,
+    uint32* indexCounts, uint32 numThreads)
+{
+	if (lights == NULL || flags == NULL || indexCounts == NULL)
+	{ return Result::InvalidArgument; }
+
+	if (indexBuffer == NULL)
+	{ return Result::NoData; }
+
+	const uint32 indicesPerLight = getIndexDataSize() / getIndexDataStride();
+	for (uint32 light = 0; light < numLights; light += c_maxLightsPerPass)
 	{
-		ShadowVolumeEdge* edge0, *edge1, *edge2;
-		edge0 = &m_shadowMesh.edges[m_shadowMesh.triangles[i].edgeIndices[0]];
-		edge1 = &m_shadowMesh.edges[m_shadowMesh.triangles[i].edgeIndices[1]];
-		edge2 = &m_shadowMesh.edges[m_shadowMesh.triangles[i].edgeIndices[2]];
+		const uint32 numPassLights = std::min(numLights - light, c_maxLightsPerPass);
+		for (uint32 i = 0; i < numPassLights; ++i) { indexCounts[light + i] = 0; }
 
-		if (isPointLight)
+		if (m_shadowMesh.needs32BitIndices)
 		{
-			glm::vec3 v;
-			v.x = m_shadowMesh.vertices[edge0->vertexIndices[0]].x - lightModel.x;
-			v.y = m_shadowMesh.vertices[edge0->vertexIndices[0]].y - lightModel.y;
-			v.z = m_shadowMesh.vertices[edge0->vertexIndices[0]].z - lightModel.z;
-
-			// Dot product
-			f = m_shadowMesh.triangles[i].normal.x * v.x + m_shadowMesh.triangles[i].normal.y * v.y + m_shadowMesh.triangles[i].normal.z *
-			    v.z;
+			project<uint32>(lights + light, numPassLights, flags + light,
+			                reinterpret_cast<uint32*>(indexBuffer) + light * indicesPerLight, indicesPerLight, indexCounts + light, numThreads);
 		}
 		else
 		{
-			f = m_shadowMesh.triangles[i].normal.x * lightModel.x + m_shadowMesh.triangles[i].normal.y * lightModel.y +
-			    m_shadowMesh.triangles[i].normal.z * lightModel.z;
+			project<uint16>(lights + light, numPassLights, flags + light,
+			                reinterpret_cast<uint16*>(indexBuffer) + light * indicesPerLight, indicesPerLight, indexCounts + light, numThreads);
 		}
+	}
+	return Result::Success;
+}
 
-		if (f >= 0)
+namespace {
+/*!*********************************************************************************************************************
+\brief Test which triangles face each light. Point light: dot(n, v0 - L) >= 0. Directional light: dot(n, L) >= 0.
+\param nx,ny,nz,d Structure-of-arrays triangle planes, padded to a multiple of 8 entries
+\param count Number of triangles
+\param lights The model-space lights, at most 32
+\param numLights The number of lights
+\param outLitMasks Receives, for every triangle, a mask with bit N set if it faces light N. Must hold count rounded up
+       to a multiple of 8 entries.
+\description The planes of each block of triangles are loaded once and tested against all lights.
+***********************************************************************************************************************/
+void computeTriangleFacing(const float32* nx, const float32* ny, const float32* nz, const float32* d, uint32 count,
+                           const ShadowVolume::Light* lights, uint32 numLights, uint32* outLitMasks)
+{
+	uint32 i = 0;
+#if defined(PVR_SHADOWVOLUME_AVX)
+	const __m256 zero = _mm256_setzero_ps();
+	for (; i < count; i += 8)
+	{
+		const __m256 px = _mm256_loadu_ps(nx + i), py = _mm256_loadu_ps(ny + i), pz = _mm256_loadu_ps(nz + i);
+		const __m256 pd = _mm256_loadu_ps(d + i);
+		uint32 masks[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		for (uint32 l = 0; l < numLights; ++l)
 		{
-			// Triangle is in the light
-			edge0->visibilityFlags |= 0x01;
-			edge1->visibilityFlags |= 0x01;
-			edge2->visibilityFlags |= 0x01;
-
-			if (flags & Cap_front)
-			{
-				// Add the triangle to the volume, un-extruded.
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[0]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[1]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[2]);
-			}
+			const glm::vec3& light = lights[l].lightModel;
+			__m256 f = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(light.x)), _mm256_mul_ps(py, _mm256_set1_ps(light.y))),
+			                         _mm256_mul_ps(pz, _mm256_set1_ps(light.z)));
+			if (lights[l].isPointLight) { f = _mm256_sub_ps(pd, f); }
+			const uint32 lit = static_cast<uint32>(_mm256_movemask_ps(_mm256_cmp_ps(f, zero, _CMP_GE_OQ)));
+			for (uint32 j = 0; j < 8; ++j) { masks[j] |= ((lit >> j) & 1) << l; }
 		}
-		else
+		memcpy(outLitMasks + i, masks, sizeof(masks));
+	}
+#elif defined(PVR_SHADOWVOLUME_SSE)
+	const __m128 zero = _mm_setzero_ps();
+	for (; i < count; i += 4)
+	{
+		const __m128 px = _mm_loadu_ps(nx + i), py = _mm_loadu_ps(ny + i), pz = _mm_loadu_ps(nz + i), pd = _mm_loadu_ps(d + i);
+		uint32 masks[4] = { 0, 0, 0, 0 };
+		for (uint32 l = 0; l < numLights; ++l)
+		{
+			const glm::vec3& light = lights[l].lightModel;
+			__m128 f = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(light.x)), _mm_mul_ps(py, _mm_set1_ps(light.y))),
+			                      _mm_mul_ps(pz, _mm_set1_ps(light.z)));
+			if (lights[l].isPointLight) { f = _mm_sub_ps(pd, f); }
+			const uint32 lit = static_cast<uint32>(_mm_movemask_ps(_mm_cmpge_ps(f, zero)));
+			masks[0] |= (lit & 1) << l;
+			masks[1] |= ((lit >> 1) & 1) << l;
+			masks[2] |= ((lit >> 2) & 1) << l;
+			masks[3] |= ((lit >> 3) & 1) << l;
+		}
+		memcpy(outLitMasks + i, masks, sizeof(masks));
+	}
+#elif defined(PVR_SHADOWVOLUME_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.f);
+	for (; i < count; i += 4)
+	{
+		const float32x4_t px = vld1q_f32(nx + i), py = vld1q_f32(ny + i), pz = vld1q_f32(nz + i), pd = vld1q_f32(d + i);
+		uint32x4_t masks = vdupq_n_u32(0);
+		for (uint32 l = 0; l < numLights; ++l)
 		{
-			// Triangle is in shade; set Bit3 if the winding order needs reversing
-			edge0->visibilityFlags |= 0x02 | (m_shadowMesh.triangles[i].winding & 0x01) << 2;
-			edge1->visibilityFlags |= 0x02 | (m_shadowMesh.triangles[i].winding & 0x02) << 1;
-			edge2->visibilityFlags |= 0x02 | (m_shadowMesh.triangles[i].winding & 0x04);
+			const glm::vec3& light = lights[l].lightModel;
+			float32x4_t f = vmulq_n_f32(px, light.x);
+			f = vmlaq_n_f32(f, py, light.y);
+			f = vmlaq_n_f32(f, pz, light.z);
+			if (lights[l].isPointLight) { f = vsubq_f32(pd, f); }
+			masks = vorrq_u32(masks, vshlq_u32(vshrq_n_u32(vcgeq_f32(f, zero), 31), vdupq_n_s32(static_cast<int32>(l))));
+		}
+		vst1q_u32(outLitMasks + i, masks);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		uint32 mask = 0;
+		for (uint32 l = 0; l < numLights; ++l)
+		{
+			const glm::vec3& light = lights[l].lightModel;
+			float32 f = nx[i] * light.x + ny[i] * light.y + nz[i] * light.z;
+			if (lights[l].isPointLight) { f = d[i] - f; }
+			mask |= static_cast<uint32>(f >= 0) << l;
+		}
+		outLitMasks[i] = mask;
+	}
+}
 
-			if (flags & Cap_back)
-			{
-				// Add the triangle to the volume, extruded.
-				// numVertices is used as an offset so that the new index refers to the
-				// corresponding position in the second array of vertices (which are extruded)
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[0] + m_shadowMesh.numVertices);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[1] + m_shadowMesh.numVertices);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.triangles[i].vertexIndices[2] + m_shadowMesh.numVertices);
-			}
+// Below this many edges per thread, the cost of spawning a thread outweighs the edge pass itself.
+const uint32 c_minEdgesPerThread = 4096;
+}
+
+template<typename INDEXTYPE>
+void ShadowVolume::projectSilhouetteEdges(uint32 firstEdge, uint32 lastEdge, uint32 numLights, INDEXTYPE* indices,
+    uint32 indicesPerLight, uint32* indexCounts) const
+{
+	const uint32 numVertices = m_shadowMesh.numVertices;
+	const uint32 lightsMask = numLights >= 32 ? 0xFFFFFFFFu : ((1u << numLights) - 1);
+
+	// Run through edges, testing which are silhouette edges
+	for (uint32 i = firstEdge; i < lastEdge; ++i)
+	{
+		// For every light: is any adjacent triangle lit, is any in shade, and does any shaded one need the winding reversed
+		uint32 lit = 0, shade = 0, windingMatches = 0;
+		for (uint32 t = m_shadowMesh.edgeTriangleStart[i]; t < m_shadowMesh.edgeTriangleStart[i + 1]; ++t)
+		{
+			const ShadowVolumeEdgeTriangle& entry = m_shadowMesh.edgeTriangles[t];
+			const uint32 triangleLit = m_shadowMesh.triangleLitMask[entry.triangle];
+			lit |= triangleLit;
+			shade |= ~triangleLit;
+			windingMatches |= entry.windingMatches ? ~triangleLit : 0;
+		}
+
+		/*
+			Silhouette edge found!
+			The edge is both visible and hidden, so it is along the silhouette of the model (See header notes for more info)
+		*/
+		uint32 silhouette = lit & shade & lightsMask;
+		for (uint32 light = 0; silhouette; ++light, silhouette >>= 1, windingMatches >>= 1)
+		{
+			if (!(silhouette & 1)) { continue; }
+
+			const ShadowVolumeEdge& edge = m_shadowMesh.edges[i];
+			const uint32 first = (windingMatches & 1) ? 0 : 1;
+			const INDEXTYPE v0 = static_cast<INDEXTYPE>(edge.vertexIndices[first]);
+			const INDEXTYPE v1 = static_cast<INDEXTYPE>(edge.vertexIndices[1 - first]);
+			INDEXTYPE* out = indices + light * indicesPerLight;
+			uint32& indexCount = indexCounts[light];
+
+			out[indexCount++] = v0;
+			out[indexCount++] = v1;
+			out[indexCount++] = static_cast<INDEXTYPE>(v0 + numVertices);
+
+			out[indexCount++] = static_cast<INDEXTYPE>(v0 + numVertices);
+			out[indexCount++] = v1;
+			out[indexCount++] = static_cast<INDEXTYPE>(v1 + numVertices);
 		}
 	}
+}
 
-#ifdef DEBUG // Sanity checks
-	PVR_ASSERT(volume.indexCount * sizeof(INDEXTYPE) <= getIndexDataSize()); // Have we accessed memory we shouldn't have?
+template<typename INDEXTYPE>
+void ShadowVolume::project(const Light* lights, uint32 numLights, const uint32* flags, INDEXTYPE* indices,
+                           uint32 indicesPerLight, uint32* indexCounts, uint32 numThreads)
+{
+	PVR_PROFILE_ZONE("ShadowVolume::project");
+	// Test which triangles face the From point of each light, several at a time
+	computeTriangleFacing(m_shadowMesh.planeNormalX, m_shadowMesh.planeNormalY, m_shadowMesh.planeNormalZ,
+	                      m_shadowMesh.planeDistance, m_shadowMesh.numTriangles, lights, numLights, m_shadowMesh.triangleLitMask);
 
-	for (uint32 i = 0; i < volume.indexCount; ++i)
+	uint32 frontCapLights = 0, backCapLights = 0;
+	for (uint32 light = 0; light < numLights; ++light)
 	{
-		PVR_ASSERT(indices[i] < m_shadowMesh.numVertices * 2);
+		frontCapLights |= (flags[light] & Cap_front) ? 1u << light : 0;
+		backCapLights |= (flags[light] & Cap_back) ? 1u << light : 0;
 	}
-#endif
 
-	// Run through edges, testing which are silhouette edges
-	for (uint32 i = 0; i < m_shadowMesh.numEdges; ++i)
+	if (frontCapLights | backCapLights)
 	{
-		if ((m_shadowMesh.edges[i].visibilityFlags & 0x03) == 0x03)
+		for (uint32 i = 0; i < m_shadowMesh.numTriangles; ++i)
 		{
-			/*
-				Silhouette edge found!
-				The edge is both visible and hidden, so it is along the silhouette of the model (See header notes for more info)
-			*/
-			if (m_shadowMesh.edges[i].visibilityFlags & 0x04)
+			const ShadowVolumeTriangle& triangle = m_shadowMesh.triangles[i];
+			const uint32 triangleLit = m_shadowMesh.triangleLitMask[i];
+			for (uint32 light = 0; light < numLights; ++light)
 			{
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0] + m_shadowMesh.numVertices);
-
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0] + m_shadowMesh.numVertices);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1] + m_shadowMesh.numVertices);
+				INDEXTYPE* out = indices + light * indicesPerLight;
+				uint32& indexCount = indexCounts[light];
+				if ((triangleLit >> light) & 1)
+				{
+					if ((frontCapLights >> light) & 1)
+					{
+						// Add the triangle to the volume, un-extruded.
+						out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[0]);
+						out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[1]);
+						out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[2]);
+					}
+				}
+				else if ((backCapLights >> light) & 1)
+				{
+					// Add the triangle to the volume, extruded.
+					// numVertices is used as an offset so that the new index refers to the
+					// corresponding position in the second array of vertices (which are extruded)
+					out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[0] + m_shadowMesh.numVertices);
+					out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[1] + m_shadowMesh.numVertices);
+					out[indexCount++] = static_cast<INDEXTYPE>(triangle.vertexIndices[2] + m_shadowMesh.numVertices);
+				}
 			}
-			else
+		}
+	}
+
+	numThreads = std::max(1u, std::min(numThreads, m_shadowMesh.numEdges / c_minEdgesPerThread));
+	if (numThreads == 1)
+	{
+		projectSilhouetteEdges<INDEXTYPE>(0, m_shadowMesh.numEdges, numLights, indices, indicesPerLight, indexCounts);
+	}
+	else
+	{
+		// Every thread writes the quads of its own range of edges into its own chunk (one slice per light), sized for
+		// the worst case of all of its edges being silhouette edges. The chunks are then appended to the caps in order.
+		const uint32 edgesPerThread = (m_shadowMesh.numEdges + numThreads - 1) / numThreads;
+		const uint32 chunkSize = edgesPerThread * 6;
+		m_edgeChunks.resize(chunkSize * numLights * numThreads * sizeof(INDEXTYPE));
+		INDEXTYPE* chunks = reinterpret_cast<INDEXTYPE*>(m_edgeChunks.data());
+		std::vector<uint32> chunkCounts(numLights * numThreads, 0);
+		TaskGroup tasks(TaskScheduler::getDefault());
+
+		for (uint32 t = 1; t < numThreads; ++t)
+		{
+			const uint32 firstEdge = std::min(t * edgesPerThread, m_shadowMesh.numEdges);
+			const uint32 lastEdge = std::min(firstEdge + edgesPerThread, m_shadowMesh.numEdges);
+			tasks.run([ =, &chunkCounts]()
 			{
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1] + m_shadowMesh.numVertices);
+				projectSilhouetteEdges<INDEXTYPE>(firstEdge, lastEdge, numLights, chunks + t * chunkSize * numLights, chunkSize,
+				                                  &chunkCounts[t * numLights]);
+			});
+		}
+		// The calling thread takes the first range and can write it in place
+		projectSilhouetteEdges<INDEXTYPE>(0, std::min(edgesPerThread, m_shadowMesh.numEdges), numLights, indices,
+		                                  indicesPerLight, indexCounts);
+		tasks.wait();
 
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[1] + m_shadowMesh.numVertices);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0]);
-				indices[volume.indexCount++] = static_cast<INDEXTYPE>(m_shadowMesh.edges[i].vertexIndices[0] + m_shadowMesh.numVertices);
+		for (uint32 t = 1; t < numThreads; ++t)
+		{
+			for (uint32 light = 0; light < numLights; ++light)
+			{
+				const uint32 count = chunkCounts[t * numLights + light];
+				memcpy(indices + light * indicesPerLight + indexCounts[light], chunks + (t * numLights + light) * chunkSize,
+				       count * sizeof(INDEXTYPE));
+				indexCounts[light] += count;
 			}
 		}
-
-		// Zero for next render
-		m_shadowMesh.edges[i].visibilityFlags = 0;
 	}
 
 #ifdef DEBUG // Sanity checks
-	PVR_ASSERT(volume.indexCount * sizeof(INDEXTYPE) <= getIndexDataSize()); // Have we accessed memory we shouldn't have?
-
-	for (uint32 i = 0; i < volume.indexCount; ++i)
+	for (uint32 light = 0; light < numLights; ++light)
 	{
-		PVR_ASSERT(indices[i] < m_shadowMesh.numVertices * 2);
+		// Have we accessed memory we shouldn't have?
+		PVR_ASSERT(indexCounts[light] * sizeof(INDEXTYPE) <= getIndexDataSize());
+
+		for (uint32 i = 0; i < indexCounts[light]; ++i)
+		{
+			PVR_ASSERT(indices[light * indicesPerLight + i] < m_shadowMesh.numVertices * 2);
+		}
 	}
 #endif
-
-	return Result::Success;
 }
 
 static inline void transformPoint(const glm::mat4x4& projection, float32 bx, float32 by, float32 bz, float lightProjZ,
@@ -911,58 +1149,10 @@ static inline bool isBoundingBoxVisible(const glm::vec4* const boundingHyperCube
 	return true;
 }
 
-uint32 ShadowVolume::isVisible(const glm::mat4x4 projection, const glm::vec3& lightModel, bool isPointLight, float cameraZProj,
-                               float extrudeLength)
+static uint32 classifyVisibility(const glm::vec4(&boundingHyperCubeT)[16], uint32 clipZCount, uint32 clipFlagsA,
+                                 float cameraZProj)
 {
-	glm::vec4 boundingHyperCubeT[16];
-	uint32 result(0), clipZCount(0), clipFlagsA(0);
-
-	// Get the light z coordinate in projection space
-	float lightProjZ = projection[0][2] * lightModel.x + projection[1][2] * lightModel.y + projection[2][2] * lightModel.z +
-	                   projection[3][2];
-
-	// Transform the eight bounding box points into projection space
-	// Transform the 8 points
-	transformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z, lightProjZ,
-	               boundingHyperCubeT[0], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z, lightProjZ,
-	               boundingHyperCubeT[1], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z, lightProjZ,
-	               boundingHyperCubeT[2], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z, lightProjZ,
-	               boundingHyperCubeT[3], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z, lightProjZ,
-	               boundingHyperCubeT[4], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z, lightProjZ,
-	               boundingHyperCubeT[5], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z, lightProjZ,
-	               boundingHyperCubeT[6], clipZCount, clipFlagsA);
-	transformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z, lightProjZ,
-	               boundingHyperCubeT[7], clipZCount, clipFlagsA);
-
-	if (clipZCount == 8 && clipFlagsA == 8)
-	{
-		// We're hidden
-		return 0;
-	}
-
-	// Extrude the bounding box and transform into projection space
-	extrudeAndTransformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[8]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[9]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[10]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[11]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[12]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[13]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[14]);
-	extrudeAndTransformPoint(projection, m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z, lightModel,
-	                         isPointLight, extrudeLength, boundingHyperCubeT[15]);
+	uint32 result(0);
 
 	// Check whether any part of the hyper bounding box is visible
 	if (!isBoundingHyperCubeVisible(boundingHyperCubeT, cameraZProj))
@@ -972,17 +1162,17 @@ uint32 ShadowVolume::isVisible(const glm::mat4x4 projection, const glm::vec3& li
 	}
 
 	// It's visible, so return the appropriate visibility flags
-	result = Visible;
+	result = ShadowVolume::Visible;
 
 	if (clipZCount == 8)
 	{
 		if (isFrontClipInVolume(boundingHyperCubeT))
 		{
-			result |= Zfail;
+			result |= ShadowVolume::Zfail;
 
 			if (isBoundingBoxVisible(&boundingHyperCubeT[0], cameraZProj))
 			{
-				result |= Cap_back;
+				result |= ShadowVolume::Cap_back;
 			}
 		}
 	}
@@ -997,21 +1187,88 @@ uint32 ShadowVolume::isVisible(const glm::mat4x4 projection, const glm::vec3& li
 		else if (isFrontClipInVolume(boundingHyperCubeT))
 		{
 			// 5
-			result |= Zfail;
+			result |= ShadowVolume::Zfail;
 
 			if (isBoundingBoxVisible(&boundingHyperCubeT[0], cameraZProj))
 			{
-				result |= Cap_front;
+				result |= ShadowVolume::Cap_front;
 			}
 
 			if (isBoundingBoxVisible(&boundingHyperCubeT[8], cameraZProj))
 			{
-				result |= Cap_back;
+				result |= ShadowVolume::Cap_back;
 			}
 		}
 	}
 
 	return result;
 }
+
+uint32 ShadowVolume::isVisible(const glm::mat4x4 projection, const glm::vec3& lightModel, bool isPointLight, float cameraZProj,
+                               float extrudeLength)
+{
+	Light light;
+	light.lightModel = lightModel;
+	light.isPointLight = isPointLight;
+	uint32 result(0);
+	isVisible(projection, &light, 1, cameraZProj, extrudeLength, &result);
+	return result;
+}
+
+void ShadowVolume::isVisible(const glm::mat4x4& projection, const Light* lights, uint32 numLights, float cameraZProj,
+                             float extrudeLength, uint32* outFlags)
+{
+	glm::vec4 boundingHyperCubeT[16];
+	uint32 clipZCount(0), unused(0);
+	const glm::vec3 corners[8] =
+	{
+		glm::vec3(m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z),
+		glm::vec3(m_shadowMesh.minimum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z),
+		glm::vec3(m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z),
+		glm::vec3(m_shadowMesh.minimum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z),
+		glm::vec3(m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.minimum.z),
+		glm::vec3(m_shadowMesh.maximum.x, m_shadowMesh.minimum.y, m_shadowMesh.maximum.z),
+		glm::vec3(m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.minimum.z),
+		glm::vec3(m_shadowMesh.maximum.x, m_shadowMesh.maximum.y, m_shadowMesh.maximum.z),
+	};
+
+	// Transform the eight bounding box points into projection space. These do not depend on the light.
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		transformPoint(projection, corners[i].x, corners[i].y, corners[i].z, 0.f, boundingHyperCubeT[i], clipZCount, unused);
+	}
+
+	for (uint32 light = 0; light < numLights; ++light)
+	{
+		const glm::vec3& lightModel = lights[light].lightModel;
+
+		// Get the light z coordinate in projection space
+		float lightProjZ = projection[0][2] * lightModel.x + projection[1][2] * lightModel.y + projection[2][2] * lightModel.z +
+		                   projection[3][2];
+
+		uint32 clipFlagsA(0);
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			if (boundingHyperCubeT[i].z <= lightProjZ)
+			{ ++clipFlagsA; }
+		}
+
+		if (clipZCount == 8 && clipFlagsA == 8)
+		{
+			// We're hidden
+			outFlags[light] = 0;
+			continue;
+		}
+
+		// Extrude the bounding box and transform into projection space
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			extrudeAndTransformPoint(projection, corners[i].x, corners[i].y, corners[i].z, lightModel, lights[light].isPointLight,
+			                         extrudeLength, boundingHyperCubeT[8 + i]);
+		}
+
+		outFlags[light] = classifyVisibility(boundingHyperCubeT, clipZCount, clipFlagsA, cameraZProj);
+	}
+}
 }
 //!\endcond
\ No newline at end of file
@@ -28,6 +28,15 @@ public:
 		Zfail     = 0x08
 	};
 
+	/*!**************************************************************************************************************
+	\brief    A light to project a shadow volume against, in the model space of the mesh.
+	****************************************************************************************************************/
+	struct Light
+	{
+		glm::vec3 lightModel; //!< The model-space light position (point/spot lights) or direction (directional lights)
+		bool isPointLight;    //!< True for point (or spot) lights, false for directional lights
+	};
+
 public:
 	/*!**************************************************************************************************************
 	\brief    dtor, releases all resources held by the shadow volume.
@@ -141,6 +150,19 @@ public:
 	uint32 isVisible(const glm::mat4x4 projection, const glm::vec3& lightModel, bool isPointLight, float cameraZProj,
 	                 float extrudeLength);
 
+	/*!**************************************************************************************************************
+	\brief    Query if this shadow volume is visible, for several lights at once.
+	\param   projection The model-view-projection matrix
+	\param   lights The lights to test
+	\param   numLights Number of elements in (lights)
+	\param   cameraZProj The camera z coordinate in projection space
+	\param   extrudeLength The length the volume is extruded by
+	\param[out] outFlags Receives the Flags of each light, as isVisible would return them. Must hold numLights elements.
+	\description The bounding box of the mesh is transformed once and shared between all lights.
+	****************************************************************************************************************/
+	void isVisible(const glm::mat4x4& projection, const Light* lights, uint32 numLights, float cameraZProj,
+	               float extrudeLength, uint32* outFlags);
+
 	/*!**************************************************************************************************************
 	\brief Find the silhouette of the shadow volume for the specified light and prepare it for projection.
 	\param volumeID The Shadow Volume to prepare. Must have had alllocateShadowVolume called on it
@@ -148,9 +170,31 @@ public:
 	\param lightModel The Model-space light. Either point-light(or spot) or directional light supported
 	\param isPointLight Pass true for point (or spot) light, false for directional
 	\param externalIndexBuffer An external buffer that contains custom, user provided index data.
+	\param numThreads The number of tasks to split the silhouette edge pass into, run on TaskScheduler::getDefault().
+	       Each task writes into its own chunk of indices, which are then concatenated after the cap triangles. Only
+	       worth it for meshes with many thousands of edges; meshes too small to benefit are always processed on the
+	       calling thread.
+	\description The light facing test of the triangles is vectorised (SSE/AVX on x86, NEON on ARM) over a
+	             structure-of-arrays copy of the triangle planes that is built once by init().
 	****************************************************************************************************************/
 	Result::Enum projectSilhouette(uint32 volumeID, uint32 flags, const glm::vec3& lightModel, bool isPointLight,
-	                               byte** externalIndexBuffer = NULL);
+	                               byte** externalIndexBuffer = NULL, uint32 numThreads = 1);
+
+	/*!**************************************************************************************************************
+	\brief Find the silhouettes of the shadow volume for several lights in a single pass over the mesh.
+	\param lights The lights to project against
+	\param numLights Number of elements in (lights)
+	\param flags The properties of each light's volume (caps, technique), for example as returned by isVisible. Must
+	       hold numLights elements.
+	\param indexBuffer The output index buffer, with room for numLights * getIndexDataSize() bytes. The indices of
+	       light N start at byte offset N * getIndexDataSize().
+	\param[out] indexCounts Receives the number of indices of each light. Must hold numLights elements.
+	\param numThreads The number of threads to split the silhouette edge pass across (see projectSilhouette)
+	\description The triangle planes and the edge adjacency are read once and tested against all lights together,
+	             rather than once per light as with repeated calls to projectSilhouette.
+	****************************************************************************************************************/
+	Result::Enum projectSilhouettes(const Light* lights, uint32 numLights, const uint32* flags, byte* indexBuffer,
+	                                uint32* indexCounts, uint32 numThreads = 1);
 
 private:
 	void initialiseVertexData(byte** externalBuffer = NULL);
@@ -158,7 +202,14 @@ private:
 	struct ShadowVolumeEdge
 	{
 		uint32 vertexIndices[2];
-		uint32 visibilityFlags;
+	};
+
+	//One entry for each triangle sharing an edge. windingMatches is non-zero if the triangle traverses the edge in the
+	//same direction as its vertexIndices are stored.
+	struct ShadowVolumeEdgeTriangle
+	{
+		uint32 triangle;
+		uint32 windingMatches;
 	};
 
 	struct ShadowVolumeTriangle
@@ -181,6 +232,17 @@ private:
 		uint32 numEdges;
 		uint32 numTriangles;
 
+		//Triangle planes (normal, dot(normal, vertex0)) as structure-of-arrays, padded to a multiple of 8 entries
+		float32* planeNormalX;
+		float32* planeNormalY;
+		float32* planeNormalZ;
+		float32* planeDistance;
+		//Edge to triangle adjacency: the triangles of edge i are edgeTriangles[edgeTriangleStart[i]..edgeTriangleStart[i+1])
+		uint32* edgeTriangleStart;
+		ShadowVolumeEdgeTriangle* edgeTriangles;
+		//Per-triangle result of the last facing test, bit N set if the triangle faces light N
+		uint32* triangleLitMask;
+
 		byte* vertexData;
 		bool needs32BitIndices;
 
@@ -191,6 +253,13 @@ private:
 			numVertices(0),
 			numEdges(0),
 			numTriangles(0),
+			planeNormalX(NULL),
+			planeNormalY(NULL),
+			planeNormalZ(NULL),
+			planeDistance(NULL),
+			edgeTriangleStart(NULL),
+			edgeTriangles(NULL),
+			triangleLitMask(NULL),
 			vertexData(NULL),
 			needs32BitIndices(false)
 		{
@@ -203,27 +272,30 @@ private:
 		byte* indexData;
 		uint32 indexCount; // If the index count is greater than 0 and indexData is NULL then the data is handled externally
 
+		// indexData is owned and released by the ShadowVolume (see releaseVolume), as this struct is copied into the map.
 		ShadowVolumeData() : indexData(NULL), indexCount(0)
 		{
 		}
-		~ShadowVolumeData()
-		{
-			delete indexData;
-		}
 	};
 
 	uint32 findOrCreateVertex(const glm::vec3& vertex, bool& existed);
 	uint32 findOrCreateEdge(const glm::vec3& v0, const glm::vec3& v1, bool& existed);
 	void findOrCreateTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+	void initialiseProjectionData();
+	void releaseProjectionData();
 
-	//Extrude
+	//Extrude. The indices of light N are written at indices + N * indicesPerLight.
+	template<typename INDEXTYPE>
+	void project(const Light* lights, uint32 numLights, const uint32* flags, INDEXTYPE* indices, uint32 indicesPerLight,
+	             uint32* indexCounts, uint32 numThreads);
 	template<typename INDEXTYPE>
-	Result::Enum project(uint32 volumeID, uint32 flags, const glm::vec3& lightModel, bool isPointLight,
-	                     INDEXTYPE** externalIndexBuffer);
+	void projectSilhouetteEdges(uint32 firstEdge, uint32 lastEdge, uint32 numLights, INDEXTYPE* indices,
+	                            uint32 indicesPerLight, uint32* indexCounts) const;
 
 
 	typedef std::map<uint32, ShadowVolumeData> ShadowVolumeMapType;
 	ShadowMesh m_shadowMesh;
 	std::map<uint32, ShadowVolumeData> m_shadowVolumes;
+	std::vector<byte> m_edgeChunks;
 };
 }
@@ -91,12 +91,35 @@ public:
 		return true;
 	}
 
+	/*!***************************************************************************
+	\return			Return number of dependents
+	\brief      	Returns the number of nodes that depend on this node.
+	*****************************************************************************/
+	uint32 getNumDependents() const { return (uint32)m_apDependents.size(); }
+
+	/*!***************************************************************************
+	\param[in]		id dependent id
+	\return			Return a reference to dependent
+	\brief      	Get given dependent.
+	*****************************************************************************/
+	SkipGraphNode& getDependent(uint32 id) const
+	{
+		PVR_ASSERT(id < (uint32)m_apDependents.size());
+		return *m_apDependents[id];
+	}
+
 	/*!***************************************************************************
 	\return			Return a reference to the data
 	\brief      	Get the data associated with this node.
 	*****************************************************************************/
 	T& getData() { return m_pData; }
 
+	/*!***************************************************************************
+	\return			Return a const reference to the data
+	\brief      	Get the data associated with this node.
+	*****************************************************************************/
+	const T& getData() const { return m_pData; }
+
 private:
 	/*!***************************************************************************
 	\param[out]		pDependancyNode dependent to this node
@@ -111,7 +134,7 @@ private:
 		//	Check the dependency doesn't already exist.
 		for (ui = 0; ui < (uint32)m_apDependents.size(); ++ui)
 		{
-			if (m_apDependencies[ui] == pDependencyNode) {	return true;	}
+			if (m_apDependents[ui] == pDependencyNode) {	return true;	}
 		}
 
 		//	Add the dependancy
@@ -251,6 +274,61 @@ public:
 		recursiveSortedListAdd(aOutputArray, m_aHashTable[nodeID].getNode());
 	}
 
+	/*!***************************************************************************
+	 \brief Sorts the whole graph into levels of mutually independent nodes.
+			Level 0 contains the nodes without dependencies, and every other node is
+			placed one level after the deepest of its dependencies, so that all nodes
+			of a level can be processed in any order (or concurrently) once the
+			previous levels are complete.
+	 \param[out] outLevels	The IDs of the nodes of each level
+	 \param[out] outNodeLevels	The level of each node, indexed by node ID
+	 \return	Return false if the graph contains a cycle, else true
+	*****************************************************************************/
+	bool retrieveDependencyLevels(std::vector<std::vector<uint32> >& outLevels, std::vector<uint32>& outNodeLevels) const
+	{
+		const uint32 numNodes = getNumNodes();
+		std::map<const SkipGraphNode<T>*, uint32> nodeIds;
+		std::vector<uint32> remainingDependencies(numNodes);
+		std::vector<uint32> ready;
+		outLevels.clear();
+		outNodeLevels.assign(numNodes, 0);
+
+		for (uint32 i = 0; i < numNodes; ++i)
+		{
+			nodeIds[&m_aHashTable[i].getNode()] = i;
+			remainingDependencies[i] = m_aHashTable[i].getNode().getNumDependencies();
+			if (remainingDependencies[i] == 0) { ready.push_back(i); }
+		}
+
+		// Kahn's algorithm: a node is ready once all of its dependencies have been placed
+		for (uint32 processed = 0; processed < (uint32)ready.size(); ++processed)
+		{
+			const uint32 id = ready[processed];
+			const SkipGraphNode<T>& node = m_aHashTable[id].getNode();
+			if (outLevels.size() <= outNodeLevels[id]) { outLevels.resize(outNodeLevels[id] + 1); }
+			outLevels[outNodeLevels[id]].push_back(id);
+
+			for (uint32 i = 0; i < node.getNumDependents(); ++i)
+			{
+				const uint32 dependent = nodeIds[&node.getDependent(i)];
+				outNodeLevels[dependent] = std::max(outNodeLevels[dependent], outNodeLevels[id] + 1);
+				if (--remainingDependencies[dependent] == 0) { ready.push_back(dependent); }
+			}
+		}
+		return ready.size() == numNodes;
+	}
+
+	/*!***************************************************************************
+	 \brief Get the node with the specified ID.
+	 \param[in] nodeID The node's ID
+	 \return Return the node
+	*****************************************************************************/
+	const SkipGraphNode<T>& getNode(uint32 nodeID) const
+	{
+		PVR_ASSERT(nodeID < (uint32)m_aHashTable.size());
+		return m_aHashTable[nodeID].getNode();
+	}
+
 	/*!***************************************************************************
 	 \brief Overloads operator[] to returns a handle to the node data for the specified ID.
 	 \return Return handle to the node data
@@ -261,7 +339,7 @@ public:
 	 \brief Overloads operator[] to returns a const handle to the node data for the specified ID.
 	 \return Return handle to the node data
 	*****************************************************************************/
-	const T& operator[](const uint32 ui32NodeID) const {	return *(getNodeData(ui32NodeID));  	}
+	const T& operator[](const uint32 ui32NodeID) const {	return getNode(ui32NodeID).getData();  	}
 
 //-------------------------------------------------------------------------//
 private:
@@ -322,7 +400,7 @@ private:
 		//	force for loop to search through).
 		for (i = 0; i < i32HashTableSize; ++i)
 		{
-			if (m_aHashTable[i].getHash()) {	return &m_aHashTable[i].getNode();	}
+			if (m_aHashTable[i].getHash() == hash) {	return &m_aHashTable[i].getNode();	}
 		}
 
 		//	The element wasn't found, so return null.
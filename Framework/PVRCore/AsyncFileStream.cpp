@@ -0,0 +1,268 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AsyncFileStream.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the AsyncFileStream class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include <cstring>
+#include <algorithm>
+
+#include "PVRCore/AsyncFileStream.h"
+#include "PVRCore/Log.h"
+using std::string;
+namespace pvr {
+namespace {
+const size_t c_noChunk = ~size_t(0);
+const size_t c_chunkAlignment = 4096;
+}
+
+AsyncFileStream::AsyncFileStream(const string& filePath, size_t chunkSize)
+	: Stream(filePath), m_chunkSize(std::max<size_t>((chunkSize + c_chunkAlignment - 1) / c_chunkAlignment, 1) * c_chunkAlignment),
+	  m_file(NULL), m_size(0), m_position(0), m_currentChunk(0), m_currentOffset(c_noChunk), m_quit(false)
+{
+	m_isReadable = true;
+	for (uint32 i = 0; i < 2; ++i)
+	{
+		m_chunks[i].offset = c_noChunk;
+		m_chunks[i].size = 0;
+		m_chunks[i].ready = false;
+	}
+}
+
+bool AsyncFileStream::open() const
+{
+	if (m_file) { return seek(0, SeekOriginFromStart); }
+	if (m_fileName.length() == 0) { return false; }
+#ifdef _WIN32
+#ifdef _UNICODE
+	errno_t error = _wfopen_s(&m_file, m_fileName.c_str(), "rb");
+#else
+	errno_t error = fopen_s(&m_file, m_fileName.c_str(), "rb");
+#endif
+	if (error != 0) { m_file = NULL; return false; }
+#else
+	m_file = fopen(m_fileName.c_str(), "rb");
+#endif
+	if (!m_file) { return false; }
+
+	// The background thread does its own buffering: the stdio one would only add a copy.
+	setvbuf(m_file, NULL, _IONBF, 0);
+	fseek(m_file, 0, SEEK_END);
+	const long fileSize = ftell(m_file);
+	if (fileSize < 0)
+	{
+		Log(Log.Error, "[AsyncFileStream::open] Could not get the size of %s.", m_fileName.c_str());
+		fclose(m_file);
+		m_file = NULL;
+		return false;
+	}
+	m_size = static_cast<size_t>(fileSize);
+	m_position = 0;
+	m_currentChunk = 1;
+	m_currentOffset = c_noChunk;
+	for (uint32 i = 0; i < 2; ++i)
+	{
+		m_chunks[i].data.resize(m_chunkSize);
+		m_chunks[i].offset = c_noChunk;
+		m_chunks[i].ready = false;
+	}
+	m_quit = false;
+	m_reader = std::thread(&AsyncFileStream::readerMain, const_cast<AsyncFileStream*>(this));
+	if (m_size) { request(0, m_currentChunk); }
+	return true;
+}
+
+void AsyncFileStream::close()
+{
+	if (m_reader.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_requested.notify_one();
+		m_reader.join();
+	}
+	if (m_file && fclose(m_file) == EOF)
+	{
+		Log(Log.Warning, "[AsyncFileStream::close] Failure closing file.");
+	}
+	m_file = NULL;
+	m_currentOffset = c_noChunk;
+	for (uint32 i = 0; i < 2; ++i)
+	{
+		std::vector<char8>().swap(m_chunks[i].data);
+		m_chunks[i].offset = c_noChunk;
+		m_chunks[i].ready = false;
+	}
+}
+
+bool AsyncFileStream::read(size_t elementSize, size_t elementCount, void* const outBuffer, size_t& outDataRead) const
+{
+	outDataRead = 0;
+	if (!m_file)
+	{
+		Log("[AsyncFileStream::read] Attempted to read empty stream.");
+		PVR_ASSERT(0 && "[AsyncFileStream::read] Attempted to read empty stream.");
+		return false;
+	}
+	if (elementSize == 0) { return true; }
+
+	const size_t available = (m_position < m_size ? m_size - m_position : 0) / elementSize;
+	if (available < elementCount)
+	{
+		Log(Log.Debug, "[AsyncFileStream::read] Was attempting to read past the end of stream ");
+		elementCount = available;
+	}
+	char8* destination = static_cast<char8*>(outBuffer);
+	size_t remaining = elementCount * elementSize;
+	while (remaining)
+	{
+		const Chunk& chunk = *getChunk(m_position);
+		const size_t offsetInChunk = m_position - chunk.offset;
+		if (offsetInChunk >= chunk.size)
+		{
+			Log(Log.Error, "[AsyncFileStream::read] Failure reading %s at offset %u.", m_fileName.c_str(),
+			    static_cast<uint32>(m_position));
+			outDataRead = (elementCount * elementSize - remaining) / elementSize;
+			return false;
+		}
+		const size_t copied = std::min(remaining, chunk.size - offsetInChunk);
+		memcpy(destination, chunk.data.data() + offsetInChunk, copied);
+		destination += copied;
+		m_position += copied;
+		remaining -= copied;
+	}
+	outDataRead = elementCount;
+	return true;
+}
+
+bool AsyncFileStream::write(size_t, size_t, const void*, size_t& dataWritten)
+{
+	dataWritten = 0;
+	Log("[AsyncFileStream::write] Attempted to write a read only stream.");
+	PVR_ASSERT(0 && "[AsyncFileStream::write] Attempted to write a read only stream.");
+	return false;
+}
+
+bool AsyncFileStream::seek(long offset, SeekOrigin origin) const
+{
+	if (!m_file)
+	{
+		if (offset)
+		{
+			Log(Log.Error, "[AsyncFileStream::seek] Attempt to seek from empty stream");
+			return false;
+		}
+		return true;
+	}
+	const size_t base = (origin == SeekOriginFromStart ? 0 : origin == SeekOriginFromCurrent ? m_position : m_size);
+	if ((offset < 0 && static_cast<size_t>(-offset) > base) || (offset > 0 && static_cast<size_t>(offset) > m_size - base))
+	{
+		Log(Log.Debug, "[AsyncFileStream::seek] Was attempting to seek outside the stream ");
+		return false;
+	}
+	m_position = base + offset;
+	return true;
+}
+
+bool AsyncFileStream::isopen() const
+{
+	return m_file != NULL;
+}
+
+size_t AsyncFileStream::getPosition() const
+{
+	return m_position;
+}
+
+size_t AsyncFileStream::getSize() const
+{
+	return m_size;
+}
+
+void AsyncFileStream::prefetch(size_t offset, size_t) const
+{
+	if (!m_file || offset >= m_size) { return; }
+	const size_t chunkOffset = offset - offset % m_chunkSize;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_chunks[0].offset != chunkOffset && m_chunks[1].offset != chunkOffset)
+	{
+		Chunk& chunk = m_chunks[1 - m_currentChunk];
+		chunk.offset = chunkOffset;
+		chunk.ready = false;
+		m_requested.notify_one();
+	}
+}
+
+void AsyncFileStream::request(size_t chunkOffset, uint32 preservedChunk) const
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Chunk& chunk = m_chunks[1 - preservedChunk];
+		chunk.offset = chunkOffset;
+		chunk.ready = false;
+	}
+	m_requested.notify_one();
+}
+
+const AsyncFileStream::Chunk* AsyncFileStream::getChunk(size_t offset) const
+{
+	const size_t chunkOffset = offset - offset % m_chunkSize;
+	// Only this thread changes the offsets of the chunks, so once the current chunk is ready it stays so.
+	if (chunkOffset == m_currentOffset) { return &m_chunks[m_currentChunk]; }
+
+	uint32 chunk = (m_chunks[0].offset == chunkOffset ? 0 : m_chunks[1].offset == chunkOffset ? 1 : 2);
+	if (chunk == 2)
+	{
+		request(chunkOffset, m_currentChunk);
+		chunk = 1 - m_currentChunk;
+	}
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (!m_chunks[chunk].ready) { m_ready.wait(lock); }
+	}
+	m_currentChunk = chunk;
+	m_currentOffset = chunkOffset;
+
+	// Read ahead into the other chunk, unless it already holds the next one.
+	const size_t nextOffset = chunkOffset + m_chunkSize;
+	if (nextOffset < m_size && m_chunks[1 - chunk].offset != nextOffset) { request(nextOffset, chunk); }
+	return &m_chunks[chunk];
+}
+
+void AsyncFileStream::readerMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		Chunk* chunk = NULL;
+		while (!m_quit)
+		{
+			if (m_chunks[0].offset != c_noChunk && !m_chunks[0].ready) { chunk = &m_chunks[0]; break; }
+			if (m_chunks[1].offset != c_noChunk && !m_chunks[1].ready) { chunk = &m_chunks[1]; break; }
+			m_requested.wait(lock);
+		}
+		if (!chunk) { return; }
+
+		// The data of a chunk that is not ready is only accessed by this thread, so it can be read without the lock. If the
+		// chunk is requested again meanwhile, it stays not ready and is read again.
+		const size_t offset = chunk->offset;
+		lock.unlock();
+		size_t size = 0;
+		if (fseek(m_file, static_cast<long>(offset), SEEK_SET) == 0)
+		{
+			size = fread(chunk->data.data(), 1, std::min(m_chunkSize, m_size - offset), m_file);
+		}
+		lock.lock();
+		if (chunk->offset == offset)
+		{
+			chunk->size = size;
+			chunk->ready = true;
+			m_ready.notify_one();
+		}
+	}
+}
+}
+//!\endcond
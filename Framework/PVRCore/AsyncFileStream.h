@@ -0,0 +1,133 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AsyncFileStream.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A read only file Stream that reads ahead on a background thread.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/Stream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief     A read only Stream over a file, that reads the file in large chunks on a background thread, so that the file
+           is read while the data already read is parsed.
+\description The file is read in chunks aligned to the chunk size, into two buffers: while the caller reads from one,
+           the next chunk is read into the other. Each read call then only copies memory, unless it reaches a chunk that
+           has not been read yet. This suits the file readers (PODReader, TextureReaderKTX, TextureReaderDDS...), that
+           make many small sequential reads, and hides the latency of slow storage behind the parsing.
+           Seeking is supported, but a seek outside the two buffered chunks waits for a whole chunk to be read. Use
+           prefetch() before seeking somewhere known in advance.
+           The stream itself is not thread safe: read it from one thread at a time, as any other Stream.
+***********************************************************************************************************************/
+class AsyncFileStream : public Stream
+{
+public:
+	typedef std::auto_ptr<AsyncFileStream> ptr_type;
+	enum { DefaultChunkSize = 256 * 1024 }; //!< The default size of the chunks read by the background thread
+
+	/*!*********************************************************************************************************************
+	\brief  Create a new stream for a file. The file is opened by open().
+	\param  filePath The path of the file. Can be in any format the operating system understands (absolute, relative etc.)
+	\param  chunkSize The size of the reads of the background thread. Rounded up to a multiple of 4096 bytes. Two chunks
+	        of memory are used.
+	***********************************************************************************************************************/
+	AsyncFileStream(const std::basic_string<char8>& filePath, size_t chunkSize = DefaultChunkSize);
+	~AsyncFileStream() { close(); }
+
+	/*!********************************************************************************************************
+	\brief    Main read function. Read up to a specified amount of items into the provided buffer.
+	\param[in]  elementSize  The size of each element that will be read.
+	\param[in]  elementCount  The maximum number of elements to read.
+	\param[in]  buffer  The buffer into which to write the data.
+	\param[out]  dataRead  After returning, will contain the number of items that were actually read.
+	\return   Success if successful, error code otherwise.
+	**********************************************************************************************************/
+	virtual bool read(size_t elementSize, size_t elementCount, void* buffer, size_t& dataRead) const;
+
+	/*!********************************************************************************************************
+	\brief    Not supported: the stream is read only.
+	\return   False.
+	**********************************************************************************************************/
+	virtual bool write(size_t elementSize, size_t elementCount, const void* buffer, size_t& dataWritten);
+
+	/*!********************************************************************************************************
+	\brief    Seek a specific point in the file. Does not wait for the data to be read.
+	\param[in]  offset  The offset to seek from "origin".
+	\param[in]  origin  Beginning of stream, End of stream or Current position.
+	\return   True if successful, false if the new position would be outside the file.
+	**********************************************************************************************************/
+	virtual bool seek(long offset, SeekOrigin origin) const;
+
+	/*!********************************************************************************************************
+	\brief    Open the file and start reading its first chunk. If already open, seeks to the start.
+	\return   True if successful, false if the file could not be opened.
+	**********************************************************************************************************/
+	virtual bool open() const;
+
+	/*!********************************************************************************************************
+	\brief    Stop the background thread and close the file.
+	**********************************************************************************************************/
+	virtual void close();
+
+	/*!********************************************************************************************************
+	\brief		Query if the stream is open
+	\return   True if the stream is open and ready for other operations.
+	**********************************************************************************************************/
+	virtual bool isopen() const;
+
+	/*!********************************************************************************************************
+	\brief		Query the current position in the stream
+	\return   The current position in the stream.
+	**********************************************************************************************************/
+	virtual size_t getPosition() const;
+
+	/*!********************************************************************************************************
+	\brief		Query the total amount of data in the stream.
+	\return   The total amount of data in the stream.
+	**********************************************************************************************************/
+	virtual size_t getSize() const;
+
+	/*!********************************************************************************************************
+	\brief    Hint that a range of the file will be read soon, typically before seeking to it. The chunk
+	          containing the start of the range is read next, instead of the one after the current position.
+	\param    offset  The offset of the range from the start of the file
+	\param    size  The size of the range. Only the first chunk is read ahead: larger ranges are read ahead
+	          sequentially, as the caller reads them.
+	**********************************************************************************************************/
+	void prefetch(size_t offset, size_t size) const;
+
+	/*!********************************************************************************************************
+	\return   The size of the chunks read by the background thread.
+	**********************************************************************************************************/
+	size_t getChunkSize() const { return m_chunkSize; }
+
+private:
+	struct Chunk
+	{
+		std::vector<char8> data;
+		size_t offset; // Offset in the file that the background thread must read into this chunk, or none
+		size_t size; // Bytes of data read, valid once ready
+		bool ready; // The data of offset has been read. Cleared whenever offset changes.
+	};
+
+	const Chunk* getChunk(size_t offset) const;
+	void request(size_t chunkOffset, uint32 preservedChunk) const;
+	void readerMain();
+
+	size_t m_chunkSize;
+	mutable FILE* m_file;
+	mutable size_t m_size;
+	mutable size_t m_position;
+	mutable uint32 m_currentChunk; // The chunk that the last read copied from, kept while the other one is read ahead
+	mutable size_t m_currentOffset; // Offset of the current chunk once ready, so that reads within it need no lock
+	mutable Chunk m_chunks[2];
+	mutable bool m_quit;
+	mutable std::mutex m_mutex;
+	mutable std::condition_variable m_requested;
+	mutable std::condition_variable m_ready;
+	mutable std::thread m_reader;
+};
+}
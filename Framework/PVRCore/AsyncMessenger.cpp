@@ -0,0 +1,407 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AsyncMessenger.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementations of methods of the AsyncMessenger class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include "PVRCore/AsyncMessenger.h"
+
+#if defined(_WIN32)
+#define snprintf _snprintf
+#endif
+
+namespace pvr {
+namespace system {
+namespace {
+// Longest conversion specification kept, e.g. "%-+08.3lld". Longer ones are output synchronously.
+const size_t c_maxSpecifierLength = 32;
+// Size of the buffer a message is formatted into, as in ConsoleMessenger.
+const size_t c_maxMessageLength = 4096;
+
+enum ArgumentType
+{
+	ArgInt, ArgLong, ArgLongLong, ArgIntMax, ArgSize, ArgPtrDiff, ArgDouble, ArgLongDouble, ArgString, ArgWideString,
+	ArgPointer
+};
+
+// A printf conversion specification, and the arguments it consumes.
+struct Specifier
+{
+	int numStars; // Width and precision given as int arguments, read before the value
+	bool starPrecision; // The last star is the precision
+	int precision; // -1 if none or given by a star
+	ArgumentType type;
+};
+
+// Parse the conversion specification starting at the '%' (which is not followed by another '%').
+// Returns the character after it, or NULL if it is not supported.
+const char* parseSpecifier(const char* percent, Specifier& spec)
+{
+	const char* cursor = percent + 1;
+	spec.numStars = 0;
+	spec.starPrecision = false;
+	spec.precision = -1;
+	while (*cursor && strchr("-+ #0'", *cursor)) { ++cursor; }
+	if (*cursor == '*') { ++spec.numStars; ++cursor; }
+	while (*cursor >= '0' && *cursor <= '9') { ++cursor; }
+	if (*cursor == '.')
+	{
+		++cursor;
+		if (*cursor == '*') { ++spec.numStars; spec.starPrecision = true; ++cursor; }
+		else
+		{
+			spec.precision = 0;
+			while (*cursor >= '0' && *cursor <= '9') { spec.precision = spec.precision * 10 + (*cursor++ - '0'); }
+		}
+	}
+	enum { None, Char, Short, Long, LongLong, IntMax, Size, PtrDiff, LongDouble } length = None;
+	switch (*cursor)
+	{
+	case 'h': ++cursor; length = Short; if (*cursor == 'h') { ++cursor; length = Char; } break;
+	case 'l': ++cursor; length = Long; if (*cursor == 'l') { ++cursor; length = LongLong; } break;
+	case 'j': ++cursor; length = IntMax; break;
+	case 'z': ++cursor; length = Size; break;
+	case 't': ++cursor; length = PtrDiff; break;
+	case 'L': ++cursor; length = LongDouble; break;
+	}
+	switch (*cursor)
+	{
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+		switch (length)
+		{
+		case Long: spec.type = ArgLong; break;
+		case LongLong: spec.type = ArgLongLong; break;
+		case IntMax: spec.type = ArgIntMax; break;
+		case Size: spec.type = ArgSize; break;
+		case PtrDiff: spec.type = ArgPtrDiff; break;
+		default: spec.type = ArgInt; break; // char and short are promoted to int
+		}
+		break;
+	case 'c': spec.type = ArgInt; if (length == Long) { return NULL; } break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		spec.type = (length == LongDouble ? ArgLongDouble : ArgDouble); break;
+	case 's': spec.type = (length == Long ? ArgWideString : ArgString); break;
+	case 'p': spec.type = ArgPointer; break;
+	default: return NULL; // %n, and anything we do not know the argument of
+	}
+	++cursor;
+	return (size_t)(cursor - percent) < c_maxSpecifierLength ? cursor : NULL;
+}
+
+// Appends to a byte buffer, failing once it is full.
+class Writer
+{
+public:
+	Writer(char* buffer, size_t size) : m_cursor(buffer), m_end(buffer + size) {}
+	bool write(const void* data, size_t size)
+	{
+		if ((size_t)(m_end - m_cursor) < size) { return false; }
+		memcpy(m_cursor, data, size);
+		m_cursor += size;
+		return true;
+	}
+	template<typename Type_> bool write(const Type_& value) { return write(&value, sizeof(value)); }
+	// Write a string, up to maxLength characters, and a terminator.
+	template<typename Char_> bool writeString(const Char_* str, int maxLength)
+	{
+		size_t length = 0;
+		while ((maxLength < 0 || length < (size_t)maxLength) && str[length]) { ++length; }
+		const Char_ terminator = 0;
+		return write(str, length * sizeof(Char_)) && write(terminator);
+	}
+private:
+	char* m_cursor;
+	char* m_end;
+};
+
+// Reads back what a Writer wrote.
+class Reader
+{
+public:
+	explicit Reader(const char* buffer) : m_cursor(buffer) {}
+	template<typename Type_> Type_ read()
+	{
+		Type_ value;
+		memcpy(&value, m_cursor, sizeof(value));
+		m_cursor += sizeof(value);
+		return value;
+	}
+	// Returns a pointer into the buffer, which is only suitably aligned for char.
+	template<typename Char_> const char* readString()
+	{
+		const char* str = m_cursor;
+		Char_ character;
+		do
+		{
+			memcpy(&character, m_cursor, sizeof(character));
+			m_cursor += sizeof(character);
+		}
+		while (character);
+		return str;
+	}
+private:
+	const char* m_cursor;
+};
+
+// Copy the format string and the arguments it consumes. Returns false if they do not fit or are not supported.
+bool capture(char* buffer, size_t bufferSize, const char8* formatString, va_list argumentList)
+{
+	Writer writer(buffer, bufferSize);
+	if (!writer.writeString(formatString, -1)) { return false; }
+	for (const char* cursor = strchr(formatString, '%'); cursor; cursor = strchr(cursor, '%'))
+	{
+		if (cursor[1] == '%') { cursor += 2; continue; }
+		Specifier spec;
+		cursor = parseSpecifier(cursor, spec);
+		if (!cursor) { return false; }
+		int precision = spec.precision;
+		for (int i = 0; i < spec.numStars; ++i)
+		{
+			const int star = va_arg(argumentList, int);
+			if (!writer.write(star)) { return false; }
+			precision = star;
+		}
+		if (!spec.starPrecision) { precision = spec.precision; }
+		bool written = false;
+		switch (spec.type)
+		{
+		case ArgInt: written = writer.write(va_arg(argumentList, int)); break;
+		case ArgLong: written = writer.write(va_arg(argumentList, long)); break;
+		case ArgLongLong: written = writer.write(va_arg(argumentList, long long)); break;
+		case ArgIntMax: written = writer.write(va_arg(argumentList, intmax_t)); break;
+		case ArgSize: written = writer.write(va_arg(argumentList, size_t)); break;
+		case ArgPtrDiff: written = writer.write(va_arg(argumentList, ptrdiff_t)); break;
+		case ArgDouble: written = writer.write(va_arg(argumentList, double)); break;
+		case ArgLongDouble: written = writer.write(va_arg(argumentList, long double)); break;
+		case ArgPointer: written = writer.write(va_arg(argumentList, void*)); break;
+		case ArgString:
+		{
+			// The string may not outlive the call, so copy its characters.
+			const char* str = va_arg(argumentList, const char*);
+			written = writer.writeString(str ? str : "(null)", precision);
+			break;
+		}
+		case ArgWideString:
+		{
+			const wchar_t* str = va_arg(argumentList, const wchar_t*);
+			written = writer.writeString(str ? str : L"(null)", precision);
+			break;
+		}
+		}
+		if (!written) { return false; }
+	}
+	return true;
+}
+
+// Appends formatted text to a buffer, truncating at its end.
+class Formatter
+{
+public:
+	Formatter(char* buffer, size_t size) : m_buffer(buffer), m_length(0), m_size(size) { m_buffer[0] = 0; }
+	void append(const char* str, size_t length)
+	{
+		length = std::min(length, m_size - 1 - m_length);
+		memcpy(m_buffer + m_length, str, length);
+		m_length += length;
+		m_buffer[m_length] = 0;
+	}
+	template<typename Type_> void append(const char* spec, const int* stars, int numStars, Type_ value)
+	{
+		char* out = m_buffer + m_length;
+		const size_t space = m_size - m_length;
+		int result;
+		switch (numStars)
+		{
+		case 0: result = snprintf(out, space, spec, value); break;
+		case 1: result = snprintf(out, space, spec, stars[0], value); break;
+		default: result = snprintf(out, space, spec, stars[0], stars[1], value); break;
+		}
+		// snprintf returns the length it would have written, or a negative value on truncation on some platforms.
+		m_length = (result < 0 || (size_t)result >= space) ? m_size - 1 : m_length + result;
+		m_buffer[m_length] = 0;
+	}
+private:
+	char* m_buffer;
+	size_t m_length;
+	size_t m_size;
+};
+
+// Format the message captured by capture().
+void format(const char* captured, char* buffer, size_t bufferSize)
+{
+	Reader reader(captured);
+	const char* formatString = reader.readString<char>();
+	Formatter formatter(buffer, bufferSize);
+	const char* cursor = formatString;
+	for (const char* percent = strchr(cursor, '%'); percent; percent = strchr(cursor, '%'))
+	{
+		formatter.append(cursor, percent - cursor);
+		if (percent[1] == '%')
+		{
+			formatter.append("%", 1);
+			cursor = percent + 2;
+			continue;
+		}
+		Specifier spec;
+		cursor = parseSpecifier(percent, spec);
+		char specString[c_maxSpecifierLength];
+		memcpy(specString, percent, cursor - percent);
+		specString[cursor - percent] = 0;
+		int stars[2];
+		for (int i = 0; i < spec.numStars; ++i) { stars[i] = reader.read<int>(); }
+		switch (spec.type)
+		{
+		case ArgInt: formatter.append(specString, stars, spec.numStars, reader.read<int>()); break;
+		case ArgLong: formatter.append(specString, stars, spec.numStars, reader.read<long>()); break;
+		case ArgLongLong: formatter.append(specString, stars, spec.numStars, reader.read<long long>()); break;
+		case ArgIntMax: formatter.append(specString, stars, spec.numStars, reader.read<intmax_t>()); break;
+		case ArgSize: formatter.append(specString, stars, spec.numStars, reader.read<size_t>()); break;
+		case ArgPtrDiff: formatter.append(specString, stars, spec.numStars, reader.read<ptrdiff_t>()); break;
+		case ArgDouble: formatter.append(specString, stars, spec.numStars, reader.read<double>()); break;
+		case ArgLongDouble: formatter.append(specString, stars, spec.numStars, reader.read<long double>()); break;
+		case ArgPointer: formatter.append(specString, stars, spec.numStars, reader.read<void*>()); break;
+		case ArgString: formatter.append(specString, stars, spec.numStars, reader.readString<char>()); break;
+		case ArgWideString:
+		{
+			// Copy out, as the characters in the entry are not aligned for wchar_t.
+			const char* str = reader.readString<wchar_t>();
+			wchar_t wideString[AsyncMessenger::c_entrySize / sizeof(wchar_t)];
+			size_t length = 0;
+			do { memcpy(wideString + length, str + length * sizeof(wchar_t), sizeof(wchar_t)); }
+			while (wideString[length++]);
+			formatter.append(specString, stars, spec.numStars, static_cast<const wchar_t*>(wideString));
+			break;
+		}
+		}
+	}
+	formatter.append(cursor, strlen(cursor));
+}
+}
+
+AsyncMessenger::AsyncMessenger(Messenger& target, size_t capacity) : m_target(target), m_queue(capacity),
+	m_queuedEntries(0), m_nextFlushTicket(0), m_numSynchronousMessages(0), m_workerSleeping(false), m_quit(false),
+	m_lastFlushTicket(0)
+{
+	m_verbosityThreshold = target.getVerbosity();
+	m_worker = std::thread(&AsyncMessenger::workerMain, this);
+}
+
+AsyncMessenger::~AsyncMessenger()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_quit.store(true);
+	}
+	m_wakeUp.notify_one();
+	m_worker.join();
+}
+
+void AsyncMessenger::outputMessage(Severity severity, const char8* formatString, va_list argumentList) const
+{
+	Entry entry;
+	entry.severity = severity;
+	entry.flushTicket = 0;
+	va_list tempList;
+#if (defined _MSC_VER) // Pre VS2013
+	tempList = argumentList;
+#else
+	va_copy(tempList, argumentList);
+#endif
+	const bool captured = capture(entry.data, sizeof(entry.data), formatString, tempList);
+	va_end(tempList);
+
+	if (captured)
+	{
+		push(entry);
+		if (severity >= Critical) { flush(); }
+	}
+	else
+	{
+		m_numSynchronousMessages.fetch_add(1, std::memory_order_relaxed);
+		flush();
+		std::lock_guard<std::mutex> lock(m_outputMutex);
+		m_target.output(severity, formatString, argumentList);
+	}
+}
+
+void AsyncMessenger::push(const Entry& entry) const
+{
+	while (!m_queue.push_back(entry))
+	{
+		// Full: the worker is awake, as entries are queued. Let it make room.
+		std::this_thread::yield();
+	}
+	// Paired with the check in workerMain: either the worker sees the entry, or we see the worker asleep.
+	m_queuedEntries.fetch_add(1);
+	if (m_workerSleeping.load())
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeUp.notify_one();
+	}
+}
+
+void AsyncMessenger::flush() const
+{
+	// Tickets are taken in order, and each marker is queued after the messages of its thread, so when the worker reaches
+	// a marker, every message queued before any smaller ticket was taken has been output too.
+	Entry marker;
+	marker.severity = None;
+	marker.flushTicket = ++m_nextFlushTicket;
+	push(marker);
+	std::unique_lock<std::mutex> lock(m_sleepMutex);
+	while (m_lastFlushTicket < marker.flushTicket) { m_flushed.wait(lock); }
+}
+
+void AsyncMessenger::outputSynchronously(Severity severity, const char8* formatString, ...) const
+{
+	va_list argumentList;
+	va_start(argumentList, formatString);
+	m_target.output(severity, formatString, argumentList);
+	va_end(argumentList);
+}
+
+void AsyncMessenger::write(const Entry& entry)
+{
+	if (entry.flushTicket)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_lastFlushTicket = std::max(m_lastFlushTicket, entry.flushTicket);
+		}
+		m_flushed.notify_all();
+		return;
+	}
+	char buffer[c_maxMessageLength];
+	format(entry.data, buffer, sizeof(buffer));
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	outputSynchronously(static_cast<Severity>(entry.severity), "%s", buffer);
+}
+
+void AsyncMessenger::workerMain()
+{
+	Entry entry;
+	for (;;)
+	{
+		if (m_queue.pop_front(entry))
+		{
+			m_queuedEntries.fetch_sub(1, std::memory_order_relaxed);
+			write(entry);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_workerSleeping.store(true);
+		while (m_queuedEntries.load() == 0 && !m_quit.load()) { m_wakeUp.wait(lock); }
+		m_workerSleeping.store(false);
+		if (m_queuedEntries.load() == 0 && m_quit.load()) { return; }
+	}
+}
+}
+}
+//!\endcond
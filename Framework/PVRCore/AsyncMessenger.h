@@ -0,0 +1,87 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AsyncMessenger.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         An implementation of the Messenger interface that formats and outputs messages on a background thread.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/Messenger.h"
+#include "PVRCore/ConcurrentQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace pvr {
+namespace system {
+/*!*********************************************************************************************************************
+\brief       A Messenger that defers formatting and output of messages to a background thread.
+\description The calling thread only copies the format string and the arguments it refers to into a fixed-size entry of a
+             bounded, lock-free queue, and returns. A background thread formats the entries in order and passes the
+             text to a target Messenger, such as a ConsoleMessenger, so slow console or file output does not stall the
+             caller. Memory use is bounded by the capacity: when the queue is full, callers wait for room.
+             Critical messages flush the queue before returning, so they are out before the application goes down.
+             Messages that do not fit an entry (long strings, or unsupported conversions such as %n) are output on the
+             calling thread after flushing the queue, so the order of each thread's messages is always preserved.
+			 Use: Log.setMessageHandler(&asyncMessenger). Destroy the AsyncMessenger only once no Logger uses it.
+***********************************************************************************************************************/
+class AsyncMessenger : public Messenger, public details::CacheLineAlignedNew
+{
+	AsyncMessenger(const AsyncMessenger&);
+	AsyncMessenger& operator=(const AsyncMessenger&);
+public:
+	enum { c_entrySize = 256 }; //!< Size of a queue entry in bytes, including the format string and arguments
+
+	/*!*********************************************************************************************************************
+	\brief       Constructor. Starts the background thread.
+	\param       target The Messenger that outputs the formatted messages. Only used by one thread at a time. Must outlive
+	             this object.
+	\param       capacity The maximum number of messages waiting to be output
+	***********************************************************************************************************************/
+	explicit AsyncMessenger(Messenger& target, size_t capacity = 1024);
+
+	/*!*********************************************************************************************************************
+	\brief       Destructor. Outputs the messages still queued, then stops the background thread.
+	***********************************************************************************************************************/
+	~AsyncMessenger();
+
+	/*!*********************************************************************************************************************
+	\brief       Return once every message queued by the calling thread before this call has been output.
+	***********************************************************************************************************************/
+	void flush() const;
+
+	/*!*********************************************************************************************************************
+	\return      The number of messages that did not fit an entry and were output on the calling thread.
+	***********************************************************************************************************************/
+	uint64 getNumSynchronousMessages() const { return m_numSynchronousMessages.load(std::memory_order_relaxed); }
+
+private:
+	struct Entry
+	{
+		uint32 severity;
+		uint32 flushTicket; // Non-zero for the markers queued by flush(), which carry no message
+		char data[c_entrySize - 2 * sizeof(uint32)]; // The format string, then the arguments
+	};
+
+	void outputMessage(Severity severity, const char8* formatString, va_list argumentList) const;
+	void push(const Entry& entry) const;
+	void outputSynchronously(Severity severity, const char8* formatString, ...) const;
+	void workerMain();
+	void write(const Entry& entry);
+
+	Messenger& m_target;
+	mutable MpmcQueue<Entry> m_queue;
+	mutable std::atomic<int32> m_queuedEntries;
+	mutable std::atomic<uint32> m_nextFlushTicket;
+	mutable std::atomic<uint64> m_numSynchronousMessages;
+	std::atomic<bool> m_workerSleeping;
+	std::atomic<bool> m_quit;
+	uint32 m_lastFlushTicket;
+	mutable std::mutex m_outputMutex; // Held while using the target
+	mutable std::mutex m_sleepMutex;
+	mutable std::condition_variable m_wakeUp;
+	mutable std::condition_variable m_flushed;
+	std::thread m_worker;
+};
+}
+}
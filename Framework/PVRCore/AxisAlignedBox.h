@@ -142,14 +142,14 @@ public:
 			outAABB.m_center[i] = t[i];
 			outAABB.m_halfExtent[i] = 0.0f;
 
-			outAABB.m_center[i] += m[i][0] * m_center[0];
-			outAABB.m_halfExtent[i] += fabs(m[i][0]) * m_halfExtent[0];
+			outAABB.m_center[i] += m[0][i] * m_center[0];
+			outAABB.m_halfExtent[i] += fabs(m[0][i]) * m_halfExtent[0];
 
-			outAABB.m_center[i] += m[i][1] * m_center[1];
-			outAABB.m_halfExtent[i] += fabs(m[i][1]) * m_halfExtent[1];
+			outAABB.m_center[i] += m[1][i] * m_center[1];
+			outAABB.m_halfExtent[i] += fabs(m[1][i]) * m_halfExtent[1];
 
-			outAABB.m_center[i] += m[i][2] * m_center[2];
-			outAABB.m_halfExtent[i] += fabs(m[i][2]) * m_halfExtent[2];
+			outAABB.m_center[i] += m[2][i] * m_center[2];
+			outAABB.m_halfExtent[i] += fabs(m[2][i]) * m_halfExtent[2];
 		}
 	}
 
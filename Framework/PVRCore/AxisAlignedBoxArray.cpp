@@ -0,0 +1,194 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AxisAlignedBoxArray.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the batch axis aligned box kernels, with SSE and NEON versions.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/AxisAlignedBoxArray.h"
+#include "PVRCore/Assert_.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PVR_AABB_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PVR_AABB_NEON
+#include <arm_neon.h>
+#endif
+
+namespace pvr {
+namespace math {
+namespace {
+// Four floats, and the few operations the kernels need, so that the kernels are written once.
+#if defined(PVR_AABB_SSE)
+typedef __m128 Vector4;
+inline Vector4 load4(const float32* source) { return _mm_loadu_ps(source); }
+inline void store4(float32* destination, Vector4 value) { _mm_storeu_ps(destination, value); }
+inline Vector4 splat4(float32 value) { return _mm_set1_ps(value); }
+inline Vector4 add4(Vector4 lhs, Vector4 rhs) { return _mm_add_ps(lhs, rhs); }
+inline Vector4 mul4(Vector4 lhs, Vector4 rhs) { return _mm_mul_ps(lhs, rhs); }
+inline Vector4 abs4(Vector4 value) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+// Bit i set if lane i is greater or equal to zero.
+inline uint32 nonNegativeMask4(Vector4 value) { return (uint32)_mm_movemask_ps(_mm_cmpge_ps(value, _mm_setzero_ps())); }
+inline void transpose4(Vector4& row0, Vector4& row1, Vector4& row2, Vector4& row3) { _MM_TRANSPOSE4_PS(row0, row1, row2, row3); }
+#elif defined(PVR_AABB_NEON)
+typedef float32x4_t Vector4;
+inline Vector4 load4(const float32* source) { return vld1q_f32(source); }
+inline void store4(float32* destination, Vector4 value) { vst1q_f32(destination, value); }
+inline Vector4 splat4(float32 value) { return vdupq_n_f32(value); }
+inline Vector4 add4(Vector4 lhs, Vector4 rhs) { return vaddq_f32(lhs, rhs); }
+inline Vector4 mul4(Vector4 lhs, Vector4 rhs) { return vmulq_f32(lhs, rhs); }
+inline Vector4 abs4(Vector4 value) { return vabsq_f32(value); }
+inline uint32 nonNegativeMask4(Vector4 value)
+{
+	static const uint32 c_laneBits[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bits = vandq_u32(vcgeq_f32(value, vdupq_n_f32(0.0f)), vld1q_u32(c_laneBits));
+	uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+	sum = vpadd_u32(sum, sum);
+	return vget_lane_u32(sum, 0);
+}
+inline void transpose4(Vector4& row0, Vector4& row1, Vector4& row2, Vector4& row3)
+{
+	const float32x4x2_t rows01 = vtrnq_f32(row0, row1); // a0 b0 a2 b2, a1 b1 a3 b3
+	const float32x4x2_t rows23 = vtrnq_f32(row2, row3); // c0 d0 c2 d2, c1 d1 c3 d3
+	row0 = vcombine_f32(vget_low_f32(rows01.val[0]), vget_low_f32(rows23.val[0]));
+	row1 = vcombine_f32(vget_low_f32(rows01.val[1]), vget_low_f32(rows23.val[1]));
+	row2 = vcombine_f32(vget_high_f32(rows01.val[0]), vget_high_f32(rows23.val[0]));
+	row3 = vcombine_f32(vget_high_f32(rows01.val[1]), vget_high_f32(rows23.val[1]));
+}
+#endif
+
+struct ConstComponents
+{
+	const float32* center[3];
+	const float32* halfExtent[3];
+	explicit ConstComponents(const AxisAlignedBoxArray& boxes)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			center[i] = boxes.getComponent(AxisAlignedBoxArray::Component(AxisAlignedBoxArray::CenterX + i));
+			halfExtent[i] = boxes.getComponent(AxisAlignedBoxArray::Component(AxisAlignedBoxArray::HalfExtentX + i));
+		}
+	}
+};
+
+// Same operations in the same order as the vector version, so that both give the same results.
+void transformBox(const ConstComponents& in, const glm::mat4& m, float32* const outCenter[3], float32* const outHalfExtent[3],
+                  uint32 box)
+{
+	const float32 center[3] = { in.center[0][box], in.center[1][box], in.center[2][box] };
+	const float32 halfExtent[3] = { in.halfExtent[0][box], in.halfExtent[1][box], in.halfExtent[2][box] };
+	for (int i = 0; i < 3; ++i)
+	{
+		outCenter[i][box] = m[0][i] * center[0] + m[1][i] * center[1] + m[2][i] * center[2] + m[3][i];
+		outHalfExtent[i][box] = std::fabs(m[0][i]) * halfExtent[0] + std::fabs(m[1][i]) * halfExtent[1] +
+		                        std::fabs(m[2][i]) * halfExtent[2];
+	}
+}
+
+bool isBoxVisible(const ConstComponents& in, const glm::vec4 planes[6], uint32 box)
+{
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		const glm::vec4& p = planes[plane];
+		const float32 distance = p.x * in.center[0][box] + p.y * in.center[1][box] + p.z * in.center[2][box] + p.w;
+		const float32 radius = std::fabs(p.x) * in.halfExtent[0][box] + std::fabs(p.y) * in.halfExtent[1][box] +
+		                       std::fabs(p.z) * in.halfExtent[2][box];
+		if (!(distance + radius >= 0.0f)) { return false; }
+	}
+	return true;
+}
+}
+
+void transformAxisAlignedBoxes(const AxisAlignedBoxArray& boxes, const glm::mat4* matrices, AxisAlignedBoxArray& outBoxes,
+                               uint32 begin, uint32 end)
+{
+	PVR_ASSERT(end <= boxes.size() && end <= outBoxes.size());
+	const ConstComponents in(boxes);
+	float32* const outCenter[3] = { outBoxes.getComponent(AxisAlignedBoxArray::CenterX),
+	                                outBoxes.getComponent(AxisAlignedBoxArray::CenterY),
+	                                outBoxes.getComponent(AxisAlignedBoxArray::CenterZ) };
+	float32* const outHalfExtent[3] = { outBoxes.getComponent(AxisAlignedBoxArray::HalfExtentX),
+	                                    outBoxes.getComponent(AxisAlignedBoxArray::HalfExtentY),
+	                                    outBoxes.getComponent(AxisAlignedBoxArray::HalfExtentZ) };
+	uint32 box = begin;
+#if defined(PVR_AABB_SSE) || defined(PVR_AABB_NEON)
+	// Each box is transformed with the matrix columns as vectors (x, y, z, unused), then the four results are transposed
+	// into one vector per component.
+	for (; box + 4 <= end; box += 4)
+	{
+		Vector4 centers[4], halfExtents[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			const float32* m = &matrices[box + i][0][0];
+			const Vector4 column0 = load4(m), column1 = load4(m + 4), column2 = load4(m + 8), column3 = load4(m + 12);
+			centers[i] = add4(add4(add4(mul4(column0, splat4(in.center[0][box + i])), mul4(column1, splat4(in.center[1][box + i]))),
+			                       mul4(column2, splat4(in.center[2][box + i]))), column3);
+			halfExtents[i] = add4(add4(mul4(abs4(column0), splat4(in.halfExtent[0][box + i])),
+			                           mul4(abs4(column1), splat4(in.halfExtent[1][box + i]))),
+			                      mul4(abs4(column2), splat4(in.halfExtent[2][box + i])));
+		}
+		transpose4(centers[0], centers[1], centers[2], centers[3]);
+		transpose4(halfExtents[0], halfExtents[1], halfExtents[2], halfExtents[3]);
+		for (int i = 0; i < 3; ++i)
+		{
+			store4(outCenter[i] + box, centers[i]);
+			store4(outHalfExtent[i] + box, halfExtents[i]);
+		}
+	}
+#endif
+	for (; box < end; ++box) { transformBox(in, matrices[box], outCenter, outHalfExtent, box); }
+}
+
+void getFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 outPlanes[6])
+{
+	// Gribb and Hartmann: each plane is the last row of the matrix plus or minus one of the others.
+	const glm::mat4 rows = glm::transpose(viewProjection);
+	outPlanes[0] = rows[3] + rows[0];
+	outPlanes[1] = rows[3] - rows[0];
+	outPlanes[2] = rows[3] + rows[1];
+	outPlanes[3] = rows[3] - rows[1];
+	outPlanes[4] = rows[3] + rows[2];
+	outPlanes[5] = rows[3] - rows[2];
+	for (int i = 0; i < 6; ++i) { outPlanes[i] /= glm::length(glm::vec3(outPlanes[i])); }
+}
+
+void cullAxisAlignedBoxes(const AxisAlignedBoxArray& boxes, const glm::vec4 planes[6], uint32* visibility, uint32 begin,
+                          uint32 end)
+{
+	PVR_ASSERT(begin % 32 == 0 && (end % 32 == 0 || end == boxes.size()) && end <= boxes.size());
+	const ConstComponents in(boxes);
+	for (uint32 wordBegin = begin; wordBegin < end; wordBegin += 32)
+	{
+		const uint32 wordEnd = std::min(wordBegin + 32, end);
+		uint32 word = 0;
+		uint32 box = wordBegin;
+#if defined(PVR_AABB_SSE) || defined(PVR_AABB_NEON)
+		for (; box + 4 <= wordEnd; box += 4)
+		{
+			const Vector4 center[3] = { load4(in.center[0] + box), load4(in.center[1] + box), load4(in.center[2] + box) };
+			const Vector4 halfExtent[3] = { load4(in.halfExtent[0] + box), load4(in.halfExtent[1] + box),
+			                                load4(in.halfExtent[2] + box) };
+			uint32 visible = 0xf;
+			for (int plane = 0; plane < 6 && visible; ++plane)
+			{
+				const glm::vec4& p = planes[plane];
+				const Vector4 distance = add4(add4(add4(mul4(splat4(p.x), center[0]), mul4(splat4(p.y), center[1])),
+				                                   mul4(splat4(p.z), center[2])), splat4(p.w));
+				const Vector4 radius = add4(add4(mul4(splat4(std::fabs(p.x)), halfExtent[0]),
+				                                 mul4(splat4(std::fabs(p.y)), halfExtent[1])),
+				                            mul4(splat4(std::fabs(p.z)), halfExtent[2]));
+				visible &= nonNegativeMask4(add4(distance, radius));
+			}
+			word |= visible << (box - wordBegin);
+		}
+#endif
+		for (; box < wordEnd; ++box) { word |= (isBoxVisible(in, planes, box) ? 1u : 0u) << (box - wordBegin); }
+		visibility[wordBegin / 32] = word;
+	}
+}
+}
+}
+//!\endcond
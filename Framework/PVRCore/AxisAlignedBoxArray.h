@@ -0,0 +1,123 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\AxisAlignedBoxArray.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Structure-of-arrays storage of axis aligned boxes, and batch transform and frustum culling kernels.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/AxisAlignedBox.h"
+#include <vector>
+
+namespace pvr {
+namespace math {
+/*!********************************************************************************************************************
+\brief An array of center/half extent axis aligned boxes, stored as one array per component so that the batch kernels
+       process four boxes per SSE or NEON instruction.
+**********************************************************************************************************************/
+class AxisAlignedBoxArray
+{
+public:
+	/*!********************************************************************************************************************
+	\brief The components of a box, each stored in its own array.
+	**********************************************************************************************************************/
+	enum Component { CenterX, CenterY, CenterZ, HalfExtentX, HalfExtentY, HalfExtentZ, NumComponents };
+
+	/*!********************************************************************************************************************
+	\brief Constructor.
+	\param size Number of boxes, all empty boxes at the origin.
+	**********************************************************************************************************************/
+	explicit AxisAlignedBoxArray(uint32 size = 0) { resize(size); }
+
+	/*!********************************************************************************************************************
+	\brief Change the number of boxes. Boxes added are empty boxes at the origin.
+	**********************************************************************************************************************/
+	void resize(uint32 size)
+	{
+		for (uint32 i = 0; i < NumComponents; ++i) { m_components[i].resize(size, 0.0f); }
+	}
+
+	/*!********************************************************************************************************************
+	\return The number of boxes.
+	**********************************************************************************************************************/
+	uint32 size() const { return (uint32)m_components[0].size(); }
+
+	/*!********************************************************************************************************************
+	\brief Set a box.
+	**********************************************************************************************************************/
+	void set(uint32 index, const AxisAlignedBox& box)
+	{
+		const glm::vec3 center = box.center(), halfExtent = box.getHalfExtent();
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			m_components[CenterX + i][index] = center[i];
+			m_components[HalfExtentX + i][index] = halfExtent[i];
+		}
+	}
+
+	/*!********************************************************************************************************************
+	\return A box.
+	**********************************************************************************************************************/
+	AxisAlignedBox get(uint32 index) const
+	{
+		return AxisAlignedBox(glm::vec3(m_components[CenterX][index], m_components[CenterY][index], m_components[CenterZ][index]),
+		                      glm::vec3(m_components[HalfExtentX][index], m_components[HalfExtentY][index],
+		                                m_components[HalfExtentZ][index]));
+	}
+
+	/*!********************************************************************************************************************
+	\return The array of one component of all the boxes.
+	**********************************************************************************************************************/
+	float32* getComponent(Component component) { return m_components[component].data(); }
+
+	/*!********************************************************************************************************************
+	\return The array of one component of all the boxes.
+	**********************************************************************************************************************/
+	const float32* getComponent(Component component) const { return m_components[component].data(); }
+
+private:
+	std::vector<float32> m_components[NumComponents];
+};
+
+/*!********************************************************************************************************************
+\brief Transform boxes [begin, end), each by its own matrix, as AxisAlignedBox::transform does.
+\param boxes The boxes to transform
+\param matrices One affine matrix per box, indexed like the boxes
+\param[out] outBoxes The transformed boxes are written at the same indexes. Must have at least end boxes. May be boxes.
+\param begin The first box
+\param end One past the last box
+\description Ranges of the same arrays may be transformed by several threads at once, for example with
+             TaskScheduler::parallelFor.
+**********************************************************************************************************************/
+void transformAxisAlignedBoxes(const AxisAlignedBoxArray& boxes, const glm::mat4* matrices, AxisAlignedBoxArray& outBoxes,
+                               uint32 begin, uint32 end);
+
+/*!********************************************************************************************************************
+\brief Get the planes of the frustum defined by a view projection matrix with OpenGL clip space (-w <= z <= w).
+\param viewProjection The view projection matrix
+\param[out] outPlanes The left, right, bottom, top, near and far planes, as (normal, distance) with normalised normals
+            pointing inside: a point p is inside a plane if dot(plane.xyz, p) + plane.w >= 0.
+**********************************************************************************************************************/
+void getFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 outPlanes[6]);
+
+/*!********************************************************************************************************************
+\brief Test boxes [begin, end) against the planes of a frustum.
+\param boxes The boxes, in the same space as the planes
+\param planes Six planes as returned by getFrustumPlanes. A box is visible unless it is entirely outside a plane.
+\param[out] visibility Bit (i % 32) of visibility[i / 32] is set if box i is visible, cleared otherwise. Bits for boxes
+            past end in the last word written are cleared.
+\param begin The first box. Must be a multiple of 32.
+\param end One past the last box. Must be a multiple of 32, or the number of boxes.
+\description Each word of visibility is written by a single call, so ranges may be tested by several threads at once.
+             With TaskScheduler::parallelFor, split the words rather than the boxes:
+             \code
+             scheduler.parallelFor(0, (numBoxes + 31) / 32, 16, [&](uint32 first, uint32 last)
+             {
+                 cullAxisAlignedBoxes(boxes, planes, visibility, first * 32, std::min(last * 32, numBoxes));
+             });
+             \endcode
+             The test is conservative: a box outside the frustum but crossing the planes near a corner is visible.
+**********************************************************************************************************************/
+void cullAxisAlignedBoxes(const AxisAlignedBoxArray& boxes, const glm::vec4 planes[6], uint32* visibility, uint32 begin,
+                          uint32 end);
+}
+}
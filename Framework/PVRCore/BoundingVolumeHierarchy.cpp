@@ -0,0 +1,303 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\BoundingVolumeHierarchy.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the BoundingVolumeHierarchy class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/BoundingVolumeHierarchy.h"
+#include "PVRCore/Assert_.h"
+#include <algorithm>
+#include <utility>
+
+namespace pvr {
+namespace math {
+namespace {
+enum { c_numBins = 16, c_maxStackDepth = 64 };
+
+inline void grow(glm::vec3& min, glm::vec3& max, const glm::vec3& otherMin, const glm::vec3& otherMax)
+{
+	min = glm::min(min, otherMin);
+	max = glm::max(max, otherMax);
+}
+
+inline float32 getHalfArea(const glm::vec3& min, const glm::vec3& max)
+{
+	const glm::vec3 size = max - min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// 1 if the box is outside the plane, 2 if inside, 0 if crossing it.
+inline int classify(const glm::vec3& min, const glm::vec3& max, const glm::vec4& plane)
+{
+	const glm::vec3 normal(plane);
+	const float32 distance = glm::dot(normal, (min + max) * .5f) + plane.w;
+	const float32 radius = glm::dot(glm::abs(normal), (max - min) * .5f);
+	if (distance + radius < 0.0f) { return 1; }
+	return distance - radius >= 0.0f ? 2 : 0;
+}
+
+// The distance at which the ray enters the box, or a negative number if it misses it.
+inline float32 intersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                            float32 maxDistance)
+{
+	const glm::vec3 t0 = (min - origin) * inverseDirection, t1 = (max - origin) * inverseDirection;
+	const glm::vec3 entries = glm::min(t0, t1), exits = glm::max(t0, t1);
+	const float32 enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+	const float32 exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+	return enter <= exit ? enter : -1.0f;
+}
+
+struct NearerHit
+{
+	bool operator()(const std::pair<float32, uint32>& lhs, const std::pair<float32, uint32>& rhs) const { return lhs.first < rhs.first; }
+};
+}
+
+void BoundingVolumeHierarchy::build(const AxisAlignedBoxArray& boxes)
+{
+	clear();
+	setItemBounds(boxes);
+	const uint32 numItems = getNumItems();
+	if (!numItems) { return; }
+	m_items.resize(numItems);
+	std::vector<glm::vec3> centroids(numItems);
+	for (uint32 i = 0; i < numItems; ++i)
+	{
+		m_items[i] = i;
+		centroids[i] = (m_itemBounds[i].min + m_itemBounds[i].max) * .5f;
+	}
+	m_nodes.reserve(2 * (numItems / c_maxLeafItems) + 1);
+	buildNode(0, numItems, centroids);
+}
+
+uint32 BoundingVolumeHierarchy::buildNode(uint32 firstItem, uint32 numItems, std::vector<glm::vec3>& centroids)
+{
+	const uint32 nodeIndex = (uint32)m_nodes.size();
+	m_nodes.push_back(Node());
+	Bounds bounds = m_itemBounds[m_items[firstItem]];
+	glm::vec3 centroidMin = centroids[m_items[firstItem]], centroidMax = centroidMin;
+	for (uint32 i = firstItem + 1; i < firstItem + numItems; ++i)
+	{
+		grow(bounds.min, bounds.max, m_itemBounds[m_items[i]].min, m_itemBounds[m_items[i]].max);
+		grow(centroidMin, centroidMax, centroids[m_items[i]], centroids[m_items[i]]);
+	}
+	m_nodes[nodeIndex].bounds = bounds;
+	m_nodes[nodeIndex].firstItem = firstItem;
+	m_nodes[nodeIndex].numItems = numItems;
+	m_nodes[nodeIndex].rightChild = 0;
+	if (numItems <= c_maxLeafItems) { return nodeIndex; }
+
+	// Split along the axis where the centroids spread most, at the bin boundary of lowest surface area cost.
+	const glm::vec3 centroidExtent = centroidMax - centroidMin;
+	const int axis = centroidExtent.x >= centroidExtent.y ? (centroidExtent.x >= centroidExtent.z ? 0 : 2) :
+	                 (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+	uint32* const items = &m_items[firstItem];
+	uint32 numLeftItems = 0;
+	if (centroidExtent[axis] > 0.0f)
+	{
+		const float32 binScale = c_numBins / centroidExtent[axis];
+		uint32 binCounts[c_numBins] = {};
+		Bounds binBounds[c_numBins];
+		for (uint32 i = 0; i < numItems; ++i)
+		{
+			const uint32 bin = std::min<uint32>((uint32)((centroids[items[i]][axis] - centroidMin[axis]) * binScale), c_numBins - 1);
+			const Bounds& itemBounds = m_itemBounds[items[i]];
+			if (binCounts[bin]++) { grow(binBounds[bin].min, binBounds[bin].max, itemBounds.min, itemBounds.max); }
+			else { binBounds[bin] = itemBounds; }
+		}
+		// Cost of splitting after bin i, from the left sweep, then completed by the right sweep.
+		float32 costs[c_numBins - 1];
+		uint32 count = 0;
+		Bounds sweep = {};
+		for (uint32 i = 0; i < c_numBins - 1; ++i)
+		{
+			if (binCounts[i])
+			{
+				if (count) { grow(sweep.min, sweep.max, binBounds[i].min, binBounds[i].max); }
+				else { sweep = binBounds[i]; }
+				count += binCounts[i];
+			}
+			costs[i] = count ? count * getHalfArea(sweep.min, sweep.max) : 0.0f;
+		}
+		count = 0;
+		for (uint32 i = c_numBins - 1; i > 0; --i)
+		{
+			if (binCounts[i])
+			{
+				if (count) { grow(sweep.min, sweep.max, binBounds[i].min, binBounds[i].max); }
+				else { sweep = binBounds[i]; }
+				count += binCounts[i];
+			}
+			costs[i - 1] += count ? count * getHalfArea(sweep.min, sweep.max) : 0.0f;
+		}
+		uint32 bestSplit = 0;
+		for (uint32 i = 1; i < c_numBins - 1; ++i) { if (costs[i] < costs[bestSplit]) { bestSplit = i; } }
+		for (uint32 i = 0; i < numItems; ++i)
+		{
+			const uint32 bin = std::min<uint32>((uint32)((centroids[items[i]][axis] - centroidMin[axis]) * binScale), c_numBins - 1);
+			if (bin <= bestSplit) { std::swap(items[i], items[numLeftItems++]); }
+		}
+	}
+	if (numLeftItems == 0 || numLeftItems == numItems)
+	{
+		// All centroids in the same place: split in the middle.
+		numLeftItems = numItems / 2;
+		struct CentroidLess
+		{
+			const std::vector<glm::vec3>& centroids;
+			int axis;
+			bool operator()(uint32 lhs, uint32 rhs) const { return centroids[lhs][axis] < centroids[rhs][axis]; }
+		} less = { centroids, axis };
+		std::nth_element(items, items + numLeftItems, items + numItems, less);
+	}
+	buildNode(firstItem, numLeftItems, centroids);
+	const uint32 rightChild = buildNode(firstItem + numLeftItems, numItems - numLeftItems, centroids);
+	m_nodes[nodeIndex].rightChild = rightChild;
+	return nodeIndex;
+}
+
+void BoundingVolumeHierarchy::refit(const AxisAlignedBoxArray& boxes)
+{
+	PVR_ASSERT(boxes.size() == getNumItems());
+	setItemBounds(boxes);
+	// Children are stored after their parent.
+	for (size_t i = m_nodes.size(); i-- > 0;)
+	{
+		Node& node = m_nodes[i];
+		if (node.rightChild)
+		{
+			const Bounds& left = m_nodes[i + 1].bounds;
+			const Bounds& right = m_nodes[node.rightChild].bounds;
+			node.bounds = left;
+			grow(node.bounds.min, node.bounds.max, right.min, right.max);
+		}
+		else
+		{
+			node.bounds = m_itemBounds[m_items[node.firstItem]];
+			for (uint32 item = node.firstItem + 1; item < node.firstItem + node.numItems; ++item)
+			{
+				grow(node.bounds.min, node.bounds.max, m_itemBounds[m_items[item]].min, m_itemBounds[m_items[item]].max);
+			}
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	m_nodes.clear();
+	m_items.clear();
+	m_itemBounds.clear();
+}
+
+AxisAlignedBox BoundingVolumeHierarchy::getBoundingBox() const
+{
+	AxisAlignedBox box;
+	if (!m_nodes.empty()) { box.setMinMax(m_nodes[0].bounds.min, m_nodes[0].bounds.max); }
+	return box;
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const glm::vec4 planes[6], std::vector<uint32>& outItems) const
+{
+	if (m_nodes.empty()) { return; }
+	// Each entry is a node and the planes its box may still cross. Planes a node is entirely inside are not tested again
+	// for its children.
+	std::pair<uint32, uint32> stack[c_maxStackDepth];
+	uint32 stackSize = 0;
+	stack[stackSize++] = std::make_pair(0u, 0x3fu);
+	while (stackSize)
+	{
+		const uint32 nodeIndex = stack[--stackSize].first;
+		uint32 planeMask = stack[stackSize].second;
+		const Node& node = m_nodes[nodeIndex];
+		bool outside = false;
+		for (int plane = 0; plane < 6 && !outside; ++plane)
+		{
+			if (!(planeMask & (1u << plane))) { continue; }
+			const int side = classify(node.bounds.min, node.bounds.max, planes[plane]);
+			outside = (side == 1);
+			if (side == 2) { planeMask &= ~(1u << plane); }
+		}
+		if (outside) { continue; }
+		if (!planeMask)
+		{
+			outItems.insert(outItems.end(), m_items.begin() + node.firstItem, m_items.begin() + node.firstItem + node.numItems);
+		}
+		else if (!node.rightChild)
+		{
+			for (uint32 i = node.firstItem; i < node.firstItem + node.numItems; ++i)
+			{
+				const Bounds& itemBounds = m_itemBounds[m_items[i]];
+				bool itemOutside = false;
+				for (int plane = 0; plane < 6 && !itemOutside; ++plane)
+				{
+					itemOutside = (planeMask & (1u << plane)) && classify(itemBounds.min, itemBounds.max, planes[plane]) == 1;
+				}
+				if (!itemOutside) { outItems.push_back(m_items[i]); }
+			}
+		}
+		else if (stackSize + 2 <= c_maxStackDepth)
+		{
+			stack[stackSize++] = std::make_pair(node.rightChild, planeMask);
+			stack[stackSize++] = std::make_pair(nodeIndex + 1, planeMask);
+		}
+		else
+		{
+			// Deeper than any tree built from sensible data: report the whole subtree rather than miss items.
+			outItems.insert(outItems.end(), m_items.begin() + node.firstItem, m_items.begin() + node.firstItem + node.numItems);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::queryRay(const glm::vec3& origin, const glm::vec3& direction, std::vector<uint32>& outItems,
+                                       float32 maxDistance) const
+{
+	if (m_nodes.empty()) { return; }
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	std::vector<std::pair<float32, uint32> > hits;
+	uint32 stack[c_maxStackDepth];
+	uint32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize)
+	{
+		const uint32 nodeIndex = stack[--stackSize];
+		const Node& node = m_nodes[nodeIndex];
+		if (intersectRay(node.bounds.min, node.bounds.max, origin, inverseDirection, maxDistance) < 0.0f) { continue; }
+		if (node.rightChild && stackSize + 2 <= c_maxStackDepth)
+		{
+			stack[stackSize++] = node.rightChild;
+			stack[stackSize++] = nodeIndex + 1;
+			continue;
+		}
+		// A leaf, or a subtree too deep for the stack whose items are then tested one by one.
+		for (uint32 i = node.firstItem; i < node.firstItem + node.numItems; ++i)
+		{
+			const Bounds& itemBounds = m_itemBounds[m_items[i]];
+			const float32 distance = intersectRay(itemBounds.min, itemBounds.max, origin, inverseDirection, maxDistance);
+			if (distance >= 0.0f) { hits.push_back(std::make_pair(distance, m_items[i])); }
+		}
+	}
+	std::sort(hits.begin(), hits.end(), NearerHit());
+	for (size_t i = 0; i < hits.size(); ++i) { outItems.push_back(hits[i].second); }
+}
+
+void BoundingVolumeHierarchy::setItemBounds(const AxisAlignedBoxArray& boxes)
+{
+	m_itemBounds.resize(boxes.size());
+	const float32* center[3] = { boxes.getComponent(AxisAlignedBoxArray::CenterX), boxes.getComponent(AxisAlignedBoxArray::CenterY),
+	                             boxes.getComponent(AxisAlignedBoxArray::CenterZ) };
+	const float32* halfExtent[3] = { boxes.getComponent(AxisAlignedBoxArray::HalfExtentX),
+	                                 boxes.getComponent(AxisAlignedBoxArray::HalfExtentY),
+	                                 boxes.getComponent(AxisAlignedBoxArray::HalfExtentZ) };
+	for (uint32 i = 0; i < boxes.size(); ++i)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			m_itemBounds[i].min[axis] = center[axis][i] - halfExtent[axis][i];
+			m_itemBounds[i].max[axis] = center[axis][i] + halfExtent[axis][i];
+		}
+	}
+}
+}
+}
+//!\endcond
@@ -0,0 +1,104 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\BoundingVolumeHierarchy.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A bounding volume hierarchy of axis aligned boxes, for frustum and ray queries.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/AxisAlignedBoxArray.h"
+#include <cfloat>
+
+namespace pvr {
+namespace math {
+/*!********************************************************************************************************************
+\brief A tree of axis aligned boxes over a set of items (each with its own box), answering frustum and ray queries
+       without testing every item.
+\description Built top-down with the surface area heuristic, so that queries visit few nodes. When the items move, as
+             after an animation step, refit() updates the boxes of the tree in linear time, keeping its structure. Refit
+             trees get slower to query as the items drift from where they were when built, so rebuild with build() when
+             the items have moved a lot, for example every few hundred frames or after a cut.
+**********************************************************************************************************************/
+class BoundingVolumeHierarchy
+{
+public:
+	enum { c_maxLeafItems = 4 }; //!< Leaves hold up to this many items
+
+	/*!********************************************************************************************************************
+	\brief Build the tree.
+	\param boxes The box of each item. The index of a box is the item returned by the queries.
+	**********************************************************************************************************************/
+	void build(const AxisAlignedBoxArray& boxes);
+
+	/*!********************************************************************************************************************
+	\brief Update the boxes of the tree after the boxes of the items changed. The items must be the same as when built.
+	\param boxes The new box of each item
+	**********************************************************************************************************************/
+	void refit(const AxisAlignedBoxArray& boxes);
+
+	/*!********************************************************************************************************************
+	\brief Remove all items.
+	**********************************************************************************************************************/
+	void clear();
+
+	/*!********************************************************************************************************************
+	\return The number of items.
+	**********************************************************************************************************************/
+	uint32 getNumItems() const { return (uint32)m_itemBounds.size(); }
+
+	/*!********************************************************************************************************************
+	\return The number of nodes of the tree.
+	**********************************************************************************************************************/
+	uint32 getNumNodes() const { return (uint32)m_nodes.size(); }
+
+	/*!********************************************************************************************************************
+	\return The box containing all the items.
+	**********************************************************************************************************************/
+	AxisAlignedBox getBoundingBox() const;
+
+	/*!********************************************************************************************************************
+	\brief Find the items whose box is at least partly inside a frustum.
+	\param planes Six planes, as returned by getFrustumPlanes
+	\param[out] outItems The items are appended, in no particular order
+	\description As with cullAxisAlignedBoxes, the test is conservative. Subtrees entirely inside the frustum are added
+	             without testing their items.
+	**********************************************************************************************************************/
+	void queryFrustum(const glm::vec4 planes[6], std::vector<uint32>& outItems) const;
+
+	/*!********************************************************************************************************************
+	\brief Find the items whose box is hit by a ray, nearest first.
+	\param origin The origin of the ray
+	\param direction The direction of the ray. Need not be normalised: distances are in multiples of its length.
+	\param[out] outItems The items are appended, sorted by the distance at which the ray enters their box
+	\param maxDistance Boxes entered further than this are ignored
+	\description To pick the object under a point, test the triangles of the items in order, stopping at the first
+	             item whose nearest hit is closer than the box entry distance of the next item.
+	**********************************************************************************************************************/
+	void queryRay(const glm::vec3& origin, const glm::vec3& direction, std::vector<uint32>& outItems,
+	              float32 maxDistance = FLT_MAX) const;
+
+private:
+	struct Bounds
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	// Nodes are stored in depth first order: the left child of an interior node follows it. The items of any subtree are
+	// contiguous in m_items.
+	struct Node
+	{
+		Bounds bounds;
+		uint32 firstItem;
+		uint32 numItems;
+		uint32 rightChild; // Zero for leaves, as the root is never a right child
+	};
+
+	void setItemBounds(const AxisAlignedBoxArray& boxes);
+	uint32 buildNode(uint32 firstItem, uint32 numItems, std::vector<glm::vec3>& centroids);
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32> m_items;
+	std::vector<Bounds> m_itemBounds;
+};
+}
+}
@@ -0,0 +1,445 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\CompressedStream.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the CompressedStream class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#include "PVRCore/CompressedStream.h"
+#include "PVRCore/TaskScheduler.h"
+#include "PVRCore/Lz4.h"
+#include "PVRCore/Log.h"
+using std::string;
+namespace pvr {
+namespace {
+// LZ4 frame format constants (little endian)
+const uint32 c_frameMagic = 0x184D2204;
+const uint32 c_skippableFrameMagic = 0x184D2A50; // The low four bits are free
+const uint8 c_flagVersion = 0x40;
+const uint8 c_flagIndependentBlocks = 0x20;
+const uint8 c_flagBlockChecksums = 0x10;
+const uint8 c_flagContentSize = 0x08;
+const uint8 c_flagContentChecksum = 0x04;
+const uint8 c_flagDictionaryId = 0x01;
+const uint32 c_blockUncompressedBit = 0x80000000u;
+const size_t c_linkedWindowSize = 64 * 1024; // How far back the blocks of a linked frame can copy from
+const uint32 c_noBlock = 0xFFFFFFFFu;
+const size_t c_maxBatchSize = 8 * 1024 * 1024; // Of the blocks read into the caller's buffer at once
+
+inline uint32 read32(const uint8* source)
+{
+	uint32 value;
+	memcpy(&value, source, sizeof(value));
+	return value;
+}
+
+inline uint32 rotateLeft(uint32 value, uint32 bits) { return (value << bits) | (value >> (32 - bits)); }
+
+// XXH32, the checksum of the LZ4 frame format.
+const uint32 c_xxhPrime1 = 2654435761U;
+const uint32 c_xxhPrime2 = 2246822519U;
+const uint32 c_xxhPrime3 = 3266489917U;
+const uint32 c_xxhPrime4 = 668265263U;
+const uint32 c_xxhPrime5 = 374761393U;
+
+inline uint32 xxhRound(uint32 accumulator, uint32 input)
+{
+	return rotateLeft(accumulator + input * c_xxhPrime2, 13) * c_xxhPrime1;
+}
+
+uint32 xxh32(const void* data, size_t size)
+{
+	const uint8* current = static_cast<const uint8*>(data);
+	const uint8* const end = current + size;
+	uint32 hash;
+	if (size >= 16)
+	{
+		uint32 v1 = c_xxhPrime1 + c_xxhPrime2, v2 = c_xxhPrime2, v3 = 0, v4 = 0 - c_xxhPrime1;
+		const uint8* const limit = end - 16;
+		do
+		{
+			v1 = xxhRound(v1, read32(current));
+			v2 = xxhRound(v2, read32(current + 4));
+			v3 = xxhRound(v3, read32(current + 8));
+			v4 = xxhRound(v4, read32(current + 12));
+			current += 16;
+		}
+		while (current <= limit);
+		hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+	}
+	else { hash = c_xxhPrime5; }
+	hash += static_cast<uint32>(size);
+	for (; current + 4 <= end; current += 4) { hash = rotateLeft(hash + read32(current) * c_xxhPrime3, 17) * c_xxhPrime4; }
+	for (; current < end; ++current) { hash = rotateLeft(hash + *current * c_xxhPrime5, 11) * c_xxhPrime1; }
+	hash ^= hash >> 15;
+	hash *= c_xxhPrime2;
+	hash ^= hash >> 13;
+	hash *= c_xxhPrime3;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+bool writeBytes(Stream& output, const void* data, size_t size)
+{
+	size_t written = 0;
+	return size == 0 || (output.write(1, size, data, written) && written == size);
+}
+
+bool write32(Stream& output, uint32 value) { return writeBytes(output, &value, sizeof(value)); }
+}
+
+CompressedStream::CompressedStream(Stream::ptr_type compressedStream, TaskScheduler* scheduler)
+	: Stream(compressedStream.get() ? compressedStream->getFileName() : string()), m_source(compressedStream),
+	  m_scheduler(scheduler), m_blockSize(0), m_lastBlockSize(0), m_blockChecksums(false), m_linkedBlocks(false), m_size(0),
+	  m_position(0), m_isOpen(false), m_loadedBlock(c_noBlock), m_loadedPrefixSize(0)
+{
+	m_isReadable = true;
+}
+
+bool CompressedStream::readSource(uint64 offset, size_t size, void* buffer) const
+{
+	size_t dataRead = 0;
+	return m_source->seek(static_cast<long>(offset), SeekOriginFromStart) && m_source->read(1, size, buffer, dataRead) &&
+	       dataRead == size;
+}
+
+bool CompressedStream::readFrame() const
+{
+	// Skip the skippable frames (user data) before the frame.
+	uint64 offset = 0;
+	uint8 header[8];
+	for (;;)
+	{
+		if (!readSource(offset, 4, header)) { return false; }
+		const uint32 magic = read32(header);
+		if (magic == c_frameMagic) { break; }
+		if ((magic & 0xFFFFFFF0u) != c_skippableFrameMagic || !readSource(offset + 4, 4, header)) { return false; }
+		offset += 8 + read32(header);
+	}
+	offset += 4;
+
+	// Frame descriptor: flags, block size, optional content size, checksum of the descriptor.
+	uint8 descriptor[11];
+	if (!readSource(offset, 2, descriptor)) { return false; }
+	const uint8 flags = descriptor[0];
+	const uint8 blockSizeId = (descriptor[1] >> 4) & 7;
+	if ((flags & 0xC0) != c_flagVersion || (flags & 0x02) || (descriptor[1] & 0x8F) || blockSizeId < BlockSize64KB)
+	{
+		Log(Log.Error, "[CompressedStream::open] %s has an unsupported LZ4 frame version or invalid flags.", m_fileName.c_str());
+		return false;
+	}
+	if (flags & c_flagDictionaryId)
+	{
+		Log(Log.Error, "[CompressedStream::open] %s requires a dictionary, which is not supported.", m_fileName.c_str());
+		return false;
+	}
+	const size_t descriptorSize = (flags & c_flagContentSize) ? 10 : 2;
+	if (!readSource(offset, descriptorSize + 1, descriptor)) { return false; }
+	if (((xxh32(descriptor, descriptorSize) >> 8) & 0xFF) != descriptor[descriptorSize])
+	{
+		Log(Log.Error, "[CompressedStream::open] The frame descriptor of %s is corrupt.", m_fileName.c_str());
+		return false;
+	}
+	offset += descriptorSize + 1;
+	m_blockSize = size_t(1) << (8 + 2 * blockSizeId);
+	m_linkedBlocks = (flags & c_flagIndependentBlocks) == 0;
+	m_blockChecksums = (flags & c_flagBlockChecksums) != 0;
+
+	// Index the blocks, skipping their data.
+	const uint64 sourceSize = m_source->getSize();
+	for (;;)
+	{
+		if (!readSource(offset, 4, header)) { return false; }
+		const uint32 blockHeader = read32(header);
+		if (blockHeader == 0) { break; } // End mark
+		Block block;
+		block.sourceOffset = offset + 4;
+		block.storedSize = blockHeader & ~c_blockUncompressedBit;
+		block.isCompressed = (blockHeader & c_blockUncompressedBit) == 0;
+		offset = block.sourceOffset + block.storedSize + (m_blockChecksums ? 4 : 0);
+		if (block.storedSize == 0 || block.storedSize > m_blockSize || offset > sourceSize)
+		{
+			Log(Log.Error, "[CompressedStream::open] Block %u of %s is corrupt.", (uint32)m_blocks.size(), m_fileName.c_str());
+			return false;
+		}
+		m_blocks.push_back(block);
+	}
+
+	// All blocks but the last are full. The size of the last is in the content size, if any, else in the block itself.
+	const uint32 numBlocks = (uint32)m_blocks.size();
+	uint64 lastBlockSize = 0;
+	if (flags & c_flagContentSize)
+	{
+		uint64 contentSize;
+		memcpy(&contentSize, descriptor + 2, sizeof(contentSize));
+		const uint64 fullBlocksSize = uint64(numBlocks ? numBlocks - 1 : 0) * m_blockSize;
+		lastBlockSize = contentSize - fullBlocksSize;
+		if (contentSize < fullBlocksSize || lastBlockSize > m_blockSize || (numBlocks != 0) != (lastBlockSize != 0))
+		{
+			Log(Log.Error, "[CompressedStream::open] The content size of %s does not match its blocks.", m_fileName.c_str());
+			return false;
+		}
+	}
+	else if (numBlocks)
+	{
+		const Block& last = m_blocks.back();
+		lastBlockSize = last.storedSize;
+		if (last.isCompressed)
+		{
+			m_storedData.resize(last.storedSize);
+			size_t decompressedSize = 0;
+			if (!readSource(last.sourceOffset, last.storedSize, m_storedData.data()) ||
+			    !lz4::getDecompressedSize(m_storedData.data(), last.storedSize, decompressedSize) ||
+			    decompressedSize > m_blockSize)
+			{
+				Log(Log.Error, "[CompressedStream::open] Block %u of %s is corrupt.", numBlocks - 1, m_fileName.c_str());
+				return false;
+			}
+			lastBlockSize = decompressedSize;
+		}
+	}
+	const uint64 size = uint64(numBlocks ? numBlocks - 1 : 0) * m_blockSize + lastBlockSize;
+	if (size != size_t(size))
+	{
+		Log(Log.Error, "[CompressedStream::open] %s is too large to decompress.", m_fileName.c_str());
+		return false;
+	}
+	m_lastBlockSize = size_t(lastBlockSize);
+	m_size = size_t(size);
+	return true;
+}
+
+bool CompressedStream::open() const
+{
+	if (m_isOpen)
+	{
+		m_position = 0;
+		return true;
+	}
+	if (!m_source.get() || (!m_source->isopen() && !m_source->open())) { return false; }
+	m_blocks.clear();
+	if (!readFrame())
+	{
+		Log(Log.Error, "[CompressedStream::open] Could not read an LZ4 frame from %s.", m_fileName.c_str());
+		m_blocks.clear();
+		return false;
+	}
+	m_loadedBlock = c_noBlock;
+	m_loadedPrefixSize = 0;
+	m_position = 0;
+	m_isOpen = true;
+	return true;
+}
+
+void CompressedStream::close()
+{
+	std::vector<Block>().swap(m_blocks);
+	std::vector<char8>().swap(m_blockData);
+	std::vector<char8>().swap(m_storedData);
+	m_loadedBlock = c_noBlock;
+	m_size = 0;
+	m_position = 0;
+	m_isOpen = false;
+}
+
+const char8* CompressedStream::decompressBlock(const char8* storedData, uint32 block, char8* destination, size_t prefixSize) const
+{
+	const Block& info = m_blocks[block];
+	const size_t dataSize = getBlockDataSize(block);
+	if (m_blockChecksums && xxh32(storedData, info.storedSize) != read32(reinterpret_cast<const uint8*>(storedData) + info.storedSize))
+	{
+		return "its checksum does not match";
+	}
+	size_t decompressedSize = info.storedSize;
+	if (info.isCompressed)
+	{
+		if (!lz4::decompressBlock(storedData, info.storedSize, destination, dataSize, decompressedSize, prefixSize))
+		{
+			return "it is corrupt";
+		}
+	}
+	else if (decompressedSize <= dataSize) { memcpy(destination, storedData, decompressedSize); }
+	if (decompressedSize != dataSize) { return "it is not full, and only the last block of a frame may be smaller than the block size"; }
+	return NULL;
+}
+
+bool CompressedStream::loadBlock(uint32 block) const
+{
+	if (block == m_loadedBlock) { return true; }
+	// The blocks of a linked frame need the data before them: decompress from the loaded block, or from the first.
+	uint32 current = block;
+	if (m_linkedBlocks) { current = (m_loadedBlock != c_noBlock && m_loadedBlock < block ? m_loadedBlock + 1 : 0); }
+	if (current == 0 || !m_linkedBlocks)
+	{
+		m_loadedBlock = c_noBlock;
+		m_loadedPrefixSize = 0;
+	}
+	m_blockData.resize((m_linkedBlocks ? c_linkedWindowSize : 0) + m_blockSize);
+	for (; current <= block; ++current)
+	{
+		size_t prefixSize = 0;
+		if (m_loadedBlock != c_noBlock)
+		{
+			// Keep the end of the data decompressed so far in front of the next block.
+			const size_t decompressedSize = m_loadedPrefixSize + getBlockDataSize(m_loadedBlock);
+			prefixSize = std::min(decompressedSize, c_linkedWindowSize);
+			memmove(m_blockData.data(), m_blockData.data() + decompressedSize - prefixSize, prefixSize);
+		}
+		const Block& info = m_blocks[current];
+		m_storedData.resize(info.storedSize + (m_blockChecksums ? 4 : 0));
+		m_loadedBlock = c_noBlock;
+		if (!readSource(info.sourceOffset, m_storedData.size(), m_storedData.data()))
+		{
+			Log(Log.Error, "[CompressedStream::read] Failure reading %s.", m_fileName.c_str());
+			return false;
+		}
+		const char8* error = decompressBlock(m_storedData.data(), current, m_blockData.data() + prefixSize, prefixSize);
+		if (error)
+		{
+			Log(Log.Error, "[CompressedStream::read] Could not decompress block %u of %s: %s.", current, m_fileName.c_str(), error);
+			return false;
+		}
+		m_loadedBlock = current;
+		m_loadedPrefixSize = prefixSize;
+	}
+	return true;
+}
+
+bool CompressedStream::readBlocks(uint32 firstBlock, uint32 numBlocks, char8* destination) const
+{
+	// The blocks are contiguous in the source, so are read at once, then decompressed in parallel.
+	const Block& first = m_blocks[firstBlock];
+	const Block& last = m_blocks[firstBlock + numBlocks - 1];
+	m_storedData.resize(size_t(last.sourceOffset + last.storedSize + (m_blockChecksums ? 4 : 0) - first.sourceOffset));
+	if (!readSource(first.sourceOffset, m_storedData.size(), m_storedData.data()))
+	{
+		Log(Log.Error, "[CompressedStream::read] Failure reading %s.", m_fileName.c_str());
+		return false;
+	}
+	// Only the first error is kept, to be logged on this thread.
+	std::atomic<uint32> failedBlock(c_noBlock);
+	std::atomic<const char8*> error(NULL);
+	const std::function<void(uint32, uint32)> decompressRange = [&](uint32 begin, uint32 end)
+	{
+		for (uint32 block = begin; block < end && failedBlock.load(std::memory_order_relaxed) == c_noBlock; ++block)
+		{
+			const char8* storedData = m_storedData.data() + size_t(m_blocks[block].sourceOffset - first.sourceOffset);
+			const char8* blockError = decompressBlock(storedData, block, destination + size_t(block - firstBlock) * m_blockSize, 0);
+			uint32 noBlock = c_noBlock;
+			if (blockError && failedBlock.compare_exchange_strong(noBlock, block)) { error = blockError; }
+		}
+	};
+	if (m_scheduler && numBlocks > 1) { m_scheduler->parallelFor(firstBlock, firstBlock + numBlocks, 1, decompressRange); }
+	else { decompressRange(firstBlock, firstBlock + numBlocks); }
+	if (failedBlock != c_noBlock)
+	{
+		Log(Log.Error, "[CompressedStream::read] Could not decompress block %u of %s: %s.", failedBlock.load(), m_fileName.c_str(),
+		    error.load());
+		return false;
+	}
+	return true;
+}
+
+bool CompressedStream::read(size_t elementSize, size_t elementCount, void* buffer, size_t& dataRead) const
+{
+	dataRead = 0;
+	if (!m_isOpen)
+	{
+		Log("[CompressedStream::read] Attempted to read empty stream.");
+		PVR_ASSERT(0 && "[CompressedStream::read] Attempted to read empty stream.");
+		return false;
+	}
+	if (elementSize == 0) { return true; }
+
+	const size_t available = (m_size - m_position) / elementSize;
+	if (available < elementCount)
+	{
+		Log(Log.Debug, "[CompressedStream::read] Was attempting to read past the end of stream ");
+		elementCount = available;
+	}
+	char8* destination = static_cast<char8*>(buffer);
+	size_t remaining = elementCount * elementSize;
+	while (remaining)
+	{
+		const uint32 block = uint32(m_position / m_blockSize);
+		const size_t offsetInBlock = m_position % m_blockSize;
+		size_t size = 0;
+		if (!m_linkedBlocks && offsetInBlock == 0 && block != m_loadedBlock && remaining >= getBlockDataSize(block))
+		{
+			// Whole independent blocks are decompressed straight into the buffer.
+			uint32 numBlocks = 0;
+			while (block + numBlocks < m_blocks.size() && size + getBlockDataSize(block + numBlocks) <= remaining &&
+			       size < c_maxBatchSize)
+			{
+				size += getBlockDataSize(block + numBlocks++);
+			}
+			if (!readBlocks(block, numBlocks, destination)) { return false; }
+		}
+		else
+		{
+			if (!loadBlock(block)) { return false; }
+			size = std::min(remaining, getBlockDataSize(block) - offsetInBlock);
+			memcpy(destination, m_blockData.data() + m_loadedPrefixSize + offsetInBlock, size);
+		}
+		destination += size;
+		remaining -= size;
+		m_position += size;
+	}
+	dataRead = elementCount;
+	return true;
+}
+
+bool CompressedStream::write(size_t, size_t, const void*, size_t& dataWritten)
+{
+	dataWritten = 0;
+	Log("[CompressedStream::write] Attempted to write a read only stream.");
+	PVR_ASSERT(0 && "[CompressedStream::write] Attempted to write a read only stream.");
+	return false;
+}
+
+bool CompressedStream::seek(long offset, SeekOrigin origin) const
+{
+	const size_t base = (origin == SeekOriginFromStart ? 0 : origin == SeekOriginFromCurrent ? m_position : m_size);
+	if ((offset < 0 && static_cast<size_t>(-offset) > base) || (offset > 0 && static_cast<size_t>(offset) > m_size - base))
+	{
+		Log(Log.Debug, "[CompressedStream::seek] Was attempting to seek outside the stream ");
+		return false;
+	}
+	m_position = base + offset;
+	return true;
+}
+
+bool CompressedStream::compress(const void* data, size_t size, Stream& output, BlockSize blockSize)
+{
+	uint8 descriptor[11];
+	descriptor[0] = c_flagVersion | c_flagIndependentBlocks | c_flagContentSize | c_flagContentChecksum;
+	descriptor[1] = static_cast<uint8>(blockSize << 4);
+	const uint64 contentSize = size;
+	memcpy(descriptor + 2, &contentSize, sizeof(contentSize));
+	descriptor[10] = static_cast<uint8>(xxh32(descriptor, 10) >> 8);
+	if (!write32(output, c_frameMagic) || !writeBytes(output, descriptor, sizeof(descriptor))) { return false; }
+
+	const size_t maxBlockSize = size_t(1) << (8 + 2 * blockSize);
+	std::vector<char8> compressed(lz4::getMaxCompressedSize(maxBlockSize));
+	const char8* const source = static_cast<const char8*>(data);
+	for (size_t offset = 0; offset < size; offset += maxBlockSize)
+	{
+		// Blocks that do not compress are stored as they are.
+		const size_t sourceSize = std::min(maxBlockSize, size - offset);
+		const size_t compressedSize = lz4::compressBlock(source + offset, sourceSize, compressed.data(), compressed.size());
+		const bool isCompressed = compressedSize && compressedSize < sourceSize;
+		const uint32 storedSize = static_cast<uint32>(isCompressed ? compressedSize : sourceSize);
+		if (!write32(output, storedSize | (isCompressed ? 0 : c_blockUncompressedBit)) ||
+		    !writeBytes(output, isCompressed ? compressed.data() : source + offset, storedSize))
+		{
+			return false;
+		}
+	}
+	return write32(output, 0) && write32(output, xxh32(data, size));
+}
+}
+//!\endcond
@@ -0,0 +1,143 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\CompressedStream.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A Stream decompressing another Stream, compressed in the LZ4 frame format.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/Stream.h"
+
+namespace pvr {
+class TaskScheduler;
+
+/*!*********************************************************************************************************************
+\brief     A read only Stream that decompresses another Stream compressed in the LZ4 frame format, as written by the lz4
+           command line tool (for example "lz4 -BI scene.pod scene.pod.lz4") or by CompressedStream::compress.
+\description Any file reader can read a compressed asset through this stream unchanged:
+           \code
+           assets::PODReader reader(Stream::ptr_type(new CompressedStream(getAssetStream("scene.pod.lz4"))));
+           \endcode
+           The frame is a sequence of blocks of up to 64KB to 4MB of data each. When the blocks are independent (the
+           default of CompressedStream::compress, "-BI" for the lz4 tool), any block can be decompressed on its own, so
+           seeking only costs the decompression of the block sought to, and reads spanning several blocks decompress
+           them straight into the caller's buffer, in parallel if a TaskScheduler is provided. Frames of linked blocks
+           are supported too, but are decompressed in order: seeking backwards decompresses from the start of the frame.
+           Block checksums are verified; the content checksum is not. Only the first frame of the stream is read, and all
+           its blocks but the last must be full, as with the lz4 tool and CompressedStream::compress.
+***********************************************************************************************************************/
+class CompressedStream : public Stream
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief  The maximum size of the data of a block.
+	***********************************************************************************************************************/
+	enum BlockSize
+	{
+		BlockSize64KB = 4,
+		BlockSize256KB = 5,
+		BlockSize1MB = 6,
+		BlockSize4MB = 7
+	};
+
+	/*!*********************************************************************************************************************
+	\brief  Create a stream decompressing another. Nothing is read until open() is called.
+	\param  compressedStream The compressed stream. Owned by the CompressedStream.
+	\param  scheduler If not NULL, reads spanning several independent blocks decompress them in parallel on it.
+	***********************************************************************************************************************/
+	explicit CompressedStream(Stream::ptr_type compressedStream, TaskScheduler* scheduler = NULL);
+
+	/*!********************************************************************************************************
+	\brief    Main read function. Read up to a specified amount of items into the provided buffer.
+	\param[in]  elementSize  The size of each element that will be read.
+	\param[in]  elementCount  The maximum number of elements to read.
+	\param[in]  buffer  The buffer into which to write the data.
+	\param[out]  dataRead  After returning, will contain the number of items that were actually read.
+	\return   Success if successful, error code otherwise.
+	**********************************************************************************************************/
+	virtual bool read(size_t elementSize, size_t elementCount, void* buffer, size_t& dataRead) const;
+
+	/*!********************************************************************************************************
+	\brief    Not supported: the stream is read only. Use compress() to create compressed data.
+	\return   False.
+	**********************************************************************************************************/
+	virtual bool write(size_t elementSize, size_t elementCount, const void* buffer, size_t& dataWritten);
+
+	/*!********************************************************************************************************
+	\brief    Seek a specific point in the decompressed data. Does not decompress anything by itself.
+	\param[in]  offset  The offset to seek from "origin".
+	\param[in]  origin  Beginning of stream, End of stream or Current position.
+	\return   True if successful, false if the new position would be outside the stream.
+	**********************************************************************************************************/
+	virtual bool seek(long offset, SeekOrigin origin) const;
+
+	/*!********************************************************************************************************
+	\brief    Open the compressed stream and read the header and the index of the blocks of the frame. If already
+	          open, seeks to the start.
+	\return   True if successful, false if the compressed stream could not be opened or is not a supported LZ4 frame.
+	**********************************************************************************************************/
+	virtual bool open() const;
+
+	/*!********************************************************************************************************
+	\brief    Close the compressed stream and release the decompression buffers.
+	**********************************************************************************************************/
+	virtual void close();
+
+	/*!********************************************************************************************************
+	\return   True if the stream is open and ready for other operations.
+	**********************************************************************************************************/
+	virtual bool isopen() const { return m_isOpen; }
+
+	/*!********************************************************************************************************
+	\return   The current position in the decompressed data.
+	**********************************************************************************************************/
+	virtual size_t getPosition() const { return m_position; }
+
+	/*!********************************************************************************************************
+	\return   The size of the decompressed data.
+	**********************************************************************************************************/
+	virtual size_t getSize() const { return m_size; }
+
+	/*!********************************************************************************************************
+	\brief    Compress data into an LZ4 frame of independent blocks, that CompressedStream and the lz4 tool can read.
+	\param    data The data to compress
+	\param    size The size of the data
+	\param    output A writable stream. The frame is written at its current position.
+	\param    blockSize The maximum size of the data of each block. Larger blocks compress slightly better, smaller
+	          ones make seeking cheaper and let more blocks be decompressed in parallel.
+	\return   True on success, false if writing failed.
+	**********************************************************************************************************/
+	static bool compress(const void* data, size_t size, Stream& output, BlockSize blockSize = BlockSize256KB);
+
+private:
+	struct Block
+	{
+		uint64 sourceOffset; // Of the data of the block in the compressed stream
+		uint32 storedSize;
+		bool isCompressed;
+	};
+
+	bool readFrame() const;
+	bool readSource(uint64 offset, size_t size, void* buffer) const;
+	// Returns NULL on success, else what is wrong with the block. Does not log, as it may run on any thread.
+	const char8* decompressBlock(const char8* storedData, uint32 block, char8* destination, size_t prefixSize) const;
+	bool loadBlock(uint32 block) const;
+	bool readBlocks(uint32 firstBlock, uint32 numBlocks, char8* destination) const;
+	size_t getBlockDataSize(uint32 block) const { return block + 1 < m_blocks.size() ? m_blockSize : m_lastBlockSize; }
+
+	Stream::ptr_type m_source;
+	TaskScheduler* m_scheduler;
+	mutable std::vector<Block> m_blocks;
+	mutable size_t m_blockSize;
+	mutable size_t m_lastBlockSize;
+	mutable bool m_blockChecksums;
+	mutable bool m_linkedBlocks;
+	mutable size_t m_size;
+	mutable size_t m_position;
+	mutable bool m_isOpen;
+	// The last block read, after the up to 64KB of data before it when the blocks are linked
+	mutable std::vector<char8> m_blockData;
+	mutable std::vector<char8> m_storedData;
+	mutable uint32 m_loadedBlock;
+	mutable size_t m_loadedPrefixSize;
+};
+}
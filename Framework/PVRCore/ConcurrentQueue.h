@@ -0,0 +1,318 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\ConcurrentQueue.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Contains bounded, lock-free queues to pass items between threads: SpscQueue and MpmcQueue.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pvr {
+//!\cond NO_DOXYGEN
+namespace details {
+// Indices written by different threads are kept this far apart, so that they do not share a cache line. Must match
+// PVR_CACHE_LINE_ALIGNED.
+enum { c_cacheLineSize = 64 };
+
+inline size_t roundUpToPowerOfTwo(size_t value)
+{
+	size_t result = 2;
+	while (result < value) { result <<= 1; }
+	return result;
+}
+
+// An index alone on its cache line.
+struct PVR_CACHE_LINE_ALIGNED PaddedIndex
+{
+	std::atomic<size_t> value;
+	char padding[c_cacheLineSize - sizeof(std::atomic<size_t>)];
+	PaddedIndex() : value(0) {}
+};
+
+// The index of one side of a single-producer / single-consumer queue, with the side's cached copy of the other index.
+struct PVR_CACHE_LINE_ALIGNED PaddedIndexPair
+{
+	std::atomic<size_t> value; // Written by this side
+	size_t cachedOther; // This side's last read of the other side's index
+	char padding[c_cacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	PaddedIndexPair() : value(0), cachedOther(0) {}
+};
+PVR_STATIC_ASSERT(sizeof(PaddedIndex) == c_cacheLineSize && sizeof(PaddedIndexPair) == c_cacheLineSize,
+                  padded_indices_fill_one_cache_line);
+
+// Base of the queues, and of the classes holding one, so that new honours their cache line alignment: before C++17,
+// operator new only guarantees the alignment of the fundamental types. The pointer returned by the global operator new
+// is kept just before the aligned block.
+struct CacheLineAlignedNew
+{
+	static void* operator new(size_t size)
+	{
+		char* memory = static_cast<char*>(::operator new(size + c_cacheLineSize));
+		char* aligned = memory + c_cacheLineSize - ((size_t)memory & (c_cacheLineSize - 1));
+		reinterpret_cast<char**>(aligned)[-1] = memory;
+		return aligned;
+	}
+
+	static void operator delete(void* aligned)
+	{
+		if (aligned) { ::operator delete(static_cast<char**>(aligned)[-1]); }
+	}
+};
+}
+//!\endcond
+
+/*!*********************************************************************************************************************
+\brief   A bounded, lock-free, single-producer / single-consumer FIFO queue.
+\description One thread pushes items at the back, one other thread pops them from the front, with no locks and no
+         allocation after construction. Use it like a RingBuffer that does not grow: push_back and pop_front return
+         false instead of blocking when the queue is full or empty. Each side keeps a cached copy of the other side's
+         index, so it only touches the other side's cache line when the cached copy says the queue is full (or empty).
+\tparam  ItemType The type of the items. Must be copy or move constructible.
+***********************************************************************************************************************/
+template<typename ItemType> class SpscQueue : public details::CacheLineAlignedNew
+{
+	SpscQueue(const SpscQueue&);
+	SpscQueue& operator=(const SpscQueue&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor.
+	\param capacity The maximum number of items. Rounded up to a power of two.
+	\description Throws std::bad_alloc if the items cannot be allocated, as MpmcQueue does.
+	***********************************************************************************************************************/
+	explicit SpscQueue(size_t capacity) : m_capacity(details::roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1),
+		m_store(static_cast<ItemType*>(::operator new(m_capacity * sizeof(ItemType)))) {}
+
+	~SpscQueue()
+	{
+		const size_t tail = m_tail.value.load(std::memory_order_acquire);
+		for (size_t head = m_head.value.load(std::memory_order_relaxed); head != tail; ++head)
+		{
+			m_store[head & m_mask].~ItemType();
+		}
+		::operator delete(m_store);
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Add an item at the back. Producer thread only.
+	\return False if the queue was full
+	***********************************************************************************************************************/
+	bool push_back(const ItemType& item)
+	{
+		const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+		if (!hasSpace(tail)) { return false; }
+		new(m_store + (tail & m_mask)) ItemType(item);
+		m_tail.value.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Move an item to the back. Producer thread only.
+	\return False if the queue was full, in which case item is left untouched
+	***********************************************************************************************************************/
+	bool push_back(ItemType&& item)
+	{
+		const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+		if (!hasSpace(tail)) { return false; }
+		new(m_store + (tail & m_mask)) ItemType(std::move(item));
+		m_tail.value.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Remove the item at the front. Consumer thread only.
+	\param[out] item The item removed
+	\return False if the queue was empty
+	***********************************************************************************************************************/
+	bool pop_front(ItemType& item)
+	{
+		const size_t head = m_head.value.load(std::memory_order_relaxed);
+		if (head == m_head.cachedOther)
+		{
+			m_head.cachedOther = m_tail.value.load(std::memory_order_acquire);
+			if (head == m_head.cachedOther) { return false; }
+		}
+		ItemType* stored = m_store + (head & m_mask);
+		item = std::move(*stored);
+		stored->~ItemType();
+		m_head.value.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\return The number of items. Exact only when called by the producer or the consumer with the other one idle.
+	***********************************************************************************************************************/
+	size_t size() const
+	{
+		return m_tail.value.load(std::memory_order_acquire) - m_head.value.load(std::memory_order_acquire);
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/*!*********************************************************************************************************************
+	\return The maximum number of items.
+	***********************************************************************************************************************/
+	size_t capacity() const { return m_capacity; }
+
+private:
+	bool hasSpace(size_t tail)
+	{
+		if (tail - m_tail.cachedOther < m_capacity) { return true; }
+		m_tail.cachedOther = m_head.value.load(std::memory_order_acquire);
+		return tail - m_tail.cachedOther < m_capacity;
+	}
+
+	const size_t m_capacity;
+	const size_t m_mask;
+	ItemType* const m_store;
+	char m_padding[details::c_cacheLineSize];
+	details::PaddedIndexPair m_head; // Next item to pop, and the consumer's copy of m_tail
+	details::PaddedIndexPair m_tail; // Next slot to push to, and the producer's copy of m_head
+};
+
+/*!*********************************************************************************************************************
+\brief   A bounded, lock-free, multi-producer / multi-consumer FIFO queue (D. Vyukov's algorithm).
+\description Any number of threads push items at the back and pop them from the front, with no locks and no allocation
+         after construction. push_back and pop_front return false instead of blocking when the queue is full or empty.
+         Each slot carries a sequence number telling whether it is ready to be written or read in the current lap
+         around the buffer, so that producers and consumers only contend on the index of their own side.
+\tparam  ItemType The type of the items. Must be copy or move constructible.
+***********************************************************************************************************************/
+template<typename ItemType> class MpmcQueue : public details::CacheLineAlignedNew
+{
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		ItemType* item() { return reinterpret_cast<ItemType*>(&storage); }
+		typename std::aligned_storage<sizeof(ItemType), std::alignment_of<ItemType>::value>::type storage;
+	};
+
+	MpmcQueue(const MpmcQueue&);
+	MpmcQueue& operator=(const MpmcQueue&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor.
+	\param capacity The maximum number of items. Rounded up to a power of two.
+	***********************************************************************************************************************/
+	explicit MpmcQueue(size_t capacity) : m_capacity(details::roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1),
+		m_cells(new Cell[m_capacity])
+	{
+		for (size_t i = 0; i < m_capacity; ++i) { m_cells[i].sequence.store(i, std::memory_order_relaxed); }
+	}
+
+	~MpmcQueue()
+	{
+		const size_t tail = m_tail.value.load(std::memory_order_acquire);
+		for (size_t head = m_head.value.load(std::memory_order_relaxed); head != tail; ++head)
+		{
+			m_cells[head & m_mask].item()->~ItemType();
+		}
+		delete[] m_cells;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Add an item at the back. Any thread.
+	\return False if the queue was full
+	***********************************************************************************************************************/
+	bool push_back(const ItemType& item)
+	{
+		size_t position;
+		Cell* cell = acquireForPush(position);
+		if (!cell) { return false; }
+		new(cell->item()) ItemType(item);
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Move an item to the back. Any thread.
+	\return False if the queue was full, in which case item is left untouched
+	***********************************************************************************************************************/
+	bool push_back(ItemType&& item)
+	{
+		size_t position;
+		Cell* cell = acquireForPush(position);
+		if (!cell) { return false; }
+		new(cell->item()) ItemType(std::move(item));
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Remove the item at the front. Any thread.
+	\param[out] item The item removed
+	\return False if the queue was empty
+	***********************************************************************************************************************/
+	bool pop_front(ItemType& item)
+	{
+		size_t position = m_head.value.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell* cell = &m_cells[position & m_mask];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+			if (difference == 0)
+			{
+				if (m_head.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					item = std::move(*cell->item());
+					cell->item()->~ItemType();
+					// Ready for the push of the next lap.
+					cell->sequence.store(position + m_capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0) { return false; }
+			else { position = m_head.value.load(std::memory_order_relaxed); }
+		}
+	}
+
+	/*!*********************************************************************************************************************
+	\return An estimate of the number of items.
+	***********************************************************************************************************************/
+	size_t size() const
+	{
+		const size_t head = m_head.value.load(std::memory_order_acquire);
+		const size_t tail = m_tail.value.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/*!*********************************************************************************************************************
+	\return The maximum number of items.
+	***********************************************************************************************************************/
+	size_t capacity() const { return m_capacity; }
+
+private:
+	// Claim the cell at the tail, at position. Returns NULL if the queue is full.
+	Cell* acquireForPush(size_t& position)
+	{
+		position = m_tail.value.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell* cell = &m_cells[position & m_mask];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+			if (difference == 0)
+			{
+				if (m_tail.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					return cell;
+				}
+			}
+			else if (difference < 0) { return NULL; }
+			else { position = m_tail.value.load(std::memory_order_relaxed); }
+		}
+	}
+
+	const size_t m_capacity;
+	const size_t m_mask;
+	Cell* const m_cells;
+	details::PaddedIndex m_tail; // Next position to push to
+	details::PaddedIndex m_head; // Next position to pop from
+};
+}
@@ -20,6 +20,13 @@
 #endif
 #endif
 
+// constexpr needs Visual Studio 2015. With older compilers, PVR_CONSTEXPR functions are evaluated at runtime.
+#if defined(_MSC_VER) && (_MSC_VER<1900)
+#define PVR_CONSTEXPR
+#else
+#define PVR_CONSTEXPR constexpr
+#endif
+
 #ifdef DEBUG
 #define PVR_DEBUG_THROW_ON_API_ERROR
 #define PVR_FRAMEWORK_OBJECT_NAMES
@@ -0,0 +1,118 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\HalfFloat.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Batch conversion between 32 bit and 16 bit floats, using the F16C or NEON instructions where available.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/HalfFloat.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PVR_HALF_FLOAT_F16C
+#define PVR_HALF_FLOAT_F16C_TARGET __attribute__((target("avx,f16c")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#define PVR_HALF_FLOAT_F16C
+#define PVR_HALF_FLOAT_F16C_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__aarch64__) || (defined(__ARM_NEON) && defined(__ARM_FP) && (__ARM_FP & 2))
+#define PVR_HALF_FLOAT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace pvr {
+namespace {
+void convertFloat32ToFloat16Scalar(const float* source, HalfFloat* destination, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) { destination[i] = HalfFloat::fromBits(HalfFloat::packFloat32(source[i])); }
+}
+
+void convertFloat16ToFloat32Scalar(const HalfFloat* source, float* destination, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) { destination[i] = HalfFloat::unpackFloat32(source[i].getBits()); }
+}
+
+#if defined(PVR_HALF_FLOAT_F16C)
+// F16C instructions work on the AVX registers, so the OS must also save them on context switches.
+bool detectF16C()
+{
+	int registers[4];
+#if defined(_MSC_VER)
+	__cpuid(registers, 1);
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) { return false; }
+	registers[2] = (int)ecx;
+#endif
+	const unsigned int c_osxsave = 1u << 27, c_avx = 1u << 28, c_f16c = 1u << 29;
+	const unsigned int features = (unsigned int)registers[2];
+	if ((features & (c_osxsave | c_avx | c_f16c)) != (c_osxsave | c_avx | c_f16c)) { return false; }
+#if defined(_MSC_VER)
+	const unsigned long long enabledState = _xgetbv(0);
+#else
+	unsigned int enabledLow, enabledHigh;
+	__asm__ __volatile__("xgetbv" : "=a"(enabledLow), "=d"(enabledHigh) : "c"(0));
+	const unsigned long long enabledState = enabledLow;
+#endif
+	return (enabledState & 6) == 6; // SSE and AVX state
+}
+
+const bool g_hasF16C = detectF16C();
+
+PVR_HALF_FLOAT_F16C_TARGET size_t convertFloat32ToFloat16F16C(const float* source, HalfFloat* destination, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), halves);
+	}
+	return i;
+}
+
+PVR_HALF_FLOAT_F16C_TARGET size_t convertFloat16ToFloat32F16C(const HalfFloat* source, float* destination, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		_mm256_storeu_ps(destination + i, _mm256_cvtph_ps(halves));
+	}
+	return i;
+}
+#endif
+}
+
+void convertFloat32ToFloat16(const float* source, HalfFloat* destination, size_t count)
+{
+	size_t converted = 0;
+#if defined(PVR_HALF_FLOAT_F16C)
+	if (g_hasF16C) { converted = convertFloat32ToFloat16F16C(source, destination, count); }
+#elif defined(PVR_HALF_FLOAT_NEON)
+	for (; converted + 4 <= count; converted += 4)
+	{
+		const float16x4_t halves = vcvt_f16_f32(vld1q_f32(source + converted));
+		vst1_u16(reinterpret_cast<uint16_t*>(destination + converted), vreinterpret_u16_f16(halves));
+	}
+#endif
+	convertFloat32ToFloat16Scalar(source + converted, destination + converted, count - converted);
+}
+
+void convertFloat16ToFloat32(const HalfFloat* source, float* destination, size_t count)
+{
+	size_t converted = 0;
+#if defined(PVR_HALF_FLOAT_F16C)
+	if (g_hasF16C) { converted = convertFloat16ToFloat32F16C(source, destination, count); }
+#elif defined(PVR_HALF_FLOAT_NEON)
+	for (; converted + 4 <= count; converted += 4)
+	{
+		const uint16x4_t halves = vld1_u16(reinterpret_cast<const uint16_t*>(source + converted));
+		vst1q_f32(destination + converted, vcvt_f32_f16(vreinterpret_f16_u16(halves)));
+	}
+#endif
+	convertFloat16ToFloat32Scalar(source + converted, destination + converted, count - converted);
+}
+}
+//!\endcond
@@ -5,6 +5,8 @@
 \brief    Software implementation of a 16 bit floating point number.
 ***********************************************************************************************************************/
 #pragma once
+#include <cstddef>
+#include <cstring>
 //Half float class
 #if defined(_WIN32)
 #pragma pack(push,1)
@@ -85,156 +87,102 @@ public:
 	static float getMinimumAbsoluteValue() { return 0.0000000596f; }
 	static float getLowestValue() { return - ((float)getMaximumAbsoluteValue()); }
 
-private:
-	struct HalfFloatBits
-	{
-		unsigned int mantissa: 10;
-		unsigned int exponent: 5;
-		unsigned int sign: 1;
-	};
-
-	struct FloatBits
-	{
-		unsigned int mantissa: 23;
-		unsigned int exponent: 8;
-		unsigned int sign: 1;
-	};
-
-	union FloatData
-	{
-		float      value;
-		FloatBits bits;
-	};
-
-	union HalfFloatData
-	{
-		short    value;
-		HalfFloatBits bits;
-#if defined(__GNUC__)
-	} __attribute__((packed));
-#else
-	};
-#endif //__GNUC__
-
-	short m_value;
-
-	static const int c_halfExponentBias = 15;
-	static const int c_floatExponentBias = 127;
+	/*!*********************************************************************************************************************
+	\return The raw 16 bits of the value, as stored in GL_HALF_FLOAT data.
+	***********************************************************************************************************************/
+	unsigned short getBits() const { return m_value; }
 
-	static const int c_halfExponentNaN = 31;
-	static const int c_floatExponentNaN = 255;
-
-	void packFloat(const float& value)
+	/*!*********************************************************************************************************************
+	\brief Create a HalfFloat from its raw 16 bits.
+	***********************************************************************************************************************/
+	static HalfFloat fromBits(unsigned short bits)
 	{
-		HalfFloatData halfData = { m_value };
-		//Get the raw bits of the floating point value.
-		const FloatData floatFields = { value };
-
-		//Work out the new exponent.
-		int newExponent = floatFields.bits.exponent - c_floatExponentBias + c_halfExponentBias;
-
-		//Set a sort of "default state" for the half float value
-		halfData.value = 0;
-		halfData.bits.sign = floatFields.bits.sign;
-
-		//Check for NaNs, Infinities, Overflows and Underflows.
+		HalfFloat value;
+		value.m_value = bits;
+		return value;
+	}
 
-		//Anything above or equal to halfExponentNaN is going to be either too large to represent or a NaN.
-		if (newExponent >= c_halfExponentNaN)
+	/*!*********************************************************************************************************************
+	\brief Convert a 32 bit float to the bits of the nearest 16 bit float, rounding ties to even as F16C and NEON do.
+	        Values too large become infinity, NaNs stay NaNs.
+	***********************************************************************************************************************/
+	static unsigned short packFloat32(float value)
+	{
+		const unsigned int c_float32Infinity = 255u << 23;
+		const unsigned int c_float16Overflow = (127u + 16u) << 23; // Smallest float that rounds to infinity, rounded down
+		const unsigned int c_denormalMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const unsigned int sign = bits & 0x80000000u;
+		bits ^= sign;
+		unsigned int result;
+		if (bits >= c_float16Overflow)
 		{
-			//Any exponent greater than the representable range will return Infinity.
-			halfData.bits.exponent = c_halfExponentNaN;
-
-			//Ensure that any NaNs are still a NaN, and not accidentally turned into an infinity.
-			if (floatFields.bits.exponent == c_floatExponentNaN && floatFields.bits.mantissa != 0)
-			{
-				halfData.bits.mantissa = 0x200;
-			}
+			// Infinity, or NaN with the top of its payload kept and the quiet bit set
+			result = bits > c_float32Infinity ? (0x7e00u | ((bits >> 13) & 0x3ffu)) : 0x7c00u;
 		}
-		//Underflows may be representable with a loss of accuracy
-		else if (newExponent <= 0)
+		else if (bits < (113u << 23))
 		{
-			//Attempt to deal with it if we can.
-			if (newExponent >= -10)
-			{
-				//Calculate the new mantissa, masking off the top bit.
-				unsigned int newMantissa = floatFields.bits.mantissa | 0x800000;
-				halfData.bits.mantissa = newMantissa >> (14 - newExponent);
-
-				//Check if it needs to be rounded up
-				if ((newMantissa >> (13 - newExponent)) & 1)
-				{
-					//It might overflow to the exponent bit, but this is fine due to the way floats work.
-					halfData.value++;
-				}
-			}
+			// Zero or denormal: let the FPU align and round the mantissa, by adding 0.5
+			float magic, aligned;
+			memcpy(&magic, &c_denormalMagic, sizeof(magic));
+			memcpy(&aligned, &bits, sizeof(aligned));
+			aligned += magic;
+			memcpy(&result, &aligned, sizeof(result));
+			result -= c_denormalMagic;
 		}
 		else
 		{
-			//Simple case, just set the exponent and mantissa.
-			halfData.bits.exponent = newExponent;
-			halfData.bits.mantissa = floatFields.bits.mantissa >> 13;
-
-			//Check if it needs to be rounded up
-			if (floatFields.bits.mantissa & 0x1000)
-			{
-				//It might overflow to the exponent bit, but this is fine due to the way floats work.
-				halfData.value++;
-			}
+			// Normal: rebias the exponent and round the mantissa to nearest, ties to even
+			const unsigned int mantissaOdd = (bits >> 13) & 1u;
+			bits += (unsigned int)(15 - 127) << 23;
+			bits += 0xfffu + mantissaOdd;
+			result = bits >> 13;
 		}
-		m_value = halfData.value;
+		return (unsigned short)(result | (sign >> 16));
 	}
 
-	float unpackFloat() const
-	{
-		//Get the raw bits of the half float, and turn them into a float.
-		FloatData floatFields;
-		const HalfFloatData halfData = { m_value };
-		//Set a default value for the float
-		floatFields.bits.sign = halfData.bits.sign;
-		floatFields.bits.exponent = 0;
-		floatFields.bits.mantissa = 0;
-
-		// Check for anything that isn't signed zero
-		if (halfData.bits.exponent != 0 || halfData.bits.mantissa != 0)
+	/*!*********************************************************************************************************************
+	\brief Convert the bits of a 16 bit float to a 32 bit float. Exact.
+	***********************************************************************************************************************/
+	static float unpackFloat32(unsigned short value)
+	{
+		const unsigned int c_shiftedExponent = 0x7c00u << 13;
+		unsigned int bits = (value & 0x7fffu) << 13;
+		const unsigned int exponent = bits & c_shiftedExponent;
+		bits += (127u - 15u) << 23;
+		float result;
+		if (exponent == c_shiftedExponent)
 		{
-			//Some de-normalised half floats can be normalised - due to the increased mantissa of a full float.
-			//This is a kind of slow operation, but means that the floating point values can be easier to work on in hardware and thus faster.
-			if (halfData.bits.exponent == 0)
-			{
-				// Adjust the exponent and mantissa to try to normalise the new value.
-				unsigned int exponentAdjustment = 0;
-				unsigned int newMantissa = halfData.bits.mantissa << 1;
-
-				//Loop through until the mantissa hits its maximum
-				while ((newMantissa & 0x400) == 0)
-				{
-					exponentAdjustment++;
-					newMantissa <<= 1;
-				}
-
-				//Set the new mantissa and exponent values
-				floatFields.bits.mantissa = (newMantissa & 0x3ff) << 13;
-				floatFields.bits.exponent = (c_floatExponentBias - c_halfExponentBias) - exponentAdjustment;
-			}
-			//Handle infinities and NaNs
-			else if (halfData.bits.exponent == c_halfExponentNaN)
-			{
-				//Expand the mantissa up to the original size, and set the NaN value for the exponent.
-				floatFields.bits.exponent = c_floatExponentNaN;
-				floatFields.bits.mantissa = halfData.bits.mantissa << 13;
-			}
-			//Otherwise it's a simple normalised number
-			else
-			{
-				floatFields.bits.exponent = halfData.bits.exponent + (c_floatExponentBias - c_halfExponentBias);
-				floatFields.bits.mantissa = halfData.bits.mantissa << 13;
-			}
+			bits += (128u - 16u) << 23; // Infinity or NaN. NaNs are made quiet, as by the hardware conversions.
+			if (bits & 0x7fffffu) { bits |= 0x400000u; }
+			memcpy(&result, &bits, sizeof(result));
 		}
-
-		return floatFields.value;
+		else if (exponent == 0)
+		{
+			// Zero or denormal: renormalise through the FPU
+			const unsigned int c_magic = 113u << 23;
+			float magic;
+			memcpy(&magic, &c_magic, sizeof(magic));
+			bits += 1u << 23;
+			memcpy(&result, &bits, sizeof(result));
+			result -= magic;
+		}
+		else { memcpy(&result, &bits, sizeof(result)); }
+		unsigned int resultBits;
+		memcpy(&resultBits, &result, sizeof(resultBits));
+		resultBits |= (unsigned int)(value & 0x8000u) << 16;
+		memcpy(&result, &resultBits, sizeof(result));
+		return result;
 	}
 
+private:
+	short m_value;
+
+	void packFloat(const float& value) { m_value = (short)packFloat32(value); }
+
+	float unpackFloat() const { return unpackFloat32((unsigned short)m_value); }
+
 #if defined(_WIN32)
 };
 #pragma pack(pop)
@@ -243,4 +191,22 @@ private:
 #else
 };
 #endif //_WIN32
+
+/*!*********************************************************************************************************************
+\brief    Convert an array of 32 bit floats to 16 bit floats, rounding to nearest even. Uses F16C on x86 processors that
+          support it and NEON on ARM, and otherwise HalfFloat::packFloat32. All give identical results.
+\param    source The floats to convert
+\param    destination The converted values. May be the raw data of a GL_HALF_FLOAT texture or vertex buffer.
+\param    count The number of values
+***********************************************************************************************************************/
+void convertFloat32ToFloat16(const float* source, HalfFloat* destination, size_t count);
+
+/*!*********************************************************************************************************************
+\brief    Convert an array of 16 bit floats to 32 bit floats. Exact. Uses F16C on x86 processors that support it and NEON
+          on ARM, and otherwise HalfFloat::unpackFloat32.
+\param    source The values to convert. May be the raw data of a GL_HALF_FLOAT texture or vertex buffer.
+\param    destination The converted floats
+\param    count The number of values
+***********************************************************************************************************************/
+void convertFloat16ToFloat32(const HalfFloat* source, float* destination, size_t count);
 }
\ No newline at end of file
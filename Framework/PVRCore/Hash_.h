@@ -50,6 +50,18 @@ inline uint32 hash32_bytes(const void* bytes, size_t count)
 	return hashValue;
 }
 
+/*!*********************************************************************************************************************
+\brief     Compile-time version of hash32_bytes, for string literals. Returns the same value as hash32_bytes(str, count).
+\param     str Pointer to the characters to hash.
+\param     count Number of characters to hash.
+\param     hashValue The hash of the characters before str. Leave to the default.
+\return    The hash of the characters.
+***********************************************************************************************************************/
+inline PVR_CONSTEXPR uint32 hash32_literal(const char* str, size_t count, uint32 hashValue = 2166136261U)
+{
+	return count == 0 ? hashValue : hash32_literal(str + 1, count - 1, (hashValue * 16777619U) ^ static_cast<unsigned char>(*str));
+}
+
 /*!*********************************************************************************************************************
 \brief     Class template denoting a hash. Specializations only - no default implementation. (int32/int64/uint32/uint64/string)
 \tparam    The type of the value to hash.
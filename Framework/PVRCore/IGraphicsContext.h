@@ -217,6 +217,14 @@ typedef pvr::RefCountedWeakReference<IGraphicsContext> GraphicsContext;
 *******************************************************************************************************************/
 GraphicsContextStrongReference createGraphicsContext();
 
+/*!****************************************************************************************************************
+\brief	This function is implemented in PVRApi, in order to return a Graphics Context that records the calls it would
+        make to the graphics API instead of making them, for measuring CPU costs without a GPU. Must be used with a
+        platform::NullPlatformContext (PVRCore/NullPlatformContext.h).
+\return A new GraphicsContext object that makes no graphics API calls.
+*******************************************************************************************************************/
+GraphicsContextStrongReference createNullGraphicsContext();
+
 
 /*!****************************************************************************************************************
 \brief	Interface for Graphics context. This interface will be used all over in user code to pass GraphicsContext
@@ -3,23 +3,49 @@
 \author       PowerVR by Imagination, Developer Technology Team.
 \copyright    Copyright (c) Imagination Technologies Limited.
 \brief		Implementation of a special kind of map that stores the data in a linear, contiguous store (std::vector interface),
-			but additionally contains an Index to them (std::map interface). Supports custom association of names with
+			but additionally contains an Index to them (hash table). Supports custom association of names with
 			values, and retrieval of indexes by name or values by index.
 ***********************************************************************************************************************/
 #pragma once
+#include "PVRCore/Hash_.h"
 #include <vector>
-#include <map>
-#include <list>
 #include <algorithm>
+#include <type_traits>
 namespace pvr {
+//!\cond NO_DOXYGEN
+namespace details {
+// Keys with a getHash() method (such as StringHash) provide a precomputed hash. Other keys are hashed with pvr::hash.
+template<typename Key_>
+struct HasGetHash
+{
+	template<typename U> static char Test(decltype(&U::getHash));
+	template<typename U> static int Test(...);
+	enum { value = sizeof(Test<Key_>(0)) == sizeof(char) };
+};
+
+template<typename Key_, bool = HasGetHash<Key_>::value>
+struct IndexedArrayKeyHash
+{
+	uint32 operator()(const Key_& key) const { return hash<Key_>()(key); }
+};
+
+template<typename Key_>
+struct IndexedArrayKeyHash<Key_, true>
+{
+	uint32 operator()(const Key_& key) const { return static_cast<uint32>(key.getHash()); }
+};
+}
+//!\endcond
+
 /*!*********************************************************************************************************************
-\brief     			A combination of array (std::vector) with associative container (std::map). Supports association of names
+\brief     			A combination of array (std::vector) with associative container (hash table). Supports association of names
 with values, and retrieval by index.
 \description		An std::vector style array class with the additional feature of associating "names" (IndexType_, std::string
 by default) with the values stored. Keys are of type IndexType_, correspond to vector position 1:1, so that each vector position
 ("index") is associated with a "key", and only one key.
 Use: Add pairs of values with insert(key, value).
-Retrieve indices by key, using getIndex(key) -- O(logn)
+Retrieve indices by key, using getIndex(key) -- O(1) on average. The index is an open-addressing hash table (linear probing)
+over a dense array of (key, index) pairs. Keys with a getHash() method, such as StringHash, are not hashed again.
 Retrieve values by index, using indexing operator [] -- O(1)
 The remove() function destroys the items on which it was called, but a default-constructed object will still exist. Performing
 insert() after removing an item will use the place of a previously deleted item, if it exists.
@@ -44,16 +70,24 @@ private:
 	struct StorageItem_ : DictionaryEntry
 	{
 		bool isUnused;
-		StorageItem_() {}
+		StorageItem_() : isUnused(false) {}
 		StorageItem_(const IndexType_& key, const ValueType_& value) : DictionaryEntry(key, value), isUnused(false) { }
 	};
 
+	struct IndexBucket_
+	{
+		uint32 hash;
+		uint32 entry; // Position in myindex, or c_emptyBucket
+	};
+	enum { c_emptyBucket = 0xFFFFFFFFu, c_minBuckets = 16 };
+
 	typedef std::vector<StorageItem_> vectortype_;
-	typedef typename std::map<IndexType_, size_t> maptype_;
-	typedef std::list<size_t> deleteditemlisttype_;
+	typedef std::vector<std::pair<IndexType_, size_t> > maptype_;
+	typedef std::vector<size_t> deleteditemlisttype_;
 
 	vectortype_ mystorage;
-	maptype_ myindex;
+	maptype_ myindex; // Dense (key, index into mystorage) pairs, in no particular order
+	std::vector<IndexBucket_> mybuckets; // Power of two size, at most 3/4 full
 	deleteditemlisttype_ myDeletedItems;
 
 public:
@@ -176,14 +210,14 @@ public:
 		}
 	};
 	/*!*********************************************************************************************************************
-	\brief     An Indexed iterator of the IndexedArray class. Will follow the indexing map of the IndexedArray iterating items
-	           in their Indexing order.
+	\brief     An Indexed iterator of the IndexedArray class. Iterates the (key, index) pairs of the index, in no particular
+	           order. Do not modify the key through it.
 	***********************************************************************************************************************/
 	typedef typename maptype_::iterator index_iterator;
 
 	/*!*********************************************************************************************************************
-	\brief     An Indexed (Constant) iterator of the IndexedArray class. Will follow the indexing map of the IndexedArray 
-	           iterating items in their Indexing order.
+	\brief     An Indexed (Constant) iterator of the IndexedArray class. Iterates the (key, index) pairs of the index, in no
+	           particular order.
 	***********************************************************************************************************************/
 	typedef typename maptype_::const_iterator const_index_iterator;
 
@@ -229,7 +263,8 @@ public:
 	***********************************************************************************************************************/
 	typename maptype_::iterator indexed_find(const IndexType_& key)
 	{
-		return myindex.find(key);
+		const size_t entry = findEntry(key);
+		return entry == static_cast<size_t>(-1) ? myindex.end() : myindex.begin() + entry;
 	}
 
 	/*!*********************************************************************************************************************
@@ -237,7 +272,8 @@ public:
 	***********************************************************************************************************************/
 	typename maptype_::const_iterator indexed_find(const IndexType_& key)const
 	{
-		return myindex.find(key);
+		const size_t entry = findEntry(key);
+		return entry == static_cast<size_t>(-1) ? myindex.end() : myindex.begin() + entry;
 	}
 
 	/*!*********************************************************************************************************************
@@ -260,7 +296,7 @@ public:
 	***********************************************************************************************************************/
 	typename maptype_::iterator indexed_end()
 	{
-		return myindex.begin();
+		return myindex.end();
 	}
 
 	/*!*********************************************************************************************************************
@@ -308,16 +344,20 @@ public:
 	***********************************************************************************************************************/
 	size_t insert(const IndexType_& key, const ValueType_ & val)
 	{
-		std::pair<typename maptype_::iterator, bool> found = myindex.insert(std::make_pair(key, 0));
-		if (!found.second) // Element already existed!
-		{
-			mystorage[found.first->second].value = val;
-		}
-		else
+		const uint32 hashValue = hashKey(key);
+		if (!mybuckets.empty())
 		{
-			found.first->second = insertinvector(key, val);
+			const IndexBucket_& bucket = mybuckets[findBucket(key, hashValue)];
+			if (bucket.entry != c_emptyBucket) // Element already existed!
+			{
+				const size_t index = myindex[bucket.entry].second;
+				mystorage[index].value = val;
+				return index;
+			}
 		}
-		return found.first->second;
+		const size_t index = insertinvector(key, val);
+		addEntry(key, hashValue, index);
+		return index;
 	}
 
 	/*!*********************************************************************************************************************
@@ -326,12 +366,22 @@ public:
 	***********************************************************************************************************************/
 	size_t getIndex(const IndexType_& key) const
 	{
-		typename maptype_::const_iterator found = myindex.find(key);
-		if (found != myindex.end()) // Element already existed!
-		{
-			return found->second;
-		}
-		return static_cast<size_t>(-1);// == static_cast<size_t>(-1)
+		const size_t entry = findEntry(key);
+		return entry == static_cast<size_t>(-1) ? entry : myindex[entry].second;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief     Get the index of a key given as another type, without converting it to IndexType_. Use to look StringHash keys
+	           up by StringHashLiteral without allocating.
+	\tparam    Key_ A type with a getHash() method returning the same hash as the equal IndexType_, and comparable to
+	           IndexType_ with ==.
+	***********************************************************************************************************************/
+	template<typename Key_>
+	typename std::enable_if < details::HasGetHash<Key_>::value && !std::is_same<Key_, IndexType_>::value, size_t >::type
+	getIndex(const Key_& key) const
+	{
+		const size_t entry = findEntry(key);
+		return entry == static_cast<size_t>(-1) ? entry : myindex[entry].second;
 	}
 
 	/*!*********************************************************************************************************************
@@ -342,11 +392,12 @@ public:
 	***********************************************************************************************************************/
 	void erase(const IndexType_& key)
 	{
-		typename maptype_::iterator where = myindex.find(key);
-		if (where != myindex.end())
+		if (mybuckets.empty()) { return; }
+		const size_t bucket = findBucket(key, hashKey(key));
+		if (mybuckets[bucket].entry != c_emptyBucket)
 		{
-			removefromvector(where->second);
-			myindex.erase(where);
+			removefromvector(myindex[mybuckets[bucket].entry].second);
+			removeEntry(bucket);
 
 			//SPECIAL CASE: If no more items are left, there is absolutely no point in NOT compacting, as no iterators or indices exist to be invalidated, so we can clean up
 			//even though "deferred" was asked. Additionally, this is essentially free, except maybe for the list...
@@ -376,20 +427,20 @@ public:
 	}
 
 	/*!*********************************************************************************************************************
-	\brief  Indexed indexing operator. Uses std::map binary search to find and retrieve the specified value. If the key does not
+	\brief  Indexed indexing operator. Uses a hash lookup to find and retrieve the specified value. If the key does not
 	        exist, behaviour is undefined.
 	***********************************************************************************************************************/
 	ValueType_& operator[](const IndexType_& key)
 	{
-		return mystorage[myindex.find(key)->second].value;
+		return mystorage[myindex[findEntry(key)].second].value;
 	}
 	/*!*********************************************************************************************************************
-	\brief  Const Indexed indexing operator. Uses std::map binary search to find and retrieve the specified value. If the key 
+	\brief  Const Indexed indexing operator. Uses a hash lookup to find and retrieve the specified value. If the key
 	        does not exist, behaviour is undefined.
 	***********************************************************************************************************************/
 	const ValueType_& operator[](const IndexType_& key)const
 	{
-		return mystorage[myindex.find(key)->second].value;
+		return mystorage[myindex[findEntry(key)].second].value;
 	}
 
 	/*!*********************************************************************************************************************
@@ -404,60 +455,43 @@ public:
 		{
 			return;
 		}
-		//First, make sure there is something to compact...
-		deleteditemlisttype_::iterator unused_spot = myDeletedItems.begin();
-		while (myDeletedItems.size() && unused_spot != myDeletedItems.end())
+		//Fill the unused spots, lowest first, with the items from the end of the vector.
+		std::sort(myDeletedItems.begin(), myDeletedItems.end());
+		size_t unused_spot = 0;
+		while (unused_spot < myDeletedItems.size())
 		{
-			//Last item in the storage vector.
-			size_t last = mystorage.size();
-
 			//1) Trim the end of the vector...
-			while (last-- && mystorage[last].isUnused)
+			while (!mystorage.empty() && mystorage.back().isUnused)
 			{
 				mystorage.pop_back();
-				//Rinse, repeat. If size is zero, there is nothing to do.
 			}
-
-			//Either the storage is empty
-			if (mystorage.empty())
+			//2)Trim any spots that have been trimmed off by the vector...
+			while (unused_spot < myDeletedItems.size() && myDeletedItems.back() >= mystorage.size())
 			{
-				myDeletedItems.clear();
-				//the rest should already be cleared...
-				//the loop will exit naturally
+				myDeletedItems.pop_back();
 			}
-			else //Or we can have find its last item!
-			{
-				//2)Trim any items from the end of the unused spots list that may have been trimmed off by the vector...
-				while (unused_spot != myDeletedItems.end() && *unused_spot >= last)
-				{
-					myDeletedItems.erase(unused_spot++);
-				}
-				//Any spots left?
-				if (unused_spot != myDeletedItems.end())
-				{
-					//Do the actual data movement. After all we've been through, we know that
-					//i. The last item of the vector is a valid item (guaranteed by 1)
-					//ii. The unused spot is not out of bounds of the vector
-					//iii.
-					//Copy by hand(as we have not defined a move assignment operator for compatibility reasons.
-					//Also, since the string does not throw, this makes easier to reason about exceptions.
+			if (unused_spot == myDeletedItems.size()) { break; }
+
+			//Do the actual data movement. We know that the last item of the vector is a valid item (guaranteed by 1)
+			//and the unused spot is not out of bounds of the vector (guaranteed by 2).
+			//Copy by hand(as we have not defined a move assignment operator for compatibility reasons.
+			//Also, since the string does not throw, this makes easier to reason about exceptions.
+			const size_t spot = myDeletedItems[unused_spot++];
+			const size_t last = mystorage.size() - 1;
 #ifdef PVR_SUPPORT_MOVE_SEMANTICS
-					mystorage[*unused_spot].value = std::move(mystorage[last].value);
-					mystorage[*unused_spot].key = std::move(mystorage[last].key);
+			mystorage[spot].value = std::move(mystorage[last].value);
+			mystorage[spot].key = std::move(mystorage[last].key);
 #else
-					mystorage[*unused_spot].value = mystorage[last].value;
-					mystorage[last].value.ValueType_::~ValueType_();
-					new(&mystorage[last].value) ValueType_();
-					mystorage[*unused_spot].key = mystorage[last].key;
-					mystorage[last].key.clear();
+			mystorage[spot].value = mystorage[last].value;
+			mystorage[last].value.ValueType_::~ValueType_();
+			new(&mystorage[last].value) ValueType_();
+			mystorage[spot].key = mystorage[last].key;
 #endif
-					mystorage[*unused_spot].isUnused = false;
-					myindex[mystorage[*unused_spot].key] = *unused_spot;
-					mystorage.pop_back();
-					myDeletedItems.erase(unused_spot++);
-				}//else : No action needed - unused spots has been trimmed off completely, so no movement is possible, or necessary...
-			}
+			mystorage[spot].isUnused = false;
+			myindex[findEntry(mystorage[spot].key)].second = spot;
+			mystorage.pop_back();
 		}
+		myDeletedItems.clear();
 	}
 
 	/*!*********************************************************************************************************************
@@ -466,6 +500,7 @@ public:
 	void clear()
 	{
 		myindex.clear();
+		mybuckets.clear();
 		mystorage.clear();
 		myDeletedItems.clear();
 	}
@@ -513,9 +548,9 @@ public:
 	***********************************************************************************************************************/
 	bool relocate(const IndexType_& key, size_t index)
 	{
-		typename maptype_::iterator found = myindex.find(key);
-		if (found == myindex.end()) { return false; }
-		size_t old_index = myindex[key];
+		const size_t entry = findEntry(key);
+		if (entry == static_cast<size_t>(-1)) { return false; }
+		size_t old_index = myindex[entry].second;
 		if (index == old_index) { return true; } //No-op
 		if (index + 1 > mystorage.size()) // Storage not big enough.
 		{
@@ -524,7 +559,7 @@ public:
 			mystorage.resize(index + 1);
 			for (size_t i = oldsize; i < index; ++i)
 			{
-				myDeletedItems.push_front(i);
+				myDeletedItems.push_back(i);
 				mystorage[i].isUnused = 1;
 			}
 			mystorage.back() = mystorage[old_index];
@@ -532,7 +567,7 @@ public:
 		}
 		else if (mystorage[index].isUnused) // Lucky! Storage is big enough, and the item is not used!
 		{
-			deleteditemlisttype_::iterator place = std::find(myDeletedItems.begin(), myDeletedItems.end(), index);
+			typename deleteditemlisttype_::iterator place = std::find(myDeletedItems.begin(), myDeletedItems.end(), index);
 			assert(place != myDeletedItems.end()); // Shouldn't happen!! Ever!!
 			myDeletedItems.erase(place);
 			mystorage[index] = mystorage[old_index];
@@ -540,14 +575,103 @@ public:
 		}
 		else // Whoops! Space is already occupied. Swap with the old item!
 		{
-			myindex[mystorage[index].key] = old_index;
+			myindex[findEntry(mystorage[index].key)].second = old_index;
 			std::swap(mystorage[index], mystorage[old_index]);
 		}
-		myindex[key] = index;
+		myindex[entry].second = index;
 		return true;
 	}
 
 private:
+	template<typename Key_>
+	static uint32 hashKey(const Key_& key)
+	{
+		return details::IndexedArrayKeyHash<Key_>()(key);
+	}
+
+	// The bucket holding the key, or the empty bucket where it would be inserted. There must be buckets.
+	template<typename Key_>
+	size_t findBucket(const Key_& key, uint32 hashValue) const
+	{
+		const size_t mask = mybuckets.size() - 1;
+		for (size_t bucket = hashValue & mask;; bucket = (bucket + 1) & mask)
+		{
+			const IndexBucket_& current = mybuckets[bucket];
+			if (current.entry == c_emptyBucket || (current.hash == hashValue && myindex[current.entry].first == key))
+			{
+				return bucket;
+			}
+		}
+	}
+
+	// The position of the key in myindex, or (size_t)-1.
+	template<typename Key_>
+	size_t findEntry(const Key_& key) const
+	{
+		if (mybuckets.empty()) { return static_cast<size_t>(-1); }
+		const uint32 entry = mybuckets[findBucket(key, hashKey(key))].entry;
+		return entry == c_emptyBucket ? static_cast<size_t>(-1) : entry;
+	}
+
+	// Add a key that is not in the index yet.
+	void addEntry(const IndexType_& key, uint32 hashValue, size_t index)
+	{
+		if ((myindex.size() + 1) * 4 > mybuckets.size() * 3)
+		{
+			rehash(mybuckets.empty() ? static_cast<size_t>(c_minBuckets) : mybuckets.size() * 2);
+		}
+		IndexBucket_& bucket = mybuckets[findBucket(key, hashValue)];
+		bucket.hash = hashValue;
+		bucket.entry = static_cast<uint32>(myindex.size());
+		myindex.push_back(std::make_pair(key, index));
+	}
+
+	void rehash(size_t numBuckets)
+	{
+		std::vector<IndexBucket_> oldBuckets(numBuckets);
+		oldBuckets.swap(mybuckets);
+		const size_t mask = numBuckets - 1;
+		for (size_t i = 0; i < numBuckets; ++i) { mybuckets[i].entry = c_emptyBucket; }
+		for (size_t i = 0; i < oldBuckets.size(); ++i)
+		{
+			if (oldBuckets[i].entry == c_emptyBucket) { continue; }
+			size_t bucket = oldBuckets[i].hash & mask;
+			while (mybuckets[bucket].entry != c_emptyBucket) { bucket = (bucket + 1) & mask; }
+			mybuckets[bucket] = oldBuckets[i];
+		}
+	}
+
+	// Remove the key held by a bucket from the index.
+	void removeEntry(size_t bucket)
+	{
+		const size_t mask = mybuckets.size() - 1;
+		const uint32 entry = mybuckets[bucket].entry;
+
+		//Backward shift deletion: move back any following item of the probe sequence that may no longer be reachable.
+		size_t hole = bucket;
+		for (size_t next = (hole + 1) & mask; mybuckets[next].entry != c_emptyBucket; next = (next + 1) & mask)
+		{
+			const size_t home = mybuckets[next].hash & mask;
+			if (((next - home) & mask) >= ((next - hole) & mask))
+			{
+				mybuckets[hole] = mybuckets[next];
+				hole = next;
+			}
+		}
+		mybuckets[hole].entry = c_emptyBucket;
+
+		//Keep myindex dense by moving its last pair into the removed one.
+		const uint32 last = static_cast<uint32>(myindex.size() - 1);
+		if (entry != last)
+		{
+			myindex[entry] = myindex[last];
+			size_t moved = hashKey(myindex[entry].first) & mask;
+			while (mybuckets[moved].entry != last) { moved = (moved + 1) & mask; }
+			mybuckets[moved].entry = entry;
+		}
+		myindex.pop_back();
+	}
+
 	size_t insertinvector(const IndexType_& key, const ValueType_ & val)
 	{
 		size_t retval;
@@ -581,7 +705,7 @@ private:
 			//NOT the last item, so we just destruct it (to free any potential expensive resources),
 			//and then default-construct it (to have the spot destructible). We keep the reference to
 			//the key as we will need it.
-			myDeletedItems.push_front(index);
+			myDeletedItems.push_back(index);
 			mystorage[index].isUnused = true;
 			mystorage[index].value.ValueType_::~ValueType_();
 			new(&mystorage[index].value) ValueType_;
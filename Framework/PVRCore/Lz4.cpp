@@ -0,0 +1,270 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\Lz4.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the LZ4 block compressor and decompressor.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/Lz4.h"
+#include <cstring>
+
+namespace pvr {
+namespace lz4 {
+namespace {
+// Format constants: matches are at least c_minMatch bytes long, the last c_lastLiterals bytes of a block are literals,
+// and the last match starts at least c_matchFindLimit bytes before the end of the block.
+const size_t c_minMatch = 4;
+const size_t c_lastLiterals = 5;
+const size_t c_matchFindLimit = 12;
+const size_t c_maxOffset = 65535;
+const uint32 c_hashBits = 12;
+
+inline uint32 read32(const uint8* source)
+{
+	uint32 value;
+	memcpy(&value, source, sizeof(value));
+	return value;
+}
+
+inline uint32 hashSequence(uint32 sequence) { return (sequence * 2654435761u) >> (32 - c_hashBits); }
+
+// Copies length bytes sixteen at a time, so may write up to 15 bytes past destination + length and read as many past
+// source + length. The source must not overlap the destination, or be at least sixteen bytes before it.
+inline void wildCopy16(uint8* destination, const uint8* source, size_t length)
+{
+	uint8* const destinationEnd = destination + length;
+	do
+	{
+		memcpy(destination, source, 16);
+		destination += 16;
+		source += 16;
+	}
+	while (destination < destinationEnd);
+}
+
+// Writes the 255-valued bytes continuing a length that did not fit in its four bits of the token.
+inline uint8* writeLengthBytes(uint8* destination, size_t length)
+{
+	for (; length >= 255; length -= 255) { *destination++ = 255; }
+	*destination++ = static_cast<uint8>(length);
+	return destination;
+}
+
+// Reads the bytes continuing a length. False if the block ends first.
+inline bool readLengthBytes(const uint8*& source, const uint8* sourceEnd, size_t& length)
+{
+	uint8 byte;
+	do
+	{
+		if (source == sourceEnd) { return false; }
+		byte = *source++;
+		length += byte;
+	}
+	while (byte == 255);
+	return true;
+}
+
+// Writes a sequence: literals, then a match unless matchLength is zero (the last sequence). Null if it does not fit.
+uint8* writeSequence(uint8* destination, uint8* destinationEnd, const uint8* literals, size_t literalLength, size_t offset,
+                     size_t matchLength)
+{
+	const size_t maxSize = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+	if (maxSize > size_t(destinationEnd - destination)) { return NULL; }
+	uint8* token = destination++;
+	if (literalLength >= 15)
+	{
+		*token = 15 << 4;
+		destination = writeLengthBytes(destination, literalLength - 15);
+	}
+	else { *token = static_cast<uint8>(literalLength << 4); }
+	if (literalLength) { memcpy(destination, literals, literalLength); }
+	destination += literalLength;
+	if (matchLength)
+	{
+		*destination++ = static_cast<uint8>(offset);
+		*destination++ = static_cast<uint8>(offset >> 8);
+		matchLength -= c_minMatch;
+		if (matchLength >= 15)
+		{
+			*token |= 15;
+			destination = writeLengthBytes(destination, matchLength - 15);
+		}
+		else { *token |= static_cast<uint8>(matchLength); }
+	}
+	return destination;
+}
+}
+
+size_t compressBlock(const void* source, size_t sourceSize, void* destination, size_t destinationCapacity)
+{
+	const uint8* const begin = static_cast<const uint8*>(source);
+	const uint8* const end = begin + sourceSize;
+	uint8* const outBegin = static_cast<uint8*>(destination);
+	uint8* const outEnd = outBegin + destinationCapacity;
+	uint8* out = outBegin;
+	const uint8* anchor = begin;
+
+	if (sourceSize > c_matchFindLimit)
+	{
+		// Positions of the last sequence seen with each hash. Candidates are verified, so stale entries are harmless.
+		uint32 table[1 << c_hashBits];
+		memset(table, 0, sizeof(table));
+		const uint8* const matchLimit = end - c_lastLiterals;
+		const uint8* const searchEnd = end - c_matchFindLimit + 1;
+		const uint8* current = begin;
+		while (current < searchEnd)
+		{
+			const uint32 sequence = read32(current);
+			const uint32 hash = hashSequence(sequence);
+			const uint8* candidate = begin + table[hash];
+			table[hash] = static_cast<uint32>(current - begin);
+			if (candidate >= current || size_t(current - candidate) > c_maxOffset || read32(candidate) != sequence)
+			{
+				// Step faster through data that does not compress.
+				current += 1 + ((current - anchor) >> 6);
+				continue;
+			}
+			// Extend the match backwards over unmatched literals, then forwards.
+			while (current > anchor && candidate > begin && current[-1] == candidate[-1]) { --current; --candidate; }
+			const uint8* matchEnd = current + c_minMatch;
+			const uint8* candidateEnd = candidate + c_minMatch;
+			while (matchEnd < matchLimit && *matchEnd == *candidateEnd) { ++matchEnd; ++candidateEnd; }
+
+			out = writeSequence(out, outEnd, anchor, current - anchor, current - candidate, matchEnd - current);
+			if (!out) { return 0; }
+			current = anchor = matchEnd;
+			if (current < searchEnd)
+			{
+				table[hashSequence(read32(current - 2))] = static_cast<uint32>(current - 2 - begin);
+			}
+		}
+	}
+	out = writeSequence(out, outEnd, anchor, end - anchor, 0, 0);
+	return out ? size_t(out - outBegin) : 0;
+}
+
+bool decompressBlock(const void* source, size_t sourceSize, void* destination, size_t destinationCapacity,
+                     size_t& outDecompressedSize, size_t prefixSize)
+{
+	const uint8* in = static_cast<const uint8*>(source);
+	const uint8* const inEnd = in + sourceSize;
+	uint8* const outBegin = static_cast<uint8*>(destination);
+	uint8* const outEnd = outBegin + destinationCapacity;
+	uint8* out = outBegin;
+	outDecompressedSize = 0;
+
+	for (;;)
+	{
+		if (in == inEnd) { return false; }
+		const uint8 token = *in++;
+
+		// Most sequences have short lengths. With room to spare in both buffers, they are copied with fixed size copies.
+		if (token < 0xF0 && (token & 15) != 15 && size_t(inEnd - in) >= 32 && size_t(outEnd - out) >= 64)
+		{
+			const size_t literalLength = token >> 4;
+			memcpy(out, in, 16);
+			out += literalLength;
+			in += literalLength;
+			const size_t offset = in[0] | (size_t(in[1]) << 8);
+			in += 2;
+			if (offset == 0 || offset > size_t(out - outBegin) + prefixSize) { return false; }
+			const size_t matchLength = (token & 15) + c_minMatch;
+			const uint8* match = out - offset;
+			if (offset >= 8)
+			{
+				memcpy(out, match, 8);
+				memcpy(out + 8, match + 8, 8);
+				memcpy(out + 16, match + 16, 8);
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; ++i) { out[i] = match[i]; }
+			}
+			out += matchLength;
+			continue;
+		}
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLengthBytes(in, inEnd, literalLength)) { return false; }
+		if (literalLength > size_t(inEnd - in) || literalLength > size_t(outEnd - out)) { return false; }
+		if (literalLength <= 32 && literalLength + 16 <= size_t(inEnd - in) && literalLength + 16 <= size_t(outEnd - out))
+		{
+			wildCopy16(out, in, literalLength);
+		}
+		else if (literalLength) { memcpy(out, in, literalLength); }
+		out += literalLength;
+		in += literalLength;
+		if (in == inEnd) { break; } // The last sequence has no match
+
+		if (inEnd - in < 2) { return false; }
+		const size_t offset = in[0] | (size_t(in[1]) << 8);
+		in += 2;
+		if (offset == 0 || offset > size_t(out - outBegin) + prefixSize) { return false; }
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLengthBytes(in, inEnd, matchLength)) { return false; }
+		matchLength += c_minMatch;
+		if (matchLength > size_t(outEnd - out)) { return false; }
+
+		const uint8* match = out - offset;
+		if (offset >= 16 && matchLength + 16 <= size_t(outEnd - out)) { wildCopy16(out, match, matchLength); }
+		else if (offset >= 8 && matchLength + 8 <= size_t(outEnd - out))
+		{
+			// Each eight bytes are copied from before the destination, as the offset is at least eight.
+			uint8* const matchEnd = out + matchLength;
+			uint8* copy = out;
+			do
+			{
+				memcpy(copy, match, 8);
+				copy += 8;
+				match += 8;
+			}
+			while (copy < matchEnd);
+		}
+		else if (matchLength + 8 <= size_t(outEnd - out))
+		{
+			// Short offset: the match repeats its first offset bytes. Copy a whole number of repetitions, at least eight
+			// bytes, byte by byte, then eight bytes at a time from that far before.
+			const size_t step = offset * ((8 + offset - 1) / offset);
+			size_t i = 0;
+			for (; i < step && i < matchLength; ++i) { out[i] = match[i]; }
+			for (; i < matchLength; i += 8) { memcpy(out + i, out + i - step, 8); }
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; ++i) { out[i] = match[i]; }
+		}
+		out += matchLength;
+	}
+	outDecompressedSize = size_t(out - outBegin);
+	return true;
+}
+
+bool getDecompressedSize(const void* source, size_t sourceSize, size_t& outDecompressedSize)
+{
+	const uint8* in = static_cast<const uint8*>(source);
+	const uint8* const inEnd = in + sourceSize;
+	size_t size = 0;
+	outDecompressedSize = 0;
+	for (;;)
+	{
+		if (in == inEnd) { return false; }
+		const uint8 token = *in++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLengthBytes(in, inEnd, literalLength)) { return false; }
+		if (literalLength > size_t(inEnd - in)) { return false; }
+		in += literalLength;
+		size += literalLength;
+		if (in == inEnd) { break; }
+
+		if (inEnd - in < 2) { return false; }
+		in += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLengthBytes(in, inEnd, matchLength)) { return false; }
+		size += matchLength + c_minMatch;
+	}
+	outDecompressedSize = size;
+	return true;
+}
+}
+}
+//!\endcond
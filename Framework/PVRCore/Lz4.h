@@ -0,0 +1,66 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\Lz4.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Compression and decompression of blocks of data in the LZ4 block format.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief Self-contained implementation of the LZ4 block format, compatible with the reference LZ4 library: blocks it
+       compresses can be decompressed here and the other way around. Decompression is fast enough to be faster than
+       reading the uncompressed data from most storage, so it suits assets that are read often and written rarely.
+***********************************************************************************************************************/
+namespace lz4 {
+/*!*********************************************************************************************************************
+\brief  Get the size of a destination buffer that compressBlock cannot fail to fill.
+\param  sourceSize The size of the data to compress
+\return The size of the worst case compressed block.
+***********************************************************************************************************************/
+inline size_t getMaxCompressedSize(size_t sourceSize) { return sourceSize + sourceSize / 255 + 16; }
+
+/*!*********************************************************************************************************************
+\brief  Get the largest size that a block can decompress to. Each byte of a block decompresses to at most 255 bytes.
+\param  sourceSize The size of the compressed block
+\return The size of the largest data that a block of sourceSize bytes can decompress to.
+***********************************************************************************************************************/
+inline uint64 getMaxDecompressedSize(size_t sourceSize) { return uint64(sourceSize) * 255; }
+
+/*!*********************************************************************************************************************
+\brief  Compress a block of data.
+\param  source The data to compress
+\param  sourceSize The size of the data, in bytes
+\param[out] destination The compressed block is written here
+\param  destinationCapacity The size of destination. getMaxCompressedSize(sourceSize) bytes are always enough.
+\return The size of the compressed block, or zero if it did not fit in destination.
+***********************************************************************************************************************/
+size_t compressBlock(const void* source, size_t sourceSize, void* destination, size_t destinationCapacity);
+
+/*!*********************************************************************************************************************
+\brief  Decompress a block of data. Safe with any input: malformed blocks are rejected, never read or written outside
+        the buffers.
+\param  source The compressed block
+\param  sourceSize The size of the compressed block, in bytes
+\param[out] destination The decompressed data is written here
+\param  destinationCapacity The size of destination
+\param[out] outDecompressedSize The size of the decompressed data
+\param  prefixSize For the blocks of a linked stream, which may copy from the data decompressed before them: the
+        number of bytes before destination that hold that data (up to 64KB are used)
+\return True on success, false if the block is malformed or decompresses to more than destinationCapacity bytes.
+***********************************************************************************************************************/
+bool decompressBlock(const void* source, size_t sourceSize, void* destination, size_t destinationCapacity,
+                     size_t& outDecompressedSize, size_t prefixSize = 0);
+
+/*!*********************************************************************************************************************
+\brief  Get the size a block decompresses to, by walking its sequences without decompressing them. The offsets of the
+        matches are not validated, so decompressBlock may still reject the block.
+\param  source The compressed block
+\param  sourceSize The size of the compressed block, in bytes
+\param[out] outDecompressedSize The size of the decompressed data
+\return True on success, false if the block is malformed.
+***********************************************************************************************************************/
+bool getDecompressedSize(const void* source, size_t sourceSize, size_t& outDecompressedSize);
+}
+}
@@ -0,0 +1,82 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\NullPlatformContext.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A platform context that creates no native context or surface, for use with a null graphics context.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/OSManager.h"
+#include "PVRCore/Log.h"
+#include "PVRCore/StringFunctions.h"
+
+namespace pvr {
+namespace platform {
+/*!*********************************************************************************************************************
+\brief  IPlatformContext that does not touch the display, the window or any graphics driver. Presenting only counts the
+        frames. Used with a null graphics context (see createNullGraphicsContext) to measure the CPU cost of an
+        application on machines without a GPU (for example with the NullWS build of PVRShell and "-nullgraphics").
+***********************************************************************************************************************/
+class NullPlatformContext : public IPlatformContext
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief  Create an uninitialised platform context for an OSManager.
+	***********************************************************************************************************************/
+	explicit NullPlatformContext(OSManager& osManager) : m_osManager(osManager), m_initialised(false), m_framesPresented(0) {}
+
+	/*!*********************************************************************************************************************
+	\brief  Resolve an unspecified API to the highest one and give the display a size if the window system left it unset.
+	***********************************************************************************************************************/
+	Result::Enum init()
+	{
+		if (m_osManager.getApiTypeRequired() == Api::Unspecified)
+		{
+			m_osManager.setApiTypeRequired(getMaxApiVersion());
+			Log(Log.Information, "Unspecified target API -- Setting to max API level : %s", Api::getApiName(getMaxApiVersion()));
+		}
+		system::DisplayAttributes& attributes = m_osManager.getDisplayAttributes();
+		if (attributes.width == 0 || attributes.height == 0)
+		{
+			attributes.width = 1280;
+			attributes.height = 720;
+		}
+		m_framesPresented = 0;
+		m_initialised = true;
+		return Result::Success;
+	}
+
+	void release() { m_initialised = false; }
+
+	Result::Enum presentBackbuffer()
+	{
+		++m_framesPresented;
+		return Result::Success;
+	}
+
+	Result::Enum makeCurrent() { return Result::Success; }
+
+	std::string getInfo()
+	{
+		return strings::createFormatted("\nNull platform context: no native context, %u frames presented\n", m_framesPresented);
+	}
+
+	bool isInitialised() { return m_initialised; }
+
+	size_t getID() { return 0; }
+
+	Api::Enum getMaxApiVersion() { return Api::OpenGLESMaxVersion; }
+
+	bool isApiSupported(Api::Enum api) { return api >= Api::OpenGLES2 && api <= Api::OpenGLESMaxVersion; }
+
+	/*!*********************************************************************************************************************
+	\return The number of frames presented since init().
+	***********************************************************************************************************************/
+	uint32 getNumFramesPresented() const { return m_framesPresented; }
+
+private:
+	OSManager& m_osManager;
+	bool m_initialised;
+	uint32 m_framesPresented;
+};
+}
+}
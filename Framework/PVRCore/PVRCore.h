@@ -8,9 +8,13 @@
 #include "PVRCore/CoreIncludes.h"
 #include "PVRCore/RefCounted.h"
 #include "PVRCore/AxisAlignedBox.h"
+#include "PVRCore/AxisAlignedBoxArray.h"
+#include "PVRCore/BoundingVolumeHierarchy.h"
 #include "PVRCore/FileStream.h"
 #include "PVRCore/BufferStream.h"
+#include "PVRCore/PackFile.h"
 #include "PVRCore/RingBuffer.h"
+#include "PVRCore/ConcurrentQueue.h"
 #include "PVRCore/StringFunctions.h"
 #include "PVRCore/Time_.h"
 #include "PVRCore/UnicodeConverter.h"
@@ -27,11 +31,11 @@
 PVRCore is the supporting code of the library that you can leverage for your own use. PVRCore is also used by the rest of the Framework and because of that, all examples using any other part of the Framework should link with PVRCore. An example of code that can be found in PVRCore:
 <ul>
 	<li>Interfaces that bind other modules together (e.g. <span class="code">GraphicsContext.h</span>, <span class="code">OSManager.h</span>)</li>
-	<li>Utility classes and specialized data structures used by the Framework (<span class="code">RingBuffer.h</span>, <span class="code">ListOfInterfaces.h</span>)</li>
+	<li>Utility classes and specialized data structures used by the Framework (<span class="code">RingBuffer.h</span>, <span class="code">ConcurrentQueue.h</span>, <span class="code">ListOfInterfaces.h</span>)</li>
 	<li>The main Smart Pointer class used by the Framework (<span class="code">RefCounted.h</span>)</li>
-	<li>Data streams (e.g. <span class="code">FileStream.h</span>, <span class="code">BufferStream.h</span>)</li>
+	<li>Data streams (e.g. <span class="code">FileStream.h</span>, <span class="code">BufferStream.h</span>), pack files of many assets (<span class="code">PackFile.h</span>) and LZ4 compressed assets (<span class="code">CompressedStream.h</span>)</li>
 	<li>Logging and error reporting (<span class="code">Log.h</span>)</li>
-	<li>Special math (bounding boxes, shadow volumes)</li>
+	<li>Special math (bounding boxes, batch box transform and frustum culling in <span class="code">AxisAlignedBoxArray.h</span>, shadow volumes)</li>
 </ul>
 
 In general, you have to include files from here only if you wish to utilise a specific functionality (most commonly Streams, Log or Refcounted). That said, most of that functionality is core to the rest of the Framework and at least the basic classes would be exposed. Unlike our old Framework, PVRCore uses the Standard Template Library and Generalized Linear Models. It is also completely API agnostic, and mostly platform agnostic (it retains some platform dependence so as to create the platform abstractions). 
@@ -62,10 +66,37 @@ pvr::BufferStream myTexture(myTextureInMemory);
 
 Everything that deals with file/asset data uses streams. Also includes <span class="code">WindowsResourceStream</span>, <span class="code">AndroidAssetStream</span>
 
+To read a large file while parsing it, as when loading models and textures from slow storage, use an
+<span class="code">AsyncFileStream</span> (<span class="code">AsyncFileStream.h</span>) instead of a FileStream: it reads
+ahead on a background thread.
+
+\code
+pvr::assets::PODReader reader(pvr::Stream::ptr_type(new pvr::AsyncFileStream("scene.pod")));
+\endcode
+
+Assets compressed with the lz4 tool ("lz4 -BI scene.pod scene.pod.lz4") are read through a
+<span class="code">CompressedStream</span> (<span class="code">CompressedStream.h</span>), which decompresses them as
+they are read. The Shell does this by itself, once enabled with Shell::setLoadCompressedAssets, when an asset is
+found with the ".lz4" extension.
+
+\code
+pvr::assets::PODReader reader(pvr::Stream::ptr_type(new pvr::CompressedStream(
+                                pvr::Stream::ptr_type(new pvr::FileStream("scene.pod.lz4", "rb")))));
+\endcode
+
 \code
 pvr::Logger myLog; 
 myLog.setMessenger(myCustomFileLoggingMessenger);
 myLog(“I am logging this in my custom logger”);
 pvr::Log(Log.Verbose, “Usually I will just be using the global PowerVR Log object. Nobody likes globals, except for logging…”);
 \endcode
+
+Logging formats and writes on the calling thread. To move that work to a background thread, wrap the messenger in an
+<span class="code">AsyncMessenger</span> (<span class="code">AsyncMessenger.h</span>):
+
+\code
+pvr::system::ConsoleMessenger console;
+pvr::system::AsyncMessenger asyncMessenger(console);
+pvr::Log.setMessageHandler(&asyncMessenger);
+\endcode
 */
\ No newline at end of file
@@ -0,0 +1,354 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\PackFile.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the PackFile, PackStream and PackFileWriter classes.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include <cstring>
+#include <algorithm>
+
+#include "PVRCore/PackFile.h"
+#include "PVRCore/Lz4.h"
+#include "PVRCore/Log.h"
+using std::string;
+namespace pvr {
+namespace {
+inline char8 normaliseSeparator(char8 character) { return character == '\\' ? '/' : character; }
+
+bool writeBytes(Stream& output, const void* data, size_t size)
+{
+	size_t written = 0;
+	return size == 0 || (output.write(1, size, data, written) && written == size);
+}
+}
+
+uint32 PackFile::hashName(const char8* name, size_t length)
+{
+	// Same as hash32_bytes, on the name with normalised separators.
+	uint32 hashValue = 2166136261U;
+	for (size_t i = 0; i < length; ++i) { hashValue = (hashValue * 16777619U) ^ static_cast<unsigned char>(normaliseSeparator(name[i])); }
+	return hashValue;
+}
+
+bool PackFile::open(Stream::ptr_type stream)
+{
+	static_assert(sizeof(Header) == 32, "The pack file header must be 32 bytes");
+	static_assert(sizeof(Entry) == 32, "The pack file entries must be 32 bytes");
+	close();
+	if (!stream.get() || (!stream->isopen() && !stream->open())) { return false; }
+
+	Header header;
+	size_t dataRead = 0;
+	if (!stream->read(sizeof(header), 1, &header, dataRead) || dataRead != 1 || header.magic != c_magic)
+	{
+		Log(Log.Error, "[PackFile::open] %s is not a pack file.", stream->getFileName().c_str());
+		return false;
+	}
+	if (header.version != c_version)
+	{
+		Log(Log.Error, "[PackFile::open] %s has unsupported version %u.", stream->getFileName().c_str(), header.version);
+		return false;
+	}
+	const uint64 streamSize = stream->getSize();
+	if (sizeof(Header) + uint64(header.numEntries) * sizeof(Entry) + header.namesSize > streamSize)
+	{
+		Log(Log.Error, "[PackFile::open] %s is truncated.", stream->getFileName().c_str());
+		return false;
+	}
+	m_entries.resize(header.numEntries);
+	m_names.resize(header.namesSize);
+	if ((header.numEntries && (!stream->read(sizeof(Entry), header.numEntries, m_entries.data(), dataRead) ||
+	                           dataRead != header.numEntries)) ||
+	    (header.namesSize && (!stream->read(1, header.namesSize, m_names.data(), dataRead) || dataRead != header.namesSize)))
+	{
+		Log(Log.Error, "[PackFile::open] Could not read the index of %s.", stream->getFileName().c_str());
+		close();
+		return false;
+	}
+
+	for (uint32 i = 0; i < header.numEntries; ++i)
+	{
+		const Entry& entry = m_entries[i];
+		const bool valid = uint64(entry.nameOffset) + entry.nameLength < header.namesSize &&
+		                   m_names[entry.nameOffset + entry.nameLength] == '\0' && entry.offset <= streamSize &&
+		                   entry.storedSize <= streamSize - entry.offset &&
+		                   ((entry.compression == CompressionLz4 && entry.size <= lz4::getMaxDecompressedSize(entry.storedSize)) ||
+		                    (entry.compression == CompressionNone && entry.storedSize == entry.size)) &&
+		                   (i == 0 || m_entries[i - 1].nameHash <= entry.nameHash);
+		if (!valid)
+		{
+			Log(Log.Error, "[PackFile::open] Entry %u of %s is corrupt.", i, stream->getFileName().c_str());
+			close();
+			return false;
+		}
+	}
+
+	// About one bucket per entry, so that each lookup compares a name or two.
+	uint32 bucketBits = 0;
+	while ((1u << bucketBits) < header.numEntries && bucketBits < 16) { ++bucketBits; }
+	m_bucketShift = 32 - bucketBits;
+	const uint32 numBuckets = 1u << bucketBits;
+	m_buckets.resize(numBuckets + 1);
+	uint32 entry = 0;
+	for (uint32 bucket = 0; bucket <= numBuckets; ++bucket)
+	{
+		while (entry < header.numEntries && (bucketBits ? m_entries[entry].nameHash >> m_bucketShift : 0) < bucket) { ++entry; }
+		m_buckets[bucket] = entry;
+	}
+
+	m_source.construct();
+	m_source->stream = stream;
+	return true;
+}
+
+void PackFile::close()
+{
+	m_source.reset();
+	m_entries.clear();
+	m_names.clear();
+	m_buckets.clear();
+	m_bucketShift = 32;
+}
+
+int32 PackFile::findEntry(const string& name) const
+{
+	if (m_entries.empty()) { return -1; }
+	const uint32 hash = hashName(name.data(), name.size());
+	const uint32 bucket = (m_bucketShift < 32 ? hash >> m_bucketShift : 0);
+	for (uint32 i = m_buckets[bucket]; i < m_buckets[bucket + 1] && m_entries[i].nameHash <= hash; ++i)
+	{
+		const Entry& entry = m_entries[i];
+		if (entry.nameHash != hash || entry.nameLength != name.size()) { continue; }
+		const char8* entryName = m_names.data() + entry.nameOffset;
+		size_t character = 0;
+		while (character < name.size() && entryName[character] == normaliseSeparator(name[character])) { ++character; }
+		if (character == name.size()) { return static_cast<int32>(i); }
+	}
+	return -1;
+}
+
+Stream::ptr_type PackFile::openStream(const string& name) const
+{
+	const int32 entry = findEntry(name);
+	if (entry == -1) { return Stream::ptr_type(); }
+	Stream::ptr_type stream(new PackStream(getEntryName(entry), m_source, m_entries[entry]));
+	if (!stream->open()) { return Stream::ptr_type(); }
+	return stream;
+}
+
+bool PackStream::readSource(uint64 offset, size_t size, void* buffer) const
+{
+	std::lock_guard<std::mutex> lock(m_source->mutex);
+	size_t dataRead = 0;
+	return m_source->stream->seek(static_cast<long>(offset), SeekOriginFromStart) &&
+	       m_source->stream->read(1, size, buffer, dataRead) && dataRead == size;
+}
+
+bool PackStream::open() const
+{
+	if (m_isOpen)
+	{
+		m_position = 0;
+		return true;
+	}
+	if (m_entry.compression == PackFile::CompressionLz4)
+	{
+		std::vector<char8> compressed(m_entry.storedSize);
+		m_data.resize(m_entry.size);
+		size_t decompressedSize = 0;
+		if (!readSource(m_entry.offset, compressed.size(), compressed.data()) ||
+		    !lz4::decompressBlock(compressed.data(), compressed.size(), m_data.data(), m_data.size(), decompressedSize) ||
+		    decompressedSize != m_entry.size)
+		{
+			Log(Log.Error, "[PackStream::open] Could not decompress %s.", m_fileName.c_str());
+			std::vector<char8>().swap(m_data);
+			return false;
+		}
+	}
+	m_position = 0;
+	m_isOpen = true;
+	return true;
+}
+
+void PackStream::close()
+{
+	std::vector<char8>().swap(m_data);
+	m_isOpen = false;
+}
+
+bool PackStream::read(size_t elementSize, size_t elementCount, void* buffer, size_t& dataRead) const
+{
+	dataRead = 0;
+	if (!m_isOpen)
+	{
+		Log("[PackStream::read] Attempted to read empty stream.");
+		PVR_ASSERT(0 && "[PackStream::read] Attempted to read empty stream.");
+		return false;
+	}
+	if (elementSize == 0) { return true; }
+
+	const size_t available = (m_entry.size - m_position) / elementSize;
+	if (available < elementCount)
+	{
+		Log(Log.Debug, "[PackStream::read] Was attempting to read past the end of stream ");
+		elementCount = available;
+	}
+	const size_t size = elementCount * elementSize;
+	if (m_entry.compression == PackFile::CompressionLz4) { memcpy(buffer, m_data.data() + m_position, size); }
+	else if (size && !readSource(m_entry.offset + m_position, size, buffer))
+	{
+		Log(Log.Error, "[PackStream::read] Failure reading %s.", m_fileName.c_str());
+		return false;
+	}
+	m_position += size;
+	dataRead = elementCount;
+	return true;
+}
+
+bool PackStream::write(size_t, size_t, const void*, size_t& dataWritten)
+{
+	dataWritten = 0;
+	Log("[PackStream::write] Attempted to write a read only stream.");
+	PVR_ASSERT(0 && "[PackStream::write] Attempted to write a read only stream.");
+	return false;
+}
+
+bool PackStream::seek(long offset, SeekOrigin origin) const
+{
+	const size_t size = m_entry.size;
+	const size_t base = (origin == SeekOriginFromStart ? 0 : origin == SeekOriginFromCurrent ? m_position : size);
+	if ((offset < 0 && static_cast<size_t>(-offset) > base) || (offset > 0 && static_cast<size_t>(offset) > size - base))
+	{
+		Log(Log.Debug, "[PackStream::seek] Was attempting to seek outside the stream ");
+		return false;
+	}
+	m_position = base + offset;
+	return true;
+}
+
+bool PackFileWriter::addEntry(const string& name, const void* data, size_t size, PackFile::Compression compression)
+{
+	string normalisedName(name);
+	std::replace(normalisedName.begin(), normalisedName.end(), '\\', '/');
+	if (size > 0xFFFFFFFFu)
+	{
+		Log(Log.Error, "[PackFileWriter::addEntry] %s is too large for a pack file.", name.c_str());
+		return false;
+	}
+	if (!m_names.insert(normalisedName).second)
+	{
+		Log(Log.Error, "[PackFileWriter::addEntry] The pack already has an entry named %s.", name.c_str());
+		return false;
+	}
+
+	m_entries.push_back(PendingEntry());
+	PendingEntry& entry = m_entries.back();
+	entry.name.swap(normalisedName);
+	entry.size = static_cast<uint32>(size);
+	entry.compression = PackFile::CompressionNone;
+	if (compression == PackFile::CompressionLz4 && size)
+	{
+		entry.data.resize(lz4::getMaxCompressedSize(size));
+		const size_t compressedSize = lz4::compressBlock(data, size, entry.data.data(), entry.data.size());
+		if (compressedSize && compressedSize < size)
+		{
+			entry.data.resize(compressedSize);
+			entry.compression = PackFile::CompressionLz4;
+		}
+	}
+	if (entry.compression == PackFile::CompressionNone)
+	{
+		const char8* bytes = static_cast<const char8*>(data);
+		entry.data.assign(bytes, bytes + size);
+	}
+	return true;
+}
+
+bool PackFileWriter::addEntry(const string& name, const Stream& stream, PackFile::Compression compression)
+{
+	const size_t size = stream.getSize() - stream.getPosition();
+	std::vector<char8> data(size);
+	size_t dataRead = 0;
+	if (size && (!stream.read(1, size, data.data(), dataRead) || dataRead != size))
+	{
+		Log(Log.Error, "[PackFileWriter::addEntry] Could not read %s.", stream.getFileName().c_str());
+		return false;
+	}
+	return addEntry(name, data.data(), size, compression);
+}
+
+namespace {
+struct EntryOrder
+{
+	const std::vector<uint32>& hashes;
+	const std::vector<string>& names;
+	bool operator()(uint32 lhs, uint32 rhs) const
+	{
+		return hashes[lhs] != hashes[rhs] ? hashes[lhs] < hashes[rhs] : names[lhs] < names[rhs];
+	}
+};
+}
+
+bool PackFileWriter::write(Stream& output) const
+{
+	const uint32 numEntries = static_cast<uint32>(m_entries.size());
+	std::vector<uint32> hashes(numEntries);
+	std::vector<string> names(numEntries);
+	std::vector<uint32> order(numEntries);
+	for (uint32 i = 0; i < numEntries; ++i)
+	{
+		names[i] = m_entries[i].name;
+		hashes[i] = PackFile::hashName(names[i].data(), names[i].size());
+		order[i] = i;
+	}
+	const EntryOrder entryOrder = { hashes, names };
+	std::sort(order.begin(), order.end(), entryOrder);
+
+	std::vector<char8> packNames;
+	std::vector<PackFile::Entry> entries(numEntries);
+	for (uint32 i = 0; i < numEntries; ++i)
+	{
+		const PendingEntry& pending = m_entries[order[i]];
+		PackFile::Entry& entry = entries[i];
+		entry.nameHash = hashes[order[i]];
+		entry.nameOffset = static_cast<uint32>(packNames.size());
+		entry.nameLength = static_cast<uint32>(pending.name.size());
+		entry.compression = pending.compression;
+		entry.storedSize = static_cast<uint32>(pending.data.size());
+		entry.size = pending.size;
+		packNames.insert(packNames.end(), pending.name.begin(), pending.name.end());
+		packNames.push_back('\0');
+	}
+	uint64 offset = sizeof(PackFile::Header) + uint64(numEntries) * sizeof(PackFile::Entry) + packNames.size();
+	for (uint32 i = 0; i < numEntries; ++i)
+	{
+		offset = (offset + m_alignment - 1) / m_alignment * m_alignment;
+		entries[i].offset = offset;
+		offset += entries[i].storedSize;
+	}
+
+	PackFile::Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = PackFile::c_magic;
+	header.version = PackFile::c_version;
+	header.numEntries = numEntries;
+	header.alignment = m_alignment;
+	header.namesSize = static_cast<uint32>(packNames.size());
+	bool result = writeBytes(output, &header, sizeof(header)) &&
+	              writeBytes(output, entries.data(), entries.size() * sizeof(PackFile::Entry)) &&
+	              writeBytes(output, packNames.data(), packNames.size());
+	uint64 position = sizeof(PackFile::Header) + uint64(numEntries) * sizeof(PackFile::Entry) + packNames.size();
+	const std::vector<char8> padding(m_alignment, 0);
+	for (uint32 i = 0; i < numEntries && result; ++i)
+	{
+		const std::vector<char8>& data = m_entries[order[i]].data;
+		result = writeBytes(output, padding.data(), static_cast<size_t>(entries[i].offset - position)) &&
+		         writeBytes(output, data.data(), data.size());
+		position = entries[i].offset + data.size();
+	}
+	if (!result) { Log(Log.Error, "[PackFileWriter::write] Failure writing %s.", output.getFileName().c_str()); }
+	return result;
+}
+}
+//!\endcond
@@ -0,0 +1,261 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\PackFile.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Pack files: many assets stored in a single file, with an index to find them by name.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/Stream.h"
+#include "PVRCore/RefCounted.h"
+#include <mutex>
+#include <set>
+
+namespace pvr {
+//!\cond NO_DOXYGEN
+namespace impl {
+// The stream of a pack, shared by the PackFile and the streams of its entries, which seek it under the mutex.
+struct PackFileSource
+{
+	Stream::ptr_type stream;
+	mutable std::mutex mutex;
+};
+}
+//!\endcond
+}
+PVR_ATOMIC_REFCOUNT(impl::PackFileSource)
+
+namespace pvr {
+class PackStream;
+
+/*!*********************************************************************************************************************
+\brief     A read only archive of named entries (assets), read from any Stream.
+\description Opening many loose files is slow on some file systems (each asset costs a few open() and stat() calls,
+           once per read path tried). A pack file is opened once, and its entries are then found by name in constant
+           time, through an index sorted by the hash of the names, and read through the pack's stream.
+           File layout (little endian):
+           <ul>
+           <li>Header: magic "PVPK", version, number of entries, alignment of the data, size of the names</li>
+           <li>Index: one Entry per asset, sorted by the hash of its name (then by name)</li>
+           <li>Names: the null terminated names of the entries</li>
+           <li>Data: the data of each entry, at an offset that is a multiple of the alignment, so that a memory mapped
+           pack can be used in place</li>
+           </ul>
+           Each entry is stored either as is, or compressed with LZ4 (see Lz4.h). Names are case sensitive, and '\\'
+           and '/' are equivalent. Use PackFileWriter to create pack files.
+***********************************************************************************************************************/
+class PackFile
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief How an entry is stored.
+	***********************************************************************************************************************/
+	enum Compression
+	{
+		CompressionNone, //!< Stored as is
+		CompressionLz4   //!< Compressed as a single LZ4 block, decompressed when the entry is opened
+	};
+
+	PackFile() : m_bucketShift(32) {}
+
+	/*!*********************************************************************************************************************
+	\brief Read the index of a pack.
+	\param stream The pack. Kept by the PackFile and by the streams it opens, which read from it.
+	\return True on success, false if the stream is not a valid pack file.
+	***********************************************************************************************************************/
+	bool open(Stream::ptr_type stream);
+
+	/*!*********************************************************************************************************************
+	\brief Release the index and the stream of the pack. Streams already opened keep working.
+	***********************************************************************************************************************/
+	void close();
+
+	/*!*********************************************************************************************************************
+	\return True if a pack is open.
+	***********************************************************************************************************************/
+	bool isOpen() const { return m_source.isValid(); }
+
+	/*!*********************************************************************************************************************
+	\return The number of entries of the pack.
+	***********************************************************************************************************************/
+	uint32 getNumEntries() const { return (uint32)m_entries.size(); }
+
+	/*!*********************************************************************************************************************
+	\param entry The index of an entry, between 0 and getNumEntries()
+	\return The name of the entry.
+	***********************************************************************************************************************/
+	const char8* getEntryName(uint32 entry) const { return m_names.data() + m_entries[entry].nameOffset; }
+
+	/*!*********************************************************************************************************************
+	\param name The name of an entry
+	\return True if the pack contains an entry with this name.
+	***********************************************************************************************************************/
+	bool contains(const string& name) const { return findEntry(name) != -1; }
+
+	/*!*********************************************************************************************************************
+	\brief Create a stream reading an entry. Several streams can be read at once, from different threads.
+	\param name The name of the entry
+	\return An open stream, or NULL if the pack has no entry with this name or the entry could not be read.
+	***********************************************************************************************************************/
+	Stream::ptr_type openStream(const string& name) const;
+
+private:
+	friend class PackStream;
+	friend class PackFileWriter;
+
+	struct Header
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 numEntries;
+		uint32 alignment;
+		uint32 namesSize;
+		uint32 reserved[3];
+	};
+
+	struct Entry
+	{
+		uint32 nameHash;
+		uint32 nameOffset; // In the names
+		uint32 nameLength;
+		uint32 compression;
+		uint64 offset; // From the start of the pack
+		uint32 storedSize;
+		uint32 size;
+	};
+
+	static const uint32 c_magic = 0x4B505650; // "PVPK"
+	static const uint32 c_version = 1;
+
+	static uint32 hashName(const char8* name, size_t length);
+	int32 findEntry(const string& name) const;
+
+	RefCountedResource<impl::PackFileSource> m_source;
+	std::vector<Entry> m_entries;
+	std::vector<char8> m_names;
+	std::vector<uint32> m_buckets; // First entry of each range of hash values, indexed by the top bits of the hash
+	uint32 m_bucketShift;
+};
+
+/*!*********************************************************************************************************************
+\brief     A read only stream over an entry of a PackFile. Created by PackFile::openStream.
+***********************************************************************************************************************/
+class PackStream : public Stream
+{
+public:
+	/*!********************************************************************************************************
+	\brief    Main read function. Read up to a specified amount of items into the provided buffer.
+	\param[in]  elementSize  The size of each element that will be read.
+	\param[in]  elementCount  The maximum number of elements to read.
+	\param[in]  buffer  The buffer into which to write the data.
+	\param[out]  dataRead  After returning, will contain the number of items that were actually read.
+	\return   Success if successful, error code otherwise.
+	**********************************************************************************************************/
+	virtual bool read(size_t elementSize, size_t elementCount, void* buffer, size_t& dataRead) const;
+
+	/*!********************************************************************************************************
+	\brief    Not supported: the stream is read only.
+	\return   False.
+	**********************************************************************************************************/
+	virtual bool write(size_t elementSize, size_t elementCount, const void* buffer, size_t& dataWritten);
+
+	/*!********************************************************************************************************
+	\brief    Seek a specific point in the entry.
+	\param[in]  offset  The offset to seek from "origin".
+	\param[in]  origin  Beginning of stream, End of stream or Current position.
+	\return   True if successful, false if the new position would be outside the entry.
+	**********************************************************************************************************/
+	virtual bool seek(long offset, SeekOrigin origin) const;
+
+	/*!********************************************************************************************************
+	\brief    Prepare the stream for reading, decompressing the entry if it is compressed. If already open, seeks
+	          to the start.
+	\return   True if successful, false if the entry could not be read.
+	**********************************************************************************************************/
+	virtual bool open() const;
+
+	/*!********************************************************************************************************
+	\brief    Close the stream, releasing the decompressed data.
+	**********************************************************************************************************/
+	virtual void close();
+
+	/*!********************************************************************************************************
+	\return   True if the stream is open and ready for other operations.
+	**********************************************************************************************************/
+	virtual bool isopen() const { return m_isOpen; }
+
+	/*!********************************************************************************************************
+	\return   The current position in the entry.
+	**********************************************************************************************************/
+	virtual size_t getPosition() const { return m_position; }
+
+	/*!********************************************************************************************************
+	\return   The size of the entry, uncompressed.
+	**********************************************************************************************************/
+	virtual size_t getSize() const { return m_entry.size; }
+
+private:
+	friend class PackFile;
+	PackStream(const string& name, const RefCountedResource<impl::PackFileSource>& source, const PackFile::Entry& entry)
+		: Stream(name), m_source(source), m_entry(entry), m_position(0), m_isOpen(false) { m_isReadable = true; }
+	bool readSource(uint64 offset, size_t size, void* buffer) const;
+
+	RefCountedResource<impl::PackFileSource> m_source;
+	PackFile::Entry m_entry;
+	mutable std::vector<char8> m_data; // The decompressed entry
+	mutable size_t m_position;
+	mutable bool m_isOpen;
+};
+
+/*!*********************************************************************************************************************
+\brief     Creates pack files, to be read with PackFile. Typically used by tools.
+***********************************************************************************************************************/
+class PackFileWriter
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor.
+	\param alignment The data of each entry will start at a multiple of this from the start of the pack. Use the page
+	       size (4096) to use the entries of a memory mapped pack in place.
+	***********************************************************************************************************************/
+	explicit PackFileWriter(uint32 alignment = 16) : m_alignment(alignment ? alignment : 1) {}
+
+	/*!*********************************************************************************************************************
+	\brief Add an entry. The data is copied, and compressed if requested.
+	\param name The name of the entry
+	\param data The data of the entry
+	\param size The size of the data
+	\param compression CompressionLz4 to compress the entry. It is stored as is anyway if it does not compress.
+	\return True on success, false if the pack already has an entry with this name.
+	***********************************************************************************************************************/
+	bool addEntry(const string& name, const void* data, size_t size,
+	              PackFile::Compression compression = PackFile::CompressionNone);
+
+	/*!*********************************************************************************************************************
+	\brief Add an entry from the contents of a stream.
+	\param name The name of the entry
+	\param stream An open stream. Read from its current position to its end.
+	\param compression CompressionLz4 to compress the entry. It is stored as is anyway if it does not compress.
+	\return True on success, false if the stream could not be read or the pack already has an entry with this name.
+	***********************************************************************************************************************/
+	bool addEntry(const string& name, const Stream& stream, PackFile::Compression compression = PackFile::CompressionNone);
+
+	/*!*********************************************************************************************************************
+	\brief Write the pack.
+	\param output A writable stream
+	\return True on success, false if writing failed.
+	***********************************************************************************************************************/
+	bool write(Stream& output) const;
+
+private:
+	struct PendingEntry
+	{
+		string name;
+		uint32 compression;
+		uint32 size;
+		std::vector<char8> data;
+	};
+	std::vector<PendingEntry> m_entries;
+	std::set<string> m_names;
+	uint32 m_alignment;
+};
+}
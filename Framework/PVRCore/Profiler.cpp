@@ -0,0 +1,336 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\Profiler.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the Profiler and ProfileZone classes.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/Profiler.h"
+#include "PVRCore/ConcurrentQueue.h"
+#include "PVRCore/Log.h"
+#include "PVRCore/ThreadLocalPointer.h"
+#include "PVRCore/Time_.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace pvr {
+namespace details {
+struct ProfilerThreadBuffer : public CacheLineAlignedNew
+{
+	SpscQueue<Profiler::Zone> zones; // Pushed by the owning thread, popped under the profiler's mutex
+	const uint32 threadId;
+	uint32 depth; // Zones of the owning thread currently entered. Owning thread only.
+	std::atomic<bool> retired; // The owning thread has exited
+	std::atomic<uint64> dropped;
+
+	explicit ProfilerThreadBuffer(uint32 threadId) : zones(Profiler::c_threadBufferSize), threadId(threadId), depth(0),
+		retired(false), dropped(0) {}
+};
+}
+
+namespace {
+struct ZoneStatistics
+{
+	const char* name;
+	uint32 depth;
+	uint64 frameNanoSecs; // Totals of the current frame
+	uint32 frameCalls;
+	uint64 historyNanoSecs[Profiler::c_summaryFrames]; // Totals of the last frames
+	uint32 historyCalls[Profiler::c_summaryFrames];
+};
+
+struct ProfilerState
+{
+	std::atomic<bool> enabled;
+	std::mutex mutex; // Protects everything below
+	std::vector<details::ProfilerThreadBuffer*> threads;
+	uint32 nextThreadId;
+	uint64 droppedByRetiredThreads;
+	std::vector<Profiler::Zone> history; // Ring of the most recent zones
+	size_t historyNext;
+	std::map<const char*, uint32> statisticsByPointer;
+	std::map<std::string, uint32> statisticsByName; // Identical names may be at different addresses
+	std::vector<ZoneStatistics> statistics;
+	uint32 frameIndex;
+	uint32 numFrames;
+
+	ProfilerState() : enabled(false), nextThreadId(0), droppedByRetiredThreads(0), historyNext(0), frameIndex(0),
+		numFrames(0) {}
+
+	ZoneStatistics& getStatistics(const Profiler::Zone& zone)
+	{
+		std::map<const char*, uint32>::iterator found = statisticsByPointer.find(zone.name);
+		if (found != statisticsByPointer.end()) { return statistics[found->second]; }
+		std::map<std::string, uint32>::iterator foundByName = statisticsByName.find(zone.name);
+		uint32 index;
+		if (foundByName != statisticsByName.end()) { index = foundByName->second; }
+		else
+		{
+			index = (uint32)statistics.size();
+			statisticsByName[zone.name] = index;
+			ZoneStatistics newStatistics = {};
+			newStatistics.name = zone.name;
+			newStatistics.depth = zone.depth;
+			statistics.push_back(newStatistics);
+		}
+		statisticsByPointer[zone.name] = index;
+		return statistics[index];
+	}
+
+	// Move the zones out of the thread buffers. Mutex must be held.
+	void collect()
+	{
+		for (size_t i = 0; i < threads.size();)
+		{
+			details::ProfilerThreadBuffer* buffer = threads[i];
+			// Read before draining: once retired, the thread pushes nothing more.
+			const bool retired = buffer->retired.load(std::memory_order_acquire);
+			Profiler::Zone zone;
+			while (buffer->zones.pop_front(zone))
+			{
+				zone.beginNanoSecs = Time::rawTicksToNanoSecs(zone.beginNanoSecs);
+				zone.endNanoSecs = Time::rawTicksToNanoSecs(zone.endNanoSecs);
+				if (history.size() < Profiler::c_maxRecordedZones) { history.push_back(zone); }
+				else { history[historyNext] = zone; }
+				historyNext = (historyNext + 1) % Profiler::c_maxRecordedZones;
+				ZoneStatistics& zoneStatistics = getStatistics(zone);
+				zoneStatistics.frameNanoSecs += zone.endNanoSecs - zone.beginNanoSecs;
+				++zoneStatistics.frameCalls;
+			}
+			if (retired)
+			{
+				droppedByRetiredThreads += buffer->dropped.load(std::memory_order_relaxed);
+				delete buffer;
+				threads.erase(threads.begin() + i);
+			}
+			else { ++i; }
+		}
+	}
+};
+
+// Never destroyed, as threads may record zones while static objects are destroyed.
+ProfilerState& getState()
+{
+	static ProfilerState* state = new ProfilerState;
+	return *state;
+}
+
+// Value of the thread buffer slot once the thread has exited, so that zones recorded by later thread exit callbacks
+// are dropped.
+details::ProfilerThreadBuffer* const c_exitedThreadBuffer = reinterpret_cast<details::ProfilerThreadBuffer*>(1);
+
+void PVR_TLS_CALLBACK retireThreadBuffer(void* value);
+
+// The buffer of the calling thread, retired when the thread exits. Never destroyed, like the state.
+ThreadLocalPointer& getThreadBufferSlot()
+{
+	static ThreadLocalPointer* slot = new ThreadLocalPointer(&retireThreadBuffer);
+	return *slot;
+}
+
+void PVR_TLS_CALLBACK retireThreadBuffer(void* value)
+{
+	if (value != c_exitedThreadBuffer)
+	{
+		static_cast<details::ProfilerThreadBuffer*>(value)->retired.store(true, std::memory_order_release);
+	}
+	getThreadBufferSlot().set(c_exitedThreadBuffer);
+}
+
+details::ProfilerThreadBuffer* getThreadBuffer()
+{
+	ThreadLocalPointer& slot = getThreadBufferSlot();
+	details::ProfilerThreadBuffer* buffer = static_cast<details::ProfilerThreadBuffer*>(slot.get());
+	if (buffer == c_exitedThreadBuffer) { return NULL; }
+	if (!buffer)
+	{
+		ProfilerState& state = getState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		buffer = new details::ProfilerThreadBuffer(state.nextThreadId++);
+		state.threads.push_back(buffer);
+		slot.set(buffer);
+	}
+	return buffer;
+}
+
+// Write a string as the contents of a JSON string.
+void appendEscaped(std::string& out, const char* str)
+{
+	for (; *str; ++str)
+	{
+		const unsigned char character = (unsigned char)*str;
+		if (character == '"' || character == '\\') { out += '\\'; out += *str; }
+		else if (character < 0x20)
+		{
+			char escaped[8];
+			sprintf(escaped, "\\u%04x", character);
+			out += escaped;
+		}
+		else { out += *str; }
+	}
+}
+
+bool writeString(Stream& stream, const std::string& str)
+{
+	size_t dataWritten = 0;
+	return str.empty() || (stream.write(1, str.size(), str.data(), dataWritten) && dataWritten == str.size());
+}
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	getState().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled()
+{
+	return getState().enabled.load(std::memory_order_relaxed);
+}
+
+uint64 Profiler::getCurrentTimeNanoSecs()
+{
+	return Time::rawTicksToNanoSecs(Time::rawTicks());
+}
+
+void Profiler::endFrame()
+{
+	ProfilerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.collect();
+	for (size_t i = 0; i < state.statistics.size(); ++i)
+	{
+		ZoneStatistics& zoneStatistics = state.statistics[i];
+		zoneStatistics.historyNanoSecs[state.frameIndex] = zoneStatistics.frameNanoSecs;
+		zoneStatistics.historyCalls[state.frameIndex] = zoneStatistics.frameCalls;
+		zoneStatistics.frameNanoSecs = 0;
+		zoneStatistics.frameCalls = 0;
+	}
+	state.frameIndex = (state.frameIndex + 1) % c_summaryFrames;
+	state.numFrames = std::min<uint32>(state.numFrames + 1, c_summaryFrames);
+}
+
+void Profiler::getSummary(std::vector<ZoneSummary>& summary)
+{
+	ProfilerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	summary.resize(state.statistics.size());
+	for (size_t i = 0; i < state.statistics.size(); ++i)
+	{
+		const ZoneStatistics& zoneStatistics = state.statistics[i];
+		uint64 totalNanoSecs = 0, maxNanoSecs = 0, totalCalls = 0;
+		// Frames not yet seen are still zero.
+		for (uint32 frame = 0; frame < c_summaryFrames; ++frame)
+		{
+			totalNanoSecs += zoneStatistics.historyNanoSecs[frame];
+			maxNanoSecs = std::max(maxNanoSecs, zoneStatistics.historyNanoSecs[frame]);
+			totalCalls += zoneStatistics.historyCalls[frame];
+		}
+		const float64 numFrames = state.numFrames ? (float64)state.numFrames : 1.0;
+		summary[i].name = zoneStatistics.name;
+		summary[i].depth = zoneStatistics.depth;
+		summary[i].callsPerFrame = (float32)(totalCalls / numFrames);
+		summary[i].averageMilliSecs = totalNanoSecs / numFrames * 1e-6;
+		summary[i].maxMilliSecs = maxNanoSecs * 1e-6;
+	}
+}
+
+void Profiler::logSummary()
+{
+	std::vector<ZoneSummary> summary;
+	getSummary(summary);
+	for (size_t i = 0; i < summary.size(); ++i)
+	{
+		Log(Log.Information, "%*s%s: %.3fms average, %.3fms max, %.1f calls per frame", (int)summary[i].depth * 2, "",
+		    summary[i].name, summary[i].averageMilliSecs, summary[i].maxMilliSecs, summary[i].callsPerFrame);
+	}
+}
+
+bool Profiler::exportChromeTrace(Stream& stream)
+{
+	ProfilerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.collect();
+
+	// Oldest first, and relative to the oldest zone, so that the timestamps are small.
+	const size_t count = state.history.size();
+	const size_t first = (count < c_maxRecordedZones ? 0 : state.historyNext);
+	uint64 startNanoSecs = count ? state.history[first].beginNanoSecs : 0;
+	for (size_t i = 0; i < count; ++i) { startNanoSecs = std::min(startNanoSecs, state.history[i].beginNanoSecs); }
+
+	std::string out("{\"traceEvents\":[\n");
+	char numbers[128];
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Zone& zone = state.history[(first + i) % count];
+		out += "{\"name\":\"";
+		appendEscaped(out, zone.name);
+		sprintf(numbers, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n", zone.threadId,
+		        (zone.beginNanoSecs - startNanoSecs) * 1e-3, (zone.endNanoSecs - zone.beginNanoSecs) * 1e-3,
+		        i + 1 < count ? "," : "");
+		out += numbers;
+		if (out.size() > 65536)
+		{
+			if (!writeString(stream, out)) { return false; }
+			out.clear();
+		}
+	}
+	out += "],\"displayTimeUnit\":\"ms\"}\n";
+	return writeString(stream, out);
+}
+
+void Profiler::clear()
+{
+	ProfilerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.collect();
+	state.history.clear();
+	state.historyNext = 0;
+	state.statisticsByPointer.clear();
+	state.statisticsByName.clear();
+	state.statistics.clear();
+	state.frameIndex = 0;
+	state.numFrames = 0;
+}
+
+uint64 Profiler::getNumDroppedZones()
+{
+	ProfilerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	uint64 dropped = state.droppedByRetiredThreads;
+	for (size_t i = 0; i < state.threads.size(); ++i) { dropped += state.threads[i]->dropped.load(std::memory_order_relaxed); }
+	return dropped;
+}
+
+void ProfileZone::begin(const char* name)
+{
+	end();
+	if (!Profiler::isEnabled()) { return; }
+	m_buffer = getThreadBuffer();
+	if (!m_buffer) { return; }
+	m_name = name;
+	++m_buffer->depth;
+	m_beginTicks = Time::rawTicks();
+}
+
+void ProfileZone::record()
+{
+	// Recorded in ticks, converted to nanoseconds when collected.
+	Profiler::Zone zone;
+	zone.endNanoSecs = Time::rawTicks();
+	zone.beginNanoSecs = m_beginTicks;
+	zone.name = m_name;
+	zone.threadId = m_buffer->threadId;
+	zone.depth = --m_buffer->depth;
+	if (!m_buffer->zones.push_back(zone))
+	{
+		// Only the owning thread writes the counter.
+		m_buffer->dropped.store(m_buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	m_buffer = NULL;
+}
+}
+//!\endcond
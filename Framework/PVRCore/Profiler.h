@@ -0,0 +1,170 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\Profiler.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A hierarchical CPU profiler: scoped zones, per-zone summaries and Chrome trace export.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+#include "PVRCore/Stream.h"
+#include <vector>
+
+namespace pvr {
+//!\cond NO_DOXYGEN
+namespace details {
+struct ProfilerThreadBuffer;
+}
+//!\endcond
+
+/*!*********************************************************************************************************************
+\brief   Collects the zones recorded by all threads, and summarises or exports them.
+\description Zones (see ProfileZone and PVR_PROFILE_ZONE) record nothing until the profiler is enabled, apart from
+         checking a flag. When enabled, each thread writes its zones into its own lock-free queue, without locks or
+         allocation. endFrame(), normally called by the Shell once per frame, moves them into a bounded history used by
+         exportChromeTrace, and into per-zone totals from which getSummary reports averages over the last
+         c_summaryFrames frames. A thread that records more than c_threadBufferSize zones between two calls to endFrame
+         loses the extra zones (see getNumDroppedZones).
+***********************************************************************************************************************/
+class Profiler
+{
+public:
+	enum
+	{
+		c_threadBufferSize = 4096, //!< Zones a thread can record between two calls to endFrame
+		c_maxRecordedZones = 65536, //!< Most recent zones kept for exportChromeTrace
+		c_summaryFrames = 60 //!< Frames getSummary averages over
+	};
+
+	/*!*********************************************************************************************************************
+	\brief A zone as recorded.
+	***********************************************************************************************************************/
+	struct Zone
+	{
+		const char* name; //!< The name passed to the zone. Always a string with static storage.
+		uint64 beginNanoSecs; //!< Time the zone was entered (see getCurrentTimeNanoSecs)
+		uint64 endNanoSecs; //!< Time the zone was left
+		uint32 threadId; //!< Small number identifying the thread, in the order threads first recorded a zone
+		uint32 depth; //!< Number of zones of the same thread the zone was nested in
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Statistics of all the zones with the same name, over the last c_summaryFrames frames.
+	***********************************************************************************************************************/
+	struct ZoneSummary
+	{
+		const char* name; //!< The name of the zones
+		uint32 depth; //!< Depth of the first zone seen with this name, to indent the summary
+		float32 callsPerFrame; //!< Average number of zones per frame
+		float64 averageMilliSecs; //!< Average time per frame spent in the zones. Nested zones are included.
+		float64 maxMilliSecs; //!< Longest time spent in the zones in a single frame
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Start or stop recording zones. Disabled by default. Zones already entered are still recorded when left.
+	***********************************************************************************************************************/
+	static void setEnabled(bool enabled);
+
+	/*!*********************************************************************************************************************
+	\return True if zones are recorded.
+	***********************************************************************************************************************/
+	static bool isEnabled();
+
+	/*!*********************************************************************************************************************
+	\return The current time of the clock the zones are measured with, in nanoseconds.
+	***********************************************************************************************************************/
+	static uint64 getCurrentTimeNanoSecs();
+
+	/*!*********************************************************************************************************************
+	\brief Collect the zones recorded by all threads since the last call, and advance the summary by one frame.
+	***********************************************************************************************************************/
+	static void endFrame();
+
+	/*!*********************************************************************************************************************
+	\brief Get the statistics of each zone name, in the order the names were first seen.
+	\param[out] summary Overwritten with the statistics
+	***********************************************************************************************************************/
+	static void getSummary(std::vector<ZoneSummary>& summary);
+
+	/*!*********************************************************************************************************************
+	\brief Log the summary, one line per zone name.
+	***********************************************************************************************************************/
+	static void logSummary();
+
+	/*!*********************************************************************************************************************
+	\brief Write the collected zones (up to c_maxRecordedZones) as Chrome trace_event JSON, for chrome://tracing.
+	\param stream A stream open for writing
+	\return True on success, false if the stream could not be written
+	***********************************************************************************************************************/
+	static bool exportChromeTrace(Stream& stream);
+
+	/*!*********************************************************************************************************************
+	\brief Discard the collected zones and the summary.
+	***********************************************************************************************************************/
+	static void clear();
+
+	/*!*********************************************************************************************************************
+	\return The number of zones lost because a thread's buffer was full.
+	***********************************************************************************************************************/
+	static uint64 getNumDroppedZones();
+};
+
+/*!*********************************************************************************************************************
+\brief   Records the time between its construction and destruction as a zone of the Profiler.
+\description Normally used through PVR_PROFILE_ZONE. A zone that does not match a scope, such as one spanning from a
+         begin() to an end() method of a class, can be recorded with a ProfileZone member and its begin and end methods.
+***********************************************************************************************************************/
+class ProfileZone
+{
+	ProfileZone(const ProfileZone&);
+	ProfileZone& operator=(const ProfileZone&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor. Does not begin a zone.
+	***********************************************************************************************************************/
+	ProfileZone() : m_buffer(NULL) {}
+
+	/*!*********************************************************************************************************************
+	\brief Constructor. Begins a zone.
+	\param name The name of the zone. Must have static storage, such as a string literal.
+	***********************************************************************************************************************/
+	explicit ProfileZone(const char* name) : m_buffer(NULL) { begin(name); }
+
+	/*!*********************************************************************************************************************
+	\brief Destructor. Ends the zone, if any.
+	***********************************************************************************************************************/
+	~ProfileZone() { end(); }
+
+	/*!*********************************************************************************************************************
+	\brief Begin a zone, if the profiler is enabled. Ends the previous zone of this object first.
+	\param name The name of the zone. Must have static storage, such as a string literal.
+	***********************************************************************************************************************/
+	void begin(const char* name);
+
+	/*!*********************************************************************************************************************
+	\brief End the zone begun by this object, if any. Must be called on the thread that began it.
+	***********************************************************************************************************************/
+	void end() { if (m_buffer) { record(); } }
+
+private:
+	void record();
+
+	details::ProfilerThreadBuffer* m_buffer;
+	const char* m_name;
+	uint64 m_beginTicks;
+};
+}
+
+//!\cond NO_DOXYGEN
+#define PVR_PROFILE_CONCATENATE_(a, b) a##b
+#define PVR_PROFILE_CONCATENATE(a, b) PVR_PROFILE_CONCATENATE_(a, b)
+//!\endcond
+
+/*!*********************************************************************************************************************
+\brief   Record the rest of the enclosing scope as a zone of the Profiler. Define PVR_DISABLE_PROFILER to compile zones out.
+\param   name The name of the zone, a string literal
+***********************************************************************************************************************/
+#ifdef PVR_DISABLE_PROFILER
+#define PVR_PROFILE_ZONE(name)
+#else
+#define PVR_PROFILE_ZONE(name) ::pvr::ProfileZone PVR_PROFILE_CONCATENATE(pvrProfileZone, __LINE__)(name)
+#endif
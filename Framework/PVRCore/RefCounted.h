@@ -7,24 +7,115 @@
 ***********************************************************************************************************************/
 #pragma once
 #include "PVRCore/CoreIncludes.h"
+#include "PVRCore/SmallObjectAllocator.h"
 
+#include <atomic>
 #include <memory>
 #include <type_traits>
 
 namespace pvr {
 
+/*!*********************************************************************************************************************
+\brief    Selects whether the reference counts of objects of type MyClass_ are updated atomically.
+\description By default reference counting is not thread safe: it is the cheapest option, and correct as long as all the
+          references to an object are copied and released on one thread at a time. Specialise this (preferably with
+          PVR_ATOMIC_REFCOUNT) for types whose references are shared between threads, for example resources created on
+          a loader thread and used on the render thread. Define PVR_ALWAYS_ATOMIC_REFCOUNT to make every type atomic.
+          The choice is made when the reference counted object is created, from the type it is created as, and sticks
+          to the object whatever type it is later referred to as.
+\tparam   MyClass_ The type of the reference counted object
+***********************************************************************************************************************/
+template<typename MyClass_>
+struct UseAtomicRefCount
+{
+#ifdef PVR_ALWAYS_ATOMIC_REFCOUNT
+	enum { value = 1 };
+#else
+	enum { value = 0 };
+#endif
+};
+
+/*!*********************************************************************************************************************
+\brief    Use at global scope with a fully qualified type name to make the reference counts of that type atomic.
+***********************************************************************************************************************/
+#define PVR_ATOMIC_REFCOUNT(Type) namespace pvr { template<> struct UseAtomicRefCount< Type > { enum { value = 1 }; }; }
+
 /*!*********************************************************************************************************************
 \brief    An interface that represents a block of memory that will be doing the bookkeeping for an object that will be Reference
           Counted. This bit of memory holds the reference counts.
+\description All the strong references together hold one weak reference, released when the object is destroyed, so the
+          block is deleted exactly when the weak count reaches zero. With atomic counting, increments are relaxed and
+          decrements acquire/release, as in std::shared_ptr; otherwise the counts are updated with plain loads and
+          stores.
 ***********************************************************************************************************************/
 struct IRefCountEntry
 {
-	int32 count; //!< Number of total references for this object
-	int32 weakcount; //!< Number of weak references for this object
+	std::atomic<int32> count; //!< Number of strong references for this object
+	std::atomic<int32> weakcount; //!< Number of weak references for this object, plus one while count is not zero
+	const bool isAtomic; //!< Use atomic read-modify-write operations on the counts
 	virtual void deleteEntry() = 0; //!< Will be overriden with the actual code required to delete the bookkeeping entry
 	virtual void destroyObject() = 0; //!< Will be overriden with the actual code required to delete the object
 	virtual ~IRefCountEntry() {} //!< Will be overriden with the actual code required to delete the object
-	IRefCountEntry() : count(1), weakcount(0) {}
+	IRefCountEntry(bool isAtomic) : count(1), weakcount(1), isAtomic(isAtomic) {}
+
+	//!\cond NO_DOXYGEN
+	int32 getCount() const { return count.load(std::memory_order_relaxed); }
+
+	void incrementCount() { increment(count); }
+
+	void incrementWeakCount() { increment(weakcount); }
+
+	// Take a strong reference only if the object is still alive. Lock-free.
+	bool tryIncrementCount()
+	{
+		int32 current = count.load(std::memory_order_relaxed);
+		if (!isAtomic)
+		{
+			if (current == 0) { return false; }
+			count.store(current + 1, std::memory_order_relaxed);
+			return true;
+		}
+		while (current != 0)
+		{
+			if (count.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Release a strong reference. Destroys the object with the last one, and the entry too if no weak reference is left.
+	void releaseCount()
+	{
+		if (decrement(count) == 0)
+		{
+			destroyObject();
+			releaseWeakCount();
+		}
+	}
+
+	// Release a weak reference. Deletes the entry with the last one.
+	void releaseWeakCount()
+	{
+		if (decrement(weakcount) == 0) { deleteEntry(); }
+	}
+	//!\endcond
+
+private:
+	void increment(std::atomic<int32>& counter)
+	{
+		if (isAtomic) { counter.fetch_add(1, std::memory_order_relaxed); }
+		else { counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+	}
+
+	int32 decrement(std::atomic<int32>& counter)
+	{
+		if (isAtomic) { return counter.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+		const int32 value = counter.load(std::memory_order_relaxed) - 1;
+		counter.store(value, std::memory_order_relaxed);
+		return value;
+	}
 };
 
 /*!*********************************************************************************************************************
@@ -53,6 +144,7 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	             Uses MyClass_'s parameterless constructor. Creates the class in place on our block of memory.
 	*******************************************************************************************************************/
 	RefCountEntryIntrusive(MyClass_*& pointee)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry) MyClass_();
 	}
@@ -66,6 +158,7 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	             Uses MyClass_'s one-parameter constructor. Creates the class in place on our block of memory.
 	*******************************************************************************************************************/
 	template<typename P1> RefCountEntryIntrusive(MyClass_*& pointee, P1&& p1)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry)MyClass_(std::forward<P1>(p1));
 	}
@@ -81,6 +174,7 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	             Uses MyClass_'s two-parameter constructor. Creates the class in place on our block of memory.
 	******************************************************************************************************************/
 	template<typename P1, typename P2> RefCountEntryIntrusive(MyClass_*& pointee, P1&& p1, P2&& p2)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry)MyClass_(std::forward<P1>(p1), std::forward<P2>(p2));
 	}
@@ -97,6 +191,7 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	             Uses MyClass_'s three-parameter constructor. Creates the class in place on our block of memory.
 	******************************************************************************************************************/
 	template<typename P1, typename P2, typename P3> RefCountEntryIntrusive(MyClass_*& pointee, P1&& p1, P2&& p2, P3&& p3)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry)MyClass_(std::forward<P1>(p1), std::forward<P2>(p2), std::forward<P3>(p3));
 	}
@@ -117,6 +212,7 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	******************************************************************************************************************/
 	template<typename P1, typename P2, typename P3, typename P4> RefCountEntryIntrusive(MyClass_*& pointee, P1&& p1, P2&& p2, P3&& p3,
 	        P4&& p4)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry)MyClass_(std::forward<P1>(p1), std::forward<P2>(p2), std::forward<P3>(p3), std::forward<P4>(p4));
 	}
@@ -139,11 +235,18 @@ struct RefCountEntryIntrusive : public IRefCountEntry
 	******************************************************************************************************************/
 	template<typename P1, typename P2, typename P3, typename P4, typename P5> RefCountEntryIntrusive(MyClass_*& pointee, P1&& p1,
 	        P2&& p2, P3&& p3, P4&& p4, P5&& p5)
+		: IRefCountEntry(UseAtomicRefCount<MyClass_>::value != 0)
 	{
 		pointee = new(entry)MyClass_(std::forward<P1>(p1), std::forward<P2>(p2), std::forward<P3>(p3), std::forward<P4>(p4),
 		                             std::forward<P5>(p5));
 	}
 
+	//!\cond NO_DOXYGEN
+	// Entries come from the pools of the SmallObjectAllocator, as objects are constructed and released constantly.
+	static void* operator new(size_t size) { return SmallObjectAllocator::allocate(size); }
+	static void operator delete(void* entry, size_t size) { SmallObjectAllocator::deallocate(entry, size); }
+	//!\endcond
+
 	/*!*****************************************************************************************************************
 	\brief       Destroys the RefcountEntryIntrusive object (entry and counters). Called when all references
 	             (count + weak count) are  0. It assumes the object has already been destroyed - so it will NOT destroy
@@ -178,10 +281,14 @@ template<typename MyClass_>
 struct RefCountEntry : public IRefCountEntry
 {
 	MyClass_* ptr; //!<Pointer to the object
-	RefCountEntry() : ptr(NULL) { }
-	RefCountEntry(MyClass_* ptr) : ptr(ptr) { }
+	RefCountEntry(bool isAtomic = UseAtomicRefCount<MyClass_>::value != 0) : IRefCountEntry(isAtomic), ptr(NULL) { }
+	RefCountEntry(MyClass_* ptr, bool isAtomic = UseAtomicRefCount<MyClass_>::value != 0) : IRefCountEntry(isAtomic), ptr(ptr) { }
 	void deleteEntry() { delete this; }
 	void destroyObject() { delete ptr; }
+	//!\cond NO_DOXYGEN
+	static void* operator new(size_t size) { return SmallObjectAllocator::allocate(size); }
+	static void operator delete(void* entry, size_t size) { SmallObjectAllocator::deallocate(entry, size); }
+	//!\endcond
 };
 
 /*!*********************************************************************************************************************
@@ -317,13 +424,13 @@ public:
 	\return True if this object contains a reference to a non-null object (is safely dereferenceable).
 	        Equivalent to !isNull().
 	***********************************************************************************************************************/
-	bool isValid() const { return RefcountEntryHolder<MyClass_>::refCountEntry != NULL && RefcountEntryHolder<MyClass_>::refCountEntry->count > 0; }
+	bool isValid() const { return RefcountEntryHolder<MyClass_>::refCountEntry != NULL && RefcountEntryHolder<MyClass_>::refCountEntry->getCount() > 0; }
 
 	/*!*********************************************************************************************************************
 	\return True if this object does not contain a reference to a non-null object (is not safely dereferenceable).
 	        Equivalent to !isValid().
 	***********************************************************************************************************************/
-	bool isNull() const { return RefcountEntryHolder<MyClass_>::refCountEntry == NULL || RefcountEntryHolder<MyClass_>::refCountEntry->count == 0; }
+	bool isNull() const { return RefcountEntryHolder<MyClass_>::refCountEntry == NULL || RefcountEntryHolder<MyClass_>::refCountEntry->getCount() == 0; }
 
 	/*!*********************************************************************************************************************
 	\brief    Get a raw pointer to the pointed-to object.
@@ -360,7 +467,7 @@ public:
 	***********************************************************************************************************************/
 	RefCountedResource(const RefCountedResource& rhs) : Dereferenceable<MyClass_>(rhs), RefcountEntryHolder<MyClass_>(rhs)
 	{
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->count); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -371,9 +478,9 @@ public:
 	          count reaches zero. MyPointer_ may be MyClass_ or a subclass of MyClass_. delete MyPointer_ will happen, not MyClass_.
 	***********************************************************************************************************************/
 	template<typename MyPointer_>
-	explicit RefCountedResource(MyPointer_* ref) : Dereferenceable<MyClass_>(ref), RefcountEntryHolder<MyClass_>(new RefCountEntry<MyPointer_>(ref))
+	explicit RefCountedResource(MyPointer_* ref) : Dereferenceable<MyClass_>(ref),
+		RefcountEntryHolder<MyClass_>(new RefCountEntry<MyPointer_>(ref, UseAtomicRefCount<MyPointer_>::value || UseAtomicRefCount<MyClass_>::value))
 	{
-		RefcountEntryHolder<MyClass_>::refCountEntry->count = 1;
 	}
 
 	/*!*********************************************************************************************************************
@@ -400,7 +507,7 @@ public:
 		//Compile-time check: are these types compatible?
 		OldType_* checkMe = static_cast<OldType_*>(Dereferenceable<MyClass_>::pointee);
 		(void)checkMe;
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->count); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -420,7 +527,7 @@ public:
 		//Compile-time check: are these types compatible?
 		OldType_* checkMe = static_cast<MyClass_*>(Dereferenceable<MyClass_>::pointee);
 		(void)checkMe;
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->count); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -458,7 +565,7 @@ public:
 	void reset(MyPointer_* ref)
 	{
 		release();
-		RefcountEntryHolder<MyClass_>::refCountEntry = new RefCountEntry<MyPointer_>(ref);
+		RefcountEntryHolder<MyClass_>::refCountEntry = new RefCountEntry<MyPointer_>(ref, UseAtomicRefCount<MyPointer_>::value || UseAtomicRefCount<MyClass_>::value);
 		Dereferenceable<MyClass_>::pointee = ref;
 	}
 
@@ -604,7 +711,7 @@ public:
 private:
 	void retainOne()
 	{
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->count++; }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementCount(); }
 	}
 
 	void releaseOne()
@@ -612,29 +719,18 @@ private:
 		if (RefcountEntryHolder<MyClass_>::refCountEntry)
 		{
 #ifdef DEBUG
-			if (RefcountEntryHolder<MyClass_>::refCountEntry->count == 0) //SANITY CHECK - should never happen!
+			if (RefcountEntryHolder<MyClass_>::refCountEntry->getCount() == 0) //SANITY CHECK - should never happen!
 			{
 				PVR_ASSERT(0 && "POSSIBLE BUG - Refcount entry count is zero but a strong reference to it was still live");
-				if (RefcountEntryHolder<MyClass_>::refCountEntry->weakcount == 0)
-				{
-					RefcountEntryHolder<MyClass_>::refCountEntry->deleteEntry();
-				}
 				RefcountEntryHolder<MyClass_>::refCountEntry = 0;
 				Dereferenceable<MyClass_>::pointee = 0;
 			}
 			else
 #endif
 			{
-				if (--(RefcountEntryHolder<MyClass_>::refCountEntry->count) == 0)
-				{
-					RefcountEntryHolder<MyClass_>::refCountEntry->destroyObject();
-					if (RefcountEntryHolder<MyClass_>::refCountEntry->weakcount == 0)
-					{
-						RefcountEntryHolder<MyClass_>::refCountEntry->deleteEntry();
-					}
-					RefcountEntryHolder<MyClass_>::refCountEntry = 0;
-					Dereferenceable<MyClass_>::pointee = 0;
-				}
+				RefcountEntryHolder<MyClass_>::refCountEntry->releaseCount();
+				RefcountEntryHolder<MyClass_>::refCountEntry = 0;
+				Dereferenceable<MyClass_>::pointee = 0;
 			}
 		}
 	}
@@ -644,7 +740,7 @@ private:
 	{
 		if (RefcountEntryHolder<MyClass_>::refCountEntry)
 		{
-			++(RefcountEntryHolder<MyClass_>::refCountEntry->count);
+			RefcountEntryHolder<MyClass_>::refCountEntry->incrementCount();
 		}
 	}
 	template<typename PointeeType>
@@ -652,7 +748,7 @@ private:
 	{
 		release();
 		RefcountEntryHolder<MyClass_>::refCountEntry = entry;
-		++(entry->count);
+		entry->incrementCount();
 	}
 };
 
@@ -683,13 +779,13 @@ public:
 	\brief     Test if this reference points to a valid object.
 	\return    True if this reference points to a valid object.
 	***********************************************************************************************************************/
-	bool isValid() const { return RefcountEntryHolder<MyClass_>::refCountEntry != NULL && RefcountEntryHolder<MyClass_>::refCountEntry->count > 0; }
+	bool isValid() const { return RefcountEntryHolder<MyClass_>::refCountEntry != NULL && RefcountEntryHolder<MyClass_>::refCountEntry->getCount() > 0; }
 
 	/*!*********************************************************************************************************************
 	\brief     Test if this reference does not point to a valid object.
 	\return    True if this reference does not points to a valid object.
 	***********************************************************************************************************************/
-	bool isNull() const { return RefcountEntryHolder<MyClass_>::refCountEntry == NULL || RefcountEntryHolder<MyClass_>::refCountEntry->count == 0; }
+	bool isNull() const { return RefcountEntryHolder<MyClass_>::refCountEntry == NULL || RefcountEntryHolder<MyClass_>::refCountEntry->getCount() == 0; }
 
 	/*!*********************************************************************************************************************
 	\brief     Get a raw pointer to the pointed-to object.
@@ -703,6 +799,24 @@ public:
 	***********************************************************************************************************************/
 	const MyClass_* get() const { return Dereferenceable<MyClass_>::pointee; }
 
+	/*!*********************************************************************************************************************
+	\brief     Get a strong reference to the pointed-to object, if it is still alive.
+	\return    A RefCountedResource to the object, or a NULL one if the object has been destroyed.
+	\description Use this instead of isValid() followed by a copy when the last strong reference may be released on
+	           another thread: with atomic reference counting, the test and the increment are done as one lock-free step.
+	***********************************************************************************************************************/
+	RefCountedResource<MyClass_> lock() const
+	{
+		RefCountedResource<MyClass_> strong;
+		IRefCountEntry* entry = RefcountEntryHolder<MyClass_>::refCountEntry;
+		if (entry && entry->tryIncrementCount())
+		{
+			strong.refCountEntry = entry;
+			strong.pointee = Dereferenceable<MyClass_>::pointee;
+		}
+		return strong;
+	}
+
 	void swap(RefCountedWeakReference& rhs)
 	{
 		IRefCountEntry* tmpRefCountEntry = RefcountEntryHolder<MyClass_>::refCountEntry;
@@ -723,7 +837,7 @@ public:
 	***********************************************************************************************************************/
 	RefCountedWeakReference(const RefCountedWeakReference& rhs) : Dereferenceable<MyClass_>(rhs), RefcountEntryHolder<MyClass_>(rhs)
 	{
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -732,7 +846,7 @@ public:
 	***********************************************************************************************************************/
 	RefCountedWeakReference(const RefCountedResource<MyClass_>& rhs) : Dereferenceable<MyClass_>(rhs), RefcountEntryHolder<MyClass_>(rhs)
 	{
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -755,7 +869,7 @@ public:
 		//Compile-time check: are these types compatible?
 		OldType_* checkMe = static_cast<OldType_*>(Dereferenceable<MyClass_>::pointee);
 		(void)checkMe;
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -773,7 +887,7 @@ public:
 		//Compile-time check: are these types compatible?
 		OldType_* checkMe = static_cast<MyClass_*>(Dereferenceable<MyClass_>::pointee);
 		(void)checkMe;
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { ++(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount); }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount(); }
 	}
 
 	/*!*********************************************************************************************************************
@@ -812,7 +926,7 @@ public:
 private:
 	void retainOne()
 	{
-		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->weakcount++; }
+		if (RefcountEntryHolder<MyClass_>::refCountEntry) { RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount(); }
 	}
 
 	void releaseOne()
@@ -820,24 +934,18 @@ private:
 		if (RefcountEntryHolder<MyClass_>::refCountEntry)
 		{
 #ifdef DEBUG
-			if ((RefcountEntryHolder<MyClass_>::refCountEntry->count == 0)
-			        && (RefcountEntryHolder<MyClass_>::refCountEntry->weakcount == 0)) //SANITY CHECK - should never happen!
+			if (RefcountEntryHolder<MyClass_>::refCountEntry->weakcount.load(std::memory_order_relaxed) == 0) //SANITY CHECK - should never happen!
 			{
 				PVR_ASSERT(0 && "POSSIBLE BUG - Refcount entry is zero but a weak reference to it still existed.");
-				RefcountEntryHolder<MyClass_>::refCountEntry->deleteEntry();
 				RefcountEntryHolder<MyClass_>::refCountEntry = 0;
 				Dereferenceable<MyClass_>::pointee = 0;
 			}
 			else
 #endif
 			{
-				if (--(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount) == 0
-				        && (RefcountEntryHolder<MyClass_>::refCountEntry->count == 0))
-				{
-					RefcountEntryHolder<MyClass_>::refCountEntry->deleteEntry();
-					RefcountEntryHolder<MyClass_>::refCountEntry = 0;
-					Dereferenceable<MyClass_>::pointee = 0;
-				}
+				RefcountEntryHolder<MyClass_>::refCountEntry->releaseWeakCount();
+				RefcountEntryHolder<MyClass_>::refCountEntry = 0;
+				Dereferenceable<MyClass_>::pointee = 0;
 			}
 		}
 	}
@@ -848,7 +956,7 @@ private:
 	{
 		if (RefcountEntryHolder<MyClass_>::refCountEntry)
 		{
-			++(RefcountEntryHolder<MyClass_>::refCountEntry->weakcount);
+			RefcountEntryHolder<MyClass_>::refCountEntry->incrementWeakCount();
 		}
 	}
 	template<typename PointeeType>
@@ -856,7 +964,7 @@ private:
 	{
 		release();
 		RefcountEntryHolder<MyClass_>::refCountEntry = entry;
-		++(entry->weakcount);
+		entry->incrementWeakCount();
 	}
 };
 
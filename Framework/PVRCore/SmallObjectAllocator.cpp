@@ -0,0 +1,290 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\SmallObjectAllocator.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the SmallObjectAllocator.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/SmallObjectAllocator.h"
+#include "PVRCore/ThreadLocalPointer.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace pvr {
+namespace {
+const uint32 c_numClasses = SmallObjectAllocator::c_maxSize / SmallObjectAllocator::c_granularity;
+// Blocks moved at once between a thread and the global free lists.
+const uint32 c_batchSize = 32;
+// A thread gives a batch back when it has this many free blocks of a size class.
+const uint32 c_maxCachedBlocks = c_batchSize * 2;
+
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+
+inline uint32 getSizeClass(size_t size) { return size ? (uint32)((size - 1) / SmallObjectAllocator::c_granularity) : 0; }
+inline size_t getClassSize(uint32 sizeClass) { return (sizeClass + 1) * (size_t)SmallObjectAllocator::c_granularity; }
+
+// Counters are only written by their thread, so they need no read-modify-write, only to be readable by getStatistics.
+inline void increment(std::atomic<uint64>& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+struct ThreadCache;
+
+struct GlobalPool
+{
+	std::mutex mutex;
+	FreeBlock* freeLists[c_numClasses];
+	ThreadCache* threads; // Live thread caches, for the statistics
+	SmallObjectAllocator::Statistics retired; // Counters of exited threads, and of allocations made without a cache
+	std::atomic<uint64> heapAllocations;
+	std::atomic<uint64> heapBytes;
+
+	GlobalPool() : threads(NULL), heapAllocations(0), heapBytes(0)
+	{
+		for (uint32 i = 0; i < c_numClasses; ++i) { freeLists[i] = NULL; }
+	}
+
+	void recordHeapAllocation(size_t size)
+	{
+		heapAllocations.fetch_add(1, std::memory_order_relaxed);
+		heapBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	// Split a new chunk into blocks of a size class. Mutex must be held.
+	void carve(uint32 sizeClass)
+	{
+		const size_t blockSize = getClassSize(sizeClass);
+		char* chunk = static_cast<char*>(::operator new(SmallObjectAllocator::c_chunkSize));
+		recordHeapAllocation(SmallObjectAllocator::c_chunkSize);
+		// ::operator new only guarantees 8 byte alignment on 32 bit platforms. Chunks are never freed, so the blocks can
+		// start at the first c_granularity boundary; block sizes are multiples of it, so every block is aligned.
+		const size_t misalignment = (size_t)chunk % SmallObjectAllocator::c_granularity;
+		const size_t start = misalignment ? SmallObjectAllocator::c_granularity - misalignment : 0;
+		for (size_t offset = start; offset + blockSize <= SmallObjectAllocator::c_chunkSize; offset += blockSize)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + offset);
+			block->next = freeLists[sizeClass];
+			freeLists[sizeClass] = block;
+		}
+	}
+
+	// Move up to count blocks of a size class onto list. Mutex must be held. Returns the number moved, at least one.
+	uint32 take(uint32 sizeClass, uint32 count, FreeBlock*& list)
+	{
+		if (!freeLists[sizeClass]) { carve(sizeClass); }
+		uint32 taken = 0;
+		while (taken < count && freeLists[sizeClass])
+		{
+			FreeBlock* block = freeLists[sizeClass];
+			freeLists[sizeClass] = block->next;
+			block->next = list;
+			list = block;
+			++taken;
+		}
+		return taken;
+	}
+
+	// Put back a linked list of blocks of a size class. Mutex must be held.
+	void give(uint32 sizeClass, FreeBlock* first, FreeBlock* last)
+	{
+		last->next = freeLists[sizeClass];
+		freeLists[sizeClass] = first;
+	}
+};
+
+// Never destroyed, as blocks may still be freed during static destruction.
+GlobalPool& getGlobalPool()
+{
+	static GlobalPool* pool = new GlobalPool;
+	return *pool;
+}
+
+struct ThreadCache
+{
+	FreeBlock* freeLists[c_numClasses];
+	uint32 numFree[c_numClasses];
+	std::atomic<uint64> allocations;
+	std::atomic<uint64> deallocations;
+	std::atomic<uint64> globalRefills;
+	ThreadCache* previous;
+	ThreadCache* next;
+
+	ThreadCache();
+	~ThreadCache();
+
+	void* allocate(uint32 sizeClass)
+	{
+		increment(allocations);
+		if (!freeLists[sizeClass])
+		{
+			GlobalPool& pool = getGlobalPool();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			numFree[sizeClass] += pool.take(sizeClass, c_batchSize, freeLists[sizeClass]);
+			increment(globalRefills);
+		}
+		FreeBlock* block = freeLists[sizeClass];
+		freeLists[sizeClass] = block->next;
+		--numFree[sizeClass];
+		return block;
+	}
+
+	void deallocate(void* memory, uint32 sizeClass)
+	{
+		increment(deallocations);
+		FreeBlock* block = static_cast<FreeBlock*>(memory);
+		block->next = freeLists[sizeClass];
+		freeLists[sizeClass] = block;
+		if (++numFree[sizeClass] < c_maxCachedBlocks) { return; }
+
+		FreeBlock* last = block;
+		for (uint32 i = 1; i < c_batchSize; ++i) { last = last->next; }
+		freeLists[sizeClass] = last->next;
+		numFree[sizeClass] -= c_batchSize;
+		GlobalPool& pool = getGlobalPool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.give(sizeClass, block, last);
+	}
+};
+
+// Value of the thread cache slot once the cache of the thread has been destroyed, so that blocks freed by later thread
+// exit callbacks go to the global pool directly.
+ThreadCache* const c_destroyedCache = reinterpret_cast<ThreadCache*>(1);
+
+void PVR_TLS_CALLBACK destroyThreadCache(void* value);
+
+// Never destroyed, as threads may free blocks while static objects are destroyed.
+ThreadLocalPointer& getThreadCacheSlot()
+{
+	static ThreadLocalPointer* slot = new ThreadLocalPointer(&destroyThreadCache);
+	return *slot;
+}
+
+ThreadCache* getThreadCache()
+{
+	ThreadLocalPointer& slot = getThreadCacheSlot();
+	ThreadCache* cache = static_cast<ThreadCache*>(slot.get());
+	if (cache == c_destroyedCache) { return NULL; }
+	if (!cache)
+	{
+		cache = new ThreadCache;
+		slot.set(cache);
+	}
+	return cache;
+}
+
+void PVR_TLS_CALLBACK destroyThreadCache(void* value)
+{
+	if (value != c_destroyedCache) { delete static_cast<ThreadCache*>(value); }
+	getThreadCacheSlot().set(c_destroyedCache);
+}
+
+ThreadCache::ThreadCache() : allocations(0), deallocations(0), globalRefills(0), previous(NULL)
+{
+	for (uint32 i = 0; i < c_numClasses; ++i)
+	{
+		freeLists[i] = NULL;
+		numFree[i] = 0;
+	}
+	GlobalPool& pool = getGlobalPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	next = pool.threads;
+	if (next) { next->previous = this; }
+	pool.threads = this;
+}
+
+ThreadCache::~ThreadCache()
+{
+	GlobalPool& pool = getGlobalPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	for (uint32 i = 0; i < c_numClasses; ++i)
+	{
+		if (!freeLists[i]) { continue; }
+		FreeBlock* last = freeLists[i];
+		while (last->next) { last = last->next; }
+		pool.give(i, freeLists[i], last);
+	}
+	pool.retired.allocations += allocations.load(std::memory_order_relaxed);
+	pool.retired.deallocations += deallocations.load(std::memory_order_relaxed);
+	pool.retired.globalRefills += globalRefills.load(std::memory_order_relaxed);
+	if (previous) { previous->next = next; }
+	else { pool.threads = next; }
+	if (next) { next->previous = previous; }
+}
+}
+
+void* SmallObjectAllocator::allocate(size_t size)
+{
+	ThreadCache* cache = getThreadCache();
+	if (size > c_maxSize)
+	{
+		GlobalPool& pool = getGlobalPool();
+		pool.recordHeapAllocation(size);
+		if (cache) { increment(cache->allocations); }
+		else
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			++pool.retired.allocations;
+		}
+		return ::operator new(size);
+	}
+	if (cache) { return cache->allocate(getSizeClass(size)); }
+
+	GlobalPool& pool = getGlobalPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	FreeBlock* block = NULL;
+	pool.take(getSizeClass(size), 1, block);
+	++pool.retired.allocations;
+	return block;
+}
+
+void SmallObjectAllocator::deallocate(void* block, size_t size)
+{
+	if (!block) { return; }
+	ThreadCache* cache = getThreadCache();
+	if (size > c_maxSize)
+	{
+		if (cache) { increment(cache->deallocations); }
+		else
+		{
+			GlobalPool& pool = getGlobalPool();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			++pool.retired.deallocations;
+		}
+		::operator delete(block);
+		return;
+	}
+	if (cache)
+	{
+		cache->deallocate(block, getSizeClass(size));
+		return;
+	}
+
+	GlobalPool& pool = getGlobalPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	pool.give(getSizeClass(size), freeBlock, freeBlock);
+	++pool.retired.deallocations;
+}
+
+SmallObjectAllocator::Statistics SmallObjectAllocator::getStatistics()
+{
+	GlobalPool& pool = getGlobalPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	Statistics statistics = pool.retired;
+	for (ThreadCache* cache = pool.threads; cache; cache = cache->next)
+	{
+		statistics.allocations += cache->allocations.load(std::memory_order_relaxed);
+		statistics.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+		statistics.globalRefills += cache->globalRefills.load(std::memory_order_relaxed);
+	}
+	statistics.heapAllocations = pool.heapAllocations.load(std::memory_order_relaxed);
+	statistics.heapBytes = pool.heapBytes.load(std::memory_order_relaxed);
+	return statistics;
+}
+}
+//!\endcond
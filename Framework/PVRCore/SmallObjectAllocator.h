@@ -0,0 +1,64 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\SmallObjectAllocator.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A pooled allocator for small, frequently created and destroyed blocks, such as reference count entries.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief   Allocates small blocks from size-class pools instead of the general heap.
+\description Block sizes are rounded up to a multiple of c_granularity. Each size class has a free list per thread, so the
+         common case takes no lock. A thread whose free list runs out takes a batch of blocks from a global, mutex-
+         protected free list, which in turn carves new blocks out of c_chunkSize chunks from the heap. A thread whose
+         free list grows too long gives a batch back. Chunks are never returned to the heap, so once an application has
+         reached its peak working set, allocating and freeing perform no heap allocations. Blocks may be freed on any
+         thread. Blocks larger than c_maxSize go directly to the heap. Pooled blocks are aligned to c_granularity; blocks
+         from the heap have the alignment of ::operator new.
+***********************************************************************************************************************/
+class SmallObjectAllocator
+{
+public:
+	enum
+	{
+		c_granularity = 16, //!< Block sizes are rounded up to a multiple of this
+		c_maxSize = 512, //!< Larger blocks are allocated from the heap
+		c_chunkSize = 64 * 1024 //!< Size of the heap allocations the pools grow by
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Counters of all threads, including threads that have exited.
+	***********************************************************************************************************************/
+	struct Statistics
+	{
+		uint64 allocations; //!< Blocks allocated
+		uint64 deallocations; //!< Blocks freed
+		uint64 globalRefills; //!< Times a thread took a batch of blocks from the global free lists
+		uint64 heapAllocations; //!< Heap allocations: chunks, and blocks larger than c_maxSize
+		uint64 heapBytes; //!< Total bytes allocated from the heap
+		Statistics() : allocations(0), deallocations(0), globalRefills(0), heapAllocations(0), heapBytes(0) {}
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Allocate a block.
+	\param size The size of the block in bytes
+	\return The block. Never NULL: throws std::bad_alloc as operator new does.
+	***********************************************************************************************************************/
+	static void* allocate(size_t size);
+
+	/*!*********************************************************************************************************************
+	\brief Free a block returned by allocate.
+	\param block The block. May be NULL.
+	\param size The size passed to allocate when the block was allocated
+	***********************************************************************************************************************/
+	static void deallocate(void* block, size_t size);
+
+	/*!*********************************************************************************************************************
+	\return The counters. Counters of other threads are sampled without synchronisation, so they may lag slightly.
+	        Compare heapAllocations across a frame to check that it did not allocate from the heap.
+	***********************************************************************************************************************/
+	static Statistics getStatistics();
+};
+}
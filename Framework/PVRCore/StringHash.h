@@ -7,32 +7,86 @@
 #pragma once
 #include "PVRCore/CoreIncludes.h"
 #include "PVRCore/Hash_.h"
+#include "PVRCore/StringTable.h"
+#include <cstring>
 #include <functional>
 
 namespace pvr {
+/*!*********************************************************************************************
+\brief A string literal together with its hash, computed at compile time.
+\description Compares against StringHash objects without allocating or hashing at runtime: the hashes are
+		compared, then the characters. Use it for the constant names (semantics, keywords) that runtime
+		strings are looked up against. The characters are not copied, so the string must outlive the
+		object, as literals always do.
+**********************************************************************************************/
+class StringHashLiteral
+{
+public:
+	/*!*********************************************************************************************
+	\param[in]			str	A string literal
+	**********************************************************************************************/
+	template<size_t N>
+	explicit PVR_CONSTEXPR StringHashLiteral(const char (&str)[N])
+		: m_String(str), m_Length(N - 1), m_Hash(hash32_literal(str, N - 1)) { }
+
+	/*!*********************************************************************************************
+	\param[in]			str	A string, not necessarily null terminated
+	\param[in]			length	The number of characters of the string
+	**********************************************************************************************/
+	PVR_CONSTEXPR StringHashLiteral(const char* str, size_t length)
+		: m_String(str), m_Length(length), m_Hash(hash32_literal(str, length)) { }
+
+	/*!***********************************************************************
+	\return 		The characters of the string.
+	*************************************************************************/
+	PVR_CONSTEXPR const char* c_str() const { return m_String; }
+
+	/*!***********************************************************************
+	\return 		The number of characters of the string.
+	*************************************************************************/
+	PVR_CONSTEXPR size_t length() const { return m_Length; }
+
+	/*!***********************************************************************
+	\return 		The hash value, equal to the hash of a StringHash of the same string.
+	*************************************************************************/
+	PVR_CONSTEXPR std::size_t getHash() const { return m_Hash; }
+
+private:
+	const char* m_String;
+	size_t m_Length;
+	std::size_t m_Hash;
+};
+
 /*!*********************************************************************************************
 \brief Implementation of a hashed string with functionality for fast compares.
 \description In most cases, can be used as a drop-in replacement for std::strings to take advantage 
-		of fast hashed  comparisons. On debug builds, tests for hash collisions are performed 
-		(Assertion + error log if collision found)
+		of fast hashed comparisons. The string is interned in the process-wide StringTable: all
+		StringHash objects with the same characters point to one immutable copy, so a StringHash is
+		the size of a pointer, copying it never allocates, and comparing two of them is a pointer
+		compare. Constructing one from characters looks them up in the StringTable.
  ***********************************************************************************************/
 class StringHash
 {
-	typedef hash<std::string> HashFn;
 public:
 	/*!*********************************************************************************************
 	\param[in]			str	A c-style string
 	**********************************************************************************************/
-	StringHash(const char* str) : m_String(str), m_Hash(HashFn()(m_String)) { }
+	StringHash(const char* str) : m_Interned(StringTable::intern(str, strlen(str))) { }
 
 	/*!*********************************************************************************************
 	\param[in]			right	A string
 	**********************************************************************************************/
-	StringHash(const std::string& right) : m_String(right), m_Hash(HashFn()(m_String)) { }
+	StringHash(const std::string& right) : m_Interned(StringTable::intern(right)) { }
+
+	operator const std::string&() const { return m_Interned->string; }
 
-	operator const std::string&() const { return m_String; }
+	StringHash() : m_Interned(StringTable::getEmpty()) {}
 
-	StringHash() : m_String(""), m_Hash(HashFn()(m_String)) {}
+	/*!*********************************************************************************************
+	\param[in]			literal	A StringHashLiteral. Its hash is reused.
+	**********************************************************************************************/
+	StringHash(const StringHashLiteral& literal)
+		: m_Interned(StringTable::intern(literal.c_str(), literal.length(), static_cast<uint32>(literal.getHash()))) { }
 
 	/*!*********************************************************************************************
 	\brief      		Appends a string to the end of this StringHash, recalculates hash.
@@ -41,8 +95,7 @@ public:
 	*************************************************************************/
 	StringHash& append(const char* ptr)
 	{
-		m_String.append(ptr);
-		m_Hash = HashFn()(m_String);
+		m_Interned = StringTable::intern(m_Interned->string + ptr);
 		return *this;
 	}
 
@@ -53,8 +106,7 @@ public:
 	************************************************************************************************/
 	StringHash& append(const string& str)
 	{
-		m_String.append(str);
-		m_Hash = HashFn()(m_String);
+		m_Interned = StringTable::intern(m_Interned->string + str);
 		return *this;
 	}
 
@@ -65,8 +117,7 @@ public:
 	************************************************************************************************/
 	StringHash& assign(const char* ptr)
 	{
-		m_String.assign(ptr);
-		m_Hash = HashFn()(m_String);
+		m_Interned = StringTable::intern(ptr, strlen(ptr));
 		return *this;
 	}
 
@@ -77,33 +128,18 @@ public:
 	************************************************************************************************/
 	StringHash& assign(const string& str)
 	{
-		m_String = str;
-		m_Hash = HashFn()(m_String);
+		m_Interned = StringTable::intern(str);
 		return *this;
 	}
 
 	/*!**********************************************************************************************
-	\brief      	== Operator. This function compares the hash values of the StringHashes.
+	\brief      	== Operator. Compares the interned strings, which is a pointer compare.
 	\param[in]		str 	A hashed string to compare with
 	\return 		True if they match
 	************************************************************************************************/
 	bool operator==(const StringHash& str) const
 	{
-#ifdef DEBUG //Collision detection
-		if (m_Hash == str.getHash() && m_String != str.m_String)
-		{
-			Log(Log.Critical, "***** STRING HASH COLLISION DETECTED ********************");
-			Log(Log.Critical, "** String [%s] collides with string [%s] ", m_String.c_str(), str.m_String.c_str());
-			Log(Log.Critical, "*********************************************************");
-			PVR_ASSERT(0 && "COLLISION FOUND");
-		}
-#endif
-
-#ifdef PVR_STRING_HASH_STRONG_COMPARISONS
-		return (m_Hash == str.getHash());
-#else
-		return (m_Hash == str.getHash()) && m_String == str.m_String;
-#endif
+		return m_Interned == str.m_Interned;
 	}
 
 	/*!**********************************************************************************************
@@ -114,7 +150,7 @@ public:
 	************************************************************************************************/
 	bool operator==(const char* str) const
 	{
-		return (m_String.compare(str) == 0);
+		return (m_Interned->string.compare(str) == 0);
 	}
 
 	/*!**********************************************************************************************
@@ -126,11 +162,32 @@ public:
 	************************************************************************************************/
 	bool operator==(const std::string& str) const
 	{
-		return m_String == str;
+		return m_Interned->string == str;
+	}
+
+	/*!**********************************************************************************************
+	\brief      	== Operator. Compares the hash values, then the characters. Does not allocate.
+	\param[in]		str 	A StringHashLiteral to compare with
+	\return 		True if they match
+	************************************************************************************************/
+	bool operator==(const StringHashLiteral& str) const
+	{
+		return (getHash() == str.getHash()) &&
+		       m_Interned->string.compare(0, string::npos, str.c_str(), str.length()) == 0;
 	}
 
 	/*!***********************************************************************
 	\brief      	!= Operator. Compares hash values.
+	\param[in]		str 	A StringHashLiteral to compare with
+	\return 		True if they don't match
+	*************************************************************************/
+	bool operator!=(const StringHashLiteral& str) const
+	{
+		return !(*this == str);
+	}
+
+	/*!***********************************************************************
+	\brief      	!= Operator. Compares the interned strings.
 	\param[in]		str 	A StringHash to compare with
 	\return 		True if they don't match
 	*************************************************************************/
@@ -139,16 +196,14 @@ public:
 		return !(*this == str);
 	}
 
+	/*!***********************************************************************
+	\brief      	< Operator. Orders by hash value, then by string when the hashes collide, so that the
+	                order does not depend on the order strings were interned in.
+	*************************************************************************/
 	bool operator<(const StringHash& str)const
 	{
-#ifndef DEBUG //Collision detection
-        PVR_ASSERT(m_Hash != str.getHash() || m_String == str.m_String);
-#endif
-#ifndef PVR_STRING_HASH_STRONG_COMPARISONS
-		return m_Hash < str.getHash();
-#else
-		return m_Hash < str.getHash() || (m_Hash == str.getHash() && m_String < str.m_String);
-#endif
+		return m_Interned->hash < str.m_Interned->hash ||
+		       (m_Interned->hash == str.m_Interned->hash && m_Interned != str.m_Interned && m_Interned->string < str.m_Interned->string);
 	}
 
 	/*!***********************************************************************
@@ -156,7 +211,7 @@ public:
 	*************************************************************************/
 	const string& getString() const
 	{
-		return m_String;
+		return m_Interned->string;
 	}
 
 	/*!***********************************************************************
@@ -164,7 +219,15 @@ public:
 	*************************************************************************/
 	const std::size_t getHash() const
 	{
-		return m_Hash;
+		return m_Interned->hash;
+	}
+
+	/*!***********************************************************************
+	\return 		A number unique to the string, assigned by the StringTable.
+	*************************************************************************/
+	uint32 getId() const
+	{
+		return m_Interned->id;
 	}
 
 	/*!***************************************************************************
@@ -172,12 +235,15 @@ public:
 	*****************************************************************************/
 	const char* c_str() const
 	{
-		return m_String.c_str();
+		return m_Interned->string.c_str();
 	}
 
 private:
-	std::string m_String;
-	std::size_t m_Hash;
+	const InternedString* m_Interned;
 };
-}
 
+//!\cond NO_DOXYGEN
+inline bool operator==(const StringHashLiteral& lhs, const StringHash& rhs) { return rhs == lhs; }
+inline bool operator!=(const StringHashLiteral& lhs, const StringHash& rhs) { return rhs != lhs; }
+//!\endcond
+}
@@ -0,0 +1,121 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\StringTable.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the StringTable.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/StringTable.h"
+#include "PVRCore/Hash_.h"
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace pvr {
+namespace {
+const uint32 c_numShardBits = 4;
+const uint32 c_numShards = 1 << c_numShardBits;
+const uint32 c_minBuckets = 64;
+
+// An open-addressing (linear probing) hash set of interned strings, indexed by the low bits of the hash.
+struct Shard
+{
+	std::mutex mutex;
+	std::vector<InternedString*> buckets;
+	uint32 count;
+	std::deque<InternedString> storage; // Never moves its elements
+
+	Shard() : buckets(c_minBuckets, (InternedString*)NULL), count(0) {}
+
+	// The bucket holding the string, or the empty bucket where it would be inserted. Mutex must be held.
+	size_t findBucket(const char* str, size_t length, uint32 hash) const
+	{
+		const size_t mask = buckets.size() - 1;
+		for (size_t bucket = hash & mask;; bucket = (bucket + 1) & mask)
+		{
+			const InternedString* current = buckets[bucket];
+			if (!current || (current->hash == hash && current->string.size() == length &&
+			                 memcmp(current->string.data(), str, length) == 0))
+			{
+				return bucket;
+			}
+		}
+	}
+
+	void grow()
+	{
+		std::vector<InternedString*> oldBuckets(buckets.size() * 2, (InternedString*)NULL);
+		oldBuckets.swap(buckets);
+		const size_t mask = buckets.size() - 1;
+		for (size_t i = 0; i < oldBuckets.size(); ++i)
+		{
+			if (!oldBuckets[i]) { continue; }
+			size_t bucket = oldBuckets[i]->hash & mask;
+			while (buckets[bucket]) { bucket = (bucket + 1) & mask; }
+			buckets[bucket] = oldBuckets[i];
+		}
+	}
+};
+
+struct Table
+{
+	Shard shards[c_numShards];
+	std::atomic<uint32> nextId;
+	const InternedString* empty;
+
+	Table() : nextId(0) { empty = intern("", 0, hash32_bytes("", 0)); }
+
+	const InternedString* intern(const char* str, size_t length, uint32 hash)
+	{
+		Shard& shard = shards[hash >> (32 - c_numShardBits)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		size_t bucket = shard.findBucket(str, length, hash);
+		if (shard.buckets[bucket]) { return shard.buckets[bucket]; }
+
+		if ((shard.count + 1) * 4 > shard.buckets.size() * 3)
+		{
+			shard.grow();
+			bucket = shard.findBucket(str, length, hash);
+		}
+		shard.storage.push_back(InternedString());
+		InternedString* interned = &shard.storage.back();
+		interned->string.assign(str, length);
+		interned->hash = hash;
+		interned->id = nextId.fetch_add(1, std::memory_order_relaxed);
+		shard.buckets[bucket] = interned;
+		++shard.count;
+		return interned;
+	}
+};
+
+// Never destroyed, as StringHash objects with static storage may outlive it otherwise.
+Table& getTable()
+{
+	static Table* table = new Table;
+	return *table;
+}
+}
+
+const InternedString* StringTable::intern(const char* str, size_t length)
+{
+	return getTable().intern(str, length, hash32_bytes(str, length));
+}
+
+const InternedString* StringTable::intern(const char* str, size_t length, uint32 hash)
+{
+	return getTable().intern(str, length, hash);
+}
+
+const InternedString* StringTable::getEmpty()
+{
+	return getTable().empty;
+}
+
+uint32 StringTable::getNumStrings()
+{
+	return getTable().nextId.load(std::memory_order_relaxed);
+}
+}
+//!\endcond
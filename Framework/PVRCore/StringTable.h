@@ -0,0 +1,65 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\StringTable.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A process-wide, thread-safe table of interned strings.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+#include <string>
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief   A string owned by the StringTable. There is exactly one per distinct string, so two InternedString pointers are
+         equal if and only if their strings are. Immutable, and never destroyed.
+***********************************************************************************************************************/
+struct InternedString
+{
+	std::string string; //!< The characters
+	uint32 hash; //!< hash32_bytes of the characters, equal to pvr::hash<std::string> of the string
+	uint32 id; //!< A small, unique number. Ids are assigned in the order strings are first interned.
+};
+
+/*!*********************************************************************************************************************
+\brief   The process-wide table of interned strings that StringHash objects point to.
+\description Interning a string returns the one InternedString with those characters, creating it the first time. The
+         table is split into shards, selected by hash, each protected by its own mutex, so threads interning
+         different strings rarely contend. Strings are never removed: intern names and keywords, whose number is bounded
+         by the content loaded, rather than arbitrary text.
+***********************************************************************************************************************/
+class StringTable
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief Get the interned string with these characters.
+	\param str The characters. Need not be null terminated.
+	\param length The number of characters
+	\return The interned string. Never NULL.
+	***********************************************************************************************************************/
+	static const InternedString* intern(const char* str, size_t length);
+
+	/*!*********************************************************************************************************************
+	\brief Get the interned string with these characters, when their hash is already known.
+	\param str The characters. Need not be null terminated.
+	\param length The number of characters
+	\param hash hash32_bytes(str, length), for example from a StringHashLiteral
+	\return The interned string. Never NULL.
+	***********************************************************************************************************************/
+	static const InternedString* intern(const char* str, size_t length, uint32 hash);
+
+	/*!*********************************************************************************************************************
+	\brief Get the interned string equal to a string.
+	***********************************************************************************************************************/
+	static const InternedString* intern(const std::string& str) { return intern(str.data(), str.size()); }
+
+	/*!*********************************************************************************************************************
+	\return The interned empty string. Does not lock.
+	***********************************************************************************************************************/
+	static const InternedString* getEmpty();
+
+	/*!*********************************************************************************************************************
+	\return The number of strings interned so far.
+	***********************************************************************************************************************/
+	static uint32 getNumStrings();
+};
+}
@@ -0,0 +1,239 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\TaskScheduler.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of methods of the TaskScheduler and TaskGroup classes.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/TaskScheduler.h"
+#include "PVRCore/ThreadLocalPointer.h"
+
+namespace pvr {
+namespace {
+// The scheduler a worker thread belongs to, and its index there. Each worker keeps its own on its stack.
+struct WorkerIdentity
+{
+	const TaskScheduler* scheduler;
+	uint32 index;
+};
+
+// The identity of the calling thread, NULL if it is not a worker. Never destroyed, as the workers of a static
+// TaskScheduler may run while static objects are destroyed.
+ThreadLocalPointer& getWorkerIdentitySlot()
+{
+	static ThreadLocalPointer* slot = new ThreadLocalPointer;
+	return *slot;
+}
+
+// Spins an idle worker does looking for work before going to sleep.
+const uint32 c_idleSpins = 64;
+
+void splitRange(TaskGroup& group, uint32 first, uint32 last, uint32 grainSize,
+                const std::function<void(uint32, uint32)>& body)
+{
+	// Fork off the upper halves and keep the lowest piece, so that thieves take the largest ranges.
+	while (last - first > grainSize)
+	{
+		const uint32 middle = first + (last - first) / 2;
+		group.run([&group, middle, last, grainSize, &body]()
+		{
+			splitRange(group, middle, last, grainSize, body);
+		});
+		last = middle;
+	}
+	body(first, last);
+}
+}
+
+void TaskGroup::run(const std::function<void()>& task)
+{
+	TaskScheduler::Task* newTask = new TaskScheduler::Task;
+	newTask->function = task;
+	newTask->group = this;
+	m_pending.fetch_add(1, std::memory_order_relaxed);
+	m_scheduler.submit(newTask);
+}
+
+void TaskGroup::wait()
+{
+	while (!isDone())
+	{
+		if (!m_scheduler.helpOne()) { std::this_thread::yield(); }
+	}
+}
+
+TaskScheduler::TaskScheduler(uint32 numWorkers) : m_queuedTasks(0), m_sleepingWorkers(0), m_quit(false)
+{
+	m_workers.reserve(numWorkers);
+	for (uint32 i = 0; i < numWorkers; ++i) { m_workers.push_back(new Worker); }
+	// Create the slot before the workers race to it.
+	getWorkerIdentitySlot();
+	// Start the threads only once every deque exists, as they steal from each other.
+	for (uint32 i = 0; i < numWorkers; ++i)
+	{
+		m_workers[i]->thread = std::thread(&TaskScheduler::workerMain, this, i);
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_quit.store(true);
+	}
+	m_wakeUp.notify_all();
+	// Join every thread before deleting any worker, as the others may still be stealing from its deque.
+	for (uint32 i = 0; i < m_workers.size(); ++i) { m_workers[i]->thread.join(); }
+	for (uint32 i = 0; i < m_workers.size(); ++i) { delete m_workers[i]; }
+	PVR_ASSERT(m_injectionQueue.empty() && "TaskScheduler destroyed with tasks pending");
+}
+
+TaskScheduler& TaskScheduler::getDefault()
+{
+	static TaskScheduler scheduler;
+	return scheduler;
+}
+
+uint32 TaskScheduler::getDefaultNumWorkers()
+{
+	const uint32 hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 2 ? hardwareThreads - 1 : 1;
+}
+
+uint32 TaskScheduler::getCurrentWorkerIndex() const
+{
+	const WorkerIdentity* identity = static_cast<const WorkerIdentity*>(getWorkerIdentitySlot().get());
+	return identity && identity->scheduler == this ? identity->index : getNumWorkers();
+}
+
+void TaskScheduler::submit(Task* task)
+{
+	const uint32 self = getCurrentWorkerIndex();
+	if (self < getNumWorkers())
+	{
+		m_workers[self]->deque.push(task);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(m_injectionMutex);
+		m_injectionQueue.push_back(task);
+	}
+	// Paired with the check in workerMain: either the worker sees the task, or we see the worker asleep.
+	m_queuedTasks.fetch_add(1);
+	if (m_sleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeUp.notify_one();
+	}
+}
+
+TaskScheduler::Task* TaskScheduler::findTask(uint32 self)
+{
+	Task* task = NULL;
+	const uint32 numWorkers = getNumWorkers();
+	if (self < numWorkers && m_workers[self]->deque.pop(task)) { return task; }
+
+	if (m_queuedTasks.load(std::memory_order_relaxed) <= 0) { return NULL; }
+	{
+		std::lock_guard<std::mutex> lock(m_injectionMutex);
+		if (!m_injectionQueue.empty())
+		{
+			task = m_injectionQueue.front();
+			m_injectionQueue.pop_front();
+			return task;
+		}
+	}
+	for (uint32 i = 1; i <= numWorkers; ++i)
+	{
+		const uint32 victim = (self + i) % (numWorkers + 1);
+		if (victim < numWorkers && m_workers[victim]->deque.steal(task))
+		{
+			ThreadStatistics& statistics = self < numWorkers ? m_workers[self]->statistics : m_externalStatistics;
+			statistics.tasksStolen.fetch_add(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+	return NULL;
+}
+
+void TaskScheduler::execute(Task* task, uint32 self)
+{
+	m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	ThreadStatistics& statistics = self < getNumWorkers() ? m_workers[self]->statistics : m_externalStatistics;
+	const uint64 startTime = m_clock.getCurrentTimeNanoSecs();
+	task->function();
+	statistics.busyNanoSecs.fetch_add(m_clock.getCurrentTimeNanoSecs() - startTime, std::memory_order_relaxed);
+	statistics.tasksExecuted.fetch_add(1, std::memory_order_relaxed);
+
+	TaskGroup* group = task->group;
+	delete task;
+	group->m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+bool TaskScheduler::helpOne()
+{
+	const uint32 self = getCurrentWorkerIndex();
+	Task* task = findTask(self);
+	if (!task) { return false; }
+	execute(task, self);
+	return true;
+}
+
+void TaskScheduler::workerMain(uint32 index)
+{
+	WorkerIdentity identity = { this, index };
+	getWorkerIdentitySlot().set(&identity);
+	uint32 idleSpins = 0;
+	while (!m_quit.load(std::memory_order_relaxed))
+	{
+		Task* task = findTask(index);
+		if (task)
+		{
+			execute(task, index);
+			idleSpins = 0;
+			continue;
+		}
+		if (++idleSpins < c_idleSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		idleSpins = 0;
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingWorkers.fetch_add(1);
+		while (!m_quit.load() && m_queuedTasks.load() <= 0) { m_wakeUp.wait(lock); }
+		m_sleepingWorkers.fetch_sub(1);
+	}
+	getWorkerIdentitySlot().set(NULL);
+}
+
+void TaskScheduler::parallelFor(uint32 begin, uint32 end, uint32 grainSize, const std::function<void(uint32, uint32)>& body)
+{
+	if (begin >= end) { return; }
+	TaskGroup group(*this);
+	splitRange(group, begin, end, grainSize ? grainSize : 1, body);
+	group.wait();
+}
+
+TaskScheduler::Statistics TaskScheduler::getStatistics(uint32 worker) const
+{
+	const ThreadStatistics& source = worker < getNumWorkers() ? m_workers[worker]->statistics : m_externalStatistics;
+	Statistics statistics;
+	statistics.tasksExecuted = source.tasksExecuted.load(std::memory_order_relaxed);
+	statistics.tasksStolen = source.tasksStolen.load(std::memory_order_relaxed);
+	statistics.busyNanoSecs = source.busyNanoSecs.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+void TaskScheduler::resetStatistics()
+{
+	for (uint32 i = 0; i <= getNumWorkers(); ++i)
+	{
+		ThreadStatistics& statistics = i < getNumWorkers() ? m_workers[i]->statistics : m_externalStatistics;
+		statistics.tasksExecuted.store(0, std::memory_order_relaxed);
+		statistics.tasksStolen.store(0, std::memory_order_relaxed);
+		statistics.busyNanoSecs.store(0, std::memory_order_relaxed);
+	}
+}
+}
+//!\endcond
@@ -0,0 +1,176 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\TaskScheduler.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A work-stealing task scheduler with fork/join task groups and parallelFor.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+#include "PVRCore/WorkStealingDeque.h"
+#include "PVRCore/Time_.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pvr {
+class TaskScheduler;
+
+/*!*********************************************************************************************************************
+\brief   A set of tasks forked on a TaskScheduler that can be joined together.
+\description Tasks may run further tasks on the same group, for recursive fork/join. wait() does not block while tasks
+         of the scheduler are pending: the waiting thread, worker or not, executes them itself. The destructor waits.
+***********************************************************************************************************************/
+class TaskGroup
+{
+	TaskGroup(const TaskGroup&);
+	TaskGroup& operator=(const TaskGroup&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor.
+	\param scheduler The scheduler the tasks of this group run on
+	***********************************************************************************************************************/
+	explicit TaskGroup(TaskScheduler& scheduler) : m_scheduler(scheduler), m_pending(0) {}
+
+	~TaskGroup() { wait(); }
+
+	/*!*********************************************************************************************************************
+	\brief Queue a task. Returns immediately.
+	***********************************************************************************************************************/
+	void run(const std::function<void()>& task);
+
+	/*!*********************************************************************************************************************
+	\brief Return when all tasks run on this group, including tasks they ran in turn, have completed.
+	***********************************************************************************************************************/
+	void wait();
+
+	/*!*********************************************************************************************************************
+	\return True if no task of this group is pending.
+	***********************************************************************************************************************/
+	bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class TaskScheduler;
+	TaskScheduler& m_scheduler;
+	std::atomic<uint32> m_pending;
+};
+
+/*!*********************************************************************************************************************
+\brief   A pool of worker threads that execute tasks, balancing the load by work stealing.
+\description Each worker owns a Chase-Lev deque. Tasks queued by a worker go to its own deque, which it executes in LIFO
+         order for cache locality, while idle workers steal the oldest (usually largest) tasks from the others. Tasks
+         queued by any other thread go to a shared injection queue. Idle workers sleep until work is queued.
+         Use getDefault() for the scheduler shared by the framework rather than creating new ones.
+***********************************************************************************************************************/
+class TaskScheduler
+{
+	TaskScheduler(const TaskScheduler&);
+	TaskScheduler& operator=(const TaskScheduler&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Per-thread counters. Busy time is measured with pvr::Time around every task.
+	***********************************************************************************************************************/
+	struct Statistics
+	{
+		uint64 tasksExecuted; //!< Tasks executed by the thread
+		uint64 tasksStolen; //!< Tasks the thread took from the deque of another worker
+		uint64 busyNanoSecs; //!< Time spent executing tasks
+		Statistics() : tasksExecuted(0), tasksStolen(0), busyNanoSecs(0) {}
+	};
+
+	/*!*********************************************************************************************************************
+	\brief Constructor. Starts the worker threads.
+	\param numWorkers Number of worker threads. Zero is valid: tasks then only execute in TaskGroup::wait().
+	***********************************************************************************************************************/
+	explicit TaskScheduler(uint32 numWorkers = getDefaultNumWorkers());
+
+	/*!*********************************************************************************************************************
+	\brief Destructor. Stops and joins the worker threads. All task groups must have been waited on.
+	***********************************************************************************************************************/
+	~TaskScheduler();
+
+	/*!*********************************************************************************************************************
+	\return The number of worker threads.
+	***********************************************************************************************************************/
+	uint32 getNumWorkers() const { return (uint32)m_workers.size(); }
+
+	/*!*********************************************************************************************************************
+	\brief Call body on subranges of [begin, end) in parallel and return when all have completed.
+	\param begin First index
+	\param end One past the last index
+	\param grainSize Ranges are split in halves until no longer than this. Pick it so that one range is worth at
+	       least a few microseconds of work.
+	\param body Called with (first, last) for every subrange, last being exclusive
+	***********************************************************************************************************************/
+	void parallelFor(uint32 begin, uint32 end, uint32 grainSize, const std::function<void(uint32, uint32)>& body);
+
+	/*!*********************************************************************************************************************
+	\brief Execute one pending task on the calling thread, if there is one. Lets a thread that is not a worker (typically
+	       the main thread) contribute while it waits for something other than a TaskGroup.
+	\return True if a task was executed
+	***********************************************************************************************************************/
+	bool helpOne();
+
+	/*!*********************************************************************************************************************
+	\param worker Worker index. getNumWorkers() returns the combined counters of all other threads.
+	\return The counters of a worker.
+	***********************************************************************************************************************/
+	Statistics getStatistics(uint32 worker) const;
+
+	/*!*********************************************************************************************************************
+	\brief Reset the counters of all threads.
+	***********************************************************************************************************************/
+	void resetStatistics();
+
+	/*!*********************************************************************************************************************
+	\return The scheduler shared by the framework, created with getDefaultNumWorkers() workers on first use.
+	***********************************************************************************************************************/
+	static TaskScheduler& getDefault();
+
+	/*!*********************************************************************************************************************
+	\return One less than the number of hardware threads, leaving one for the calling thread, but at least one.
+	***********************************************************************************************************************/
+	static uint32 getDefaultNumWorkers();
+
+private:
+	friend class TaskGroup;
+	struct Task
+	{
+		std::function<void()> function;
+		TaskGroup* group;
+	};
+	struct ThreadStatistics
+	{
+		std::atomic<uint64> tasksExecuted;
+		std::atomic<uint64> tasksStolen;
+		std::atomic<uint64> busyNanoSecs;
+		ThreadStatistics() : tasksExecuted(0), tasksStolen(0), busyNanoSecs(0) {}
+	};
+	struct Worker
+	{
+		WorkStealingDeque<Task*> deque;
+		ThreadStatistics statistics;
+		std::thread thread;
+	};
+
+	void submit(Task* task);
+	Task* findTask(uint32 self);
+	void execute(Task* task, uint32 self);
+	void workerMain(uint32 index);
+	uint32 getCurrentWorkerIndex() const;
+
+	std::vector<Worker*> m_workers;
+	ThreadStatistics m_externalStatistics;
+	std::mutex m_injectionMutex;
+	std::deque<Task*> m_injectionQueue;
+	std::atomic<int32> m_queuedTasks;
+	std::atomic<uint32> m_sleepingWorkers;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeUp;
+	std::atomic<bool> m_quit;
+	Time m_clock;
+};
+}
@@ -0,0 +1,76 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\ThreadLocalPointer.cpp
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Implementation of the ThreadLocalPointer class.
+***********************************************************************************************************************/
+//!\cond NO_DOXYGEN
+#include "PVRCore/ThreadLocalPointer.h"
+#include "PVRCore/Log.h"
+
+#if defined(_WIN32)
+#include "windows.h"
+
+namespace pvr {
+ThreadLocalPointer::ThreadLocalPointer(ExitCallback exitCallback)
+{
+	// Fiber local storage, unlike TlsAlloc, calls a callback when a thread exits.
+	const DWORD index = FlsAlloc(exitCallback);
+	if (index == FLS_OUT_OF_INDEXES)
+	{
+		Log(Log.Critical, "[ThreadLocalPointer::ThreadLocalPointer] Out of fiber local storage indexes");
+	}
+	PVR_ASSERT(index != FLS_OUT_OF_INDEXES);
+	m_key = index;
+}
+
+ThreadLocalPointer::~ThreadLocalPointer()
+{
+	FlsFree((DWORD)m_key);
+}
+
+void* ThreadLocalPointer::get() const
+{
+	return FlsGetValue((DWORD)m_key);
+}
+
+void ThreadLocalPointer::set(void* value)
+{
+	FlsSetValue((DWORD)m_key, value);
+}
+}
+#else
+#include <pthread.h>
+
+namespace pvr {
+PVR_STATIC_ASSERT(sizeof(pthread_key_t) <= sizeof(size_t), pthread_key_t_fits_in_m_key);
+
+ThreadLocalPointer::ThreadLocalPointer(ExitCallback exitCallback)
+{
+	pthread_key_t key = 0;
+	const int result = pthread_key_create(&key, exitCallback);
+	if (result != 0)
+	{
+		Log(Log.Critical, "[ThreadLocalPointer::ThreadLocalPointer] pthread_key_create failed with error %d", result);
+	}
+	PVR_ASSERT(result == 0);
+	m_key = (size_t)key;
+}
+
+ThreadLocalPointer::~ThreadLocalPointer()
+{
+	pthread_key_delete((pthread_key_t)m_key);
+}
+
+void* ThreadLocalPointer::get() const
+{
+	return pthread_getspecific((pthread_key_t)m_key);
+}
+
+void ThreadLocalPointer::set(void* value)
+{
+	pthread_setspecific((pthread_key_t)m_key, value);
+}
+}
+#endif
+//!\endcond
@@ -0,0 +1,64 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\ThreadLocalPointer.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         A pointer with a value per thread, and a callback to clean the value up when its thread exits.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+
+#if defined(_WIN32)
+#define PVR_TLS_CALLBACK __stdcall
+#else
+#define PVR_TLS_CALLBACK
+#endif
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief   A pointer with a separate value for each thread, built on the thread local storage of the platform (fiber local
+         storage on Windows, pthread keys elsewhere).
+\description Unlike PVR_THREAD_LOCAL, which is not available on every platform, and unlike C++11 thread_local, which is not
+         supported by every compiler the Framework builds with, ThreadLocalPointer works everywhere and can clean up
+         what it points to: the exit callback is called, on the exiting thread, with the value of each thread that exits
+         with a value other than NULL. The value is NULL in every thread until set. Setting a value from the exit callback
+         may call the callback again, a bounded number of times. ThreadLocalPointer objects are usually created on first
+         use and never destroyed, so that they outlive every thread that may use them: destroying a ThreadLocalPointer
+         does not call the exit callback.
+***********************************************************************************************************************/
+class ThreadLocalPointer
+{
+public:
+	/*!*********************************************************************************************************************
+	\brief   A function called with the value of a thread when the thread exits.
+	***********************************************************************************************************************/
+	typedef void (PVR_TLS_CALLBACK* ExitCallback)(void* value);
+
+	/*!*********************************************************************************************************************
+	\brief   Allocate a thread local storage slot.
+	\param   exitCallback Called with the value of each thread that exits with a value other than NULL. Can be NULL.
+	***********************************************************************************************************************/
+	explicit ThreadLocalPointer(ExitCallback exitCallback = NULL);
+
+	/*!*********************************************************************************************************************
+	\brief   Free the thread local storage slot. The exit callback is not called.
+	***********************************************************************************************************************/
+	~ThreadLocalPointer();
+
+	/*!*********************************************************************************************************************
+	\brief   Get the value of the calling thread.
+	\return  The last value set by the calling thread, or NULL
+	***********************************************************************************************************************/
+	void* get() const;
+
+	/*!*********************************************************************************************************************
+	\brief   Set the value of the calling thread.
+	\param   value The new value of the calling thread
+	***********************************************************************************************************************/
+	void set(void* value);
+
+private:
+	ThreadLocalPointer(const ThreadLocalPointer&);
+	ThreadLocalPointer& operator=(const ThreadLocalPointer&);
+	size_t m_key; // Fiber local storage index or pthread key
+};
+}
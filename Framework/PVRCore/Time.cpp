@@ -16,6 +16,8 @@
 
 #elif defined(__QNX__)
 #include <sys/time.h>
+#include <time.h>
+#define PVR_TIMER_CLOCK CLOCK_MONOTONIC
 
 #else
 #include <time.h>
@@ -29,7 +31,90 @@
 #include "PVRCore/Time_.h"
 #include <ctime>
 
+#if defined(PVR_TIME_TICK_COUNTER_TSC)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 namespace pvr {
+namespace details {
+std::atomic<int32> g_rawTicksSource(0);
+}
+
+namespace {
+// How long the tick counter is measured against the monotonic clock for, if its frequency cannot be queried.
+const uint64 c_calibrationNanoSecs = 5000000;
+
+// True if the tick counter runs at a constant rate, whatever the power state of the core.
+bool hasConstantRateTickCounter()
+{
+#if defined(PVR_TIME_TICK_COUNTER_TSC)
+	// Invariant TSC: CPUID leaf 0x80000007, EDX bit 8
+#if defined(_MSC_VER)
+	int registers[4];
+	__cpuid(registers, 0x80000000);
+	if ((unsigned)registers[0] < 0x80000007u) { return false; }
+	__cpuid(registers, 0x80000007);
+	return (registers[3] & (1 << 8)) != 0;
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007u) { return false; }
+	__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+	return (edx & (1 << 8)) != 0;
+#endif
+#elif defined(PVR_TIME_TICK_COUNTER_CNTVCT)
+	return true; // The ARMv8 generic timer always runs at a fixed frequency
+#else
+	return false;
+#endif
+}
+
+// The clock rawTicks falls back to, and the tick counter is calibrated against. Never destroyed.
+const Time& getMonotonicClock()
+{
+	static Time* clock = new Time;
+	return *clock;
+}
+
+struct RawTicksCalibration
+{
+	float64 ticksPerSecond;
+	float64 nanoSecsPerTick;
+
+	RawTicksCalibration() : ticksPerSecond(1.0e9)
+	{
+		Time::rawTicks(); // Choose the source
+		if (details::g_rawTicksSource.load(std::memory_order_relaxed) == 1)
+		{
+#if defined(PVR_TIME_TICK_COUNTER_CNTVCT)
+			uint64 frequency;
+			__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+			ticksPerSecond = (float64)frequency;
+#else
+			const Time& clock = getMonotonicClock();
+			const uint64 startNanoSecs = clock.getCurrentTimeNanoSecs();
+			const uint64 startTicks = Time::rawTicks();
+			uint64 nanoSecs;
+			do { nanoSecs = clock.getCurrentTimeNanoSecs(); }
+			while (nanoSecs - startNanoSecs < c_calibrationNanoSecs);
+			const uint64 ticks = Time::rawTicks();
+			ticksPerSecond = (float64)(ticks - startTicks) * 1.0e9 / (float64)(nanoSecs - startNanoSecs);
+#endif
+		}
+		nanoSecsPerTick = 1.0e9 / ticksPerSecond;
+	}
+};
+
+const RawTicksCalibration& getRawTicksCalibration()
+{
+	static RawTicksCalibration calibration;
+	return calibration;
+}
+}
+
 Time::Time()
 {
 #if defined(_WIN32)
@@ -116,7 +201,9 @@ uint64 Time::getCurrentTimeNanoSecs() const
 	if (m_highResolutionSupported)
 	{
 		QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
-		currentTime = (1000000000 * (currentTime - initialTime)) / m_timerFrequency;
+		// Split, so that the multiplication does not overflow after a few minutes
+		const uint64 elapsed = currentTime - initialTime;
+		currentTime = (elapsed / m_timerFrequency) * 1000000000ull + (elapsed % m_timerFrequency) * 1000000000ull / m_timerFrequency;
 	}
 	else
 	{
@@ -124,18 +211,16 @@ uint64 Time::getCurrentTimeNanoSecs() const
 	}
 
 #elif defined(__APPLE__)
-	uint64_t time = mach_absolute_time();
-	currentTime = static_cast<uint64>(time * (m_timeBaseInfo->numer / m_timeBaseInfo->denom));
-#elif defined(__QNX__)
-	timeval tv;
-	gettimeofday(&tv,NULL);
-	currentTime =(uint64)((tv.tv_sec*(unsigned long)1000) + (tv.tv_usec/1000.0)) * 1000000;
+	// Divide last, as numer / denom is not an integer on every device, but split so that time * numer does not overflow.
+	const uint64 time = mach_absolute_time();
+	const uint64 numer = m_timeBaseInfo->numer, denom = m_timeBaseInfo->denom;
+	currentTime = (time / denom) * numer + (time % denom) * numer / denom;
 #else
 	timespec time;
 	clock_gettime(PVR_TIMER_CLOCK, &time);
 	currentTime = static_cast<uint64>(time.tv_nsec) +
 	              // convert seconds to ns and add
-	              1e9 * static_cast<uint64>(time.tv_sec);
+	              1000000000ull * static_cast<uint64>(time.tv_sec);
 #endif
 
 	return currentTime;
@@ -193,6 +278,35 @@ uint64 Time::getCurrentTimeHours() const
 	return getCurrentTimeSecs() / 3600ull;
 }
 
+uint64 Time::rawTicksSlow()
+{
+#if defined(PVR_TIME_TICK_COUNTER_TSC) || defined(PVR_TIME_TICK_COUNTER_CNTVCT)
+	int32 source = details::g_rawTicksSource.load(std::memory_order_relaxed);
+	if (source == 0)
+	{
+		// Every thread decides the same, so racing first calls are harmless.
+		source = hasConstantRateTickCounter() ? 1 : 2;
+		details::g_rawTicksSource.store(source, std::memory_order_relaxed);
+	}
+	if (source == 1) { return readTickCounter(); }
+#else
+	details::g_rawTicksSource.store(2, std::memory_order_relaxed);
+#endif
+	return getMonotonicClock().getCurrentTimeNanoSecs();
+}
+
+uint64 Time::rawTicksToNanoSecs(uint64 ticks)
+{
+	const RawTicksCalibration& calibration = getRawTicksCalibration();
+	if (details::g_rawTicksSource.load(std::memory_order_relaxed) != 1) { return ticks; }
+	return static_cast<uint64>(ticks * calibration.nanoSecsPerTick);
+}
+
+float64 Time::getRawTicksPerSecond()
+{
+	return getRawTicksCalibration().ticksPerSecond;
+}
+
 uint64 Time::getTimerFrequencyHertz() const
 {
 	return m_timerFrequency;
@@ -6,12 +6,32 @@
 ***********************************************************************************************************************/
 #pragma once
 #include "PVRCore/CoreIncludes.h"
+#include <atomic>
 
 // Required forward declarations
 #if defined(__APPLE__)
 struct mach_timebase_info;
 #endif
+
+// Platforms with a cheap, constant rate tick counter that Time::rawTicks can read directly
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PVR_TIME_TICK_COUNTER_TSC
+#if defined(_MSC_VER)
+extern "C" unsigned __int64 __rdtsc();
+#pragma intrinsic(__rdtsc)
+#endif
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define PVR_TIME_TICK_COUNTER_CNTVCT
+#endif
+
 namespace pvr {
+//!\cond NO_DOXYGEN
+namespace details {
+// Where Time::rawTicks reads from: 0 until the first call, then 1 for the tick counter or 2 for the fallback.
+extern std::atomic<int32> g_rawTicksSource;
+}
+//!\endcond
+
 /*!****************************************************************************************************
 \brief         This class provides functions for measuring time: current time, elapsed time etc.
               High performance timers are used if available by the platform.
@@ -84,7 +104,52 @@ class Time {
 		              only useful for comparison.
         ******************************************************************************************************/
         uint64 getCurrentTimeHours() const;
+
+		/*!****************************************************************************************************
+        \brief         Provides a timestamp as cheaply as possible, for example for profiling. Ticks are abstract
+		              units: use rawTicksToNanoSecs to convert them. Where available, reads the CPU timestamp
+		              counter (x86 TSC if invariant, ARMv8 virtual counter) with no system call. Otherwise ticks
+		              are the nanoseconds of getCurrentTimeNanoSecs.
+        ******************************************************************************************************/
+        static uint64 rawTicks()
+        {
+#if defined(PVR_TIME_TICK_COUNTER_TSC) || defined(PVR_TIME_TICK_COUNTER_CNTVCT)
+            if (details::g_rawTicksSource.load(std::memory_order_relaxed) == 1) { return readTickCounter(); }
+#endif
+            return rawTicksSlow();
+        }
+
+		/*!****************************************************************************************************
+        \brief         Converts ticks from rawTicks to nanoseconds. The first call may take a few milliseconds, to
+		              calibrate the tick counter against the monotonic clock.
+        ******************************************************************************************************/
+        static uint64 rawTicksToNanoSecs(uint64 ticks);
+
+		/*!****************************************************************************************************
+        \brief         Provides the rate of rawTicks. Calibrates the tick counter on the first call, as
+		              rawTicksToNanoSecs.
+        ******************************************************************************************************/
+        static float64 getRawTicksPerSecond();
     private:
+#if defined(PVR_TIME_TICK_COUNTER_TSC)
+        static uint64 readTickCounter()
+        {
+#if defined(_MSC_VER)
+            return __rdtsc();
+#else
+            return __builtin_ia32_rdtsc();
+#endif
+        }
+#elif defined(PVR_TIME_TICK_COUNTER_CNTVCT)
+        static uint64 readTickCounter()
+        {
+            uint64 ticks;
+            __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+            return ticks;
+        }
+#endif
+        static uint64 rawTicksSlow();
+
         uint64 getTimerFrequencyHertz() const;
         uint64 m_startTime;
         uint64 m_timerFrequency;
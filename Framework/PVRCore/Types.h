@@ -687,4 +687,13 @@ inline float32 randomrange(float32 min, float32 max)
 #define PVR_ALIGNED alignas(16)
 #endif
 
+// Aligns a type to the size of a cache line, so that objects written by different threads do not share a cache line.
+#if defined(_MSC_VER)
+#define PVR_CACHE_LINE_ALIGNED __declspec(align(64))
+#elif defined(__GNUC__) || defined (__clang__)
+#define PVR_CACHE_LINE_ALIGNED __attribute__((aligned(64)))
+#else
+#define PVR_CACHE_LINE_ALIGNED alignas(64)
+#endif
+
 }
@@ -7,6 +7,14 @@
 //!\cond NO_DOXYGEN
 #include <cstring>
 #include "PVRCore/UnicodeConverter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PVR_UNICODE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PVR_UNICODE_NEON
+#include <arm_neon.h>
+#endif
 using std::vector;
 
 namespace pvr {
@@ -14,7 +22,6 @@ namespace utils {
 
 #define VALID_ASCII 0x80
 #define TAIL_MASK 0x3F
-#define BYTES_PER_TAIL 6
 
 #define UTF16_SURG_H_MARK 0xD800
 #define UTF16_SURG_H_END  0xDBFF
@@ -26,13 +33,22 @@ namespace utils {
 #define UNICODE_RESERVED	 0xFFFE
 #define UNICODE_MAX			 0x10FFFF
 
-// A table which allows quick lookup to determine the number of bytes of a UTF8 code point.
-static const utf8 c_utf8TailLengths[256] =
+namespace {
+// UTF-8 is decoded with a deterministic finite automaton. Each byte is mapped to a class, and the state after a byte is
+// looked up from the state before it and the class of the byte. The states encode how many continuation bytes are still
+// expected and, right after a lead byte that restricts it, the range of the next one, which rejects overlong encodings,
+// surrogates and values above U+10FFFF.
+enum Utf8State
+{
+	Utf8Accept = 0, // Between characters
+	Utf8Reject = 1, // Invalid. Final.
+	// Any other state is inside a character.
+};
+
+// Classes: 0 ASCII, 1 continuation 80..8F, 2 continuation 90..9F, 3 continuation A0..BF, 4 never valid (C0, C1, F5..FF),
+// 5 lead of 2 bytes, 6 E0, 7 other leads of 3 bytes, 8 ED, 9 F0, 10 F1..F3, 11 F4.
+const utf8 c_utf8ByteClasses[256] =
 {
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -42,59 +58,121 @@ static const utf8 c_utf8TailLengths[256] =
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
 	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-	3, 3, 3, 3, 3, 3, 3, 3, 0, 0, 0, 0, 0, 0, 0, 0,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 7,
+	9, 10, 10, 10, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
 };
 
-// A table which allows quick lookup to determine whether a UTF8 sequence is 'overlong'.
-static const utf32 c_utf32MinimumValues[4] =
+// The bits of the code point held by a lead byte of each class.
+const utf8 c_utf8LeadMasks[12] = { 0x7F, 0, 0, 0, 0, 0x1F, 0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x07 };
+
+// Next state, indexed by [state][class]. States 2 to 8: 1, 2 or 3 continuation bytes expected (2, 3, 6), 2 expected with
+// the first in A0..BF (4, after E0) or 80..9F (5, after ED), 3 expected with the first in 90..BF (7, after F0) or 80..8F
+// (8, after F4).
+const utf8 c_utf8Transitions[9][12] =
 {
-	0x00000000,		// 0 tail bytes
-	0x00000080,		// 1 tail bytes
-	0x00000800,		// 2 tail bytes
-	0x00010000,		// 3 tail bytes
+	{ 0, 1, 1, 1, 1, 2, 4, 3, 5, 7, 6, 8 },
+	{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+	{ 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
 };
 
+// Copy (if output is not NULL) the ASCII characters at the start of [string, string + length), 16 at a time where
+// possible. Returns how many were copied. Stops early when capacity characters have been written.
+uint32 copyAsciiRun(const utf8* string, uint32 length, utf32* output, uint32 capacity)
+{
+	uint32 i = 0;
+	const uint32 limit = output ? (length < capacity ? length : capacity) : length;
+#if defined(PVR_UNICODE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= limit; i += 16)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string + i));
+		if (_mm_movemask_epi8(bytes)) { break; }
+		if (output)
+		{
+			const __m128i low = _mm_unpacklo_epi8(bytes, zero), high = _mm_unpackhi_epi8(bytes, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 4), _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8), _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 12), _mm_unpackhi_epi16(high, zero));
+		}
+	}
+#elif defined(PVR_UNICODE_NEON)
+	for (; i + 16 <= limit; i += 16)
+	{
+		const uint8x16_t bytes = vld1q_u8(string + i);
+		const uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+		if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ull) { break; }
+		if (output)
+		{
+			const uint16x8_t low = vmovl_u8(vget_low_u8(bytes)), high = vmovl_u8(vget_high_u8(bytes));
+			vst1q_u32(output + i, vmovl_u16(vget_low_u16(low)));
+			vst1q_u32(output + i + 4, vmovl_u16(vget_high_u16(low)));
+			vst1q_u32(output + i + 8, vmovl_u16(vget_low_u16(high)));
+			vst1q_u32(output + i + 12, vmovl_u16(vget_high_u16(high)));
+		}
+	}
+#endif
+	for (; i < limit && string[i] < 0x80; ++i)
+	{
+		if (output) { output[i] = string[i]; }
+	}
+	return i;
+}
+}
+
 uint32 UnicodeConverter::unicodeCount(const utf8* unicodeString)
 {
-	const utf8* currentCharacter = unicodeString;
+	return unicodeCount(unicodeString, static_cast<uint32>(strlen((const char*)unicodeString)));
+}
 
+uint32 UnicodeConverter::unicodeCount(const utf8* unicodeString, uint32 length)
+{
+	// Count the bytes that are not continuation bytes (10xxxxxx, -128 to -65 as signed bytes).
 	uint32 characterCount = 0;
-	while (*currentCharacter)
+	uint32 i = 0;
+#if defined(PVR_UNICODE_SSE2)
+	const __m128i lastContinuation = _mm_set1_epi8(-65);
+	while (i + 16 <= length)
 	{
-		// Quick optimisation for ASCII characters
-		while (*currentCharacter && ((*currentCharacter) > 0))
+		// Per-byte counters, summed before they can overflow.
+		__m128i counts = _mm_setzero_si128();
+		for (uint32 block = 0; block < 255 && i + 16 <= length; ++block, i += 16)
 		{
-			characterCount++;
-			currentCharacter++;
+			const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(unicodeString + i));
+			counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(bytes, lastContinuation));
 		}
-
-		// Done
-#if defined(USE_UTF8)
-		if (*currentCharacter)
+		const __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+		characterCount += static_cast<uint32>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+	}
+#elif defined(PVR_UNICODE_NEON)
+	const int8x16_t lastContinuation = vdupq_n_s8(-65);
+	while (i + 16 <= length)
+	{
+		uint8x16_t counts = vdupq_n_u8(0);
+		for (uint32 block = 0; block < 255 && i + 16 <= length; ++block, i += 16)
 		{
-			utf8 tailMask = *currentCharacter & 0xF0;
-			switch (tailMask)
-			{
-			case 0xF0:
-				currentCharacter++;
-			case 0xE0:
-				currentCharacter++;
-			case 0xC0:
-				currentCharacter++;
-				break;
-			default:
-				//Invalid tail byte
-				return 0;
-			}
-
-			currentCharacter++;
-			characterCount++;
+			const int8x16_t bytes = vreinterpretq_s8_u8(vld1q_u8(unicodeString + i));
+			counts = vsubq_u8(counts, vcgtq_s8(bytes, lastContinuation));
 		}
+		const uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counts)));
+		characterCount += static_cast<uint32>(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1));
+	}
 #endif
+	for (; i < length; ++i)
+	{
+		if ((unicodeString[i] & 0xC0) != 0x80) { ++characterCount; }
 	}
-
 	return characterCount;
 }
 
@@ -198,82 +276,73 @@ Result::Enum UnicodeConverter::convertUTF8ToUTF16(const utf8* unicodeString, vec
 
 Result::Enum UnicodeConverter::convertUTF8ToUTF32(const utf8* unicodeString, vector<utf32>& unicodeStringOut)
 {
-	Result::Enum result = Result::Success;
+	// A string of n bytes has at most n characters: convert in place, then trim.
+	const uint32 stringLength = static_cast<uint32>(strlen((const char*)unicodeString));
+	const size_t previousSize = unicodeStringOut.size();
+	unicodeStringOut.resize(previousSize + stringLength);
+	uint32 outLength = 0;
+	const Result::Enum result = convertUTF8ToUTF32(unicodeString, stringLength,
+	                            stringLength ? &unicodeStringOut[previousSize] : NULL, stringLength, outLength);
+	unicodeStringOut.resize(previousSize + outLength);
+	return result;
+}
 
-	uint32 stringLength = static_cast<uint32>(strlen((const char*)unicodeString));
-	const utf8* currentCharacter = unicodeString;
-	while (*currentCharacter && result == Result::Success)
+Result::Enum UnicodeConverter::convertUTF8ToUTF32(const utf8* unicodeString, uint32 length, utf32* unicodeStringOut,
+    uint32 capacity, uint32& outLength)
+{
+	// With a NULL output, only validates (see isValidUnicode).
+	uint32 written = 0;
+	uint32 i = 0;
+	outLength = 0;
+	while (i < length)
 	{
-		// Quick optimisation for ASCII characters
-		while (*currentCharacter && isAsciiChar(*currentCharacter))
+		if (unicodeStringOut && written == capacity)
 		{
-			unicodeStringOut.push_back(*currentCharacter);
-			++currentCharacter;
+			outLength = written;
+			return Result::OutOfBounds;
 		}
-
-		//Check that we haven't reached the end.
-		if (*currentCharacter != 0)
+		if (unicodeString[i] < 0x80)
 		{
-			//Get the tail length and current character
-			utf32 codePoint = *currentCharacter;
-			uint32 tailLength = c_utf8TailLengths[codePoint];
-
-			//Increment the character
-			++currentCharacter;
-
-			// Check for invalid tail length. Maximum 4 bytes for each UTF8 character.
-			// Also check to make sure the tail length is inside the provided buffer.
-			if (tailLength != 0 && (currentCharacter + tailLength <= unicodeString + stringLength))
+			// Quick optimisation for runs of ASCII characters
+			if (i + 16 <= length)
 			{
-				//Get the data out of the first byte. This depends on the length of the tail.
-				codePoint &= (TAIL_MASK >> tailLength);
-
-				//Get the data out of each tail byte
-				for (uint32 i = 0; i < tailLength; ++i)
-				{
-					// Check for invalid tail bytes
-					if ((currentCharacter[i] & 0xC0) != 0x80)
-					{
-						//Invalid tail byte.
-						result = Result::InvalidArgument;
-					}
-
-					codePoint = (codePoint << BYTES_PER_TAIL) + (currentCharacter[i] & TAIL_MASK);
-				}
-
-				if (result == Result::Success)
-				{
-					currentCharacter += tailLength;
-
-					// Check overlong values.
-					if (codePoint >= c_utf32MinimumValues[tailLength])
-					{
-						if (isValidCodePoint(codePoint))
-						{
-							unicodeStringOut.push_back(codePoint);
-						}
-						else
-						{
-							result = Result::InvalidArgument;
-						}
-					}
-					else
-					{
-						//Overlong!
-						result = Result::InvalidArgument;
-					}
-				}
+				const uint32 asciiLength = copyAsciiRun(unicodeString + i, length - i, unicodeStringOut ? unicodeStringOut + written : NULL,
+				                                        capacity - written);
+				i += asciiLength;
+				written += unicodeStringOut ? asciiLength : 0;
 			}
 			else
 			{
-				result = Result::OutOfBounds;
+				if (unicodeStringOut) { unicodeStringOut[written++] = unicodeString[i]; }
+				++i;
 			}
+			continue;
+		}
 
+		// One multi-byte character
+		const utf8 leadClass = c_utf8ByteClasses[unicodeString[i]];
+		utf32 codePoint = unicodeString[i] & c_utf8LeadMasks[leadClass];
+		uint32 state = c_utf8Transitions[Utf8Accept][leadClass];
+		for (++i; state > Utf8Reject && i < length; ++i)
+		{
+			state = c_utf8Transitions[state][c_utf8ByteClasses[unicodeString[i]]];
+			codePoint = (codePoint << 6) | (unicodeString[i] & TAIL_MASK);
+		}
 
+		if (state != Utf8Accept)
+		{
+			outLength = written;
+			return state == Utf8Reject ? Result::InvalidArgument : Result::OutOfBounds;
 		}
+		if (codePoint >= UNICODE_NONCHAR_MARK && !isValidCodePoint(codePoint))
+		{
+			outLength = written;
+			return Result::InvalidArgument;
+		}
+		if (unicodeStringOut) { unicodeStringOut[written++] = codePoint; }
 	}
-
-	return result;
+	outLength = written;
+	return Result::Success;
 }
 
 Result::Enum UnicodeConverter::convertUTF16ToUTF8(const utf16* unicodeString, vector<utf8>& unicodeStringOut)
@@ -381,66 +450,13 @@ bool UnicodeConverter::isAsciiChar(const char8* asciiString)
 
 bool UnicodeConverter::isValidUnicode(const utf8* unicodeString)
 {
-	uint32 stringLength = unicodeCount(unicodeString);
-	const utf8* currentCharacter = unicodeString;
-	while (*currentCharacter != 0)
-	{
-		//Quick optimisation for ASCII characters - these are always valid.
-		while (*currentCharacter && isAsciiChar((char8)*currentCharacter))
-		{
-			currentCharacter++;
-		}
-
-		//Check that we haven't hit the end with the previous loop.
-		if (*currentCharacter != 0)
-		{
-			//Get the code point
-			utf32 codePoint = *currentCharacter;
-
-			//Move to the next character
-			++currentCharacter;
-
-			//Get the tail length for this codepoint
-			uint32 tailLength = c_utf8TailLengths[codePoint];
-
-			//Check for invalid tail length, characters - there are only a few possibilities here due to the lookup table.
-			//Also check to make sure the tail length is inside the provided buffer.
-			if (tailLength == 0 || (currentCharacter + tailLength > unicodeString + stringLength))
-			{
-				return false;
-			}
-
-			// Get the data out of the first byte. This depends on the length of the tail.
-			codePoint &= (TAIL_MASK >> tailLength);
-
-			// Get the data out of each tail byte, making sure that the tail is valid unicode.
-			for (uint32 i = 0; i < tailLength; ++i)
-			{
-				// Check for invalid tail bytes
-				if ((currentCharacter[i] & 0xC0) != 0x80)
-				{
-					return false;
-				}
-
-				codePoint = (codePoint << BYTES_PER_TAIL) + (currentCharacter[i] & TAIL_MASK);
-			}
-			currentCharacter += tailLength;
-
-			//Check for 'overlong' values - i.e. values which have a tail but don't actually need it..
-			if (codePoint < c_utf32MinimumValues[tailLength])
-			{
-				return false;
-			}
-
-			//Check that it's a valid code point
-			if (!isValidCodePoint(codePoint))
-			{
-				return false;
-			}
-		}
-	}
+	return isValidUnicode(unicodeString, static_cast<uint32>(strlen((const char*)unicodeString)));
+}
 
-	return true;
+bool UnicodeConverter::isValidUnicode(const utf8* unicodeString, uint32 length)
+{
+	uint32 characterCount;
+	return convertUTF8ToUTF32(unicodeString, length, NULL, 0, characterCount) == Result::Success;
 }
 
 bool UnicodeConverter::isValidUnicode(const utf16* unicodeString)
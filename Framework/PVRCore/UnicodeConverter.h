@@ -23,6 +23,15 @@ public:
     ***********************************************************************************************************************/
 	static uint32 unicodeCount(const utf8* unicodeString);
 
+	/*!*********************************************************************************************************************
+	\brief		Count the number of characters in a unicode UTF-8 string of known length. The string is not validated: each
+	            byte that is not a continuation byte counts as a character.
+	\param      unicodeString A UTF-8 string. Need not be NULL-terminated.
+	\param      length The length of unicodeString in bytes
+	\return     The number of characters unicodeString represents.
+    ***********************************************************************************************************************/
+	static uint32 unicodeCount(const utf8* unicodeString, uint32 length);
+
 	/*!*********************************************************************************************************************
 	\brief		Count the number of characters in a unicode UTF-16 string
 	\param      unicodeString A UTF-16 string.
@@ -72,6 +81,20 @@ public:
     ***********************************************************************************************************************/
 	static Result::Enum convertUTF8ToUTF32(const utf8* utf8String, std::vector<utf32>& utf32StringOut);
 
+	/*!*********************************************************************************************************************
+	\brief       Convert a UTF-8 string into a caller-provided buffer, without allocating.
+	\param[in]   utf8String A UTF-8 string. Need not be NULL-terminated.
+	\param      length The length of utf8String in bytes
+	\param[out]  utf32StringOut The resulting UTF-32 string. Not NULL-terminated. At most length characters are written. If
+	             NULL, the string is only validated and capacity is ignored.
+	\param      capacity The number of characters utf32StringOut can hold
+	\param[out]  outLength The number of characters written, including on failure
+	\return      Success, InvalidArgument if the string is not valid UTF-8, or OutOfBounds if it ends inside a character or
+	             utf32StringOut is too small.
+    ***********************************************************************************************************************/
+	static Result::Enum convertUTF8ToUTF32(const utf8* utf8String, uint32 length, utf32* utf32StringOut, uint32 capacity,
+	                                       uint32& outLength);
+
 	/*!*********************************************************************************************************************
 	\param[in]   utf16String A UTF-16 string
 	\param[out]  utf8StringOut The resulting UTF-8 string stored as an std::vector<utf8>
@@ -105,6 +128,13 @@ public:
     ***********************************************************************************************************************/
 	static bool isValidUnicode(const utf8* unicodeString);
 
+	/*!*********************************************************************************************************************
+	\brief  Check if a UTF-8 string of known length contains only valid UTF-8 characters
+	\param  unicodeString A UTF-8 string. Need not be NULL-terminated.
+	\param  length The length of unicodeString in bytes
+    ***********************************************************************************************************************/
+	static bool isValidUnicode(const utf8* unicodeString, uint32 length);
+
 	/*!*********************************************************************************************************************
 	\brief  Check if a string contains only valid UTF-16 characters
     ***********************************************************************************************************************/
@@ -0,0 +1,139 @@
+/*!*********************************************************************************************************************
+\file         PVRCore\WorkStealingDeque.h
+\author       PowerVR by Imagination, Developer Technology Team
+\copyright    Copyright (c) Imagination Technologies Limited.
+\brief         Contains a lock-free Chase-Lev work-stealing deque.
+***********************************************************************************************************************/
+#pragma once
+#include "PVRCore/CoreIncludes.h"
+#include <atomic>
+#include <vector>
+
+namespace pvr {
+/*!*********************************************************************************************************************
+\brief   A lock-free work-stealing deque (Chase and Lev, with the memory orderings of Le et al. 2013).
+\description A single owner thread pushes and pops items at the bottom, in LIFO order, while any number of other threads
+         steal items from the top, in FIFO order. Grows when full. Arrays replaced by growing are kept until the
+         deque is destroyed, as a concurrent thief may still be reading from them.
+\tparam  ItemType The type of the items. Must be trivially copyable and lock-free as an std::atomic (normally a pointer).
+***********************************************************************************************************************/
+template<typename ItemType> class WorkStealingDeque
+{
+	struct Array
+	{
+		int64 capacity;
+		int64 mask;
+		std::atomic<ItemType>* items;
+
+		explicit Array(int64 capacity) : capacity(capacity), mask(capacity - 1), items(new std::atomic<ItemType>[capacity]) {}
+		~Array() { delete[] items; }
+		ItemType get(int64 index) const { return items[index & mask].load(std::memory_order_relaxed); }
+		void put(int64 index, ItemType item) { items[index & mask].store(item, std::memory_order_relaxed); }
+	};
+
+	WorkStealingDeque(const WorkStealingDeque&);
+	WorkStealingDeque& operator=(const WorkStealingDeque&);
+public:
+	/*!*********************************************************************************************************************
+	\brief Constructor.
+	\param initialCapacity The initial capacity. Rounded up to a power of two.
+	***********************************************************************************************************************/
+	explicit WorkStealingDeque(uint32 initialCapacity = 256) : m_top(0), m_bottom(0)
+	{
+		int64 capacity = 2;
+		while (capacity < (int64)initialCapacity) { capacity <<= 1; }
+		Array* array = new Array(capacity);
+		m_arrays.push_back(array);
+		m_array.store(array, std::memory_order_relaxed);
+	}
+
+	~WorkStealingDeque()
+	{
+		for (size_t i = 0; i < m_arrays.size(); ++i) { delete m_arrays[i]; }
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Add an item at the bottom. Owner thread only.
+	***********************************************************************************************************************/
+	void push(ItemType item)
+	{
+		const int64 bottom = m_bottom.load(std::memory_order_relaxed);
+		const int64 top = m_top.load(std::memory_order_acquire);
+		Array* array = m_array.load(std::memory_order_relaxed);
+		if (bottom - top > array->capacity - 1) { array = grow(array, top, bottom); }
+		array->put(bottom, item);
+		// Publishes the item to thieves, which load bottom with acquire.
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Remove the item at the bottom (the most recently pushed). Owner thread only.
+	\param[out] item The removed item
+	\return False if the deque was empty, or its last item was stolen concurrently
+	***********************************************************************************************************************/
+	bool pop(ItemType& item)
+	{
+		const int64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		Array* array = m_array.load(std::memory_order_relaxed);
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 top = m_top.load(std::memory_order_relaxed);
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return false;
+		}
+		item = array->get(bottom);
+		if (top == bottom)
+		{
+			// Last item: race the thieves for it.
+			const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return won;
+		}
+		return true;
+	}
+
+	/*!*********************************************************************************************************************
+	\brief Remove the item at the top (the least recently pushed). Any thread.
+	\param[out] item The removed item
+	\return False if the deque was empty or another thread won the race for the item
+	***********************************************************************************************************************/
+	bool steal(ItemType& item)
+	{
+		int64 top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom) { return false; }
+		Array* array = m_array.load(std::memory_order_acquire);
+		item = array->get(top);
+		return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	/*!*********************************************************************************************************************
+	\return An estimate of the number of items. Exact only when called by the owner with no concurrent thieves.
+	***********************************************************************************************************************/
+	uint32 size() const
+	{
+		const int64 count = m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed);
+		return count > 0 ? (uint32)count : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+private:
+	Array* grow(Array* array, int64 top, int64 bottom)
+	{
+		Array* bigger = new Array(array->capacity * 2);
+		for (int64 i = top; i < bottom; ++i) { bigger->put(i, array->get(i)); }
+		m_arrays.push_back(bigger);
+		m_array.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	std::atomic<int64> m_top;
+	std::atomic<int64> m_bottom;
+	std::atomic<Array*> m_array;
+	std::vector<Array*> m_arrays; // Owner only: every array ever used, freed on destruction
+};
+}
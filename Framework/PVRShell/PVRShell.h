@@ -141,6 +141,9 @@ PVRShell takes a set of command-line arguments which allow items like the positi
 <td>-info</td><td>Output setup information to the debug output.</td>
 </tr>
 <tr>
+<td>-nullgraphics</td><td>Create no native graphics context: record the OpenGL ES calls instead of making them and log how many were made, to measure the CPU cost of the application without a GPU (e.g. with the NullWS build). Only for applications that use PVRApi.</td>
+</tr>
+<tr>
 <td>-posx=N</td><td>Sets the x coordinate of the viewport.</td>
 </tr>
 <tr>
@@ -153,6 +156,9 @@ PVRShell takes a set of command-line arguments which allow items like the positi
 <td>-priority=N</td><td>Sets the priority of the EGL context.</td>
 </tr>
 <tr>
+<td>-profile</td><td>Record profiler zones, log their summary and save them as a Chrome trace on exit.</td>
+</tr>
+<tr>
 <td>-quitafterframe=N or -qaf=N</td><td>Specify the frame after which to quit.</td>
 </tr>
 <tr>
@@ -23,6 +23,16 @@ pvr::GraphicsContextStrongReference createGraphicsContext()
 {
 	return GraphicsContextStrongReference();
 }
+
+/*!********************************************************************************************
+\brief	This is an empty implementation of an external PVRApi function call that PVRShell will
+        use with the -nullgraphics option. Used when PVRApi will not be linked into the application
+\return	An empty Graphics Context, so that the shell refuses -nullgraphics.
+***********************************************************************************************/
+pvr::GraphicsContextStrongReference createNullGraphicsContext()
+{
+	return GraphicsContextStrongReference();
+}
 }
 /*!********************************************************************************************
 \brief	This is an empty implementation of an external PVRApi function call that PVRShell will
@@ -11,6 +11,8 @@
 #include "PVRCore/Log.h"
 #include "PVRShell/OS/ShellOS.h"
 #include "PVRCore/FileStream.h"
+#include "PVRCore/CompressedStream.h"
+#include "PVRCore/TaskScheduler.h"
 #include "PVRShell/TGAWriter.h"
 #include "PVRCore/StringFunctions.h"
 #include <cstdlib>
@@ -166,7 +168,13 @@ Result::Enum Shell::shellQuitApplication()
 
 Result::Enum Shell::shellInitView()
 {
-	m_data->graphicsContextStore = createGraphicsContext();
+	m_data->graphicsContextStore = m_data->nullGraphics ? createNullGraphicsContext() : createGraphicsContext();
+	if (m_data->nullGraphics && !m_data->graphicsContextStore.isValid())
+	{
+		// Without PVRApi nothing records the OpenGL ES calls, which would be made without a native context.
+		Log(Log.Error, "-nullgraphics requires the application to use PVRApi");
+		return Result::UnsupportedRequest;
+	}
 	if (m_data->graphicsContextStore.isValid())
 	{
 		m_data->graphicsContext = m_data->graphicsContextStore;
@@ -456,49 +464,85 @@ uint32  Shell::getFakeFrameTime() const
 	return m_data->fakeFrameTime;
 }
 
+namespace {
+// Replace an open stream of an LZ4 frame with a stream of its decompressed contents. Resets it if it is not a valid frame.
+bool decompressAssetStream(Stream::ptr_type& stream)
+{
+	stream.reset(new CompressedStream(stream, &TaskScheduler::getDefault()));
+	if (stream->open()) { return true; }
+	stream.reset();
+	return false;
+}
+}
+
 Stream::ptr_type Shell::getAssetStream(const string& filename, bool logFileNotFound)
 {
+	// Assets can also be stored compressed, if enabled: "scene.pod" is then also found as "scene.pod.lz4". Both names are
+	// tried at each location before moving on to the next one.
+	static const string compressedExtension(".lz4");
+	const bool tryCompressed = m_data->loadCompressedAssets && (filename.size() < compressedExtension.size() ||
+	                           filename.compare(filename.size() - compressedExtension.size(), compressedExtension.size(),
+	                                            compressedExtension) != 0);
+	const string compressedFilename = tryCompressed ? filename + compressedExtension : string();
+	const string* const names[] = { &filename, &compressedFilename };
+	const size_t numNames = tryCompressed ? 2 : 1;
+
+	Stream::ptr_type stream;
+	for (size_t i = m_assetPacks.size(); i-- > 0;)
+	{
+		for (size_t name = 0; name < numNames; ++name)
+		{
+			stream = m_assetPacks[i]->openStream(*names[name]);
+			if (stream.get() && (name == 0 || decompressAssetStream(stream))) { return stream; }
+		}
+	}
+
 	// The shell will first attempt to open a file in your readpath with the same name.
 	// This allows you to override any built-in assets
 	const std::vector<string>& paths = getOS().getReadPaths();
-	Stream::ptr_type stream;
 	for (size_t i = 0; i < paths.size(); ++i)
 	{
-		string filepath(paths[i]);
-		filepath += filename;
-		stream.reset(new FileStream(filepath, "rb"));
-
-		if (stream->open())
+		for (size_t name = 0; name < numNames; ++name)
 		{
-			return stream;
-		}
+			string filepath(paths[i]);
+			filepath += *names[name];
+			stream.reset(new FileStream(filepath, "rb"));
+
+			if (stream->open() && (name == 0 || decompressAssetStream(stream)))
+			{
+				return stream;
+			}
 
-		stream.reset(0);
+			stream.reset(0);
+		}
 	}
 
 	// Now we attempt to load assets using the OS defined method
+	for (size_t name = 0; name < numNames; ++name)
+	{
 #if defined(_WIN32) // On windows, the filename also matches the resource id in our examples, which is fortunate
-	stream.reset(new WindowsResourceStream(filename.c_str()));
+		stream.reset(new WindowsResourceStream(names[name]->c_str()));
 #elif defined(__ANDROID__) // On android, external files are packaged in the .apk as assets
-	struct android_app* app = static_cast<android_app*>(m_data->os->getApplication());
+		struct android_app* app = static_cast<android_app*>(m_data->os->getApplication());
 
-	if (app && app->activity && app->activity->assetManager)
-	{
-		stream.reset(new AndroidAssetStream(app->activity->assetManager, filename.c_str()));
-	}
-	else
-	{
-		Log(Log.Debug, "Could not request android asset stream %s -- Application, Activity or Assetmanager was null",
-		    filename.c_str());
-	}
+		if (app && app->activity && app->activity->assetManager)
+		{
+			stream.reset(new AndroidAssetStream(app->activity->assetManager, names[name]->c_str()));
+		}
+		else
+		{
+			Log(Log.Debug, "Could not request android asset stream %s -- Application, Activity or Assetmanager was null",
+			    names[name]->c_str());
+		}
 #endif //On the rest of the files, the filesystem is either sandboxed (iOS) or we use it directly (Linux)
-	if (stream.get())
-	{
-		if (stream->open())
+		if (stream.get())
 		{
-			return stream;
+			if (stream->open() && (name == 0 || decompressAssetStream(stream)))
+			{
+				return stream;
+			}
+			stream.reset();
 		}
-		stream.reset();
 	}
 
 	if (logFileNotFound)
@@ -508,6 +552,19 @@ Stream::ptr_type Shell::getAssetStream(const string& filename, bool logFileNotFo
 	return Stream::ptr_type((Stream::ptr_type::element_type*)0);
 }
 
+bool Shell::addAssetPack(const string& packName)
+{
+	RefCountedResource<PackFile> pack;
+	pack.construct();
+	if (!pack->open(getAssetStream(packName)))
+	{
+		Log(Log.Error, "Could not add asset pack [%s]", packName.c_str());
+		return false;
+	}
+	m_assetPacks.push_back(pack);
+	return true;
+}
+
 void Shell::setExitMessage(const tchar* const format, ...)
 {
 	va_list argumentList;
@@ -693,6 +750,44 @@ float Shell::getFPS() const
 	return m_data->FPS;
 }
 
+void Shell::setLoadCompressedAssets(const bool loadCompressedAssets)
+{
+	m_data->loadCompressedAssets = loadCompressedAssets;
+}
+
+bool Shell::isLoadingCompressedAssets() const
+{
+	return m_data->loadCompressedAssets;
+}
+
+void Shell::setProfiling(const bool profiling)
+{
+	Profiler::setEnabled(profiling);
+}
+
+bool Shell::isProfiling() const
+{
+	return Profiler::isEnabled();
+}
+
+void Shell::getProfilerSummary(std::vector<Profiler::ZoneSummary>& summary) const
+{
+	Profiler::getSummary(summary);
+}
+
+bool Shell::saveProfilerTrace() const
+{
+	const string filename = getWritePath() + getApplicationName() + "_trace.json";
+	FileStream file(filename, "w");
+	if (!file.open() || !Profiler::exportChromeTrace(file))
+	{
+		Log(Log.Error, "Failed to save the profiler trace to '%s'", filename.c_str());
+		return false;
+	}
+	Log(Log.Information, "Saved the profiler trace to '%s'", filename.c_str());
+	return true;
+}
+
 void Shell::takeScreenshot() const
 {
 	byte* pBuffer = (byte*) calloc(1, m_data->attributes.width * m_data->attributes.height * 4);
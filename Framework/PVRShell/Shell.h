@@ -7,6 +7,8 @@
 ***********************************************************************************************************************/
 #pragma once
 #include "PVRShell/CommandLine.h"
+#include "PVRCore/Profiler.h"
+#include "PVRCore/PackFile.h"
 
 #include <bitset>
 
@@ -884,6 +886,44 @@ public:
 	******************************************************************************************************************/
 	float getFPS() const;
 
+	/*!****************************************************************************************************************
+	\brief  Make getAssetStream also look for the LZ4 compressed version of each asset (filename + ".lz4"). Disabled by
+	        default, as it costs an extra file system access per location searched for each asset not found there.
+	\param  loadCompressedAssets Set to true to also look for compressed assets, false otherwise.
+	******************************************************************************************************************/
+	void setLoadCompressedAssets(bool loadCompressedAssets);
+
+	/*!****************************************************************************************************************
+	\return  True if getAssetStream also looks for the LZ4 compressed version of each asset.
+	******************************************************************************************************************/
+	bool isLoadingCompressedAssets() const;
+
+	/*!****************************************************************************************************************
+	\brief  Start or stop recording the profiler zones (see PVR_PROFILE_ZONE) of the application and the Framework.
+	        While profiling, the Shell collects the zones after every frame. Also enabled by the -profile command line
+	        option, which additionally saves a trace with saveProfilerTrace() on exit.
+	\param  profiling Set to true to record zones, false otherwise.
+	******************************************************************************************************************/
+	void setProfiling(bool profiling);
+
+	/*!****************************************************************************************************************
+	\return  True if profiler zones are being recorded.
+	******************************************************************************************************************/
+	bool isProfiling() const;
+
+	/*!****************************************************************************************************************
+	\brief  Get the time spent in each profiler zone, averaged over the last frames. Updated every frame.
+	\param[out]  summary Overwritten with the statistics of each zone name
+	******************************************************************************************************************/
+	void getProfilerSummary(std::vector<Profiler::ZoneSummary>& summary) const;
+
+	/*!****************************************************************************************************************
+	\brief  Save the recorded profiler zones as a Chrome trace (chrome://tracing) in the write path, named after the
+	        application.
+	\return  True on success, false if the file could not be written.
+	******************************************************************************************************************/
+	bool saveProfilerTrace() const;
+
 	/*!****************************************************************************************************************
 	\return  The current version of the PowerVR SDK.
 	******************************************************************************************************************/
@@ -947,10 +987,22 @@ public:
 	\brief  Create and return a Stream object for a specific filename. Uses platform dependent lookup rules to create
 	        the	stream from the filesystem or a platform-specific store (Windows resources, Android .apk assets) etc.
 			Will first try the filesystem (if available) and then the built-in stores, in order to allow the user to
-			easily override built-in assets.
+			easily override built-in assets. Asset packs added with addAssetPack are searched before any of these.
+			If setLoadCompressedAssets is enabled, the LZ4 compressed version of the asset (filename + ".lz4", see
+			CompressedStream) is also looked for at each of these locations, after the asset itself, and decompressed
+			transparently.
 	******************************************************************************************************************/
 	Stream::ptr_type getAssetStream(const string& filename, bool logFileNotFound = true);
 
+	/*!****************************************************************************************************************
+	\brief  Add a pack file (see PackFile) to the asset packs searched by getAssetStream. Finding an asset in a pack
+	        costs no file system access, so an application with many assets typically packs them and adds the pack
+	        in initApplication. Packs added last are searched first, so that a patch pack can override assets.
+	\param  packName The name of the pack. Opened with getAssetStream, so it can be a file or a built-in asset.
+	\return  True on success, false if the pack was not found or is not a valid pack file.
+	******************************************************************************************************************/
+	bool addAssetPack(const string& packName);
+
 	/*!****************************************************************************************************************
 	\return  Gets the ShellOS object owned by this shell.
 	******************************************************************************************************************/
@@ -976,6 +1028,7 @@ private:
 	std::bitset<256> m_keystate;
 	PrivatePointerState m_pointerState;
 	ShellData* m_data;
+	std::vector<RefCountedResource<PackFile> > m_assetPacks;
 
 	SimplifiedInput::Enum MapKeyToMainInput(Keys::Enum key)
 	{
@@ -65,6 +65,9 @@ struct ShellData
 
 	float FPS;
 	bool showFPS;
+	bool saveProfilerTrace;
+	bool nullGraphics;
+	bool loadCompressedAssets;
 
 	Api::Enum contextType;
 	Api::Enum minContextType;
@@ -89,6 +92,9 @@ struct ShellData
 		weAreDone(false),
 		FPS(0.0f),
 		showFPS(false),
+		saveProfilerTrace(false),
+		nullGraphics(false),
+		loadCompressedAssets(false),
 		contextType(Api::Unspecified),
 		minContextType(Api::Unspecified),
 		deviceQueueType(DeviceQueueType::Graphics)
@@ -8,8 +8,10 @@
 #include "PVRShell/StateMachine.h"
 #include "PVRShell/Shell.h"
 #include "PVRCore/IPlatformContext.h"
+#include "PVRCore/NullPlatformContext.h"
 #include "PVRCore/FileStream.h"
 #include "PVRCore/Log.h"
+#include "PVRCore/Profiler.h"
 #include "PVRCore/Time_.h"
 #include <cstdlib>
 #include <cmath>
@@ -196,6 +198,11 @@ void StateMachine::applyCommandLine()
 			{
 				m_shellData.outputInfo = true;
 			}
+			else if (strcasecmp(arg, "-profile") == 0)
+			{
+				m_shellData.saveProfilerTrace = true;
+				m_shell->setProfiling(true);
+			}
 			else if (strcasecmp(arg, "-forceframetime") == 0 || strcasecmp(arg, "-fft") == 0)
 			{
 				m_shell->setForceFrameTime(true);
@@ -254,7 +261,16 @@ Result::Enum StateMachine::executeOnce()
 		return Result::NotInitialised;
 	case StateInitApplication:
 		m_shell = newDemo();
-		m_shellData.platformContext = pvr::createNativePlatformContext(*m_shell);
+		// -nullgraphics replaces the native context, so it is applied before the rest of the command line
+		m_shellData.nullGraphics = m_shellData.commandLine->getParsedCommandLine().hasOption("-nullgraphics");
+		if (m_shellData.nullGraphics)
+		{
+			m_shellData.platformContext.reset(new platform::NullPlatformContext(*m_shell));
+		}
+		else
+		{
+			m_shellData.platformContext = pvr::createNativePlatformContext(*m_shell);
+		}
 		result = m_shell->init(&m_shellData);
 
 		if (result == Result::Success)
@@ -348,8 +364,13 @@ Result::Enum StateMachine::executeOnce()
 		// Process any OS events
 		ShellOS::handleOSEvents();
 
+		ProfileZone frameZone("Frame");
+
 		// Call RenderScene
-		result = m_shell->shellRenderFrame();
+		{
+			PVR_PROFILE_ZONE("renderFrame");
+			result = m_shell->shellRenderFrame();
+		}
 
 		if (m_shellData.weAreDone && result == Result::Success)
 		{
@@ -359,7 +380,10 @@ Result::Enum StateMachine::executeOnce()
 		if (result == Result::Success)
 		{
 			// Swap buffers
-			result = m_shellData.presentBackBuffer ? m_shellData.platformContext->presentBackbuffer() : Result::Success;
+			{
+				PVR_PROFILE_ZONE("presentBackbuffer");
+				result = m_shellData.presentBackBuffer ? m_shellData.platformContext->presentBackbuffer() : Result::Success;
+			}
 
 			if (result != Result::Success)
 			{
@@ -408,6 +432,13 @@ Result::Enum StateMachine::executeOnce()
 			}
 		}
 
+		// Collect this frame's profiler zones
+		frameZone.end();
+		if (Profiler::isEnabled())
+		{
+			Profiler::endFrame();
+		}
+
 		// Have we reached the point where we need to die?
 		if ((m_shellData.dieAfterFrame >= 0 && m_shellData.frameNo >= static_cast<uint32>(m_shellData.dieAfterFrame))
 		    || (m_shellData.dieAfterTime >= 0 && ((m_shellData.timer.getCurrentTimeMilliSecs() - m_shellData.startTime) * 0.001f) > m_shellData.dieAfterTime)
@@ -466,6 +497,12 @@ Result::Enum StateMachine::executeOnce()
 		Log(Log.Debug, "QuitApplication");
 		result = m_shell->shellQuitApplication();
 
+		if (m_shellData.saveProfilerTrace)
+		{
+			Profiler::logSummary();
+			m_shell->saveProfilerTrace();
+		}
+
 		if (result != Result::Success)
 		{
 			string error = string("QuitApplication() failed with pvr error '") + Log.getResultCodeString(result) + string("'\n");
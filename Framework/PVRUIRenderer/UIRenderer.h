@@ -6,6 +6,7 @@
 ***********************************************************************************************************************/
 #pragma once
 #include "PVRUIRenderer/Sprite.h"
+#include "PVRCore/Profiler.h"
 
 
 namespace pvr {
@@ -306,6 +307,7 @@ public:
 		cb->pushPipeline();// store the currently bound pipeline
 		cb->bindPipeline(getPipeline());// bind the uirenderer pipeline
 		m_activeCommandBuffer = cb;
+		m_renderingZone.begin("UIRenderer rendering");
 	}
 
 	/*!****************************************************************************************************************
@@ -328,6 +330,7 @@ public:
 		cb->pushPipeline();
 		cb->bindPipeline(pipe);
 		m_activeCommandBuffer = cb;
+		m_renderingZone.begin("UIRenderer rendering");
 	}
 
 	/*!****************************************************************************************************************
@@ -348,6 +351,7 @@ public:
 			}
 			m_activeCommandBuffer.release();
 		}
+		m_renderingZone.end();
 	}
 
 	/*!****************************************************************************************************************
@@ -500,6 +504,7 @@ private:
 	api::Sampler m_samplerBilinear;
 	api::SecondaryCommandBuffer m_activeCommandBuffer;
 	bool m_mustEndCommandBuffer;
+	ProfileZone m_renderingZone; // From beginRendering to endRendering
 	api::Buffer m_fontIbo;
 	api::Buffer m_imageVbo;
 	glm::vec2 m_screenDimensions;